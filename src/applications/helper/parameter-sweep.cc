@@ -0,0 +1,373 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2015 Universite catholique de Louvain
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Lionel Metongnon <lionel.metongnon@uclouvain.be>
+ */
+
+#include "parameter-sweep.h"
+#include "ns3/log.h"
+#include "ns3/abort.h"
+#include "ns3/system-path.h"
+
+#include <cctype>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <list>
+#include <map>
+#include <sstream>
+
+#include <fcntl.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("ParameterSweep");
+
+namespace {
+
+/**
+ * \param name a file name
+ * \param suffix a suffix
+ * \returns true if the name ends with the suffix
+ */
+bool
+EndsWith (const std::string &name, const std::string &suffix)
+{
+  return name.size () >= suffix.size ()
+         && name.compare (name.size () - suffix.size (), suffix.size (), suffix) == 0;
+}
+
+} // anonymous namespace
+
+ParameterSweep::ParameterSweep ()
+  : m_firstRun (1),
+    m_nRuns (1),
+    m_jobs (0),
+    m_directory ("./sweep")
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+ParameterSweep::SetProgram (std::string program)
+{
+  NS_LOG_FUNCTION (this << program);
+  m_program = program;
+}
+
+void
+ParameterSweep::AddArgument (std::string argument)
+{
+  NS_LOG_FUNCTION (this << argument);
+  m_arguments.push_back (argument);
+}
+
+void
+ParameterSweep::AddParameter (std::string name, const std::vector<std::string> &values)
+{
+  NS_LOG_FUNCTION (this << name << values.size ());
+  NS_ABORT_MSG_IF (values.empty (), "ParameterSweep: no value for " << name);
+  m_names.push_back (name);
+  m_values.push_back (values);
+}
+
+void
+ParameterSweep::AddParameter (std::string name, std::string values)
+{
+  NS_LOG_FUNCTION (this << name << values);
+  std::vector<std::string> split;
+  std::istringstream is (values);
+  std::string value;
+  while (std::getline (is, value, ','))
+    {
+      split.push_back (value);
+    }
+  AddParameter (name, split);
+}
+
+void
+ParameterSweep::SetRuns (uint32_t first, uint32_t count)
+{
+  NS_LOG_FUNCTION (this << first << count);
+  m_firstRun = first;
+  m_nRuns = count;
+}
+
+void
+ParameterSweep::SetJobs (uint32_t jobs)
+{
+  NS_LOG_FUNCTION (this << jobs);
+  m_jobs = jobs;
+}
+
+void
+ParameterSweep::SetOutputDirectory (std::string directory)
+{
+  NS_LOG_FUNCTION (this << directory);
+  m_directory = directory;
+}
+
+uint32_t
+ParameterSweep::GetNRuns (void) const
+{
+  uint32_t n = m_nRuns;
+  for (uint32_t i = 0; i < m_values.size (); ++i)
+    {
+      n *= m_values[i].size ();
+    }
+  return n;
+}
+
+const std::vector<ParameterSweep::Run> &
+ParameterSweep::GetRuns (void) const
+{
+  return m_runs;
+}
+
+std::string
+ParameterSweep::Clean (std::string word)
+{
+  for (std::string::iterator c = word.begin (); c != word.end (); ++c)
+    {
+      if (!isalnum (*c) && *c != '.' && *c != '+' && *c != '-')
+        {
+          *c = '.';
+        }
+    }
+  return word;
+}
+
+void
+ParameterSweep::Prepare (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_runs.clear ();
+  m_runs.reserve (GetNRuns ());
+
+  // odometer over the indexes of the values, the last parameter first
+  std::vector<uint32_t> index (m_values.size (), 0);
+  bool done = false;
+  while (!done)
+    {
+      Run run;
+      std::ostringstream name;
+      for (uint32_t i = 0; i < m_values.size (); ++i)
+        {
+          run.values.push_back (m_values[i][index[i]]);
+          name << Clean (m_names[i]) << "-" << Clean (m_values[i][index[i]]) << "_";
+        }
+      run.status = -1;
+      std::memset (&run.results, 0, sizeof (run.results));
+      for (uint32_t r = m_firstRun; r < m_firstRun + m_nRuns; ++r)
+        {
+          std::ostringstream directory;
+          directory << m_directory << "/" << name.str () << "run-" << r;
+          run.rngRun = r;
+          run.directory = directory.str ();
+          m_runs.push_back (run);
+        }
+
+      done = true;
+      for (uint32_t i = m_values.size (); i-- > 0; )
+        {
+          if (++index[i] < m_values[i].size ())
+            {
+              done = false;
+              break;
+            }
+          index[i] = 0;
+        }
+    }
+}
+
+int
+ParameterSweep::Spawn (const Run &run) const
+{
+  NS_LOG_FUNCTION (this << run.directory);
+  SystemPath::MakeDirectories (run.directory + "/data");
+  SystemPath::MakeDirectories (run.directory + "/plot");
+
+  std::vector<std::string> arguments;
+  arguments.push_back (m_program);
+  arguments.insert (arguments.end (), m_arguments.begin (), m_arguments.end ());
+  for (uint32_t i = 0; i < m_names.size (); ++i)
+    {
+      arguments.push_back ("--" + m_names[i] + "=" + run.values[i]);
+    }
+  std::ostringstream rngRun;
+  rngRun << "--RngRun=" << run.rngRun;
+  arguments.push_back (rngRun.str ());
+
+  // nothing is allocated in the child
+  std::vector<char *> argv;
+  for (uint32_t i = 0; i < arguments.size (); ++i)
+    {
+      argv.push_back (const_cast<char *> (arguments[i].c_str ()));
+    }
+  argv.push_back (0);
+  std::string directory = run.directory;
+
+  std::cout.flush ();
+  std::cerr.flush ();
+  std::fflush (0);
+  pid_t pid = ::fork ();
+  NS_ABORT_MSG_IF (pid < 0, "ParameterSweep::Spawn(): fork error, errno = " << std::strerror (errno));
+  if (pid == 0)
+    {
+      if (::chdir (directory.c_str ()) != 0)
+        {
+          _exit (126);
+        }
+      int fd = ::open ("output.log", O_WRONLY | O_CREAT | O_TRUNC, 0644);
+      if (fd >= 0)
+        {
+          ::dup2 (fd, 1);
+          ::dup2 (fd, 2);
+          ::close (fd);
+        }
+      ::execvp (argv[0], &argv[0]);
+      _exit (127);
+    }
+  return pid;
+}
+
+uint32_t
+ParameterSweep::Start (void)
+{
+  NS_LOG_FUNCTION (this);
+  NS_ABORT_MSG_IF (m_program.empty (), "ParameterSweep: no program");
+  // the runs do not start in the current directory
+  if (m_program.find ('/') != std::string::npos && m_program[0] != '/')
+    {
+      char cwd[4096];
+      NS_ABORT_MSG_IF (::getcwd (cwd, sizeof (cwd)) == 0, "ParameterSweep: getcwd error");
+      m_program = std::string (cwd) + "/" + m_program;
+    }
+  Prepare ();
+
+  uint32_t jobs = m_jobs;
+  if (jobs == 0)
+    {
+      long cores = ::sysconf (_SC_NPROCESSORS_ONLN);
+      jobs = cores > 0 ? cores : 1;
+    }
+  NS_LOG_INFO (m_runs.size () << " runs, " << jobs << " at a time");
+
+  std::map<pid_t, uint32_t> running;
+  uint32_t next = 0;
+  uint32_t failed = 0;
+  while (next < m_runs.size () || !running.empty ())
+    {
+      while (next < m_runs.size () && running.size () < jobs)
+        {
+          running[Spawn (m_runs[next])] = next;
+          ++next;
+        }
+      // only reap the runs: the other children of the process, such as
+      // SimulationCheckpoint variants, are waited for by their owners
+      int status;
+      std::map<pid_t, uint32_t>::iterator it = running.begin ();
+      while (it != running.end ())
+        {
+          pid_t pid = ::waitpid (it->first, &status, WNOHANG);
+          NS_ABORT_MSG_IF (pid < 0 && errno != EINTR,
+                           "ParameterSweep::Start(): waitpid error, errno = " << std::strerror (errno));
+          if (pid == it->first)
+            {
+              break;
+            }
+          ++it;
+        }
+      if (it == running.end ())
+        {
+          ::usleep (10000);
+          continue;
+        }
+      Run &run = m_runs[it->second];
+      running.erase (it);
+      run.status = WIFEXITED (status) ? WEXITSTATUS (status) : 128 + WTERMSIG (status);
+      run.results = ReadResults (run.directory + "/data");
+      if (run.status != 0)
+        {
+          NS_LOG_WARN (run.directory << " exited with status " << run.status);
+          ++failed;
+        }
+    }
+
+  std::ofstream summary ((m_directory + "/summary.tsv").c_str ());
+  PrintSummary (summary);
+  return failed;
+}
+
+void
+ParameterSweep::PrintSummary (std::ostream &os) const
+{
+  os << "#";
+  for (uint32_t i = 0; i < m_names.size (); ++i)
+    {
+      os << m_names[i] << "\t";
+    }
+  os << "run\tstatus\tdiscovered\tnetworks\tcompromised\n";
+  for (std::vector<Run>::const_iterator run = m_runs.begin (); run != m_runs.end (); ++run)
+    {
+      for (uint32_t i = 0; i < run->values.size (); ++i)
+        {
+          os << run->values[i] << "\t";
+        }
+      os << run->rngRun << "\t" << run->status << "\t" << run->results.discovered << "\t"
+         << run->results.networks << "\t" << run->results.compromised << "\n";
+    }
+}
+
+ParameterSweep::Results
+ParameterSweep::ReadResults (std::string directory)
+{
+  Results results;
+  std::memset (&results, 0, sizeof (results));
+  std::list<std::string> files = SystemPath::ReadFiles (directory);
+  for (std::list<std::string>::const_iterator file = files.begin (); file != files.end (); ++file)
+    {
+      std::ifstream is ((directory + "/" + *file).c_str ());
+      if (EndsWith (*file, "_scanning.rst"))
+        {
+          // <size>_<hosts>_node<id>_scanning.rst, one line per network
+          std::istringstream name (file->substr (file->find ('_') + 1));
+          uint32_t hosts = 0;
+          name >> hosts;
+          results.discovered += hosts;
+          std::string line;
+          while (std::getline (is, line))
+            {
+              results.networks += !line.empty ();
+            }
+        }
+      else if (EndsWith (*file, "_penetration.rst"))
+        {
+          uint32_t compromised = 0;
+          is >> compromised;
+          results.compromised += compromised;
+        }
+    }
+  return results;
+}
+
+} // namespace ns3
@@ -0,0 +1,193 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2015 Universite catholique de Louvain
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Lionel Metongnon <lionel.metongnon@uclouvain.be>
+ */
+
+#ifndef PARAMETER_SWEEP_H
+#define PARAMETER_SWEEP_H
+
+#include <stdint.h>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \ingroup udpecho
+ * \brief Run a simulation program for every combination of parameters
+ *
+ * ScanTools and PenetrationTools write their results to ./data and ./plot
+ * under names which only depend on the packet size and on the number of
+ * hosts, so that two runs started from the same directory overwrite each
+ * other's files.  The sweep runs each combination of the parameter values,
+ * for each RngRun, in a process of its own whose working directory is a
+ * directory named after the parameters and the run:
+ *
+ * \verbatim
+   <output>/<name>-<value>_..._run-<RngRun>/data
+   <output>/<name>-<value>_..._run-<RngRun>/plot
+   <output>/<name>-<value>_..._run-<RngRun>/output.log
+   \endverbatim
+ *
+ * The program is given --<name>=<value> for each parameter and
+ * --RngRun=<run>, after its fixed arguments; output.log gets its standard
+ * output and error.  Up to one process per core is run at a time.  Once
+ * all the runs are over, the results found in the data directories are
+ * gathered in <output>/summary.tsv, one line per run.
+ */
+class ParameterSweep
+{
+public:
+  /**
+   * \brief Results of a run
+   */
+  struct Results
+  {
+    uint32_t discovered;  //!< hosts discovered by the scanners
+    uint32_t networks;    //!< networks with a discovered host
+    uint32_t compromised; //!< hosts compromised
+  };
+
+  /**
+   * \brief A run of the program
+   */
+  struct Run
+  {
+    std::vector<std::string> values; //!< values of the parameters
+    uint32_t rngRun;                 //!< RngRun of the run
+    std::string directory;           //!< working directory of the run
+    int status;                      //!< exit status, -1 if not run
+    Results results;                 //!< results found in the directory
+  };
+
+  ParameterSweep ();
+
+  /**
+   * \param program the simulation program
+   */
+  void SetProgram (std::string program);
+
+  /**
+   * \brief Add an argument given to every run, before the parameters
+   * \param argument the argument
+   */
+  void AddArgument (std::string argument);
+
+  /**
+   * \brief Add a parameter
+   * \param name the name of the command line argument
+   * \param values the values of the parameter
+   */
+  void AddParameter (std::string name, const std::vector<std::string> &values);
+
+  /**
+   * \brief Add a parameter
+   * \param name the name of the command line argument
+   * \param values the values of the parameter, separated by commas
+   */
+  void AddParameter (std::string name, std::string values);
+
+  /**
+   * \brief Set the RngRun of the runs of each combination
+   * \param first the first RngRun
+   * \param count the number of runs
+   */
+  void SetRuns (uint32_t first, uint32_t count);
+
+  /**
+   * \param jobs the maximum number of processes at a time, 0 for the
+   * number of cores
+   */
+  void SetJobs (uint32_t jobs);
+
+  /**
+   * \param directory the directory of the runs
+   */
+  void SetOutputDirectory (std::string directory);
+
+  /**
+   * \returns the number of runs of the sweep
+   */
+  uint32_t GetNRuns (void) const;
+
+  /**
+   * \brief Run the program for all the combinations and gather the results
+   * \returns the number of runs which failed
+   */
+  uint32_t Start (void);
+
+  /**
+   * \returns the runs
+   */
+  const std::vector<Run> &GetRuns (void) const;
+
+  /**
+   * \brief Print the summary table, one line per run
+   * \param os the output stream
+   */
+  void PrintSummary (std::ostream &os) const;
+
+  /**
+   * \brief Read the results of a run
+   *
+   * The number of hosts discovered is the one in the name of the
+   * <size>_<hosts>_node<id>_scanning.rst files, one per scanner, the number
+   * of networks is the number of lines of these files and the number of
+   * compromised hosts is the content of the <size>_<n>_node<id>_penetration.rst
+   * files.
+   *
+   * \param directory the data directory of the run
+   * \returns the results
+   */
+  static Results ReadResults (std::string directory);
+
+private:
+  /**
+   * \brief Build the list of the runs
+   */
+  void Prepare (void);
+
+  /**
+   * \brief Start the program for a run
+   * \param run the run
+   * \returns the process of the run
+   */
+  int Spawn (const Run &run) const;
+
+  /**
+   * \param word a parameter name or value
+   * \returns the word, with the characters which are not welcome in a
+   * file name replaced
+   */
+  static std::string Clean (std::string word);
+
+  std::string m_program;                 //!< simulation program
+  std::vector<std::string> m_arguments;  //!< fixed arguments
+  std::vector<std::string> m_names;      //!< names of the parameters
+  std::vector<std::vector<std::string> > m_values; //!< values of the parameters
+  uint32_t m_firstRun;                   //!< first RngRun
+  uint32_t m_nRuns;                      //!< runs per combination
+  uint32_t m_jobs;                       //!< processes at a time, 0 for one per core
+  std::string m_directory;               //!< directory of the runs
+  std::vector<Run> m_runs;               //!< runs of the last Start ()
+};
+
+} // namespace ns3
+
+#endif /* PARAMETER_SWEEP_H */
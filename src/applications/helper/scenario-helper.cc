@@ -0,0 +1,600 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2015 Universite catholique de Louvain
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Lionel Metongnon <lionel.metongnon@uclouvain.be>
+ */
+
+#include "scenario-helper.h"
+#include "sim-attack-helper.h"
+#include "sim-coap-helper.h"
+#include "dns-helper.h"
+#include "ns3/log.h"
+#include "ns3/abort.h"
+#include "ns3/string.h"
+#include "ns3/nstime.h"
+#include "ns3/ipv6.h"
+#include "ns3/ipv6-address-list.h"
+#include "ns3/ipv6-static-routing-helper.h"
+#include "ns3/ripng-helper.h"
+#include "ns3/wire-network.h"
+#include <cctype>
+#include <fstream>
+#include <sstream>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("ScenarioHelper");
+
+namespace {
+
+/**
+ * \brief Read an unsigned integer
+ * \param word the word to read
+ * \param value the integer read
+ * \returns true if the whole word is an integer
+ */
+bool
+ToUint (std::string word, uint32_t &value)
+{
+  std::istringstream is (word);
+  return (is >> value) && is.eof () && word[0] != '-';
+}
+
+/**
+ * \brief Set the attributes of the applications a helper installs
+ * \param helper the helper
+ * \param attributes the attributes, by name
+ */
+template <typename T>
+void
+SetAttributes (T &helper, const std::map<std::string, std::string> &attributes)
+{
+  for (std::map<std::string, std::string>::const_iterator i = attributes.begin (); i != attributes.end (); ++i)
+    {
+      helper.SetAttribute (i->first, StringValue (i->second));
+    }
+}
+
+} // anonymous namespace
+
+ScenarioHelper::ScenarioHelper ()
+  : m_ripng (false),
+    m_nNetworks (0),
+    m_line (0)
+{
+  NS_LOG_FUNCTION (this);
+  Ipv6StaticRoutingHelper staticRouting;
+  m_routing = new Ipv6ListRoutingHelper ();
+  m_routing->Add (staticRouting, 0);
+}
+
+ScenarioHelper::~ScenarioHelper ()
+{
+  NS_LOG_FUNCTION (this);
+  delete m_routing;
+  m_routing = 0;
+}
+
+void
+ScenarioHelper::SetVariable (std::string name, std::string value)
+{
+  NS_LOG_FUNCTION (this << name << value);
+  m_variables[name] = value;
+}
+
+void
+ScenarioHelper::Load (std::string fileName)
+{
+  NS_LOG_FUNCTION (this << fileName);
+  std::ifstream is (fileName.c_str ());
+  NS_ABORT_MSG_UNLESS (is.is_open (), "ScenarioHelper: cannot open " << fileName);
+  Load (is);
+}
+
+void
+ScenarioHelper::Load (std::istream &is)
+{
+  NS_LOG_FUNCTION (this);
+  std::string line;
+  std::vector<std::string> tokens;
+  m_line = 0;
+  while (std::getline (is, line))
+    {
+      ++m_line;
+      std::string::size_type comment = line.find ('#');
+      if (comment != std::string::npos)
+        {
+          line.erase (comment);
+        }
+      std::istringstream words (line);
+      std::string word;
+      tokens.clear ();
+      while (words >> word)
+        {
+          tokens.push_back (Substitute (word));
+        }
+      if (!tokens.empty ())
+        {
+          Parse (tokens);
+        }
+    }
+  NS_LOG_INFO (m_line << " lines read, " << m_nNetworks << " networks, "
+                      << m_targetedNetworks.size () << " targeted networks, "
+                      << m_apps.GetN () << " applications");
+}
+
+const std::vector<ScenarioHelper::Entry> &
+ScenarioHelper::GetGroup (std::string group) const
+{
+  std::map<std::string, std::vector<Entry> >::const_iterator it = m_groups.find (group);
+  NS_ABORT_MSG_IF (it == m_groups.end (), "ScenarioHelper: no group " << group);
+  return it->second;
+}
+
+uint32_t
+ScenarioHelper::GetNNetworks (void) const
+{
+  return m_nNetworks;
+}
+
+std::map<Ipv6Address, Ipv6Prefix> &
+ScenarioHelper::GetTargetedNetworks (void)
+{
+  return m_targetedNetworks;
+}
+
+ApplicationContainer
+ScenarioHelper::GetApplications (void) const
+{
+  return m_apps;
+}
+
+void
+ScenarioHelper::Parse (const std::vector<std::string> &tokens)
+{
+  NS_LOG_FUNCTION (this << tokens[0]);
+  if (tokens[0] == "set")
+    {
+      if (tokens.size () != 3)
+        {
+          Error ("expected set <name> <value>");
+        }
+      // the values given by SetVariable () win over the file
+      m_variables.insert (std::make_pair (tokens[1], tokens[2]));
+    }
+  else if (tokens[0] == "routing")
+    {
+      DoRouting (tokens);
+    }
+  else if (tokens[0] == "network")
+    {
+      DoNetwork (tokens);
+    }
+  else if (tokens[0] == "core")
+    {
+      DoCore (tokens);
+    }
+  else if (tokens[0] == "target")
+    {
+      DoTarget (tokens);
+    }
+  else if (tokens[0] == "app")
+    {
+      DoApp (tokens);
+    }
+  else
+    {
+      Error ("unknown directive " + tokens[0]);
+    }
+}
+
+void
+ScenarioHelper::DoRouting (const std::vector<std::string> &tokens)
+{
+  if (tokens.size () != 2 || (tokens[1] != "static" && tokens[1] != "ripng"))
+    {
+      Error ("expected routing static|ripng");
+    }
+  if (m_nNetworks != 0)
+    {
+      Error ("the routing must be set before the first network");
+    }
+  m_ripng = (tokens[1] == "ripng");
+  delete m_routing;
+  m_routing = new Ipv6ListRoutingHelper ();
+  Ipv6StaticRoutingHelper staticRouting;
+  if (m_ripng)
+    {
+      RipNgHelper ripNgRouting;
+      m_routing->Add (ripNgRouting, 0);
+      m_routing->Add (staticRouting, 5);
+    }
+  else
+    {
+      m_routing->Add (staticRouting, 0);
+    }
+}
+
+void
+ScenarioHelper::DoNetwork (const std::vector<std::string> &tokens)
+{
+  if (tokens.size () < 6)
+    {
+      Error ("expected network <group> <type> <count> <nodes> <base>/64 [options]");
+    }
+  std::string type = tokens[2];
+  uint32_t count;
+  uint32_t nodes;
+  if (!ToUint (tokens[3], count) || !ToUint (tokens[4], nodes) || count == 0)
+    {
+      Error ("bad number of networks or of nodes");
+    }
+  Ipv6Address base;
+  Ipv6Prefix prefix;
+  GetNetwork (tokens[5], base, prefix);
+  if (prefix != Ipv6Prefix (64))
+    {
+      Error ("the networks are /64");
+    }
+  Options options = GetOptions (tokens, 6);
+
+  Ipv6AddressList list;
+  list.Init (base, prefix, Ipv6Address ("::1"));
+  std::vector<Entry> &group = m_groups[tokens[1]];
+  group.reserve (group.size () + count);
+  m_pending.reserve (m_pending.size () + count);
+  Entry entry;
+  entry.prefix = prefix;
+
+  if (type == "csma")
+    {
+      CheckOptions (options, "rate delay");
+      std::string rate = options.count ("rate") ? options["rate"] : "100Mbps";
+      std::string delay = options.count ("delay") ? options["delay"] : "2ms";
+      for (uint32_t k = 0; k < count; ++k)
+        {
+          entry.address = list.GetNetwork (prefix, k);
+          entry.network = Create<CsmaNetwork> (rate, delay, nodes);
+          entry.network->ConfigureL2 ();
+          entry.network->ConfigureL3 (entry.address, entry.prefix, *m_routing);
+          group.push_back (entry);
+          m_pending.push_back (entry);
+        }
+    }
+  else if (type == "sixlowpan" || type == "wifi")
+    {
+      CheckOptions (options, "shared mobile");
+      NetworkFactory factory (type == "wifi" ? NetworkFactory::WIFI : NetworkFactory::SIXLOWPAN, nodes);
+      factory.SetBase (base);
+      factory.SetSharedChannel (options["shared"] == "1");
+      factory.SetMobility (10, 1000, options["mobile"] == "1");
+      factory.SetRoutingHelper (*m_routing);
+      std::vector<Ptr<Network> > networks = factory.Build (count);
+      for (uint32_t k = 0; k < count; ++k)
+        {
+          entry.address = list.GetNetwork (prefix, k);
+          entry.network = networks[k];
+          group.push_back (entry);
+          m_pending.push_back (entry);
+        }
+    }
+  else
+    {
+      Error ("unknown network type " + type);
+    }
+  m_nNetworks += count;
+}
+
+void
+ScenarioHelper::DoCore (const std::vector<std::string> &tokens)
+{
+  if (tokens.size () < 3)
+    {
+      Error ("expected core <group> <base>/64 [options]");
+    }
+  if (m_pending.empty ())
+    {
+      Error ("no network to join to the core");
+    }
+  Entry entry;
+  GetNetwork (tokens[2], entry.address, entry.prefix);
+  if (entry.prefix != Ipv6Prefix (64))
+    {
+      Error ("the networks are /64");
+    }
+  Options options = GetOptions (tokens, 3);
+  CheckOptions (options, "rate delay");
+  std::string rate = options.count ("rate") ? options["rate"] : "1Gbps";
+  std::string delay = options.count ("delay") ? options["delay"] : "2ms";
+
+  NodeContainer routers;
+  for (std::vector<Entry>::const_iterator it = m_pending.begin (); it != m_pending.end (); ++it)
+    {
+      routers.Add (it->network->GetRouter ());
+    }
+  entry.network = Create<RouterCsmaNetwork> (routers, rate, delay);
+  entry.network->ConfigureL2 ();
+  entry.network->ConfigureL3 (entry.address, entry.prefix, *m_routing);
+
+  if (!m_ripng)
+    {
+      // the core router is the first interface, the routers follow in order
+      Ipv6StaticRoutingHelper helper;
+      Ipv6InterfaceContainer interfaces = entry.network->GetIpv6Interfaces ();
+      Ptr<Ipv6StaticRouting> core = helper.GetStaticRouting (entry.network->GetRouter ()->GetObject<Ipv6> ());
+      Ipv6Address coreAddress = interfaces.GetAddress (0, 1);
+      for (uint32_t i = 0; i < m_pending.size (); ++i)
+        {
+          Ptr<Ipv6> ipv6 = m_pending[i].network->GetRouter ()->GetObject<Ipv6> ();
+          core->AddNetworkRouteTo (m_pending[i].address, m_pending[i].prefix,
+                                   interfaces.GetAddress (i + 1, 1), interfaces.GetInterfaceIndex (0));
+          helper.GetStaticRouting (ipv6)->SetDefaultRoute (coreAddress, interfaces.GetInterfaceIndex (i + 1));
+        }
+    }
+
+  m_groups[tokens[1]].push_back (entry);
+  m_pending.clear ();
+  ++m_nNetworks;
+}
+
+void
+ScenarioHelper::DoTarget (const std::vector<std::string> &tokens)
+{
+  if (tokens.size () != 2)
+    {
+      Error ("expected target <group>|<network>/<length>");
+    }
+  if (tokens[1].find ('/') != std::string::npos)
+    {
+      Ipv6Address address;
+      Ipv6Prefix prefix;
+      GetNetwork (tokens[1], address, prefix);
+      m_targetedNetworks[address] = prefix;
+      return;
+    }
+  std::map<std::string, std::vector<Entry> >::const_iterator group = m_groups.find (tokens[1]);
+  if (group == m_groups.end ())
+    {
+      Error ("unknown group " + tokens[1]);
+    }
+  for (std::vector<Entry>::const_iterator it = group->second.begin (); it != group->second.end (); ++it)
+    {
+      m_targetedNetworks[it->address] = it->prefix;
+    }
+}
+
+void
+ScenarioHelper::DoApp (const std::vector<std::string> &tokens)
+{
+  if (tokens.size () < 3)
+    {
+      Error ("expected app <type> <group>[:nodes|:routers|:all] [options]");
+    }
+  std::string type = tokens[1];
+  std::string name = tokens[2];
+  std::string which = "nodes";
+  std::string::size_type colon = name.find (':');
+  if (colon != std::string::npos)
+    {
+      which = name.substr (colon + 1);
+      name.erase (colon);
+    }
+  if (which != "nodes" && which != "routers" && which != "all")
+    {
+      Error ("expected nodes, routers or all, got " + which);
+    }
+  std::map<std::string, std::vector<Entry> >::const_iterator group = m_groups.find (name);
+  if (group == m_groups.end ())
+    {
+      Error ("unknown group " + name);
+    }
+
+  // options start with a lower case letter, attributes with a capital one
+  Options options = GetOptions (tokens, 3);
+  Options attributes;
+  for (Options::iterator it = options.begin (); it != options.end (); )
+    {
+      if (isupper (it->first[0]))
+        {
+          attributes.insert (*it);
+          options.erase (it++);
+        }
+      else
+        {
+          ++it;
+        }
+    }
+  CheckOptions (options, type == "scan-tools" ? "port start stop scan shards" : "port start stop");
+  uint32_t port = (type == "dns-server") ? 53 : 5683;
+  if (options.count ("port") && (!ToUint (options["port"], port) || port > 65535))
+    {
+      Error ("bad port " + options["port"]);
+    }
+
+  ApplicationContainer apps;
+  NodeContainer nodes;
+  for (std::vector<Entry>::const_iterator it = group->second.begin (); it != group->second.end (); ++it)
+    {
+      NodeContainer selected;
+      if (which != "nodes")
+        {
+          selected.Add (it->network->GetRouter ());
+        }
+      if (which != "routers")
+        {
+          selected.Add (it->network->GetNodes ());
+        }
+      if (type == "coap-server")
+        {
+          // each server polls the clients of its own network
+          SimCoapServerHelper server (port);
+          SetAttributes (server, attributes);
+          std::vector<Ipv6Address> clients = it->network->GetNodesAddresses ();
+          apps.Add (server.Install (selected, clients));
+        }
+      else
+        {
+          nodes.Add (selected);
+        }
+    }
+
+  if (type == "coap-client")
+    {
+      SimCoapClientHelper client (port);
+      SetAttributes (client, attributes);
+      apps.Add (client.Install (nodes));
+    }
+  else if (type == "dns-server")
+    {
+      DnsServerHelper server (port);
+      SetAttributes (server, attributes);
+      apps.Add (server.Install (nodes));
+    }
+  else if (type == "penetration-tools")
+    {
+      PenetrationToolsHelper penetration (port);
+      SetAttributes (penetration, attributes);
+      apps.Add (penetration.Install (nodes));
+    }
+  else if (type == "scan-tools")
+    {
+      ScanTools::ScanType scanType = ScanTools::INTERLACE;
+      std::string scan = options.count ("scan") ? options["scan"] : "interlace";
+      if (scan == "wifi-first")
+        {
+          scanType = ScanTools::WIFI_FIRST;
+        }
+      else if (scan == "wifi-only")
+        {
+          scanType = ScanTools::WIFI_ONLY;
+        }
+      else if (scan == "sixlowpan-first")
+        {
+          scanType = ScanTools::SIXLOWPAN_FIRST;
+        }
+      else if (scan == "sixlowpan-only")
+        {
+          scanType = ScanTools::SIXLOWPAN_ONLY;
+        }
+      else if (scan != "interlace")
+        {
+          Error ("unknown scan type " + scan);
+        }
+      ScanToolsHelper scanner (port);
+      SetAttributes (scanner, attributes);
+      if (options.count ("shards"))
+        {
+          if (options["shards"] != "network" && options["shards"] != "interleaved")
+            {
+              Error ("unknown shard mode " + options["shards"]);
+            }
+          apps.Add (scanner.InstallShards (nodes, m_targetedNetworks,
+                                           options["shards"] == "network" ? ScanTargetGenerator::SHARD_BY_NETWORK
+                                                                          : ScanTargetGenerator::SHARD_INTERLEAVED,
+                                           scanType));
+        }
+      else
+        {
+          apps.Add (scanner.Install (nodes, m_targetedNetworks, scanType));
+        }
+    }
+  else if (type != "coap-server")
+    {
+      Error ("unknown application " + type);
+    }
+
+  if (options.count ("start"))
+    {
+      apps.Start (Time (options["start"]));
+    }
+  if (options.count ("stop"))
+    {
+      apps.Stop (Time (options["stop"]));
+    }
+  m_apps.Add (apps);
+}
+
+ScenarioHelper::Options
+ScenarioHelper::GetOptions (const std::vector<std::string> &tokens, uint32_t first) const
+{
+  Options options;
+  for (uint32_t i = first; i < tokens.size (); ++i)
+    {
+      std::string::size_type equal = tokens[i].find ('=');
+      if (equal == std::string::npos || equal == 0)
+        {
+          Error ("expected <name>=<value>, got " + tokens[i]);
+        }
+      options[tokens[i].substr (0, equal)] = tokens[i].substr (equal + 1);
+    }
+  return options;
+}
+
+void
+ScenarioHelper::CheckOptions (const Options &options, std::string known) const
+{
+  known = " " + known + " ";
+  for (Options::const_iterator it = options.begin (); it != options.end (); ++it)
+    {
+      if (known.find (" " + it->first + " ") == std::string::npos)
+        {
+          Error ("unknown option " + it->first);
+        }
+    }
+}
+
+void
+ScenarioHelper::GetNetwork (std::string word, Ipv6Address &address, Ipv6Prefix &prefix) const
+{
+  std::string::size_type slash = word.find ('/');
+  uint32_t length;
+  if (slash == std::string::npos || !ToUint (word.substr (slash + 1), length) || length > 128)
+    {
+      Error ("expected <network>/<length>, got " + word);
+    }
+  address = Ipv6Address (word.substr (0, slash).c_str ());
+  prefix = Ipv6Prefix (static_cast<uint8_t> (length));
+}
+
+std::string
+ScenarioHelper::Substitute (std::string word) const
+{
+  std::string::size_type begin;
+  while ((begin = word.find ("${")) != std::string::npos)
+    {
+      std::string::size_type end = word.find ('}', begin);
+      if (end == std::string::npos)
+        {
+          Error ("unterminated variable in " + word);
+        }
+      std::map<std::string, std::string>::const_iterator it = m_variables.find (word.substr (begin + 2, end - begin - 2));
+      if (it == m_variables.end ())
+        {
+          Error ("undefined variable in " + word);
+        }
+      word.replace (begin, end - begin + 1, it->second);
+    }
+  return word;
+}
+
+void
+ScenarioHelper::Error (std::string message) const
+{
+  NS_FATAL_ERROR ("scenario line " << m_line << ": " << message);
+}
+
+} // namespace ns3
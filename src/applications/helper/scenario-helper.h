@@ -0,0 +1,238 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2015 Universite catholique de Louvain
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Lionel Metongnon <lionel.metongnon@uclouvain.be>
+ */
+
+#ifndef SCENARIO_HELPER_H
+#define SCENARIO_HELPER_H
+
+#include <stdint.h>
+#include "ns3/application-container.h"
+#include "ns3/ipv6-address.h"
+#include "ns3/ipv6-list-routing-helper.h"
+#include "ns3/network-factory.h"
+#include <ns3/network.h>
+#include <istream>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \ingroup udpecho
+ * \brief Build a scanning scenario from a description file
+ *
+ * The file is read line by line and each line is carried out as soon as it
+ * is read, so that the description of a large topology is never held as a
+ * whole.  Blank lines and what follows a '#' are ignored.  A line is a
+ * directive followed by its arguments, separated by blanks:
+ *
+ * \verbatim
+   set <name> <value>
+   routing static|ripng
+   network <group> csma|sixlowpan|wifi <count> <nodes> <base>/64 [options]
+   core <group> <network>/64 [rate=<rate>] [delay=<delay>]
+   target <group>|<network>/<length>
+   app coap-client|coap-server|dns-server|scan-tools|penetration-tools
+       <group>[:nodes|:routers|:all] [options] [<Attribute>=<value> ...]
+   \endverbatim
+ *
+ * - set: defines ${name} for the following lines, unless SetVariable ()
+ *   gave it a value first, so that a sweep only has to change variables;
+ * - routing: the routing of the routers, static by default, it must come
+ *   before the first network;
+ * - network: count networks of nodes nodes each plus a router, the k-th
+ *   one on the k-th /64 after base.  The options are rate and delay for
+ *   csma, and shared (one channel for the whole group) and mobile for
+ *   sixlowpan and wifi, which are built by a NetworkFactory;
+ * - core: a CSMA network joining the routers of the networks declared
+ *   since the previous core to a new core router.  With static routing,
+ *   these routers get a default route to the core router and the core
+ *   router a route to each of their networks;
+ * - target: add the networks of a group, or a network, to the networks
+ *   given to the scan-tools installed afterwards;
+ * - app: install applications on the nodes (the default), on the routers
+ *   or on all the nodes of the networks of a group.  The options are port,
+ *   start and stop, and for scan-tools, scan (interlace, wifi-first,
+ *   wifi-only, sixlowpan-first or sixlowpan-only) and shards (network or
+ *   interleaved, to share the targets between the nodes).  The other
+ *   <Attribute>=<value> pairs are attributes of the applications.
+ *
+ * Malformed lines abort the simulation with the number of the line.
+ */
+class ScenarioHelper
+{
+public:
+  /**
+   * \brief A network of a group
+   */
+  struct Entry
+  {
+    Ptr<Network> network; //!< the network
+    Ipv6Address address;  //!< its address
+    Ipv6Prefix prefix;    //!< its prefix
+  };
+
+  ScenarioHelper ();
+
+  ~ScenarioHelper ();
+
+  /**
+   * \brief Give a value to a variable, before the file does
+   * \param name the name of the variable
+   * \param value its value
+   */
+  void SetVariable (std::string name, std::string value);
+
+  /**
+   * \brief Build the scenario of a file
+   * \param fileName the name of the file
+   */
+  void Load (std::string fileName);
+
+  /**
+   * \brief Build the scenario read from a stream
+   * \param is the stream
+   */
+  void Load (std::istream &is);
+
+  /**
+   * \param group the name of a group
+   * \returns the networks of the group
+   */
+  const std::vector<Entry> &GetGroup (std::string group) const;
+
+  /**
+   * \returns the number of networks built, cores included
+   */
+  uint32_t GetNNetworks (void) const;
+
+  /**
+   * \returns the networks given to the scan-tools
+   */
+  std::map<Ipv6Address, Ipv6Prefix> &GetTargetedNetworks (void);
+
+  /**
+   * \returns all the applications installed
+   */
+  ApplicationContainer GetApplications (void) const;
+
+private:
+  /// Options of a directive, by name
+  typedef std::map<std::string, std::string> Options;
+
+  /**
+   * \brief Copy constructor, not implemented
+   * \param o object to copy
+   */
+  ScenarioHelper (const ScenarioHelper &o);
+
+  /**
+   * \brief Copy assignment, not implemented
+   * \param o object to copy
+   * \returns the object
+   */
+  ScenarioHelper &operator= (const ScenarioHelper &o);
+
+  /**
+   * \brief Carry out a line
+   * \param tokens the words of the line, variables substituted
+   */
+  void Parse (const std::vector<std::string> &tokens);
+
+  /**
+   * \brief Carry out a routing directive
+   * \param tokens the words of the line
+   */
+  void DoRouting (const std::vector<std::string> &tokens);
+
+  /**
+   * \brief Carry out a network directive
+   * \param tokens the words of the line
+   */
+  void DoNetwork (const std::vector<std::string> &tokens);
+
+  /**
+   * \brief Carry out a core directive
+   * \param tokens the words of the line
+   */
+  void DoCore (const std::vector<std::string> &tokens);
+
+  /**
+   * \brief Carry out a target directive
+   * \param tokens the words of the line
+   */
+  void DoTarget (const std::vector<std::string> &tokens);
+
+  /**
+   * \brief Carry out an app directive
+   * \param tokens the words of the line
+   */
+  void DoApp (const std::vector<std::string> &tokens);
+
+  /**
+   * \brief Split name=value words
+   * \param tokens the words of the line
+   * \param first the first word to split
+   * \returns the options
+   */
+  Options GetOptions (const std::vector<std::string> &tokens, uint32_t first) const;
+
+  /**
+   * \brief Abort on the options a directive does not know
+   * \param options the options
+   * \param known the names of the known options, separated by blanks
+   */
+  void CheckOptions (const Options &options, std::string known) const;
+
+  /**
+   * \brief Read a network written as address/length
+   * \param word the word to read
+   * \param address the address read
+   * \param prefix the prefix read
+   */
+  void GetNetwork (std::string word, Ipv6Address &address, Ipv6Prefix &prefix) const;
+
+  /**
+   * \brief Replace the ${name} of a word by the value of the variable
+   * \param word the word
+   * \returns the word, variables substituted
+   */
+  std::string Substitute (std::string word) const;
+
+  /**
+   * \brief Abort with the number of the line being read
+   * \param message what is wrong
+   */
+  void Error (std::string message) const;
+
+  std::map<std::string, std::string> m_variables; //!< variables, by name
+  std::map<std::string, std::vector<Entry> > m_groups; //!< networks, by group
+  std::vector<Entry> m_pending; //!< networks not joined to a core yet
+  std::map<Ipv6Address, Ipv6Prefix> m_targetedNetworks; //!< networks to scan
+  ApplicationContainer m_apps; //!< applications installed
+  Ipv6ListRoutingHelper *m_routing; //!< routing of the routers
+  bool m_ripng; //!< RIPng instead of static routing
+  uint32_t m_nNetworks; //!< number of networks built
+  uint32_t m_line; //!< line being read
+};
+
+} // namespace ns3
+
+#endif /* SCENARIO_HELPER_H */
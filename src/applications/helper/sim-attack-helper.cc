@@ -25,6 +25,35 @@
 
 namespace ns3 {
 
+namespace {
+
+/**
+ * \brief Feed the PenetrationTools of a node with the hosts discovered by
+ * its ScanTools, whatever the installation order of the applications
+ * \param node the node
+ * \param app the application just installed
+ */
+void
+ConnectDiscovery (Ptr<Node> node, Ptr<Application> app)
+{
+  Ptr<ScanTools> scanner = app->GetObject<ScanTools> ();
+  Ptr<PenetrationTools> penetration = app->GetObject<PenetrationTools> ();
+  for (uint32_t i = 0; i < node->GetNApplications (); ++i)
+    {
+      Ptr<Application> other = node->GetApplication (i);
+      if (scanner != 0 && other->GetObject<PenetrationTools> () != 0)
+        {
+          scanner->AddDiscoveryConsumer (MakeCallback (&PenetrationTools::AddVictim, other->GetObject<PenetrationTools> ()));
+        }
+      else if (penetration != 0 && other->GetObject<ScanTools> () != 0)
+        {
+          other->GetObject<ScanTools> ()->AddDiscoveryConsumer (MakeCallback (&PenetrationTools::AddVictim, penetration));
+        }
+    }
+}
+
+} // anonymous namespace
+
 ScanToolsHelper::ScanToolsHelper (uint16_t port)
 {
   m_factory.SetTypeId (ScanTools::GetTypeId ());
@@ -39,6 +68,20 @@ ScanToolsHelper::SetAttribute (
   m_factory.Set (name, value);
 }
 
+void
+ScanToolsHelper::SetScanStrategy (std::string type,
+                                  std::string n0, const AttributeValue &v0,
+                                  std::string n1, const AttributeValue &v1,
+                                  std::string n2, const AttributeValue &v2,
+                                  std::string n3, const AttributeValue &v3)
+{
+  m_strategyFactory.SetTypeId (type);
+  m_strategyFactory.Set (n0, v0);
+  m_strategyFactory.Set (n1, v1);
+  m_strategyFactory.Set (n2, v2);
+  m_strategyFactory.Set (n3, v3);
+}
+
 // void
 // ScanToolsHelper::SetTargetNetwork (
 //       std::map<std::string,
@@ -72,6 +115,28 @@ ScanToolsHelper::Install (NodeContainer c, std::map<Ipv6Address, Ipv6Prefix> &ta
   return apps;
 }
 
+ApplicationContainer
+ScanToolsHelper::InstallShards (NodeContainer c, std::map<Ipv6Address, Ipv6Prefix> &targetedNetworks,
+                                ScanTargetGenerator::ShardMode mode, ScanTools::ScanType scanType,
+                                Ptr<ScanDiscoverySet> discovery) const
+{
+  if (discovery == 0)
+    {
+      discovery = CreateObject<ScanDiscoverySet> ();
+    }
+  ApplicationContainer apps;
+  uint32_t shard = 0;
+  for (NodeContainer::Iterator i = c.Begin (); i != c.End (); ++i, ++shard)
+    {
+      Ptr<ScanTools> app = InstallPriv (*i, targetedNetworks, scanType)->GetObject<ScanTools> ();
+      app->SetShard (shard, c.GetN (), mode);
+      app->SetDiscoverySet (discovery);
+      apps.Add (app);
+    }
+
+  return apps;
+}
+
 Ptr<Application>
 ScanToolsHelper::InstallPriv (Ptr<Node> node, std::map<Ipv6Address, Ipv6Prefix> &targetedNetworks, ScanTools::ScanType scanType) const
 {
@@ -79,6 +144,11 @@ ScanToolsHelper::InstallPriv (Ptr<Node> node, std::map<Ipv6Address, Ipv6Prefix>
   node->AddApplication (app);
   app->SetTargetedNetworks (targetedNetworks);
   app->SetScanType (scanType);
+  if (m_strategyFactory.GetTypeId ().GetUid () != 0)
+    {
+      app->SetScanStrategy (m_strategyFactory.Create<ScanStrategy> ());
+    }
+  ConnectDiscovery (node, app);
 
   return app;
 }
@@ -127,6 +197,7 @@ PenetrationToolsHelper::InstallPriv (Ptr<Node> node) const
 {
   Ptr<Application> app = m_factory.Create<Application> ();
   node->AddApplication (app);
+  ConnectDiscovery (node, app);
 
   return app;
 }
@@ -65,6 +65,27 @@ public:
    */
   // void SetTargetNetwork (std::map<std::string, std::string> targetNetwork);
 
+  /**
+   * Set the ScanStrategy created for each ScanTools application.  A new
+   * strategy is created per application so that the scanners do not share
+   * their position in the target space.
+   *
+   * \param type the type of ns3::ScanStrategy to create
+   * \param n0 the name of the attribute to set
+   * \param v0 the value of the attribute to set
+   * \param n1 the name of the attribute to set
+   * \param v1 the value of the attribute to set
+   * \param n2 the name of the attribute to set
+   * \param v2 the value of the attribute to set
+   * \param n3 the name of the attribute to set
+   * \param v3 the value of the attribute to set
+   */
+  void SetScanStrategy (std::string type,
+                        std::string n0 = "", const AttributeValue &v0 = EmptyAttributeValue (),
+                        std::string n1 = "", const AttributeValue &v1 = EmptyAttributeValue (),
+                        std::string n2 = "", const AttributeValue &v2 = EmptyAttributeValue (),
+                        std::string n3 = "", const AttributeValue &v3 = EmptyAttributeValue ());
+
   /**
    * Create a udp echo client application on the specified node.  The Node
    * is provided as a Ptr<Node>.
@@ -97,6 +118,25 @@ public:
    */
   ApplicationContainer Install (NodeContainer c, std::map<Ipv6Address, Ipv6Prefix> &targetedNetworks, ScanTools::ScanType scanType = ScanTools::INTERLACE) const;
 
+  /**
+   * Create coordinated scanners: the targeted space is split in one shard
+   * per node, the i-th node scanning the i-th shard, and the discovered
+   * hosts are merged in a single ScanDiscoverySet.  The PenetrationTools of
+   * each node is then only fed with the hosts of its own shard.
+   *
+   * \param c the nodes
+   * \param targetedNetworks the networks shared by all the scanners
+   * \param mode how the space is split between the nodes
+   * \param scanType the interface ID patterns scanned
+   * \param discovery the shared set, a new one is created if null
+   *
+   * \returns the applications created, one application per input node.
+   */
+  ApplicationContainer InstallShards (NodeContainer c, std::map<Ipv6Address, Ipv6Prefix> &targetedNetworks,
+                                      ScanTargetGenerator::ShardMode mode = ScanTargetGenerator::SHARD_BY_NETWORK,
+                                      ScanTools::ScanType scanType = ScanTools::INTERLACE,
+                                      Ptr<ScanDiscoverySet> discovery = 0) const;
+
 private:
   /**
    * Install an ns3::UdpEchoClient on the node configured with all the
@@ -107,11 +147,16 @@ private:
    */
   Ptr<Application> InstallPriv (Ptr<Node> node, std::map<Ipv6Address, Ipv6Prefix> &targetedNetworks, ScanTools::ScanType scanType) const;
   ObjectFactory m_factory; //!< Object factory.
+  ObjectFactory m_strategyFactory; //!< ScanStrategy factory.
 };
 
 /**
  * \ingroup udpecho
  * \brief Create an application which sends a UDP packet and waits for an echo of this packet
+ *
+ * The PenetrationTools installed on a node attack the hosts discovered by
+ * the ScanTools of the same node as soon as they reply, whichever of the
+ * two helpers is used first.
  */
 class PenetrationToolsHelper
 {
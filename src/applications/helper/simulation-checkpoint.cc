@@ -0,0 +1,227 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2015 Universite catholique de Louvain
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Lionel Metongnon <lionel.metongnon@uclouvain.be>
+ */
+
+#include "simulation-checkpoint.h"
+#include "parameter-sweep.h"
+#include "ns3/log.h"
+#include "ns3/abort.h"
+#include "ns3/simulator.h"
+#include "ns3/thread-safety.h"
+#include "ns3/system-path.h"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+#include <fcntl.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("SimulationCheckpoint");
+
+SimulationCheckpoint::SimulationCheckpoint ()
+  : m_variants (1),
+    m_forked (false),
+    m_variant (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+SimulationCheckpoint::SetVariants (uint32_t variants)
+{
+  NS_LOG_FUNCTION (this << variants);
+  NS_ABORT_MSG_IF (variants == 0, "SimulationCheckpoint: no variant");
+  m_variants = variants;
+}
+
+void
+SimulationCheckpoint::SetVariantCallback (Callback<void, uint32_t> callback)
+{
+  NS_LOG_FUNCTION (this);
+  m_callback = callback;
+}
+
+void
+SimulationCheckpoint::SetOutputDirectory (std::string directory)
+{
+  NS_LOG_FUNCTION (this << directory);
+  m_directory = directory;
+}
+
+void
+SimulationCheckpoint::Schedule (Time at)
+{
+  NS_LOG_FUNCTION (this << at);
+  NS_ABORT_MSG_IF (at < Simulator::Now (), "SimulationCheckpoint: checkpoint in the past");
+  Simulator::Schedule (at - Simulator::Now (), &SimulationCheckpoint::Fork, this);
+}
+
+bool
+SimulationCheckpoint::IsForked (void) const
+{
+  return m_forked;
+}
+
+uint32_t
+SimulationCheckpoint::GetVariant (void) const
+{
+  return m_variant;
+}
+
+const std::vector<int> &
+SimulationCheckpoint::GetStatuses (void) const
+{
+  return m_statuses;
+}
+
+std::string
+SimulationCheckpoint::GetDirectory (uint32_t variant) const
+{
+  std::ostringstream directory;
+  directory << m_directory << "/variant-" << variant;
+  return directory.str ();
+}
+
+void
+SimulationCheckpoint::Fork (void)
+{
+  NS_LOG_FUNCTION (this);
+  NS_ABORT_MSG_IF (m_forked, "SimulationCheckpoint: already forked");
+  NS_ABORT_MSG_IF (ThreadSafety::IsEnabled (),
+                   "SimulationCheckpoint: the simulation threads do not survive a fork");
+  char cwd[4096];
+  NS_ABORT_MSG_IF (::getcwd (cwd, sizeof (cwd)) == 0, "SimulationCheckpoint: getcwd error");
+  m_cwd = cwd;
+  m_statuses.assign (m_variants, -1);
+
+  std::cout.flush ();
+  std::cerr.flush ();
+  std::fflush (0);
+  for (uint32_t i = 1; i < m_variants; ++i)
+    {
+      pid_t pid = ::fork ();
+      NS_ABORT_MSG_IF (pid < 0, "SimulationCheckpoint::Fork(): fork error, errno = " << std::strerror (errno));
+      if (pid == 0)
+        {
+          m_variant = i;
+          m_pids.clear ();
+          break;
+        }
+      m_pids.push_back (pid);
+    }
+  m_forked = true;
+
+  if (!m_directory.empty ())
+    {
+      std::string directory = GetDirectory (m_variant);
+      SystemPath::MakeDirectories (directory + "/data");
+      SystemPath::MakeDirectories (directory + "/plot");
+      NS_ABORT_MSG_IF (::chdir (directory.c_str ()) != 0,
+                       "SimulationCheckpoint::Fork(): chdir error, errno = " << std::strerror (errno));
+      if (m_variant != 0)
+        {
+          int fd = ::open ("output.log", O_WRONLY | O_CREAT | O_TRUNC, 0644);
+          if (fd >= 0)
+            {
+              ::dup2 (fd, 1);
+              ::dup2 (fd, 2);
+              ::close (fd);
+            }
+        }
+    }
+  NS_LOG_INFO ("variant " << m_variant << " starts at " << Simulator::Now ().GetSeconds () << "s");
+  if (!m_callback.IsNull ())
+    {
+      m_callback (m_variant);
+    }
+}
+
+uint32_t
+SimulationCheckpoint::Wait (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (!m_forked)
+    {
+      return 0;
+    }
+  if (m_variant != 0)
+    {
+      // the child variants do not go back to the caller of Run
+      std::cout.flush ();
+      std::cerr.flush ();
+      std::fflush (0);
+      _exit (0);
+    }
+
+  NS_ABORT_MSG_IF (::chdir (m_cwd.c_str ()) != 0, "SimulationCheckpoint::Wait(): chdir error");
+  m_statuses[0] = 0;
+  uint32_t failed = 0;
+  for (uint32_t i = 0; i < m_pids.size (); ++i)
+    {
+      int status;
+      pid_t pid;
+      do
+        {
+          pid = ::waitpid (m_pids[i], &status, 0);
+        }
+      while (pid < 0 && errno == EINTR);
+      NS_ABORT_MSG_IF (pid < 0, "SimulationCheckpoint::Wait(): waitpid error, errno = " << std::strerror (errno));
+      m_statuses[i + 1] = WIFEXITED (status) ? WEXITSTATUS (status) : 128 + WTERMSIG (status);
+      if (m_statuses[i + 1] != 0)
+        {
+          NS_LOG_WARN ("variant " << i + 1 << " exited with status " << m_statuses[i + 1]);
+          ++failed;
+        }
+    }
+  m_pids.clear ();
+
+  if (!m_directory.empty ())
+    {
+      std::ofstream summary ((m_directory + "/summary.tsv").c_str ());
+      PrintSummary (summary);
+    }
+  return failed;
+}
+
+void
+SimulationCheckpoint::PrintSummary (std::ostream &os) const
+{
+  os << "#variant\tstatus\tdiscovered\tnetworks\tcompromised\n";
+  for (uint32_t i = 0; i < m_statuses.size (); ++i)
+    {
+      ParameterSweep::Results results;
+      std::memset (&results, 0, sizeof (results));
+      if (!m_directory.empty ())
+        {
+          results = ParameterSweep::ReadResults (GetDirectory (i) + "/data");
+        }
+      os << i << "\t" << m_statuses[i] << "\t" << results.discovered << "\t"
+         << results.networks << "\t" << results.compromised << "\n";
+    }
+}
+
+} // namespace ns3
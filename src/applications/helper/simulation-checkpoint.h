@@ -0,0 +1,163 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2015 Universite catholique de Louvain
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Lionel Metongnon <lionel.metongnon@uclouvain.be>
+ */
+
+#ifndef SIMULATION_CHECKPOINT_H
+#define SIMULATION_CHECKPOINT_H
+
+#include "ns3/callback.h"
+#include "ns3/nstime.h"
+
+#include <stdint.h>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \ingroup udpecho
+ * \brief Fork variants of a simulation from a snapshot of its state
+ *
+ * Scanning runs spend a long prefix on bringing the network up (RIPng
+ * convergence, neighbor discovery, WiFi association) before ScanTools
+ * starts.  At the checkpoint time, the process is forked once per
+ * variant: each variant starts from a copy of the whole state of the
+ * simulation, with the event list, the objects and their attributes, the
+ * routing tables and caches and the positions of the RngStreams, and only
+ * the simulation after the checkpoint is run again for each variant.
+ *
+ * The state is not written to a file: the events hold C++ callbacks to
+ * arbitrary objects, which cannot be serialized.  The copy-on-write
+ * snapshot of the process is exact and costs nothing until the variants
+ * diverge, but it only lives as long as the process.
+ *
+ * \code
+   SimulationCheckpoint checkpoint;
+   checkpoint.SetVariants (4);
+   checkpoint.SetVariantCallback (MakeCallback (&ConfigureScanners));
+   checkpoint.SetOutputDirectory ("variants");
+   checkpoint.Schedule (Seconds (60));
+   Simulator::Run ();
+   Simulator::Destroy ();
+   return checkpoint.Wait ();
+   \endcode
+ *
+ * The first variant goes on in the original process; the others run in
+ * child processes, which exit in Wait ().  The callback is called at the
+ * checkpoint time in each variant, with the index of the variant, to set
+ * it apart: attributes of the applications, new applications, or
+ * RngSeedManager::SetRun for the streams created afterwards.  The streams
+ * which already exist go on from the same position in every variant.
+ *
+ * With an output directory, each variant runs in <output>/variant-<index>,
+ * with its own data and plot directories, and the standard output and
+ * error of the child variants go to its output.log.  Wait () gathers the
+ * results of the variants in <output>/summary.tsv, as ParameterSweep does.
+ *
+ * Threads do not survive a fork: the checkpoint cannot be used with the
+ * multithreaded or the realtime simulator.
+ */
+class SimulationCheckpoint
+{
+public:
+  SimulationCheckpoint ();
+
+  /**
+   * \param variants the number of variants, including the one of the
+   * original process
+   */
+  void SetVariants (uint32_t variants);
+
+  /**
+   * \param callback the callback called in each variant at the checkpoint
+   * time, with the index of the variant
+   */
+  void SetVariantCallback (Callback<void, uint32_t> callback);
+
+  /**
+   * \param directory the directory of the variants, empty to keep the
+   * current directory
+   */
+  void SetOutputDirectory (std::string directory);
+
+  /**
+   * \brief Schedule the checkpoint
+   * \param at the absolute simulation time of the checkpoint
+   */
+  void Schedule (Time at);
+
+  /**
+   * \returns true once the process was forked
+   */
+  bool IsForked (void) const;
+
+  /**
+   * \returns the index of the variant of this process, 0 for the original
+   * process
+   */
+  uint32_t GetVariant (void) const;
+
+  /**
+   * \brief End a variant
+   *
+   * A child variant exits with status 0.  The original process returns
+   * to its directory, waits for the other variants and writes the summary.
+   *
+   * \returns the number of variants which failed
+   */
+  uint32_t Wait (void);
+
+  /**
+   * \returns the exit statuses of the variants after Wait (), -1 if not
+   * run
+   */
+  const std::vector<int> &GetStatuses (void) const;
+
+  /**
+   * \brief Print the summary table, one line per variant
+   * \param os the output stream
+   */
+  void PrintSummary (std::ostream &os) const;
+
+private:
+  /**
+   * \brief Fork the variants, at the checkpoint time
+   */
+  void Fork (void);
+
+  /**
+   * \param variant the index of a variant
+   * \returns the directory of the variant
+   */
+  std::string GetDirectory (uint32_t variant) const;
+
+  uint32_t m_variants;                 //!< number of variants
+  Callback<void, uint32_t> m_callback; //!< variant callback
+  std::string m_directory;             //!< directory of the variants
+  bool m_forked;                       //!< whether the process was forked
+  uint32_t m_variant;                  //!< variant of this process
+  std::string m_cwd;                   //!< directory before the fork
+  std::vector<int> m_pids;             //!< processes of the child variants
+  std::vector<int> m_statuses;         //!< exit statuses of the variants
+};
+
+} // namespace ns3
+
+#endif /* SIMULATION_CHECKPOINT_H */
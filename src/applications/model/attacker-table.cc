@@ -0,0 +1,206 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2015 Universite catholique de Louvain
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Lionel Metongnon <lionel.metongnon@uclouvain.be>
+ */
+
+#include "ns3/log.h"
+#include "ns3/assert.h"
+
+#include "attacker-table.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("AttackerTable");
+
+AttackerTable::AttackerTable ()
+  : m_capacity (0),
+    m_newest (-1),
+    m_oldest (-1),
+    m_evictions (0),
+    m_compromised (0)
+{
+  NS_LOG_FUNCTION (this);
+  SetCapacity (64);
+}
+
+void
+AttackerTable::SetCapacity (uint32_t capacity)
+{
+  NS_LOG_FUNCTION (this << capacity);
+  NS_ASSERT (capacity > 0);
+  m_capacity = capacity;
+  // at most one entry per bucket on average
+  uint32_t buckets = 1;
+  while (buckets < capacity)
+    {
+      buckets <<= 1;
+    }
+  m_buckets.assign (buckets, -1);
+  m_entries.clear ();
+  m_entries.reserve (capacity);
+  m_newest = -1;
+  m_oldest = -1;
+  m_compromised = 0;
+}
+
+uint32_t
+AttackerTable::GetCapacity (void) const
+{
+  return m_capacity;
+}
+
+uint32_t
+AttackerTable::GetBucket (Ipv6Address address) const
+{
+  return Ipv6AddressHash () (address) & (m_buckets.size () - 1);
+}
+
+void
+AttackerTable::Unlink (int32_t index)
+{
+  Entry &entry = m_entries[index];
+  if (entry.newer >= 0)
+    {
+      m_entries[entry.newer].older = entry.older;
+    }
+  else
+    {
+      m_newest = entry.older;
+    }
+  if (entry.older >= 0)
+    {
+      m_entries[entry.older].newer = entry.newer;
+    }
+  else
+    {
+      m_oldest = entry.newer;
+    }
+}
+
+void
+AttackerTable::PushFront (int32_t index)
+{
+  Entry &entry = m_entries[index];
+  entry.newer = -1;
+  entry.older = m_newest;
+  if (m_newest >= 0)
+    {
+      m_entries[m_newest].newer = index;
+    }
+  m_newest = index;
+  if (m_oldest < 0)
+    {
+      m_oldest = index;
+    }
+}
+
+void
+AttackerTable::Unchain (int32_t index)
+{
+  int32_t *link = &m_buckets[GetBucket (m_entries[index].address)];
+  while (*link != index)
+    {
+      NS_ASSERT (*link >= 0);
+      link = &m_entries[*link].chain;
+    }
+  *link = m_entries[index].chain;
+}
+
+AttackerTable::Record *
+AttackerTable::Lookup (Ipv6Address address)
+{
+  NS_LOG_FUNCTION (this << address);
+  for (int32_t index = m_buckets[GetBucket (address)]; index >= 0; index = m_entries[index].chain)
+    {
+      if (m_entries[index].address == address)
+        {
+          if (index != m_newest)
+            {
+              Unlink (index);
+              PushFront (index);
+            }
+          return &m_entries[index].record;
+        }
+    }
+  return 0;
+}
+
+AttackerTable::Record &
+AttackerTable::Insert (Ipv6Address address, bool compromised)
+{
+  NS_LOG_FUNCTION (this << address << compromised);
+  int32_t index;
+  if (m_entries.size () < m_capacity)
+    {
+      index = m_entries.size ();
+      m_entries.push_back (Entry ());
+    }
+  else
+    {
+      // reuse the least recently seen entry
+      index = m_oldest;
+      NS_LOG_LOGIC ("Evict " << m_entries[index].address);
+      Unlink (index);
+      Unchain (index);
+      if (m_entries[index].record.compromised)
+        {
+          --m_compromised;
+        }
+      ++m_evictions;
+    }
+  Entry &entry = m_entries[index];
+  entry.address = address;
+  entry.record.compromised = compromised;
+  entry.record.attempts = 1;
+  uint32_t bucket = GetBucket (address);
+  entry.chain = m_buckets[bucket];
+  m_buckets[bucket] = index;
+  PushFront (index);
+  if (compromised)
+    {
+      ++m_compromised;
+    }
+  return entry.record;
+}
+
+void
+AttackerTable::Clear (void)
+{
+  NS_LOG_FUNCTION (this);
+  SetCapacity (m_capacity);
+}
+
+uint32_t
+AttackerTable::GetSize (void) const
+{
+  return m_entries.size ();
+}
+
+uint32_t
+AttackerTable::GetEvictions (void) const
+{
+  return m_evictions;
+}
+
+uint32_t
+AttackerTable::GetCompromised (void) const
+{
+  return m_compromised;
+}
+
+} // namespace ns3
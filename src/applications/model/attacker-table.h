@@ -0,0 +1,150 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2015 Universite catholique de Louvain
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Lionel Metongnon <lionel.metongnon@uclouvain.be>
+ */
+
+#ifndef ATTACKER_TABLE_H
+#define ATTACKER_TABLE_H
+
+#include "ns3/ipv6-address.h"
+
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \ingroup udpecho
+ * \brief Outcome of the attacks of each source on a CoapClient
+ *
+ * Hash table chaining fixed entries, with a capacity bounding its memory:
+ * when it is full, adding a source evicts the least recently seen one,
+ * which is then handled as a new attacker if it comes back.  The entries
+ * are kept in a doubly linked list, most recently seen first, through
+ * their indexes, so that a lookup, an insertion and an eviction are done
+ * in constant time without any allocation once the table is full.
+ */
+class AttackerTable
+{
+public:
+  /**
+   * \brief Outcome of the first attack of a source
+   */
+  struct Record
+  {
+    bool compromised; //!< the attack compromised the host
+    uint32_t attempts; //!< number of attacks
+  };
+
+  AttackerTable ();
+
+  /**
+   * \brief Set the maximum number of sources, removing all of them
+   * \param capacity the maximum number of sources, at least 1
+   */
+  void SetCapacity (uint32_t capacity);
+
+  /**
+   * \returns the maximum number of sources
+   */
+  uint32_t GetCapacity (void) const;
+
+  /**
+   * \brief Find a source, and make it the most recently seen one
+   * \param address the source
+   * \returns the record of the source, or 0
+   */
+  Record *Lookup (Ipv6Address address);
+
+  /**
+   * \brief Add a source not in the table, evicting the least recently seen
+   * one if the table is full
+   * \param address the source
+   * \param compromised the outcome of its first attack
+   * \returns the record of the source
+   */
+  Record &Insert (Ipv6Address address, bool compromised);
+
+  /**
+   * \brief Remove all the sources
+   */
+  void Clear (void);
+
+  /**
+   * \returns the number of sources
+   */
+  uint32_t GetSize (void) const;
+
+  /**
+   * \returns the number of sources evicted
+   */
+  uint32_t GetEvictions (void) const;
+
+  /**
+   * \returns the number of sources which compromised the host
+   */
+  uint32_t GetCompromised (void) const;
+
+private:
+  /**
+   * \brief A source, in a bucket chain and in the recency list
+   */
+  struct Entry
+  {
+    Ipv6Address address; //!< source
+    Record record;        //!< outcome of its attacks
+    int32_t chain;        //!< next entry of the bucket, or -1
+    int32_t newer;        //!< more recently seen entry, or -1
+    int32_t older;        //!< less recently seen entry, or -1
+  };
+
+  /**
+   * \param address a source
+   * \returns the bucket of the source
+   */
+  uint32_t GetBucket (Ipv6Address address) const;
+
+  /**
+   * \brief Remove an entry from the recency list
+   * \param index the index of the entry
+   */
+  void Unlink (int32_t index);
+
+  /**
+   * \brief Insert an entry at the head of the recency list
+   * \param index the index of the entry
+   */
+  void PushFront (int32_t index);
+
+  /**
+   * \brief Remove an entry from its bucket chain
+   * \param index the index of the entry
+   */
+  void Unchain (int32_t index);
+
+  uint32_t m_capacity; //!< maximum number of entries
+  std::vector<Entry> m_entries; //!< entries, never shrunk until cleared
+  std::vector<int32_t> m_buckets; //!< first entry of each bucket, or -1
+  int32_t m_newest; //!< most recently seen entry, or -1
+  int32_t m_oldest; //!< least recently seen entry, or -1
+  uint32_t m_evictions; //!< number of evicted entries
+  uint32_t m_compromised; //!< number of entries which compromised the host
+};
+
+} // namespace ns3
+
+#endif /* ATTACKER_TABLE_H */
@@ -28,12 +28,15 @@
 #include "ns3/socket-factory.h"
 #include "ns3/packet.h"
 #include "ns3/uinteger.h"
+#include "ns3/double.h"
+#include "ns3/trace-source-accessor.h"
 
 #include <cstdlib>
 #include <ctime>
 
 #include "coap-client.h"
 #include "dns-vicious-client.h"
+#include "penetration-tools.h"
 
 namespace ns3 {
 
@@ -57,10 +60,35 @@ CoapClient::GetTypeId (void)
                    TimeValue (MilliSeconds (200)),
                    MakeTimeAccessor (&CoapClient::m_interval),
                    MakeTimeChecker ())
+    .AddAttribute ("Leisure", 
+                   "The maximum delay of the response to a non-confirmable request",
+                   TimeValue (Seconds (1)),
+                   MakeTimeAccessor (&CoapClient::m_leisure),
+                   MakeTimeChecker ())
+    .AddAttribute ("NotifyInterval", 
+                   "The time between two notifications to an observer",
+                   TimeValue (Seconds (60)),
+                   MakeTimeAccessor (&CoapClient::m_notifyInterval),
+                   MakeTimeChecker ())
     .AddAttribute ("PacketSize", "Size of packets generated",
                       UintegerValue (65),
                       MakeUintegerAccessor (&CoapClient::m_sendSize),
                       MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("Vulnerability",
+                   "The probability that the first attack of a source compromises the host",
+                   DoubleValue (0.1),
+                   MakeDoubleAccessor (&CoapClient::m_vulnerability),
+                   MakeDoubleChecker<double> (0.0, 1.0))
+    .AddAttribute ("AttackerTableSize",
+                   "The maximum number of attackers remembered, "
+                   "the least recently seen one being forgotten",
+                   UintegerValue (64),
+                   MakeUintegerAccessor (&CoapClient::SetAttackerTableSize,
+                                         &CoapClient::GetAttackerTableSize),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddTraceSource ("Compromise", "The host is compromised by an attacker",
+                     MakeTraceSourceAccessor (&CoapClient::m_compromiseTrace),
+                     "ns3::CoapClient::CompromiseTracedCallback")
   ;
   return tid;
 }
@@ -68,20 +96,45 @@ CoapClient::GetTypeId (void)
 CoapClient::CoapClient ()
 {
   NS_LOG_FUNCTION (this);
-  m_data = 0;
-  m_dataSize = 0;
   m_sendEvent = EventId ();
+  m_messageId = 0;
+  m_compromised = false;
   m_magic_number = CreateObject<UniformRandomVariable>();
+  m_leisureDelay = CreateObject<UniformRandomVariable> ();
 }
 
 CoapClient::~CoapClient()
 {
   NS_LOG_FUNCTION (this);
   m_socket = 0;
-  attackerList.clear ();
-  delete [] m_data;
-  m_data = 0;
-  m_dataSize = 0;
+}
+
+void
+CoapClient::SetAttackerTableSize (uint32_t size)
+{
+  NS_LOG_FUNCTION (this << size);
+  m_attackers.SetCapacity (size);
+}
+
+uint32_t
+CoapClient::GetAttackerTableSize (void) const
+{
+  return m_attackers.GetCapacity ();
+}
+
+const AttackerTable &
+CoapClient::GetAttackers (void) const
+{
+  return m_attackers;
+}
+
+int64_t
+CoapClient::AssignStreams (int64_t stream)
+{
+  NS_LOG_FUNCTION (this << stream);
+  m_magic_number->SetStream (stream);
+  m_leisureDelay->SetStream (stream + 1);
+  return 2;
 }
 
 void
@@ -102,6 +155,7 @@ CoapClient::StartApplication (void)
       Inet6SocketAddress local6 = Inet6SocketAddress (Ipv6Address::GetAny (), m_port);
       m_socket->Bind (local6);
     }
+  m_payload.SetSize (m_sendSize);
   m_socket->SetRecvCallback (MakeCallback (&CoapClient::HandleRead, this));
 }
 
@@ -116,36 +170,48 @@ CoapClient::StopApplication ()
       m_socket->SetRecvCallback (MakeNullCallback<void, Ptr<Socket> > ());
     }
   Simulator::Cancel (m_sendEvent);
+  for (std::map<Ipv6Address, Observer>::iterator it = m_observers.begin (); it != m_observers.end (); ++it)
+    {
+      Simulator::Cancel (it->second.event);
+    }
+  m_observers.clear ();
   ShowAttackerList ();
 }
 
-void 
-CoapClient::SetFill (std::string fill)
+Ptr<Packet>
+CoapClient::CreateResponse (const CoapHeader &request, uint8_t code, Ptr<Packet> payload)
 {
-  NS_LOG_FUNCTION (this << fill);
-
-  uint32_t dataSize = fill.size () + 1;
-
-  if (dataSize != m_dataSize)
+  NS_LOG_FUNCTION (this << static_cast<uint32_t> (code));
+  CoapHeader response;
+  if (request.GetType () == CoapHeader::CON)
     {
-      delete [] m_data;
-      m_data = new uint8_t [dataSize];
-      m_dataSize = dataSize;
+      response.SetType (CoapHeader::ACK);
+      response.SetMessageId (request.GetMessageId ());
     }
+  else
+    {
+      response.SetType (CoapHeader::NON);
+      response.SetMessageId (m_messageId++);
+    }
+  response.SetCode (code);
+  response.SetToken (request.GetToken (), request.GetTokenLength ());
+  response.SetPayloadMarker (payload->GetSize () > 0);
+  payload->AddHeader (response);
+  return payload;
+}
 
-  memcpy (m_data, fill.c_str (), dataSize);
+Ptr<Packet>
+CoapClient::CreateResponse (const CoapHeader &request, uint8_t code, std::string text)
+{
+  return CreateResponse (request, code, Create<Packet> (reinterpret_cast<const uint8_t *> (text.c_str ()), text.size () + 1));
 }
 
 void
-CoapClient::ShowAttackerList()
+CoapClient::ShowAttackerList (void)
 {
   NS_LOG_FUNCTION (this);
-  // std::cout << "Attacker list addresses are : " << std::endl;
-  for (std::map<Ipv6Address, float>::iterator i = attackerList.begin(); i != attackerList.end(); ++i)
-  {
-    // cout << i->first << std::endl;
-    NS_LOG_INFO (i->first <<" "<<i->second);
-  }
+  NS_LOG_INFO (m_attackers.GetSize () << " attackers, " << m_attackers.GetCompromised () <<
+               " successful, " << m_attackers.GetEvictions () << " forgotten");
 }
 
 void 
@@ -163,127 +229,135 @@ CoapClient::HandleRead (Ptr<Socket> socket)
                    sender << " port " <<
                    Inet6SocketAddress::ConvertFrom (from).GetPort ());
 
-      NS_LOG_INFO ("CoAP packet");
-
-      uint32_t dataSize = packet->GetSize () - 1;
-      uint8_t data[dataSize];
-      packet->CopyData (data, dataSize);
-      std::string sdata((char *)data, dataSize);
-      if (sdata.compare ("Penetration Attack") == 0)
+      CoapHeader request;
+      bool coap = packet->PeekHeader (request) != 0 && request.IsRequest ();
+      if (coap && request.GetCode () == CoapHeader::POST && request.MatchUriPath ("exploit"))
         {
-          std::map<Ipv6Address, float>::iterator record = attackerList.find (sender);
-          if (record == attackerList.end ())
+          NS_LOG_INFO ("CoAP attack " << request);
+          Ptr<Packet> response;
+          AttackerTable::Record *record = m_attackers.Lookup (sender);
+          if (record == 0)
             {
               NS_LOG_INFO ("New Attacker");
-              // m_magic_number->SetAttribute ("Min", DoubleValue (0.0));
-              // m_magic_number->SetAttribute ("Max", DoubleValue (1.0));
-              // m_magic_number->SetStream (1);
-              float magicNumber = m_magic_number->GetValue ();
-              attackerList.insert (std::pair<Ipv6Address, float>(sender, magicNumber));
-              if (magicNumber <= 0.1)
+              if (m_compromised)
+                {
+                  // compromised by another source, or by this one before it was forgotten
+                  m_attackers.Insert (sender, true);
+                  response = CreateResponse (request, PenetrationTools::STATUS_ALREADY_COMPROMISED, "Host already Compromise");
+                }
+              else if (m_magic_number->GetValue () < m_vulnerability)
                 {
                   /* Node compromised*/
+                  m_compromised = true;
+                  m_attackers.Insert (sender, true);
+                  m_compromiseTrace (sender);
                   Ptr<DnsViciousClient> dnsAttack = GetNode()->GetApplication(0)->GetObject <DnsViciousClient>();
                   dnsAttack->ViciousMode ();
-                  SetFill ("Host Compromise");
+                  response = CreateResponse (request, PenetrationTools::STATUS_COMPROMISED, "Host Compromise");
                 }
               else
                 {
-                  SetFill ("Failed to compromise the host");
+                  m_attackers.Insert (sender, false);
+                  response = CreateResponse (request, PenetrationTools::STATUS_FAILED, "Failed to compromise the host");
                 }
             }
           else
             {
-              if (record->second <= 0.1)
+              ++record->attempts;
+              if (record->compromised)
                 {
-                  SetFill ("Host already Compromise");
+                  response = CreateResponse (request, PenetrationTools::STATUS_ALREADY_COMPROMISED, "Host already Compromise");
                 }
               else
                 {
-                  SetFill ("You have already failed to compromise this host");
+                  response = CreateResponse (request, PenetrationTools::STATUS_ALREADY_FAILED, "You have already failed to compromise this host");
                 }
             }
+          ScheduleTransmit (Seconds (.0), socket, from, response);
         }
-      else if (sdata.compare ("Get Temperature Data From The Node") == 0)
+      else if (coap && request.GetCode () == CoapHeader::GET && request.MatchUriPath ("temperature"))
         {
-          m_dataSize = 0;
-          NS_LOG_INFO ("Temperature Server Message");
-          // for (uint16_t i = 0; i < 4; ++i)
-          //   {
-              // socket->SendTo (Create<Packet> (m_sendSize), 0, from);
-              ScheduleTransmit (m_interval, socket, from, 2);
-            // }
-        }
-      else
-        {
-          m_dataSize = 0;
-        }
-
-      Ptr<Packet> newPacket;
-      if (m_dataSize)
-        {
-          //
-          // If m_dataSize is non-zero, we have a data buffer of the same size that we
-          // are expected to copy and send.  This state of affairs is created if one of
-          // the Fill functions is called.  In this case, m_sendSize must have been set
-          // to agree with m_dataSize
-          //
-          NS_ASSERT_MSG (m_data, "CoapClient::HandleRead(): m_dataSize but no m_data");
-          newPacket = Create<Packet> (m_data, m_dataSize);
+          NS_LOG_INFO ("Temperature Server Message " << request);
+          uint32_t observe;
+          if (request.GetOption (CoapHeader::OBSERVE, observe) && observe == 1)
+            {
+              std::map<Ipv6Address, Observer>::iterator it = m_observers.find (sender);
+              if (it != m_observers.end ())
+                {
+                  NS_LOG_INFO ("Observer " << sender << " deregistered");
+                  Simulator::Cancel (it->second.event);
+                  m_observers.erase (it);
+                }
+            }
+          // acknowledge the request now, the data follows in separate responses
+          if (request.GetType () == CoapHeader::CON)
+            {
+              CoapHeader ack;
+              ack.SetType (CoapHeader::ACK);
+              ack.SetMessageId (request.GetMessageId ());
+              Ptr<Packet> empty = Create<Packet> ();
+              empty->AddHeader (ack);
+              ScheduleTransmit (Seconds (.0), socket, from, empty);
+            }
+          if (request.GetOption (CoapHeader::OBSERVE, observe) && observe == 0)
+            {
+              NS_LOG_INFO ("Observer " << sender << " registered");
+              Observer &observer = m_observers[sender];
+              Simulator::Cancel (observer.event);
+              observer.from = from;
+              observer.token = request.GetToken ();
+              observer.tokenLength = request.GetTokenLength ();
+              observer.sequence = 0;
+              // after the acknowledgement
+              observer.event = Simulator::ScheduleNow (&CoapClient::Notify, this, sender);
+              continue;
+            }
+          CoapHeader data;
+          data.SetType (CoapHeader::NON);
+          data.SetMessageId (m_messageId++);
+          data.SetCode (CoapHeader::CONTENT);
+          data.SetToken (request.GetToken (), request.GetTokenLength ());
+          data.SetPayloadMarker (m_sendSize > 0);
+          Ptr<Packet> response = m_payload.Copy ();
+          response->AddHeader (data);
+          if (request.GetType () == CoapHeader::NON)
+            {
+              // possibly sent to a group: the response follows a leisure
+              Time leisure = Seconds (m_leisureDelay->GetValue (0, m_leisure.GetSeconds ()));
+              ScheduleTransmit (leisure, socket, from, response);
+            }
+          else
+            {
+              // a single response, a copy with the same message ID would
+              // be dropped by the server as a duplicate
+              ScheduleTransmit (m_interval, socket, from, response);
+            }
         }
       else
         {
-          //
-          // If m_dataSize is zero, we'll send any data
-          //
-          newPacket = Create<Packet> (m_sendSize);
-        }
-
-        // socket->SendTo (newPacket, 0, from);
-        ScheduleTransmit (Seconds (.0), socket, from);
-
-        // NS_LOG_INFO ("At time " << Simulator::Now ().GetSeconds () << "s node sent " << newPacket->GetSize () << " bytes to " <<
-        //             Inet6SocketAddress::ConvertFrom (from).GetIpv6 () << " port " <<
-        //             Inet6SocketAddress::ConvertFrom (from).GetPort ());
+          // not a request we serve, such as a scan probe
+          ScheduleTransmit (Seconds (.0), socket, from, m_payload.Copy ());
         }
+    }
 }
 
 void 
-CoapClient::ScheduleTransmit (Time dt, Ptr<Socket> socket, Address from, uint16_t count)
+CoapClient::ScheduleTransmit (Time dt, Ptr<Socket> socket, Address from, Ptr<Packet> packet, uint16_t count)
 {
   NS_LOG_FUNCTION (this << dt);
   for (uint16_t i = 1; i <= count; ++i)
   {
-    m_sendEvent = Simulator::Schedule (dt * i, &CoapClient::Send, this, socket, from);
+    m_sendEvent = Simulator::Schedule (dt * i, &CoapClient::Send, this, socket, from, packet);
   }
 }
 
 void 
-CoapClient::Send (Ptr<Socket> socket, Address from)
+CoapClient::Send (Ptr<Socket> socket, Address from, Ptr<Packet> packet)
 {
   NS_LOG_FUNCTION (this);
 
-  NS_ASSERT (m_sendEvent.IsExpired ());
-
-  Ptr<Packet> newPacket;
-  if (m_dataSize)
-    {
-      //
-      // If m_dataSize is non-zero, we have a data buffer of the same size that we
-      // are expected to copy and send.  This state of affairs is created if one of
-      // the Fill functions is called.  In this case, m_sendSize must have been set
-      // to agree with m_dataSize
-      //
-      NS_ASSERT_MSG (m_data, "CoapClient::Send(): m_dataSize but no m_data");
-      newPacket = Create<Packet> (m_data, m_dataSize);
-    }
-  else
-    {
-      //
-      // If m_dataSize is zero, we'll send any data
-      //
-      newPacket = Create<Packet> (m_sendSize);
-    }
+  // the same response may be scheduled several times
+  Ptr<Packet> newPacket = packet->Copy ();
   socket->SendTo (newPacket, 0, from);
 
   NS_LOG_INFO ("At time " << Simulator::Now ().GetSeconds () << "s node sent " << newPacket->GetSize () << " bytes to " <<
@@ -292,4 +366,25 @@ CoapClient::Send (Ptr<Socket> socket, Address from)
 
 }
 
-} // Namespace ns3
\ No newline at end of file
+void
+CoapClient::Notify (Ipv6Address observer)
+{
+  NS_LOG_FUNCTION (this << observer);
+  std::map<Ipv6Address, Observer>::iterator it = m_observers.find (observer);
+  NS_ASSERT (it != m_observers.end ());
+  CoapHeader notification;
+  notification.SetType (CoapHeader::NON);
+  notification.SetMessageId (m_messageId++);
+  notification.SetCode (CoapHeader::CONTENT);
+  notification.SetToken (it->second.token, it->second.tokenLength);
+  // the Observe values are 24 bits long
+  notification.AddOption (CoapHeader::OBSERVE, it->second.sequence);
+  it->second.sequence = (it->second.sequence + 1) & 0xffffff;
+  notification.SetPayloadMarker (m_sendSize > 0);
+  Ptr<Packet> packet = m_payload.Copy ();
+  packet->AddHeader (notification);
+  Send (m_socket, it->second.from, packet);
+  it->second.event = Simulator::Schedule (m_notifyInterval, &CoapClient::Notify, this, observer);
+}
+
+} // Namespace ns3
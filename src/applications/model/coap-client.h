@@ -26,6 +26,10 @@
 #include "ns3/ptr.h"
 #include "ns3/address.h"
 #include "ns3/random-variable-stream.h"
+#include "ns3/traced-callback.h"
+#include "coap-header.h"
+#include "attacker-table.h"
+#include "payload-template.h"
 
 #include <map>
 
@@ -43,7 +47,22 @@ class Packet;
  * \ingroup Iot Node App
  * \brief A CoAP client
  *
- * Every packet received is sent back.
+ * The requests are dispatched on their method and Uri-Path: a POST to
+ * /exploit is an attack, answered by a PenetrationTools::Status response
+ * code.  The first attack of a source compromises the host with the
+ * probability Vulnerability, set for each firmware or device class; the
+ * outcome is kept in an AttackerTable of AttackerTableSize sources and
+ * replayed to the later attacks of the source.  Once compromised, the
+ * host stays compromised, even for the sources forgotten by the table.
+ * A GET to /temperature is answered by a separate 2.05 Content
+ * response, after Interval.  Any other packet, such as a scan probe, is
+ * answered by PacketSize bytes.
+ *
+ * A non-confirmable GET, the kind sent to a group, gets its response
+ * after a random leisure time instead, so that the responses of the group
+ * do not collide.  A GET with an Observe option of 0 registers its sender as an
+ * observer, notified every NotifyInterval until it deregisters (Observe
+ * of 1) or the application stops.
  */
 class CoapClient : public Application 
 {
@@ -56,6 +75,37 @@ public:
   CoapClient ();
   virtual ~CoapClient ();
 
+  /**
+   * \brief Set the number of attackers remembered
+   * \param size the maximum number of attackers, at least 1
+   */
+  void SetAttackerTableSize (uint32_t size);
+
+  /**
+   * \returns the maximum number of attackers remembered
+   */
+  uint32_t GetAttackerTableSize (void) const;
+
+  /**
+   * \returns the attackers remembered
+   */
+  const AttackerTable &GetAttackers (void) const;
+
+  /**
+   * \brief Assign a fixed random variable stream number to the random
+   * variables used by this model.
+   * \param stream first stream index to use
+   * \return the number of stream indices assigned by this model
+   */
+  int64_t AssignStreams (int64_t stream);
+
+  /**
+   * TracedCallback signature for the compromise of the host
+   *
+   * \param [in] attacker the address of the successful attacker
+   */
+  typedef void (* CompromiseTracedCallback)(const Ipv6Address &attacker);
+
 protected:
   virtual void DoDispose (void);
 
@@ -73,32 +123,72 @@ private:
    */
   void HandleRead (Ptr<Socket> socket);
 
-  void ShowAttackerList();
+  /**
+   * \brief Log a summary of the attackers
+   */
+  void ShowAttackerList (void);
 
   /**
-   * Set the data fill of the packet (what is sent as data to the server) to 
-   * the zero-terminated contents of the fill string string.
+   * \brief Build the response to a request
    *
-   * \warning The size of resulting echo packets will be automatically adjusted
-   * to reflect the size of the fill string -- this means that the PacketSize
-   * attribute may be changed as a result of this call.
+   * A confirmable request gets a piggybacked acknowledgement, any other one
+   * a non-confirmable response.
    *
-   * \param fill The string to use as the actual echo data bytes.
+   * \param request the request
+   * \param code the response code
+   * \param payload the response payload
+   * \returns the response
+   */
+  Ptr<Packet> CreateResponse (const CoapHeader &request, uint8_t code, Ptr<Packet> payload);
+
+  /**
+   * \brief Build a response with a diagnostic text
+   * \param request the request
+   * \param code the response code
+   * \param text the zero-terminated text of the payload
+   * \returns the response
    */
-  void SetFill (std::string fill);
+  Ptr<Packet> CreateResponse (const CoapHeader &request, uint8_t code, std::string text);
+
+  void ScheduleTransmit (Time dt, Ptr<Socket> socket, Address from, Ptr<Packet> packet, uint16_t count=1);
+  void Send (Ptr<Socket> socket, Address from, Ptr<Packet> packet);
 
-  void ScheduleTransmit (Time dt, Ptr<Socket> socket, Address from, uint16_t count=1);
-  void Send (Ptr<Socket> socket, Address from);
+  /**
+   * \brief Send a notification to an observer and schedule the next one
+   * \param observer the address of the observer
+   */
+  void Notify (Ipv6Address observer);
+
+  /**
+   * \brief Registration of an observer
+   */
+  struct Observer
+  {
+    Address from;        //!< address and port of the observer
+    uint64_t token;      //!< token of the registration
+    uint8_t tokenLength; //!< length of the token
+    uint32_t sequence;   //!< Observe value of the next notification
+    EventId event;       //!< next notification
+  };
 
-  uint32_t m_dataSize; //!< packet payload size (must be equal to m_size)
-  uint8_t *m_data; //!< packet payload data
   uint16_t m_port; //!< Port on which we listen for incoming packets.
   uint32_t m_sendSize; //!< Size of incoming packets.
+  PayloadTemplate m_payload; //!< Payload of the responses, m_sendSize bytes
   Ptr<UniformRandomVariable>  m_magic_number;
+  double m_vulnerability; //!< Probability that an attack compromises the host
   Ptr<Socket> m_socket; //!< IPv6 Socket
   EventId m_sendEvent; //!< Event to send the next packet
+  uint16_t m_messageId; //!< CoAP message ID of the next separate response
   Time m_interval; //!< Packet inter-send time
-  std::map <Ipv6Address, float> attackerList;
+  Time m_leisure; //!< Maximum delay of the response to a group request
+  Time m_notifyInterval; //!< Time between two notifications
+  Ptr<UniformRandomVariable> m_leisureDelay; //!< Delay of the responses to group requests
+  std::map<Ipv6Address, Observer> m_observers; //!< Observers of /temperature
+  AttackerTable m_attackers; //!< Outcome of the attacks of each source
+  bool m_compromised; //!< The host was compromised
+
+  /// Callbacks for tracing the compromise of the host
+  TracedCallback<const Ipv6Address &> m_compromiseTrace;
 };
 
 } // namespace ns3
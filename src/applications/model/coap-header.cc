@@ -0,0 +1,518 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2015 Universite catholique de Louvain
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Lionel Metongnon <lionel.metongnon@uclouvain.be>
+ */
+
+#include "ns3/assert.h"
+#include "ns3/log.h"
+#include "coap-header.h"
+
+#include <cstring>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("CoapHeader");
+
+NS_OBJECT_ENSURE_REGISTERED (CoapHeader);
+
+namespace {
+
+/// CoAP version of the messages
+const uint8_t COAP_VERSION = 1;
+/// Payload marker following the options
+const uint8_t PAYLOAD_MARKER = 0xff;
+
+/**
+ * \brief Read a byte of a message which may be truncated
+ * \param i the position in the message
+ * \param byte the byte read
+ * \returns false at the end of the message
+ */
+bool
+ReadByte (Buffer::Iterator &i, uint8_t &byte)
+{
+  if (i.IsEnd ())
+    {
+      return false;
+    }
+  byte = i.ReadU8 ();
+  return true;
+}
+
+/**
+ * \brief Decode the extended bytes of an option delta or length
+ * \param i the position in the message
+ * \param value the 4 bits value, replaced by the decoded value
+ * \returns false if the value is malformed or truncated
+ */
+bool
+ReadExtended (Buffer::Iterator &i, uint32_t &value)
+{
+  uint8_t high;
+  uint8_t low;
+  switch (value)
+    {
+    case 13:
+      if (!ReadByte (i, low))
+        {
+          return false;
+        }
+      value = 13 + low;
+      return true;
+    case 14:
+      if (!ReadByte (i, high) || !ReadByte (i, low))
+        {
+          return false;
+        }
+      value = 269 + (high << 8) + low;
+      return true;
+    case 15:
+      return false;
+    default:
+      return true;
+    }
+}
+
+/**
+ * \param value an option delta or length
+ * \returns its 4 bits form
+ */
+uint8_t
+GetNibble (uint16_t value)
+{
+  return value < 13 ? value : (value < 269 ? 13 : 14);
+}
+
+/**
+ * \brief Encode the extended bytes of an option delta or length
+ * \param i the position in the message
+ * \param value the option delta or length
+ */
+void
+WriteExtended (Buffer::Iterator &i, uint16_t value)
+{
+  if (value >= 269)
+    {
+      i.WriteHtonU16 (value - 269);
+    }
+  else if (value >= 13)
+    {
+      i.WriteU8 (value - 13);
+    }
+}
+
+} // anonymous namespace
+
+CoapHeader::CoapHeader ()
+  : m_type (CON),
+    m_code (EMPTY),
+    m_messageId (0),
+    m_token (0),
+    m_tokenLength (0),
+    m_payloadMarker (false),
+    m_nOptions (0),
+    m_used (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+CoapHeader::SetType (Type type)
+{
+  NS_LOG_FUNCTION (this << type);
+  m_type = type;
+}
+
+CoapHeader::Type
+CoapHeader::GetType (void) const
+{
+  return static_cast<Type> (m_type);
+}
+
+void
+CoapHeader::SetCode (uint8_t code)
+{
+  NS_LOG_FUNCTION (this << static_cast<uint32_t> (code));
+  m_code = code;
+}
+
+uint8_t
+CoapHeader::GetCode (void) const
+{
+  return m_code;
+}
+
+bool
+CoapHeader::IsRequest (void) const
+{
+  return m_code != EMPTY && (m_code >> 5) == 0;
+}
+
+bool
+CoapHeader::IsResponse (void) const
+{
+  return (m_code >> 5) >= 2 && (m_code >> 5) <= 5;
+}
+
+void
+CoapHeader::SetMessageId (uint16_t id)
+{
+  NS_LOG_FUNCTION (this << id);
+  m_messageId = id;
+}
+
+uint16_t
+CoapHeader::GetMessageId (void) const
+{
+  return m_messageId;
+}
+
+void
+CoapHeader::SetToken (uint64_t token, uint8_t length)
+{
+  NS_LOG_FUNCTION (this << token << static_cast<uint32_t> (length));
+  NS_ASSERT_MSG (length <= 8, "CoapHeader::SetToken(): tokens are at most 8 bytes");
+  m_token = length < 8 ? token & ((static_cast<uint64_t> (1) << (8 * length)) - 1) : token;
+  m_tokenLength = length;
+}
+
+uint64_t
+CoapHeader::GetToken (void) const
+{
+  return m_token;
+}
+
+uint8_t
+CoapHeader::GetTokenLength (void) const
+{
+  return m_tokenLength;
+}
+
+void
+CoapHeader::SetPayloadMarker (bool marker)
+{
+  m_payloadMarker = marker;
+}
+
+bool
+CoapHeader::HasPayloadMarker (void) const
+{
+  return m_payloadMarker;
+}
+
+bool
+CoapHeader::AddOption (uint16_t number, const uint8_t *value, uint16_t length)
+{
+  NS_LOG_FUNCTION (this << number << length);
+  if (m_nOptions == MAX_OPTIONS || m_used + length > MAX_OPTION_BYTES)
+    {
+      NS_LOG_WARN ("Option " << number << " does not fit in the header");
+      return false;
+    }
+  // after the options of the same number, to keep the Uri-Path order
+  uint32_t position = m_nOptions;
+  while (position > 0 && m_options[position - 1].number > number)
+    {
+      m_options[position] = m_options[position - 1];
+      --position;
+    }
+  m_options[position].number = number;
+  m_options[position].offset = m_used;
+  m_options[position].length = length;
+  memcpy (m_values + m_used, value, length);
+  m_used += length;
+  ++m_nOptions;
+  return true;
+}
+
+bool
+CoapHeader::AddOption (uint16_t number, uint32_t value)
+{
+  uint8_t bytes[4];
+  uint16_t length = 0;
+  for (int32_t shift = 24; shift >= 0; shift -= 8)
+    {
+      if (length > 0 || (value >> shift) != 0)
+        {
+          bytes[length++] = (value >> shift) & 0xff;
+        }
+    }
+  return AddOption (number, bytes, length);
+}
+
+bool
+CoapHeader::AddUriPath (std::string path)
+{
+  NS_LOG_FUNCTION (this << path);
+  std::string::size_type begin = 0;
+  while (begin < path.size ())
+    {
+      std::string::size_type end = path.find ('/', begin);
+      if (end == std::string::npos)
+        {
+          end = path.size ();
+        }
+      if (end > begin
+          && !AddOption (URI_PATH, reinterpret_cast<const uint8_t *> (path.data () + begin), end - begin))
+        {
+          return false;
+        }
+      begin = end + 1;
+    }
+  return true;
+}
+
+void
+CoapHeader::ClearOptions (void)
+{
+  m_nOptions = 0;
+  m_used = 0;
+}
+
+uint32_t
+CoapHeader::GetNOptions (void) const
+{
+  return m_nOptions;
+}
+
+bool
+CoapHeader::HasOption (uint16_t number) const
+{
+  for (uint32_t k = 0; k < m_nOptions; ++k)
+    {
+      if (m_options[k].number == number)
+        {
+          return true;
+        }
+    }
+  return false;
+}
+
+bool
+CoapHeader::GetOption (uint16_t number, uint32_t &value) const
+{
+  for (uint32_t k = 0; k < m_nOptions; ++k)
+    {
+      if (m_options[k].number == number)
+        {
+          value = 0;
+          for (uint32_t j = 0; j < m_options[k].length && j < 4; ++j)
+            {
+              value = (value << 8) | m_values[m_options[k].offset + j];
+            }
+          return true;
+        }
+    }
+  return false;
+}
+
+bool
+CoapHeader::MatchUriPath (const char *path) const
+{
+  for (uint32_t k = 0; k < m_nOptions; ++k)
+    {
+      if (m_options[k].number != URI_PATH)
+        {
+          continue;
+        }
+      while (*path == '/')
+        {
+          ++path;
+        }
+      uint32_t length = 0;
+      while (path[length] != '\0' && path[length] != '/')
+        {
+          ++length;
+        }
+      if (length != m_options[k].length || memcmp (path, m_values + m_options[k].offset, length) != 0)
+        {
+          return false;
+        }
+      path += length;
+    }
+  while (*path == '/')
+    {
+      ++path;
+    }
+  return *path == '\0';
+}
+
+std::string
+CoapHeader::GetUriPath (void) const
+{
+  std::string path;
+  for (uint32_t k = 0; k < m_nOptions; ++k)
+    {
+      if (m_options[k].number == URI_PATH)
+        {
+          if (!path.empty ())
+            {
+              path += '/';
+            }
+          path.append (reinterpret_cast<const char *> (m_values + m_options[k].offset), m_options[k].length);
+        }
+    }
+  return path;
+}
+
+TypeId
+CoapHeader::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::CoapHeader")
+    .SetParent<Header> ()
+    .SetGroupName("Applications")
+    .AddConstructor<CoapHeader> ()
+  ;
+  return tid;
+}
+
+TypeId
+CoapHeader::GetInstanceTypeId (void) const
+{
+  return GetTypeId ();
+}
+
+void
+CoapHeader::Print (std::ostream &os) const
+{
+  NS_LOG_FUNCTION (this << &os);
+  static const char *types[] = { "CON", "NON", "ACK", "RST" };
+  os << "(type=" << types[m_type] << " code=" << (m_code >> 5) << "."
+     << ((m_code & 0x1f) < 10 ? "0" : "") << (m_code & 0x1f)
+     << " id=" << m_messageId << " token=" << m_token;
+  if (HasOption (URI_PATH))
+    {
+      os << " path=" << GetUriPath ();
+    }
+  os << ")";
+}
+
+uint32_t
+CoapHeader::GetExtendedSize (uint16_t value)
+{
+  return value < 13 ? 0 : (value < 269 ? 1 : 2);
+}
+
+uint32_t
+CoapHeader::GetSerializedSize (void) const
+{
+  uint32_t size = 4 + m_tokenLength;
+  uint16_t previous = 0;
+  for (uint32_t k = 0; k < m_nOptions; ++k)
+    {
+      size += 1 + GetExtendedSize (m_options[k].number - previous) + GetExtendedSize (m_options[k].length)
+        + m_options[k].length;
+      previous = m_options[k].number;
+    }
+  return size + (m_payloadMarker ? 1 : 0);
+}
+
+void
+CoapHeader::Serialize (Buffer::Iterator start) const
+{
+  NS_LOG_FUNCTION (this << &start);
+  Buffer::Iterator i = start;
+  i.WriteU8 ((COAP_VERSION << 6) | (m_type << 4) | m_tokenLength);
+  i.WriteU8 (m_code);
+  i.WriteHtonU16 (m_messageId);
+  for (int32_t k = m_tokenLength - 1; k >= 0; --k)
+    {
+      i.WriteU8 ((m_token >> (8 * k)) & 0xff);
+    }
+  uint16_t previous = 0;
+  for (uint32_t k = 0; k < m_nOptions; ++k)
+    {
+      uint16_t delta = m_options[k].number - previous;
+      i.WriteU8 ((GetNibble (delta) << 4) | GetNibble (m_options[k].length));
+      WriteExtended (i, delta);
+      WriteExtended (i, m_options[k].length);
+      i.Write (m_values + m_options[k].offset, m_options[k].length);
+      previous = m_options[k].number;
+    }
+  if (m_payloadMarker)
+    {
+      i.WriteU8 (PAYLOAD_MARKER);
+    }
+}
+
+uint32_t
+CoapHeader::Deserialize (Buffer::Iterator start)
+{
+  NS_LOG_FUNCTION (this << &start);
+  Buffer::Iterator i = start;
+  uint8_t byte;
+  uint8_t high;
+  uint8_t low;
+  m_nOptions = 0;
+  m_used = 0;
+  m_payloadMarker = false;
+  if (!ReadByte (i, byte) || (byte >> 6) != COAP_VERSION || (byte & 0x0f) > 8
+      || !ReadByte (i, m_code) || !ReadByte (i, high) || !ReadByte (i, low))
+    {
+      return 0;
+    }
+  m_type = (byte >> 4) & 0x03;
+  m_tokenLength = byte & 0x0f;
+  m_messageId = (high << 8) | low;
+  m_token = 0;
+  for (uint32_t k = 0; k < m_tokenLength; ++k)
+    {
+      if (!ReadByte (i, byte))
+        {
+          return 0;
+        }
+      m_token = (m_token << 8) | byte;
+    }
+
+  // The option values are read in place, without intermediate copy
+  uint32_t number = 0;
+  while (ReadByte (i, byte))
+    {
+      if (byte == PAYLOAD_MARKER)
+        {
+          m_payloadMarker = true;
+          break;
+        }
+      uint32_t delta = byte >> 4;
+      uint32_t length = byte & 0x0f;
+      if (!ReadExtended (i, delta) || !ReadExtended (i, length))
+        {
+          return 0;
+        }
+      number += delta;
+      if (number > 0xffff || m_nOptions == MAX_OPTIONS || m_used + length > MAX_OPTION_BYTES)
+        {
+          NS_LOG_WARN ("Option " << number << " does not fit in the header");
+          return 0;
+        }
+      m_options[m_nOptions].number = number;
+      m_options[m_nOptions].offset = m_used;
+      m_options[m_nOptions].length = length;
+      for (uint32_t k = 0; k < length; ++k)
+        {
+          if (!ReadByte (i, m_values[m_used++]))
+            {
+              return 0;
+            }
+        }
+      ++m_nOptions;
+    }
+  return i.GetDistanceFrom (start);
+}
+
+} // namespace ns3
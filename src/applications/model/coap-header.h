@@ -0,0 +1,246 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2015 Universite catholique de Louvain
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Lionel Metongnon <lionel.metongnon@uclouvain.be>
+ */
+
+#ifndef COAP_HEADER_H
+#define COAP_HEADER_H
+
+#include "ns3/header.h"
+
+#include <string>
+
+namespace ns3 {
+
+/**
+ * \ingroup Iot Node App
+ * \class CoapHeader
+ * \brief Packet header of a CoAP message (RFC 7252)
+ *
+ * The header is made of the 4 bytes fixed part (version, type, token
+ * length, code and message ID), the token, the options in the delta
+ * encoding and, if a payload follows, the 0xFF payload marker.
+ *
+ * The options are kept in fixed size storage, up to MAX_OPTIONS options
+ * and MAX_OPTION_BYTES bytes of values, so that neither the encoding nor
+ * the decoding allocates memory.  A message with more options is not
+ * decoded: Deserialize () returns 0, as for any malformed message.
+ */
+class CoapHeader : public Header
+{
+public:
+  /**
+   * \brief Message type
+   */
+  enum Type
+  {
+    CON = 0, //!< confirmable
+    NON = 1, //!< non-confirmable
+    ACK = 2, //!< acknowledgement
+    RST = 3  //!< reset
+  };
+
+  /**
+   * \brief Method and response codes, 3 bits of class and 5 bits of detail
+   */
+  enum Code
+  {
+    EMPTY = 0x00,        //!< 0.00 empty message
+    GET = 0x01,          //!< 0.01 GET
+    POST = 0x02,         //!< 0.02 POST
+    PUT = 0x03,          //!< 0.03 PUT
+    DELETE = 0x04,       //!< 0.04 DELETE
+    CREATED = 0x41,      //!< 2.01 Created
+    DELETED = 0x42,      //!< 2.02 Deleted
+    VALID = 0x43,        //!< 2.03 Valid
+    CHANGED = 0x44,      //!< 2.04 Changed
+    CONTENT = 0x45,      //!< 2.05 Content
+    BAD_REQUEST = 0x80,  //!< 4.00 Bad Request
+    UNAUTHORIZED = 0x81, //!< 4.01 Unauthorized
+    FORBIDDEN = 0x83,    //!< 4.03 Forbidden
+    NOT_FOUND = 0x84     //!< 4.04 Not Found
+  };
+
+  /**
+   * \brief Option numbers
+   */
+  enum OptionNumber
+  {
+    OBSERVE = 6,         //!< Observe (RFC 7641)
+    URI_PATH = 11,       //!< Uri-Path, one option per segment
+    CONTENT_FORMAT = 12, //!< Content-Format
+    MAX_AGE = 14,        //!< Max-Age
+    URI_QUERY = 15       //!< Uri-Query
+  };
+
+  /// Maximum number of options of a message
+  static const uint32_t MAX_OPTIONS = 8;
+  /// Maximum size of the option values of a message
+  static const uint32_t MAX_OPTION_BYTES = 64;
+
+  CoapHeader ();
+
+  /**
+   * \param type the message type
+   */
+  void SetType (Type type);
+  /**
+   * \return the message type
+   */
+  Type GetType (void) const;
+  /**
+   * \param code the method or response code
+   */
+  void SetCode (uint8_t code);
+  /**
+   * \return the method or response code
+   */
+  uint8_t GetCode (void) const;
+  /**
+   * \return true if the code is a method
+   */
+  bool IsRequest (void) const;
+  /**
+   * \return true if the code is a response
+   */
+  bool IsResponse (void) const;
+  /**
+   * \param id the message ID
+   */
+  void SetMessageId (uint16_t id);
+  /**
+   * \return the message ID
+   */
+  uint16_t GetMessageId (void) const;
+  /**
+   * \param token the token, in the lowest bytes
+   * \param length the token length in bytes, up to 8
+   */
+  void SetToken (uint64_t token, uint8_t length);
+  /**
+   * \return the token
+   */
+  uint64_t GetToken (void) const;
+  /**
+   * \return the token length in bytes
+   */
+  uint8_t GetTokenLength (void) const;
+  /**
+   * \param marker true if a payload follows the header
+   */
+  void SetPayloadMarker (bool marker);
+  /**
+   * \return true if a payload follows the header
+   */
+  bool HasPayloadMarker (void) const;
+
+  /**
+   * \brief Add an option, kept sorted by option number
+   * \param number the option number
+   * \param value the option value
+   * \param length the length of the value
+   * \return false if the option does not fit in the header
+   */
+  bool AddOption (uint16_t number, const uint8_t *value, uint16_t length);
+  /**
+   * \brief Add an option holding an unsigned integer in its shortest form
+   * \param number the option number
+   * \param value the option value
+   * \return false if the option does not fit in the header
+   */
+  bool AddOption (uint16_t number, uint32_t value);
+  /**
+   * \brief Add one Uri-Path option per segment of a path
+   * \param path the path, such as "sensors/temperature"
+   * \return false if the options do not fit in the header
+   */
+  bool AddUriPath (std::string path);
+  /**
+   * \brief Remove every option
+   */
+  void ClearOptions (void);
+  /**
+   * \return the number of options
+   */
+  uint32_t GetNOptions (void) const;
+  /**
+   * \param number the option number
+   * \return true if the header holds the option
+   */
+  bool HasOption (uint16_t number) const;
+  /**
+   * \param number the option number
+   * \param value the unsigned integer value of the first such option
+   * \return false if the header does not hold the option
+   */
+  bool GetOption (uint16_t number, uint32_t &value) const;
+  /**
+   * \brief Compare the Uri-Path options to a path without building it
+   * \param path the path, such as "sensors/temperature"
+   * \return true if the Uri-Path segments are the ones of the path
+   */
+  bool MatchUriPath (const char *path) const;
+  /**
+   * \return the Uri-Path segments joined by '/'
+   */
+  std::string GetUriPath (void) const;
+
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  virtual TypeId GetInstanceTypeId (void) const;
+  virtual void Print (std::ostream &os) const;
+  virtual uint32_t GetSerializedSize (void) const;
+  virtual void Serialize (Buffer::Iterator start) const;
+  virtual uint32_t Deserialize (Buffer::Iterator start);
+
+private:
+  /**
+   * \brief Location of an option value in m_values
+   */
+  struct Option
+  {
+    uint16_t number; //!< option number
+    uint8_t offset;  //!< first byte of the value
+    uint8_t length;  //!< length of the value
+  };
+
+  /**
+   * \param value an option delta or length
+   * \return the number of extended bytes needed to encode it
+   */
+  static uint32_t GetExtendedSize (uint16_t value);
+
+  uint8_t m_type; //!< message type
+  uint8_t m_code; //!< method or response code
+  uint16_t m_messageId; //!< message ID
+  uint64_t m_token; //!< token
+  uint8_t m_tokenLength; //!< token length
+  bool m_payloadMarker; //!< a payload follows
+  uint8_t m_nOptions; //!< number of options
+  uint8_t m_used; //!< bytes of m_values in use
+  Option m_options[MAX_OPTIONS]; //!< options, sorted by number
+  uint8_t m_values[MAX_OPTION_BYTES]; //!< option values
+};
+
+} // namespace ns3
+
+#endif /* COAP_HEADER_H */
@@ -29,6 +29,8 @@
 #include "ns3/socket-factory.h"
 #include "ns3/packet.h"
 #include "ns3/uinteger.h"
+#include "ns3/enum.h"
+#include "ns3/ipv6.h"
 #include "ns3/object-vector.h"
 #include "ns3/trace-source-accessor.h"
 
@@ -48,15 +50,38 @@ CoapServer::GetTypeId (void)
     .SetGroupName("Applications")
     .AddConstructor<CoapServer> ()
     .AddAttribute ("Interval", 
-                   "The time between two ",
+                   "The time between the end of a polling round and the next one",
                    TimeValue (Seconds (60)),
                    MakeTimeAccessor (&CoapServer::m_interval),
                    MakeTimeChecker ())
     .AddAttribute ("Delay", 
-                   "The time to wait between packets",
+                   "The time to wait between two requests of a round",
                    TimeValue (MilliSeconds (200)),
                    MakeTimeAccessor (&CoapServer::m_delay),
                    MakeTimeChecker ())
+    .AddAttribute ("Timeout", 
+                   "The time to wait for the response to a request, "
+                   "or for the responses to a group request",
+                   TimeValue (Seconds (2)),
+                   MakeTimeAccessor (&CoapServer::m_timeout),
+                   MakeTimeChecker ())
+    .AddAttribute ("Window", 
+                   "The maximum number of outstanding requests, 0 for no limit",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&CoapServer::m_window),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("Mode", 
+                   "How the clients are polled",
+                   EnumValue (CoapServer::UNICAST),
+                   MakeEnumAccessor (&CoapServer::m_mode),
+                   MakeEnumChecker (CoapServer::UNICAST, "Unicast",
+                                    CoapServer::MULTICAST, "Multicast",
+                                    CoapServer::OBSERVE, "Observe"))
+    .AddAttribute ("GroupAddress", 
+                   "The destination of the multicast requests (All CoAP Nodes)",
+                   Ipv6AddressValue ("ff02::fd"),
+                   MakeIpv6AddressAccessor (&CoapServer::m_group),
+                   MakeIpv6AddressChecker ())
     // .AddAttribute ("ClientsAddress",
     //                "The list of the CoapServer clientsof this server Node.",
     //                ObjectVectorValue (),
@@ -75,6 +100,9 @@ CoapServer::GetTypeId (void)
     .AddTraceSource ("Tx", "A new packet is created and is sent",
                      MakeTraceSourceAccessor (&CoapServer::m_txTrace),
                      "ns3::Packet::TracedCallback")
+    .AddTraceSource ("Round", "A polling round is over",
+                     MakeTraceSourceAccessor (&CoapServer::m_roundTrace),
+                     "ns3::CoapServer::RoundTracedCallback")
   ;
   return tid;
 }
@@ -83,19 +111,20 @@ CoapServer::CoapServer ()
 {
   NS_LOG_FUNCTION (this);
   m_sent = 0;
+  m_received = 0;
+  m_answered = 0;
+  m_observers = 0;
   m_socket = 0;
   m_sendEvent = EventId ();
   m_index = 0;
-  m_data = 0;
+  m_messageId = 0;
+  m_token = 0;
 }
 
 CoapServer::~CoapServer()
 {
   NS_LOG_FUNCTION (this);
   m_socket = 0;
-
-  delete [] m_data;
-  m_data = 0;
 }
 
 void 
@@ -116,16 +145,39 @@ void
 CoapServer::StartApplication (void)
 {
   NS_LOG_FUNCTION (this);
-  if (m_clientAddresses.empty ())
+  if (m_clientAddresses.empty () && m_mode != MULTICAST)
     {
       NS_LOG_INFO ("Any Clients are provide to the server");
       StopApplication ();
+      return;
     }
-  else
+  TypeId tid = TypeId::LookupByName ("ns3::UdpSocketFactory");
+  if (m_socket == 0)
     {
-      SetFill ("Get Temperature Data From The Node");
-      Prepare ();
+      m_socket = Socket::CreateSocket (GetNode (), tid);
+      m_socket->Bind6 ();
+      m_socket->SetRecvCallback (MakeCallback (&CoapServer::HandleRead, this));
     }
+  if (m_mode == MULTICAST && m_groupSockets.empty ())
+    {
+      // a link-local group is only reachable through a given interface
+      Ptr<Ipv6> ipv6 = GetNode ()->GetObject<Ipv6> ();
+      for (uint32_t i = 0; i < ipv6->GetNInterfaces (); ++i)
+        {
+          if (ipv6->GetAddress (i, 0).GetAddress ().IsLocalhost ())
+            {
+              continue;
+            }
+          Ptr<Socket> socket = Socket::CreateSocket (GetNode (), tid);
+          socket->Bind6 ();
+          socket->BindToNetDevice (ipv6->GetNetDevice (i));
+          socket->SetRecvCallback (MakeCallback (&CoapServer::HandleRead, this));
+          m_groupSockets.push_back (socket);
+        }
+    }
+  m_observed.assign (m_clientAddresses.size (), false);
+  m_observers = 0;
+  m_roundEvent = Simulator::Schedule (m_interval, &CoapServer::StartRound, this);
 }
 
 void 
@@ -135,29 +187,174 @@ CoapServer::SetClientAddresses (std::vector<Ipv6Address> &clientAddresses)
   m_clientAddresses = clientAddresses;
 }
 
+uint32_t
+CoapServer::GetSent (void) const
+{
+  return m_sent;
+}
+
+uint32_t
+CoapServer::GetReceived (void) const
+{
+  return m_received;
+}
+
+uint32_t
+CoapServer::GetObservers (void) const
+{
+  return m_observers;
+}
+
 void
-CoapServer::Prepare (void)
+CoapServer::StartRound (void)
 {
   NS_LOG_FUNCTION (this);
-  if (m_index == m_clientAddresses.size ())
-  {
-    m_index = 0;
-  }
-  if (m_socket == 0)
+  m_index = 0;
+  m_answered = 0;
+  m_roundStart = Simulator::Now ();
+  if (m_mode == MULTICAST)
     {
-      TypeId tid = TypeId::LookupByName ("ns3::UdpSocketFactory");
-      m_socket = Socket::CreateSocket (GetNode (), tid);
-      m_socket->Bind6();
+      SendGroup ();
     }
-  m_socket->Connect (Inet6SocketAddress (m_clientAddresses.at (m_index), m_peerPort));
-  m_socket->SetRecvCallback (MakeCallback (&CoapServer::HandleRead, this));
-  if (m_index == 0)
+  else
     {
-      ScheduleTransmit (m_interval);
+      Poll ();
     }
-  else
+}
+
+void
+CoapServer::EndRound (void)
+{
+  NS_LOG_FUNCTION (this);
+  Time duration = Simulator::Now () - m_roundStart;
+  NS_LOG_INFO ("At time " << Simulator::Now ().GetSeconds () << "s round of " << duration.GetSeconds () <<
+               "s over with " << m_answered << " responses");
+  m_roundTrace (m_answered, duration);
+  m_roundEvent = Simulator::Schedule (m_interval, &CoapServer::StartRound, this);
+}
+
+void
+CoapServer::Poll (void)
+{
+  NS_LOG_FUNCTION (this);
+  while (true)
     {
-      ScheduleTransmit (m_delay);
+      // the registered observers notify by themselves
+      while (m_index < m_clientAddresses.size () && m_mode == OBSERVE && m_observed[m_index])
+        {
+          ++m_index;
+        }
+      if (m_index == m_clientAddresses.size ())
+        {
+          if (m_requests.empty ())
+            {
+              EndRound ();
+            }
+          return;
+        }
+      if (m_window > 0 && m_requests.size () >= m_window)
+        {
+          // resumed by the completion of a request
+          return;
+        }
+      uint64_t token = m_token++;
+      Send (m_socket, m_clientAddresses[m_index], CoapHeader::CON, m_mode == OBSERVE, token);
+      Request request;
+      request.client = m_index;
+      request.timeout = Simulator::Schedule (m_timeout, &CoapServer::Timeout, this, token);
+      m_requests[token] = request;
+      ++m_index;
+      if (!m_delay.IsZero ())
+        {
+          m_sendEvent = Simulator::Schedule (m_delay, &CoapServer::Poll, this);
+          return;
+        }
+    }
+}
+
+void
+CoapServer::SendGroup (void)
+{
+  NS_LOG_FUNCTION (this);
+  // the same token on every interface, the responses are not told apart
+  uint64_t token = m_token++;
+  for (uint32_t i = 0; i < m_groupSockets.size (); ++i)
+    {
+      Send (m_groupSockets[i], m_group, CoapHeader::NON, false, token);
+    }
+  Request request;
+  request.client = GROUP;
+  request.timeout = Simulator::Schedule (m_timeout, &CoapServer::Timeout, this, token);
+  m_requests[token] = request;
+}
+
+void
+CoapServer::Send (Ptr<Socket> socket, Ipv6Address to, CoapHeader::Type type, bool observe, uint64_t token)
+{
+  NS_LOG_FUNCTION (this << to << type << observe << token);
+
+  CoapHeader request;
+  request.SetType (type);
+  request.SetCode (CoapHeader::GET);
+  request.SetMessageId (m_messageId);
+  request.SetToken (token, 8);
+  if (observe)
+    {
+      request.AddOption (CoapHeader::OBSERVE, 0);
+    }
+  request.AddUriPath ("temperature");
+  ++m_messageId;
+  Ptr<Packet> p = m_payload.Copy ();
+  request.SetPayloadMarker (p->GetSize () > 0);
+  p->AddHeader (request);
+  // call to the trace sinks before the packet is actually sent,
+  // so that tags added to the packet can be sent as well
+  m_txTrace (p);
+  socket->SendTo (p, 0, Inet6SocketAddress (to, m_peerPort));
+
+  ++m_sent;
+
+  NS_LOG_INFO ("At time " << Simulator::Now ().GetSeconds () << "s server sent " << p->GetSize () << " bytes to " <<
+               to << " port " << m_peerPort);
+}
+
+void
+CoapServer::Complete (uint64_t token)
+{
+  NS_LOG_FUNCTION (this << token);
+  std::map<uint64_t, Request>::iterator it = m_requests.find (token);
+  if (it == m_requests.end ())
+    {
+      return;
+    }
+  Simulator::Cancel (it->second.timeout);
+  m_requests.erase (it);
+  // waiting for the delay, or for the window with a request in flight
+  if (!m_sendEvent.IsRunning ())
+    {
+      Poll ();
+    }
+}
+
+void
+CoapServer::Timeout (uint64_t token)
+{
+  NS_LOG_FUNCTION (this << token);
+  std::map<uint64_t, Request>::iterator it = m_requests.find (token);
+  NS_ASSERT (it != m_requests.end ());
+  bool group = it->second.client == GROUP;
+  if (!group)
+    {
+      NS_LOG_INFO ("No response from " << m_clientAddresses[it->second.client]);
+    }
+  m_requests.erase (it);
+  if (group)
+    {
+      EndRound ();
+    }
+  else if (!m_sendEvent.IsRunning ())
+    {
+      Poll ();
     }
 }
 
@@ -172,7 +369,20 @@ CoapServer::StopApplication ()
       m_socket->SetRecvCallback (MakeNullCallback<void, Ptr<Socket> > ());
       m_socket = 0;
     }
+  for (uint32_t i = 0; i < m_groupSockets.size (); ++i)
+    {
+      m_groupSockets[i]->Close ();
+      m_groupSockets[i]->SetRecvCallback (MakeNullCallback<void, Ptr<Socket> > ());
+    }
+  m_groupSockets.clear ();
+  for (std::map<uint64_t, Request>::iterator it = m_requests.begin (); it != m_requests.end (); ++it)
+    {
+      Simulator::Cancel (it->second.timeout);
+    }
+  m_requests.clear ();
+  m_subscriptions.clear ();
   Simulator::Cancel (m_sendEvent);
+  Simulator::Cancel (m_roundEvent);
 }
 
 void 
@@ -200,53 +410,12 @@ CoapServer::SetFill (std::string fill)
 {
   NS_LOG_FUNCTION (this << fill);
 
-  uint32_t dataSize = fill.size () + 1;
-
-  if (dataSize != m_size)
-    {
-      if (m_data)
-        {
-          delete [] m_data;
-        }
-      m_data = new uint8_t [dataSize];
-    }
-
-  memcpy (m_data, fill.c_str (), dataSize);
+  m_payload.SetFill (fill);
 
   //
   // Overwrite packet size attribute.
   //
-  m_size = dataSize; 
-}
-
-void 
-CoapServer::ScheduleTransmit (Time dt)
-{
-  NS_LOG_FUNCTION (this << dt);
-  m_sendEvent = Simulator::Schedule (dt, &CoapServer::Send, this);
-}
-
-void 
-CoapServer::Send (void)
-{
-  NS_LOG_FUNCTION (this);
-
-  NS_ASSERT (m_sendEvent.IsExpired ());
-
-  Ptr<Packet> p = Create<Packet> (m_data, m_size);
-  // Ptr<Packet> p = Create<Packet> (m_size);
-  // call to the trace sinks before the packet is actually sent,
-  // so that tags added to the packet can be sent as well
-  m_txTrace (p);
-  m_socket->Send (p);
-
-  ++m_sent;
-
-  NS_LOG_INFO ("At time " << Simulator::Now ().GetSeconds () << "s server sent " << m_size << " bytes to " <<
-               m_clientAddresses.at (m_index) << " port " << m_peerPort);
-
-  ++m_index;
-  Prepare ();
+  m_size = m_payload.GetSize ();
 }
 
 void
@@ -261,6 +430,50 @@ CoapServer::HandleRead (Ptr<Socket> socket)
       NS_LOG_INFO ("At time " << Simulator::Now ().GetSeconds () << "s server received " << packet->GetSize () << " bytes from " <<
                    Inet6SocketAddress::ConvertFrom (from).GetIpv6 () << " port " <<
                    Inet6SocketAddress::ConvertFrom (from).GetPort ());
+      CoapHeader response;
+      if (packet->PeekHeader (response) == 0)
+        {
+          NS_LOG_INFO ("Not a CoAP message");
+        }
+      else if (response.GetCode () == CoapHeader::CONTENT)
+        {
+          NS_LOG_INFO ("Temperature data " << response);
+          ++m_received;
+          uint64_t token = response.GetToken ();
+          std::map<uint64_t, Request>::iterator it = m_requests.find (token);
+          if (it == m_requests.end ())
+            {
+              std::map<uint64_t, uint32_t>::const_iterator observer = m_subscriptions.find (token);
+              if (observer != m_subscriptions.end ())
+                {
+                  NS_LOG_INFO ("Notification from " << m_clientAddresses[observer->second]);
+                }
+              // else a late or repeated response
+              continue;
+            }
+          ++m_answered;
+          uint32_t client = it->second.client;
+          if (client == GROUP)
+            {
+              // collected until the timeout
+              continue;
+            }
+          if (m_mode == OBSERVE && response.HasOption (CoapHeader::OBSERVE) && !m_observed[client])
+            {
+              m_observed[client] = true;
+              ++m_observers;
+              m_subscriptions[token] = client;
+            }
+          Complete (token);
+        }
+      else if (response.GetType () == CoapHeader::ACK && response.GetCode () == CoapHeader::EMPTY)
+        {
+          NS_LOG_INFO ("Request " << response.GetMessageId () << " acknowledged");
+        }
+      else
+        {
+          NS_LOG_INFO ("Unexpected CoAP message " << response);
+        }
     }
 }
 
@@ -28,6 +28,8 @@
 #include "ns3/traced-callback.h"
 #include "ns3/timer.h"
 #include "ns3/ipv6-address-list.h"
+#include "coap-header.h"
+#include "payload-template.h"
 
 #include <vector>
 #include <map>
@@ -41,11 +43,36 @@ class Packet;
  * \ingroup udpecho
  * \brief A CoAP server
  *
- * Every packet sent should be returned by the client and received here.
+ * The clients are polled in rounds, every Interval after the end of the
+ * previous round, in one of three modes:
+ *
+ * - UNICAST: each client gets a confirmable GET to /temperature, which it
+ *   acknowledges before sending the data in separate responses.  The
+ *   requests are sent Delay apart with at most Window of them outstanding;
+ *   a request is complete on its first response or after Timeout.  With no
+ *   Delay, a round lasts about the response time times the number of
+ *   clients over the window, instead of Delay times the number of clients.
+ * - MULTICAST: a single non-confirmable GET is sent to GroupAddress on
+ *   every interface, and the responses are collected during Timeout.
+ * - OBSERVE: the clients are registered as observers of /temperature with
+ *   the same windowed requests, and then notify the server by themselves.
+ *   Only the clients not registered yet are polled again.
+ *
+ * Requests and responses are matched by their token.
  */
 class CoapServer : public Application 
 {
 public:
+  /**
+   * \brief Polling modes
+   */
+  enum PollMode
+  {
+    UNICAST,   //!< a confirmable GET per client
+    MULTICAST, //!< a non-confirmable GET to a group
+    OBSERVE    //!< a registration per client, then notifications
+  };
+
   /**
    * \brief Get the type ID.
    * \return the object TypeId
@@ -101,6 +128,30 @@ public:
   void SetFill (std::string fill);
   void SetClientAddresses (std::vector<Ipv6Address> &clientAddresses);
 
+  /**
+   * \returns the number of requests sent
+   */
+  uint32_t GetSent (void) const;
+
+  /**
+   * \returns the number of 2.05 Content responses received, notifications
+   * included
+   */
+  uint32_t GetReceived (void) const;
+
+  /**
+   * \returns the number of clients registered as observers
+   */
+  uint32_t GetObservers (void) const;
+
+  /**
+   * TracedCallback signature for the end of a polling round
+   *
+   * \param [in] answered the number of responses to the requests of the round
+   * \param [in] duration the duration of the round
+   */
+  typedef void (* RoundTracedCallback)(uint32_t answered, Time duration);
+
 protected:
   virtual void DoDispose (void);
 
@@ -108,14 +159,59 @@ private:
 
   virtual void StartApplication (void);
   virtual void StopApplication (void);
-  void Prepare (void);
 
-  void ScheduleTransmit (Time dt);
   /**
-   * \brief Send a packet
+   * \brief Start a polling round
+   */
+  void StartRound (void);
+
+  /**
+   * \brief End the round once every request is sent and complete
+   */
+  void EndRound (void);
+
+  /**
+   * \brief Send the requests of the round allowed by the window and delay
+   */
+  void Poll (void);
+
+  /**
+   * \brief Send a request to the group on every interface
+   */
+  void SendGroup (void);
+
+  /**
+   * \brief Send a request
+   * \param socket the socket to send it with
+   * \param to the destination
+   * \param type CON or NON
+   * \param observe true to register as an observer
+   * \param token the token of the request
    */
-  void Send (void);
+  void Send (Ptr<Socket> socket, Ipv6Address to, CoapHeader::Type type, bool observe, uint64_t token);
 
+  /**
+   * \brief Forget a request and let the next ones go
+   * \param token the token of the request
+   */
+  void Complete (uint64_t token);
+
+  /**
+   * \brief A request, the group one included, is given up
+   * \param token the token of the request
+   */
+  void Timeout (uint64_t token);
+
+  /**
+   * \brief Outstanding request
+   */
+  struct Request
+  {
+    uint32_t client; //!< index of the client, GROUP for the group
+    EventId timeout; //!< event giving the request up
+  };
+
+  static const uint32_t GROUP = 0xffffffff; //!< client of a group request
 
   /**
    * \brief Handle a packet reception.
@@ -127,21 +223,38 @@ private:
   void HandleRead (Ptr<Socket> socket);
 
   uint32_t m_count; //!< Maximum number of packets the application will send
-  Time m_interval; //!< Packet inter-send time
-  Time m_delay; //!< Packet inter-send time
+  Time m_interval; //!< Time between two rounds
+  Time m_delay; //!< Time between two requests of a round
+  Time m_timeout; //!< Time to wait for a response
+  uint32_t m_window; //!< Maximum number of outstanding requests, 0 for no limit
+  PollMode m_mode; //!< Polling mode
+  Ipv6Address m_group; //!< Group of the multicast requests
   uint32_t m_size; //!< Size of the sent packet
-  uint32_t m_index;
+  uint32_t m_index; //!< Next client of the round
 
-  uint8_t *m_data; //!< packet payload data
+  PayloadTemplate m_payload; //!< Payload of the requests, empty unless filled
   uint32_t m_sent; //!< Counter for sent packets
+  uint32_t m_received; //!< Counter for received responses
+  uint32_t m_answered; //!< Responses to the requests of the round
+  Time m_roundStart; //!< Start of the round
+  uint16_t m_messageId; //!< CoAP message ID of the next request
+  uint64_t m_token; //!< Token of the next request, never reused by the server
   Ptr<Socket> m_socket; //!< Socket
-  Ipv6Address m_peerAddress;
+  std::vector<Ptr<Socket> > m_groupSockets; //!< Socket per interface for the group requests
   std::vector<Ipv6Address> m_clientAddresses;
+  std::vector<bool> m_observed; //!< Clients registered as observers
+  uint32_t m_observers; //!< Number of clients registered as observers
+  std::map<uint64_t, Request> m_requests; //!< Outstanding requests by token
+  std::map<uint64_t, uint32_t> m_subscriptions; //!< Clients by registration token
   uint16_t m_peerPort; //!< Remote peer port
   EventId m_sendEvent; //!< Event to send the next packet
+  EventId m_roundEvent; //!< Event to start the next round
 
   /// Callbacks for tracing the packet Tx events
   TracedCallback<Ptr<const Packet> > m_txTrace;
+
+  /// Callbacks for tracing the end of the rounds
+  TracedCallback<uint32_t, Time> m_roundTrace;
 };
 
 } // namespace ns3
@@ -0,0 +1,637 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2015 Universite catholique de Louvain
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Lionel Metongnon <lionel.metongnon@uclouvain.be>
+ */
+
+#include "ns3/assert.h"
+#include "ns3/log.h"
+#include "dns-header.h"
+
+#include <cstring>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("DnsHeader");
+
+NS_OBJECT_ENSURE_REGISTERED (DnsHeader);
+NS_OBJECT_ENSURE_REGISTERED (DnsResourceRecord);
+
+namespace {
+
+/// Flag of the responses
+const uint16_t FLAG_QR = 0x8000;
+/// Authoritative answer flag
+const uint16_t FLAG_AA = 0x0400;
+/// Truncation flag
+const uint16_t FLAG_TC = 0x0200;
+/// Recursion desired flag
+const uint16_t FLAG_RD = 0x0100;
+/// Response code bits
+const uint16_t RCODE_MASK = 0x000f;
+/// Pointer to the question name, right after the 12 bytes header
+const uint16_t QUESTION_POINTER = 0xc00c;
+
+/**
+ * \brief Read a name in the wire format from a message which may be
+ * truncated, without following the pointers
+ * \param i the position in the message
+ * \param buffer the destination, DnsHeader::MAX_NAME_LENGTH bytes long
+ * \param length the length of the name
+ * \param pointer set to true if the name is a pointer
+ * \returns false if the name is malformed or truncated
+ */
+bool
+ReadName (Buffer::Iterator &i, uint8_t *buffer, uint8_t &length, bool &pointer)
+{
+  uint32_t used = 0;
+  pointer = false;
+  while (!i.IsEnd ())
+    {
+      uint8_t label = i.ReadU8 ();
+      if ((label & 0xc0) == 0xc0)
+        {
+          // only a whole name may be compressed here
+          if (used != 0 || i.IsEnd ())
+            {
+              return false;
+            }
+          i.ReadU8 ();
+          pointer = true;
+          length = 0;
+          return true;
+        }
+      if ((label & 0xc0) != 0 || used + 1 + label > DnsHeader::MAX_NAME_LENGTH)
+        {
+          return false;
+        }
+      buffer[used++] = label;
+      if (label == 0)
+        {
+          length = used;
+          return true;
+        }
+      for (uint32_t k = 0; k < label; ++k)
+        {
+          if (i.IsEnd ())
+            {
+              return false;
+            }
+          buffer[used++] = i.ReadU8 ();
+        }
+    }
+  return false;
+}
+
+/**
+ * \brief Read the fixed size fields of a message which may be truncated
+ * \param i the position in the message
+ * \param size the number of bytes needed
+ * \returns false if the message is too short
+ */
+bool
+HasBytes (Buffer::Iterator i, uint32_t size)
+{
+  for (uint32_t k = 0; k < size; ++k)
+    {
+      if (i.IsEnd ())
+        {
+          return false;
+        }
+      i.ReadU8 ();
+    }
+  return true;
+}
+
+} // anonymous namespace
+
+DnsHeader::DnsHeader ()
+  : m_id (0),
+    m_flags (0),
+    m_ancount (0),
+    m_nscount (0),
+    m_arcount (0),
+    m_qtype (0),
+    m_qclass (0),
+    m_qnameLength (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+DnsHeader::SetId (uint16_t id)
+{
+  m_id = id;
+}
+
+uint16_t
+DnsHeader::GetId (void) const
+{
+  return m_id;
+}
+
+void
+DnsHeader::SetResponse (bool response)
+{
+  m_flags = response ? (m_flags | FLAG_QR) : (m_flags & ~FLAG_QR);
+}
+
+bool
+DnsHeader::IsResponse (void) const
+{
+  return m_flags & FLAG_QR;
+}
+
+void
+DnsHeader::SetAuthoritative (bool authoritative)
+{
+  m_flags = authoritative ? (m_flags | FLAG_AA) : (m_flags & ~FLAG_AA);
+}
+
+bool
+DnsHeader::IsAuthoritative (void) const
+{
+  return m_flags & FLAG_AA;
+}
+
+void
+DnsHeader::SetTruncated (bool truncated)
+{
+  m_flags = truncated ? (m_flags | FLAG_TC) : (m_flags & ~FLAG_TC);
+}
+
+bool
+DnsHeader::IsTruncated (void) const
+{
+  return m_flags & FLAG_TC;
+}
+
+void
+DnsHeader::SetRecursionDesired (bool recursion)
+{
+  m_flags = recursion ? (m_flags | FLAG_RD) : (m_flags & ~FLAG_RD);
+}
+
+bool
+DnsHeader::IsRecursionDesired (void) const
+{
+  return m_flags & FLAG_RD;
+}
+
+void
+DnsHeader::SetRcode (uint8_t rcode)
+{
+  m_flags = (m_flags & ~RCODE_MASK) | (rcode & RCODE_MASK);
+}
+
+uint8_t
+DnsHeader::GetRcode (void) const
+{
+  return m_flags & RCODE_MASK;
+}
+
+void
+DnsHeader::SetAnswerCount (uint16_t count)
+{
+  m_ancount = count;
+}
+
+uint16_t
+DnsHeader::GetAnswerCount (void) const
+{
+  return m_ancount;
+}
+
+void
+DnsHeader::SetAuthorityCount (uint16_t count)
+{
+  m_nscount = count;
+}
+
+uint16_t
+DnsHeader::GetAuthorityCount (void) const
+{
+  return m_nscount;
+}
+
+void
+DnsHeader::SetAdditionalCount (uint16_t count)
+{
+  m_arcount = count;
+}
+
+uint16_t
+DnsHeader::GetAdditionalCount (void) const
+{
+  return m_arcount;
+}
+
+uint32_t
+DnsHeader::EncodeName (std::string name, uint8_t *buffer)
+{
+  uint32_t used = 0;
+  std::string::size_type begin = 0;
+  if (!name.empty () && name[name.size () - 1] == '.')
+    {
+      name.erase (name.size () - 1);
+    }
+  while (begin < name.size ())
+    {
+      std::string::size_type end = name.find ('.', begin);
+      if (end == std::string::npos)
+        {
+          end = name.size ();
+        }
+      uint32_t label = end - begin;
+      if (label == 0 || label > 63 || used + 1 + label + 1 > MAX_NAME_LENGTH)
+        {
+          return 0;
+        }
+      buffer[used++] = label;
+      memcpy (buffer + used, name.data () + begin, label);
+      used += label;
+      begin = end + 1;
+    }
+  buffer[used++] = 0;
+  return used;
+}
+
+std::string
+DnsHeader::DecodeName (const uint8_t *data, uint32_t length)
+{
+  std::string name;
+  uint32_t k = 0;
+  while (k < length && data[k] != 0)
+    {
+      if (!name.empty ())
+        {
+          name += '.';
+        }
+      name.append (reinterpret_cast<const char *> (data + k + 1), data[k]);
+      k += 1 + data[k];
+    }
+  return name;
+}
+
+bool
+DnsHeader::SetQuestion (std::string name, uint16_t type, uint16_t qclass)
+{
+  NS_LOG_FUNCTION (this << name << type << qclass);
+  uint32_t length = EncodeName (name, m_qname);
+  if (length == 0)
+    {
+      NS_LOG_WARN ("Invalid name " << name);
+      return false;
+    }
+  m_qnameLength = length;
+  m_qtype = type;
+  m_qclass = qclass;
+  return true;
+}
+
+void
+DnsHeader::ClearQuestion (void)
+{
+  m_qnameLength = 0;
+}
+
+bool
+DnsHeader::HasQuestion (void) const
+{
+  return m_qnameLength != 0;
+}
+
+std::string
+DnsHeader::GetQuestionName (void) const
+{
+  return DecodeName (m_qname, m_qnameLength);
+}
+
+const uint8_t *
+DnsHeader::GetQuestionNameData (void) const
+{
+  return m_qname;
+}
+
+uint32_t
+DnsHeader::GetQuestionNameLength (void) const
+{
+  return m_qnameLength;
+}
+
+uint16_t
+DnsHeader::GetQuestionType (void) const
+{
+  return m_qtype;
+}
+
+uint16_t
+DnsHeader::GetQuestionClass (void) const
+{
+  return m_qclass;
+}
+
+TypeId
+DnsHeader::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::DnsHeader")
+    .SetParent<Header> ()
+    .SetGroupName("Applications")
+    .AddConstructor<DnsHeader> ()
+  ;
+  return tid;
+}
+
+TypeId
+DnsHeader::GetInstanceTypeId (void) const
+{
+  return GetTypeId ();
+}
+
+void
+DnsHeader::Print (std::ostream &os) const
+{
+  NS_LOG_FUNCTION (this << &os);
+  os << "(id=" << m_id << (IsResponse () ? " response" : " query") << " rcode=" << static_cast<uint32_t> (GetRcode ())
+     << (IsTruncated () ? " TC" : "") << " an=" << m_ancount << " ns=" << m_nscount << " ar=" << m_arcount;
+  if (HasQuestion ())
+    {
+      os << " question=" << GetQuestionName () << "/" << m_qtype;
+    }
+  os << ")";
+}
+
+uint32_t
+DnsHeader::GetSerializedSize (void) const
+{
+  return 12 + (HasQuestion () ? m_qnameLength + 4 : 0);
+}
+
+void
+DnsHeader::Serialize (Buffer::Iterator start) const
+{
+  NS_LOG_FUNCTION (this << &start);
+  Buffer::Iterator i = start;
+  i.WriteHtonU16 (m_id);
+  i.WriteHtonU16 (m_flags);
+  i.WriteHtonU16 (HasQuestion () ? 1 : 0);
+  i.WriteHtonU16 (m_ancount);
+  i.WriteHtonU16 (m_nscount);
+  i.WriteHtonU16 (m_arcount);
+  if (HasQuestion ())
+    {
+      i.Write (m_qname, m_qnameLength);
+      i.WriteHtonU16 (m_qtype);
+      i.WriteHtonU16 (m_qclass);
+    }
+}
+
+uint32_t
+DnsHeader::Deserialize (Buffer::Iterator start)
+{
+  NS_LOG_FUNCTION (this << &start);
+  Buffer::Iterator i = start;
+  if (!HasBytes (i, 12))
+    {
+      return 0;
+    }
+  m_id = i.ReadNtohU16 ();
+  m_flags = i.ReadNtohU16 ();
+  uint16_t qdcount = i.ReadNtohU16 ();
+  m_ancount = i.ReadNtohU16 ();
+  m_nscount = i.ReadNtohU16 ();
+  m_arcount = i.ReadNtohU16 ();
+  m_qnameLength = 0;
+  if (qdcount > 1)
+    {
+      return 0;
+    }
+  if (qdcount == 1)
+    {
+      bool pointer;
+      if (!ReadName (i, m_qname, m_qnameLength, pointer) || pointer || !HasBytes (i, 4))
+        {
+          m_qnameLength = 0;
+          return 0;
+        }
+      m_qtype = i.ReadNtohU16 ();
+      m_qclass = i.ReadNtohU16 ();
+    }
+  return GetSerializedSize ();
+}
+
+DnsResourceRecord::DnsResourceRecord ()
+  : m_nameLength (1),
+    m_compressed (false),
+    m_type (0),
+    m_class (DnsHeader::CLASS_IN),
+    m_ttl (0)
+{
+  NS_LOG_FUNCTION (this);
+  m_name[0] = 0;
+}
+
+bool
+DnsResourceRecord::SetName (std::string name)
+{
+  NS_LOG_FUNCTION (this << name);
+  uint32_t length = DnsHeader::EncodeName (name, m_name);
+  if (length == 0)
+    {
+      NS_LOG_WARN ("Invalid name " << name);
+      m_name[0] = 0;
+      m_nameLength = 1;
+      return false;
+    }
+  m_nameLength = length;
+  m_compressed = false;
+  return true;
+}
+
+std::string
+DnsResourceRecord::GetName (void) const
+{
+  return m_compressed ? "" : DnsHeader::DecodeName (m_name, m_nameLength);
+}
+
+void
+DnsResourceRecord::SetCompressed (bool compressed)
+{
+  m_compressed = compressed;
+}
+
+bool
+DnsResourceRecord::IsCompressed (void) const
+{
+  return m_compressed;
+}
+
+void
+DnsResourceRecord::SetType (uint16_t type)
+{
+  m_type = type;
+}
+
+uint16_t
+DnsResourceRecord::GetType (void) const
+{
+  return m_type;
+}
+
+void
+DnsResourceRecord::SetClass (uint16_t rclass)
+{
+  m_class = rclass;
+}
+
+uint16_t
+DnsResourceRecord::GetClass (void) const
+{
+  return m_class;
+}
+
+void
+DnsResourceRecord::SetTtl (uint32_t ttl)
+{
+  m_ttl = ttl;
+}
+
+uint32_t
+DnsResourceRecord::GetTtl (void) const
+{
+  return m_ttl;
+}
+
+void
+DnsResourceRecord::SetData (const uint8_t *data, uint16_t length)
+{
+  m_data.assign (data, data + length);
+}
+
+void
+DnsResourceRecord::SetText (std::string text)
+{
+  NS_LOG_FUNCTION (this << text.size ());
+  m_data.clear ();
+  std::string::size_type begin = 0;
+  do
+    {
+      std::string::size_type length = std::min<std::string::size_type> (255, text.size () - begin);
+      m_data.push_back (length);
+      m_data.insert (m_data.end (), text.begin () + begin, text.begin () + begin + length);
+      begin += length;
+    }
+  while (begin < text.size ());
+}
+
+const std::vector<uint8_t> &
+DnsResourceRecord::GetData (void) const
+{
+  return m_data;
+}
+
+DnsResourceRecord
+DnsResourceRecord::CreateOpt (uint16_t udpSize)
+{
+  DnsResourceRecord opt;
+  opt.SetType (DnsHeader::TYPE_OPT);
+  opt.SetClass (udpSize);
+  return opt;
+}
+
+TypeId
+DnsResourceRecord::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::DnsResourceRecord")
+    .SetParent<Header> ()
+    .SetGroupName("Applications")
+    .AddConstructor<DnsResourceRecord> ()
+  ;
+  return tid;
+}
+
+TypeId
+DnsResourceRecord::GetInstanceTypeId (void) const
+{
+  return GetTypeId ();
+}
+
+void
+DnsResourceRecord::Print (std::ostream &os) const
+{
+  NS_LOG_FUNCTION (this << &os);
+  os << "(name=" << (m_compressed ? "<question>" : GetName ()) << " type=" << m_type << " class=" << m_class
+     << " ttl=" << m_ttl << " rdlength=" << m_data.size () << ")";
+}
+
+uint32_t
+DnsResourceRecord::GetSerializedSize (void) const
+{
+  return (m_compressed ? 2 : m_nameLength) + 10 + m_data.size ();
+}
+
+void
+DnsResourceRecord::Serialize (Buffer::Iterator start) const
+{
+  NS_LOG_FUNCTION (this << &start);
+  Buffer::Iterator i = start;
+  if (m_compressed)
+    {
+      i.WriteHtonU16 (QUESTION_POINTER);
+    }
+  else
+    {
+      i.Write (m_name, m_nameLength);
+    }
+  i.WriteHtonU16 (m_type);
+  i.WriteHtonU16 (m_class);
+  i.WriteHtonU32 (m_ttl);
+  i.WriteHtonU16 (m_data.size ());
+  if (!m_data.empty ())
+    {
+      i.Write (&m_data[0], m_data.size ());
+    }
+}
+
+uint32_t
+DnsResourceRecord::Deserialize (Buffer::Iterator start)
+{
+  NS_LOG_FUNCTION (this << &start);
+  Buffer::Iterator i = start;
+  if (!ReadName (i, m_name, m_nameLength, m_compressed) || !HasBytes (i, 10))
+    {
+      m_name[0] = 0;
+      m_nameLength = 1;
+      return 0;
+    }
+  m_type = i.ReadNtohU16 ();
+  m_class = i.ReadNtohU16 ();
+  m_ttl = i.ReadNtohU32 ();
+  uint16_t length = i.ReadNtohU16 ();
+  if (!HasBytes (i, length))
+    {
+      return 0;
+    }
+  m_data.resize (length);
+  if (length > 0)
+    {
+      i.Read (&m_data[0], length);
+    }
+  return GetSerializedSize ();
+}
+
+} // namespace ns3
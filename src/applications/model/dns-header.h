@@ -0,0 +1,339 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2015 Universite catholique de Louvain
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Lionel Metongnon <lionel.metongnon@uclouvain.be>
+ */
+
+#ifndef DNS_HEADER_H
+#define DNS_HEADER_H
+
+#include "ns3/header.h"
+
+#include <string>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \ingroup udpecho
+ * \class DnsHeader
+ * \brief Header and question section of a DNS message (RFC 1035)
+ *
+ * The 12 bytes header is followed by at most one question, which is how
+ * the DNS messages are used in practice.  The records of the other
+ * sections are DnsResourceRecord headers following this one.
+ *
+ * The question name is kept in its wire format in fixed size storage, so
+ * that a query can be decoded and its response built without allocating
+ * memory.
+ */
+class DnsHeader : public Header
+{
+public:
+  /**
+   * \brief Record types
+   */
+  enum RecordType
+  {
+    TYPE_A = 1,     //!< IPv4 address
+    TYPE_NS = 2,    //!< name server
+    TYPE_CNAME = 5, //!< canonical name
+    TYPE_SOA = 6,   //!< start of authority
+    TYPE_TXT = 16,  //!< text strings
+    TYPE_AAAA = 28, //!< IPv6 address
+    TYPE_OPT = 41,  //!< EDNS0 pseudo record (RFC 6891)
+    TYPE_ANY = 255  //!< every record of the name
+  };
+
+  /**
+   * \brief Response codes
+   */
+  enum Rcode
+  {
+    NOERROR = 0,  //!< no error
+    FORMERR = 1,  //!< format error
+    SERVFAIL = 2, //!< server failure
+    NXDOMAIN = 3, //!< the name does not exist
+    REFUSED = 5   //!< query refused
+  };
+
+  /// Internet class
+  static const uint16_t CLASS_IN = 1;
+  /// Maximum length of a name in its wire format
+  static const uint32_t MAX_NAME_LENGTH = 255;
+
+  DnsHeader ();
+
+  /**
+   * \param id the message ID
+   */
+  void SetId (uint16_t id);
+  /**
+   * \return the message ID
+   */
+  uint16_t GetId (void) const;
+  /**
+   * \param response true for a response, false for a query
+   */
+  void SetResponse (bool response);
+  /**
+   * \return true for a response
+   */
+  bool IsResponse (void) const;
+  /**
+   * \param authoritative the authoritative answer flag
+   */
+  void SetAuthoritative (bool authoritative);
+  /**
+   * \return the authoritative answer flag
+   */
+  bool IsAuthoritative (void) const;
+  /**
+   * \param truncated the truncation flag
+   */
+  void SetTruncated (bool truncated);
+  /**
+   * \return the truncation flag
+   */
+  bool IsTruncated (void) const;
+  /**
+   * \param recursion the recursion desired flag
+   */
+  void SetRecursionDesired (bool recursion);
+  /**
+   * \return the recursion desired flag
+   */
+  bool IsRecursionDesired (void) const;
+  /**
+   * \param rcode the response code
+   */
+  void SetRcode (uint8_t rcode);
+  /**
+   * \return the response code
+   */
+  uint8_t GetRcode (void) const;
+
+  /**
+   * \param count the number of answer records
+   */
+  void SetAnswerCount (uint16_t count);
+  /**
+   * \return the number of answer records
+   */
+  uint16_t GetAnswerCount (void) const;
+  /**
+   * \param count the number of authority records
+   */
+  void SetAuthorityCount (uint16_t count);
+  /**
+   * \return the number of authority records
+   */
+  uint16_t GetAuthorityCount (void) const;
+  /**
+   * \param count the number of additional records
+   */
+  void SetAdditionalCount (uint16_t count);
+  /**
+   * \return the number of additional records
+   */
+  uint16_t GetAdditionalCount (void) const;
+
+  /**
+   * \brief Set the question
+   * \param name the dotted name, such as "www.example.com"
+   * \param type the record type
+   * \param qclass the class
+   * \return false if the name is not valid
+   */
+  bool SetQuestion (std::string name, uint16_t type, uint16_t qclass = CLASS_IN);
+  /**
+   * \brief Remove the question
+   */
+  void ClearQuestion (void);
+  /**
+   * \return true if the message holds a question
+   */
+  bool HasQuestion (void) const;
+  /**
+   * \return the dotted question name
+   */
+  std::string GetQuestionName (void) const;
+  /**
+   * \return the question name in its wire format
+   */
+  const uint8_t * GetQuestionNameData (void) const;
+  /**
+   * \return the length of the question name in its wire format
+   */
+  uint32_t GetQuestionNameLength (void) const;
+  /**
+   * \return the question type
+   */
+  uint16_t GetQuestionType (void) const;
+  /**
+   * \return the question class
+   */
+  uint16_t GetQuestionClass (void) const;
+
+  /**
+   * \brief Encode a dotted name in the DNS wire format
+   * \param name the dotted name, the root being "" or "."
+   * \param buffer the destination, MAX_NAME_LENGTH bytes long
+   * \return the length of the encoded name, 0 if the name is not valid
+   */
+  static uint32_t EncodeName (std::string name, uint8_t *buffer);
+  /**
+   * \brief Decode a name in the DNS wire format
+   * \param data the encoded name
+   * \param length the length of the encoded name
+   * \return the dotted name
+   */
+  static std::string DecodeName (const uint8_t *data, uint32_t length);
+
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  virtual TypeId GetInstanceTypeId (void) const;
+  virtual void Print (std::ostream &os) const;
+  virtual uint32_t GetSerializedSize (void) const;
+  virtual void Serialize (Buffer::Iterator start) const;
+  virtual uint32_t Deserialize (Buffer::Iterator start);
+
+private:
+  uint16_t m_id; //!< message ID
+  uint16_t m_flags; //!< QR, opcode, AA, TC, RD, RA and RCODE
+  uint16_t m_ancount; //!< number of answer records
+  uint16_t m_nscount; //!< number of authority records
+  uint16_t m_arcount; //!< number of additional records
+  uint16_t m_qtype; //!< question type
+  uint16_t m_qclass; //!< question class
+  uint8_t m_qnameLength; //!< length of the question name, 0 without question
+  uint8_t m_qname[MAX_NAME_LENGTH]; //!< question name in its wire format
+};
+
+/**
+ * \ingroup udpecho
+ * \class DnsResourceRecord
+ * \brief A resource record of the answer, authority or additional section
+ *
+ * The owner name of a record may be written as a pointer to the question
+ * name (0xc00c), as the DNS servers do for the answers to a query.  Such a
+ * name is decoded as compressed, without resolving it.
+ *
+ * The EDNS0 OPT pseudo record carries the UDP payload size of its sender
+ * in its class field, see CreateOpt ().
+ */
+class DnsResourceRecord : public Header
+{
+public:
+  DnsResourceRecord ();
+
+  /**
+   * \param name the dotted owner name
+   * \return false if the name is not valid
+   */
+  bool SetName (std::string name);
+  /**
+   * \return the dotted owner name, empty if it is compressed
+   */
+  std::string GetName (void) const;
+  /**
+   * \param compressed true to write the owner name as a pointer to the
+   * question name
+   */
+  void SetCompressed (bool compressed);
+  /**
+   * \return true if the owner name is a pointer
+   */
+  bool IsCompressed (void) const;
+  /**
+   * \param type the record type
+   */
+  void SetType (uint16_t type);
+  /**
+   * \return the record type
+   */
+  uint16_t GetType (void) const;
+  /**
+   * \param rclass the record class
+   */
+  void SetClass (uint16_t rclass);
+  /**
+   * \return the record class
+   */
+  uint16_t GetClass (void) const;
+  /**
+   * \param ttl the time to live in seconds
+   */
+  void SetTtl (uint32_t ttl);
+  /**
+   * \return the time to live in seconds
+   */
+  uint32_t GetTtl (void) const;
+  /**
+   * \param data the record data
+   * \param length the length of the data
+   */
+  void SetData (const uint8_t *data, uint16_t length);
+  /**
+   * \brief Set the data of a TXT record
+   *
+   * The text is split in character strings of at most 255 bytes.
+   *
+   * \param text the text
+   */
+  void SetText (std::string text);
+  /**
+   * \return the record data
+   */
+  const std::vector<uint8_t> & GetData (void) const;
+
+  /**
+   * \brief Build an EDNS0 OPT pseudo record
+   * \param udpSize the largest UDP payload the sender accepts
+   * \return the record
+   */
+  static DnsResourceRecord CreateOpt (uint16_t udpSize);
+
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  virtual TypeId GetInstanceTypeId (void) const;
+  virtual void Print (std::ostream &os) const;
+  virtual uint32_t GetSerializedSize (void) const;
+  virtual void Serialize (Buffer::Iterator start) const;
+  virtual uint32_t Deserialize (Buffer::Iterator start);
+
+private:
+  uint8_t m_nameLength; //!< length of the owner name
+  uint8_t m_name[DnsHeader::MAX_NAME_LENGTH]; //!< owner name in its wire format
+  bool m_compressed; //!< owner name written as a pointer
+  uint16_t m_type; //!< record type
+  uint16_t m_class; //!< record class
+  uint32_t m_ttl; //!< time to live
+  std::vector<uint8_t> m_data; //!< record data
+};
+
+} // namespace ns3
+
+#endif /* DNS_HEADER_H */
@@ -31,9 +31,16 @@
 #include "ns3/socket-factory.h"
 #include "ns3/packet.h"
 #include "ns3/uinteger.h"
+#include "ns3/double.h"
+#include "ns3/string.h"
+#include "ns3/buffer.h"
+#include "ns3/trace-source-accessor.h"
 
 #include "dns-server.h"
 
+#include <algorithm>
+#include <cstring>
+
 namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("DnsServerApplication");
@@ -55,11 +62,60 @@ DnsServer::GetTypeId (void)
                       UintegerValue (512),
                       MakeUintegerAccessor (&DnsServer::m_sendSize),
                       MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("ZoneName",
+                   "Name whose records fill an empty zone at start, empty for none",
+                   StringValue ("example.com"),
+                   MakeStringAccessor (&DnsServer::m_zoneName),
+                   MakeStringChecker ())
+    .AddAttribute ("TxtSize",
+                   "Bytes of TXT records of ZoneName",
+                   UintegerValue (2048),
+                   MakeUintegerAccessor (&DnsServer::m_txtSize),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("MaxUdpSize",
+                   "Largest response to an EDNS0 query",
+                   UintegerValue (4096),
+                   MakeUintegerAccessor (&DnsServer::m_maxUdpSize),
+                   MakeUintegerChecker<uint16_t> (512))
+    .AddAttribute ("RrlRate",
+                   "Responses per second per source prefix, 0 to disable the rate limiting",
+                   DoubleValue (0),
+                   MakeDoubleAccessor (&DnsServer::m_rrlRate),
+                   MakeDoubleChecker<double> (0))
+    .AddAttribute ("RrlSlip",
+                   "Send a truncated response every RrlSlip dropped ones, 0 to never send",
+                   UintegerValue (2),
+                   MakeUintegerAccessor (&DnsServer::m_rrlSlip),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("RrlTableSize",
+                   "Number of source prefixes tracked, rounded up to a power of two",
+                   UintegerValue (4096),
+                   MakeUintegerAccessor (&DnsServer::m_rrlTableSize),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddAttribute ("RrlIpv4PrefixLength",
+                   "Length of the IPv4 source prefixes",
+                   UintegerValue (24),
+                   MakeUintegerAccessor (&DnsServer::m_rrlIpv4Prefix),
+                   MakeUintegerChecker<uint8_t> (0, 32))
+    .AddAttribute ("RrlIpv6PrefixLength",
+                   "Length of the IPv6 source prefixes",
+                   UintegerValue (56),
+                   MakeUintegerAccessor (&DnsServer::m_rrlIpv6Prefix),
+                   MakeUintegerChecker<uint8_t> (0, 128))
+    .AddTraceSource ("Tx", "A response is sent",
+                     MakeTraceSourceAccessor (&DnsServer::m_txTrace),
+                     "ns3::Packet::TracedCallback")
   ;
   return tid;
 }
 
 DnsServer::DnsServer ()
+  : m_received (0),
+    m_dropped (0),
+    m_slipped (0),
+    m_responsesMetric (0),
+    m_responseBytesMetric (0),
+    m_droppedMetric (0)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -75,13 +131,132 @@ void
 DnsServer::DoDispose (void)
 {
   NS_LOG_FUNCTION (this);
+  m_metrics = 0;
   Application::DoDispose ();
 }
 
+bool
+DnsServer::AddRecord (std::string name, const DnsResourceRecord &record)
+{
+  NS_LOG_FUNCTION (this << name);
+  return m_zone.AddRecord (name, record);
+}
+
+bool
+DnsServer::AddTxtRecords (std::string name, uint32_t size)
+{
+  NS_LOG_FUNCTION (this << name << size);
+  uint8_t wire[DnsHeader::MAX_NAME_LENGTH];
+  if (DnsHeader::EncodeName (name, wire) == 0)
+    {
+      return false;
+    }
+  while (size > 0)
+    {
+      uint32_t length = std::min<uint32_t> (size, 1024);
+      DnsResourceRecord txt;
+      txt.SetType (DnsHeader::TYPE_TXT);
+      txt.SetTtl (3600);
+      txt.SetText (std::string (length, 'x'));
+      m_zone.AddRecord (name, txt);
+      size -= length;
+    }
+  return true;
+}
+
+const DnsZone &
+DnsServer::GetZone (void) const
+{
+  return m_zone;
+}
+
+uint64_t
+DnsServer::GetReceived (void) const
+{
+  return m_received;
+}
+
+uint64_t
+DnsServer::GetDropped (void) const
+{
+  return m_dropped;
+}
+
+uint64_t
+DnsServer::GetSlipped (void) const
+{
+  return m_slipped;
+}
+
+void
+DnsServer::FillZone (void)
+{
+  NS_LOG_FUNCTION (this);
+  DnsResourceRecord a;
+  a.SetType (DnsHeader::TYPE_A);
+  a.SetTtl (3600);
+  const uint8_t ipv4[4] = { 192, 0, 2, 1 };
+  a.SetData (ipv4, sizeof (ipv4));
+  if (!m_zone.AddRecord (m_zoneName, a))
+    {
+      NS_LOG_WARN ("Invalid zone name " << m_zoneName);
+      return;
+    }
+
+  DnsResourceRecord aaaa;
+  aaaa.SetType (DnsHeader::TYPE_AAAA);
+  aaaa.SetTtl (3600);
+  uint8_t ipv6[16];
+  Ipv6Address ("2001:db8::1").GetBytes (ipv6);
+  aaaa.SetData (ipv6, sizeof (ipv6));
+  m_zone.AddRecord (m_zoneName, aaaa);
+
+  uint8_t wire[DnsHeader::MAX_NAME_LENGTH];
+  uint32_t length = DnsHeader::EncodeName ("ns1." + m_zoneName, wire);
+  if (length > 0)
+    {
+      DnsResourceRecord ns;
+      ns.SetType (DnsHeader::TYPE_NS);
+      ns.SetTtl (86400);
+      ns.SetData (wire, length);
+      m_zone.AddRecord (m_zoneName, ns);
+    }
+
+  AddTxtRecords (m_zoneName, m_txtSize);
+}
+
 void 
 DnsServer::StartApplication (void)
 {
   NS_LOG_FUNCTION (this);
+
+  m_metrics = MetricsRegistry::Get ();
+  m_responsesMetric = m_metrics->GetCounter ("dns.responses");
+  m_responseBytesMetric = m_metrics->GetCounter ("dns.response_bytes");
+  m_droppedMetric = m_metrics->GetCounter ("dns.rrl_dropped");
+  if (m_zone.GetSize () == 0 && !m_zoneName.empty ())
+    {
+      FillZone ();
+    }
+  m_response.resize (m_maxUdpSize);
+
+  DnsResourceRecord opt = DnsResourceRecord::CreateOpt (m_maxUdpSize);
+  Buffer buffer;
+  buffer.AddAtStart (opt.GetSerializedSize ());
+  opt.Serialize (buffer.Begin ());
+  m_opt.resize (opt.GetSerializedSize ());
+  buffer.CopyData (&m_opt[0], m_opt.size ());
+
+  if (m_rrlRate > 0)
+    {
+      uint32_t size = 1;
+      while (size < m_rrlTableSize)
+        {
+          size <<= 1;
+        }
+      RrlBucket empty = { 0, 0, 0, 0 };
+      m_rrl.assign (size, empty);
+    }
   TypeId tid = TypeId::LookupByName ("ns3::UdpSocketFactory");
   if (m_socket == 0)
     {
@@ -143,6 +318,124 @@ DnsServer::StopApplication ()
     }
 }
 
+bool
+DnsServer::Admit (const Address &from, bool &truncate)
+{
+  NS_LOG_FUNCTION (this << from);
+  truncate = false;
+
+  // FNV-1a of the source prefix
+  uint8_t bytes[16];
+  uint32_t length;
+  uint32_t prefix;
+  if (Inet6SocketAddress::IsMatchingType (from))
+    {
+      Inet6SocketAddress::ConvertFrom (from).GetIpv6 ().GetBytes (bytes);
+      length = 16;
+      prefix = m_rrlIpv6Prefix;
+    }
+  else
+    {
+      InetSocketAddress::ConvertFrom (from).GetIpv4 ().Serialize (bytes);
+      length = 4;
+      prefix = m_rrlIpv4Prefix;
+    }
+  uint64_t key = 14695981039346656037ULL;
+  for (uint32_t i = 0; i < length; ++i)
+    {
+      uint8_t byte = 0;
+      if (8 * (i + 1) <= prefix)
+        {
+          byte = bytes[i];
+        }
+      else if (8 * i < prefix)
+        {
+          byte = bytes[i] & (0xff << (8 - (prefix - 8 * i)));
+        }
+      key ^= byte;
+      key *= 1099511628211ULL;
+    }
+  key ^= length;
+  if (key == 0)
+    {
+      key = 1;
+    }
+
+  // a prefix takes the bucket of another one when they collide
+  RrlBucket &bucket = m_rrl[key & (m_rrl.size () - 1)];
+  int64_t now = Simulator::Now ().GetTimeStep ();
+  double burst = std::max (1.0, m_rrlRate);
+  if (bucket.key != key)
+    {
+      bucket.key = key;
+      bucket.tokens = burst;
+      bucket.drops = 0;
+    }
+  else
+    {
+      bucket.tokens = std::min (burst, bucket.tokens + TimeStep (now - bucket.last).GetSeconds () * m_rrlRate);
+    }
+  bucket.last = now;
+
+  if (bucket.tokens >= 1)
+    {
+      bucket.tokens -= 1;
+      return true;
+    }
+  ++m_dropped;
+  m_droppedMetric->Add ();
+  if (m_rrlSlip > 0 && ++bucket.drops % m_rrlSlip == 0)
+    {
+      ++m_slipped;
+      truncate = true;
+      return true;
+    }
+  return false;
+}
+
+Ptr<Packet>
+DnsServer::BuildResponse (DnsHeader &query, uint16_t udpSize, bool truncate)
+{
+  NS_LOG_FUNCTION (this << udpSize << truncate);
+  uint32_t limit = 512;
+  if (udpSize > 0)
+    {
+      limit = std::max<uint32_t> (512, std::min (udpSize, m_maxUdpSize));
+    }
+
+  const uint8_t *answers;
+  uint32_t size;
+  uint16_t count;
+  bool found = m_zone.GetAnswers (query.GetQuestionNameData (), query.GetQuestionNameLength (),
+                                  query.GetQuestionType (), answers, size, count);
+  query.SetResponse (true);
+  query.SetAuthoritative (found);
+  query.SetRcode (found ? DnsHeader::NOERROR : DnsHeader::NXDOMAIN);
+  query.SetAuthorityCount (0);
+  query.SetAdditionalCount (udpSize > 0 ? 1 : 0);
+
+  uint32_t opt = udpSize > 0 ? m_opt.size () : 0;
+  if (truncate || query.GetSerializedSize () + size + opt > limit)
+    {
+      query.SetTruncated (true);
+      size = 0;
+      count = 0;
+    }
+  query.SetAnswerCount (count);
+
+  if (size > 0)
+    {
+      memcpy (&m_response[0], answers, size);
+    }
+  if (opt > 0)
+    {
+      memcpy (&m_response[size], &m_opt[0], opt);
+    }
+  Ptr<Packet> response = Create<Packet> (&m_response[0], size + opt);
+  response->AddHeader (query);
+  return response;
+}
+
 void 
 DnsServer::HandleRead (Ptr<Socket> socket)
 {
@@ -165,10 +458,37 @@ DnsServer::HandleRead (Ptr<Socket> socket)
                        Inet6SocketAddress::ConvertFrom (from).GetPort ());
         }
 
-      NS_LOG_LOGIC ("DNS packet");
-      Ptr<Packet> newPacket = Create<Packet> (m_sendSize);
+      Ptr<Packet> newPacket;
+      DnsHeader query;
+      if (packet->PeekHeader (query) == 0 || query.IsResponse () || !query.HasQuestion ())
+        {
+          NS_LOG_LOGIC ("Not a DNS query");
+          newPacket = Create<Packet> (m_sendSize);
+        }
+      else
+        {
+          NS_LOG_LOGIC ("DNS query " << query);
+          ++m_received;
+          packet->RemoveHeader (query);
+          uint16_t udpSize = 0;
+          DnsResourceRecord opt;
+          if (query.GetAdditionalCount () > 0 && packet->PeekHeader (opt) != 0
+              && opt.GetType () == DnsHeader::TYPE_OPT)
+            {
+              udpSize = opt.GetClass ();
+            }
+          bool truncate = false;
+          if (!m_rrl.empty () && !Admit (from, truncate))
+            {
+              NS_LOG_LOGIC ("Response dropped by the rate limiting");
+              continue;
+            }
+          newPacket = BuildResponse (query, udpSize, truncate);
+        }
+      m_txTrace (newPacket);
       socket->SendTo (newPacket, 0, from);
-      // uint32_t p_size = SendData (socket, from);
+      m_responsesMetric->Add ();
+      m_responseBytesMetric->Add (newPacket->GetSize ());
 
       if (InetSocketAddress::IsMatchingType (from))
         {
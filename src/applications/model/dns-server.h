@@ -25,6 +25,12 @@
 #include "ns3/event-id.h"
 #include "ns3/ptr.h"
 #include "ns3/address.h"
+#include "ns3/nstime.h"
+#include "ns3/traced-callback.h"
+#include "dns-zone.h"
+#include "metrics-registry.h"
+
+#include <vector>
 
 namespace ns3 {
 
@@ -38,9 +44,26 @@ class Packet;
 
 /**
  * \ingroup udpecho
- * \brief A Udp Echo server
+ * \brief An authoritative DNS server
+ *
+ * The queries are answered from a DnsZone.  When the zone is empty at
+ * start, it is filled with the A, AAAA, NS and TXT records of ZoneName,
+ * the TXT records holding TxtSize bytes: the size of the response, hence
+ * the amplification factor, then depends on the query type, ANY being the
+ * largest.  A query carrying an EDNS0 OPT record is answered with up to
+ * the UDP payload size it announces, bounded by MaxUdpSize; without it the
+ * responses are limited to 512 bytes.  A larger response is truncated (TC
+ * flag, no answer).  A packet which is not a DNS query is answered with
+ * PacketSize bytes, as before.
  *
- * Every packet received is sent back.
+ * With RrlRate set, the responses are rate limited per source prefix, as
+ * the Response Rate Limiting of the DNS servers: a token bucket of RrlRate
+ * responses per second is kept per prefix in a fixed size table, and every
+ * RrlSlip dropped response a truncated one is sent instead, so that a
+ * legitimate client retries over TCP.
+ *
+ * The responses are built in a buffer allocated once: apart from the
+ * packet itself, answering a query does not allocate memory.
  */
 class DnsServer : public Application 
 {
@@ -53,6 +76,40 @@ public:
   DnsServer ();
   virtual ~DnsServer ();
 
+  /**
+   * \brief Add a record to the zone
+   * \param name the dotted owner name
+   * \param record the record
+   * \returns false if the name is not valid
+   */
+  bool AddRecord (std::string name, const DnsResourceRecord &record);
+
+  /**
+   * \brief Add TXT records holding a number of bytes of text
+   * \param name the dotted owner name
+   * \param size the number of bytes, split in records of up to 1024 bytes
+   * \returns false if the name is not valid
+   */
+  bool AddTxtRecords (std::string name, uint32_t size);
+
+  /**
+   * \returns the zone
+   */
+  const DnsZone & GetZone (void) const;
+
+  /**
+   * \returns the number of queries received
+   */
+  uint64_t GetReceived (void) const;
+  /**
+   * \returns the number of responses dropped by the rate limiting
+   */
+  uint64_t GetDropped (void) const;
+  /**
+   * \returns the number of truncated responses sent instead of dropped ones
+   */
+  uint64_t GetSlipped (void) const;
+
 protected:
   virtual void DoDispose (void);
 
@@ -70,8 +127,63 @@ private:
    */
   void HandleRead (Ptr<Socket> socket);
 
+  /**
+   * \brief Build the response to a query
+   * \param query the query, turned into the response header
+   * \param udpSize the UDP payload size of the client, 0 without EDNS0
+   * \param truncate true to send a truncated response
+   * \returns the response
+   */
+  Ptr<Packet> BuildResponse (DnsHeader &query, uint16_t udpSize, bool truncate);
+
+  /**
+   * \brief Rate limit the responses to a source
+   * \param from the source of the query
+   * \param truncate set to true if a truncated response slips instead of
+   * the dropped one
+   * \returns true if a response is sent
+   */
+  bool Admit (const Address &from, bool &truncate);
+
+  /**
+   * \brief Fill an empty zone with the records of ZoneName
+   */
+  void FillZone (void);
+
+  /**
+   * \brief Rate limiting state of a source prefix
+   */
+  struct RrlBucket
+  {
+    uint64_t key;   //!< source prefix, 0 if unused
+    int64_t last;   //!< time step of the last refill
+    double tokens;  //!< responses allowed
+    uint32_t drops; //!< responses dropped, for the slip
+  };
+
   uint16_t m_port; //!< Port on which we listen for incoming packets.
   uint32_t m_sendSize; //!< Size of incoming packets.
+  std::string m_zoneName; //!< name of the default zone
+  uint32_t m_txtSize; //!< bytes of TXT records of the default zone
+  uint16_t m_maxUdpSize; //!< largest EDNS0 response
+  double m_rrlRate; //!< responses per second per prefix, 0 to disable
+  uint32_t m_rrlSlip; //!< one truncated response every m_rrlSlip drops
+  uint32_t m_rrlTableSize; //!< number of rate limiting buckets
+  uint8_t m_rrlIpv4Prefix; //!< length of the IPv4 source prefixes
+  uint8_t m_rrlIpv6Prefix; //!< length of the IPv6 source prefixes
+  DnsZone m_zone; //!< records served
+  std::vector<RrlBucket> m_rrl; //!< rate limiting buckets
+  std::vector<uint8_t> m_response; //!< answers of the response being built
+  std::vector<uint8_t> m_opt; //!< serialized OPT record of the responses
+  uint64_t m_received; //!< queries received
+  uint64_t m_dropped; //!< responses dropped
+  uint64_t m_slipped; //!< truncated responses sent instead of dropped ones
+  Ptr<MetricsRegistry> m_metrics; //!< Campaign metrics
+  MetricsCounter *m_responsesMetric; //!< dns.responses
+  MetricsCounter *m_responseBytesMetric; //!< dns.response_bytes
+  MetricsCounter *m_droppedMetric; //!< dns.rrl_dropped
+  /// Callbacks for tracing the responses
+  TracedCallback<Ptr<const Packet> > m_txTrace;
   Ptr<Socket> m_socket; //!< IPv4 Socket
   Ptr<Socket> m_socket6; //!< IPv6 Socket
   Address m_local; //!< local multicast address
@@ -19,6 +19,7 @@
  */
  
 #include "ns3/log.h"
+#include "ns3/abort.h"
 #include "ns3/nstime.h"
 #include "ns3/inet6-socket-address.h"
 #include "ns3/socket.h"
@@ -26,9 +27,16 @@
 #include "ns3/socket-factory.h"
 #include "ns3/packet.h"
 #include "ns3/uinteger.h"
+#include "ns3/node.h"
+#include "ns3/string.h"
+#include "ns3/pointer.h"
+#include "ns3/enum.h"
 #include "ns3/trace-source-accessor.h"
+#include "dns-header.h"
 #include "dns-vicious-client.h"
 
+#include <algorithm>
+
 namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("DnsViciousClientApplication");
@@ -43,7 +51,7 @@ DnsViciousClient::GetTypeId (void)
     .SetGroupName("Applications")
     .AddConstructor<DnsViciousClient> ()
     .AddAttribute ("MaxPackets", 
-                   "The maximum number of packets the application will send",
+                   "The maximum number of packets the application will send, 0 for no limit",
                    UintegerValue (100),
                    MakeUintegerAccessor (&DnsViciousClient::m_count),
                    MakeUintegerChecker<uint32_t> ())
@@ -72,6 +80,53 @@ DnsViciousClient::GetTypeId (void)
                    MakeUintegerAccessor (&DnsViciousClient::SetDataSize,
                                          &DnsViciousClient::GetDataSize),
                    MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("QueryName",
+                   "Name of the DNS queries, empty to send PacketSize bytes",
+                   StringValue (""),
+                   MakeStringAccessor (&DnsViciousClient::m_queryName),
+                   MakeStringChecker ())
+    .AddAttribute ("QueryType",
+                   "Record type of the DNS queries",
+                   UintegerValue (DnsHeader::TYPE_ANY),
+                   MakeUintegerAccessor (&DnsViciousClient::m_queryType),
+                   MakeUintegerChecker<uint16_t> ())
+    .AddAttribute ("EdnsUdpSize",
+                   "UDP payload size announced by the EDNS0 queries, 0 without EDNS0",
+                   UintegerValue (4096),
+                   MakeUintegerAccessor (&DnsViciousClient::m_ednsUdpSize),
+                   MakeUintegerChecker<uint16_t> ())
+    .AddAttribute ("DataRate",
+                   "Rate of the flood, 0 to send PacketsPerEvent packets every PacketsPerEvent Interval",
+                   DataRateValue (DataRate (0)),
+                   MakeDataRateAccessor (&DnsViciousClient::m_rate),
+                   MakeDataRateChecker ())
+    .AddAttribute ("BurstSize",
+                   "Bytes of the token bucket enforcing DataRate, 0 for one batch",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&DnsViciousClient::m_burstSize),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("PacketsPerEvent",
+                   "Number of packets sent by each send event",
+                   UintegerValue (1),
+                   MakeUintegerAccessor (&DnsViciousClient::m_packetsPerEvent),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddAttribute ("Pattern",
+                   "Emission pattern of the flood",
+                   EnumValue (DnsViciousClient::CONSTANT),
+                   MakeEnumAccessor (&DnsViciousClient::m_pattern),
+                   MakeEnumChecker (DnsViciousClient::CONSTANT, "Constant",
+                                    DnsViciousClient::POISSON, "Poisson",
+                                    DnsViciousClient::ON_OFF, "OnOff"))
+    .AddAttribute ("OnTime",
+                   "A RandomVariableStream used to pick the duration of the on periods of the OnOff pattern",
+                   StringValue ("ns3::ConstantRandomVariable[Constant=1.0]"),
+                   MakePointerAccessor (&DnsViciousClient::m_onTime),
+                   MakePointerChecker <RandomVariableStream>())
+    .AddAttribute ("OffTime",
+                   "A RandomVariableStream used to pick the duration of the off periods of the OnOff pattern",
+                   StringValue ("ns3::ConstantRandomVariable[Constant=1.0]"),
+                   MakePointerAccessor (&DnsViciousClient::m_offTime),
+                   MakePointerChecker <RandomVariableStream>())
     .AddTraceSource ("Tx", "A new packet is created and is sent",
                      MakeTraceSourceAccessor (&DnsViciousClient::m_txTrace),
                      "ns3::Packet::TracedCallback")
@@ -83,20 +138,47 @@ DnsViciousClient::DnsViciousClient ()
 {
   NS_LOG_FUNCTION (this);
   m_sent = 0;
-  m_socket = 0;
+  m_tokens = 0;
   m_sendEvent = EventId ();
-  m_data = 0;
-  m_dataSize = 0;
+  m_gap = CreateObject<ExponentialRandomVariable> ();
+  m_queriesMetric = 0;
+  m_queryBytesMetric = 0;
 }
 
 DnsViciousClient::~DnsViciousClient()
 {
   NS_LOG_FUNCTION (this);
-  m_socket = 0;
+  m_sockets.clear ();
+}
+
+void
+DnsViciousClient::AddResolver (Ipv6Address address)
+{
+  NS_LOG_FUNCTION (this << address);
+  m_resolvers.push_back (address);
+}
+
+void
+DnsViciousClient::AddVictim (Ipv6Address address)
+{
+  NS_LOG_FUNCTION (this << address);
+  m_victims.push_back (address);
+}
 
-  delete [] m_data;
-  m_data = 0;
-  m_dataSize = 0;
+uint32_t
+DnsViciousClient::GetSent (void) const
+{
+  return m_sent;
+}
+
+int64_t
+DnsViciousClient::AssignStreams (int64_t stream)
+{
+  NS_LOG_FUNCTION (this << stream);
+  m_onTime->SetStream (stream);
+  m_offTime->SetStream (stream + 1);
+  m_gap->SetStream (stream + 2);
+  return 3;
 }
 
 void 
@@ -111,6 +193,7 @@ void
 DnsViciousClient::DoDispose (void)
 {
   NS_LOG_FUNCTION (this);
+  m_metrics = 0;
   Application::DoDispose ();
 }
 
@@ -125,16 +208,64 @@ DnsViciousClient::ViciousMode ()
 {
   NS_LOG_FUNCTION (this);
 
-  if (m_socket == 0)
+  if (m_resolvers.empty ())
+    {
+      m_resolvers.push_back (m_peerAddress);
+    }
+  if (m_victims.empty ())
+    {
+      m_victims.push_back (m_srcAddress);
+    }
+  m_metrics = MetricsRegistry::Get ();
+  m_queriesMetric = m_metrics->GetCounter ("dns.queries");
+  m_queryBytesMetric = m_metrics->GetCounter ("dns.query_bytes");
+  if (m_sockets.empty ())
     {
+      // the source address of a socket is the one it is bound to
       TypeId tid = TypeId::LookupByName ("ns3::UdpSocketFactory");
-      m_socket = Socket::CreateSocket (GetNode (), tid);
-      m_socket->Bind(Inet6SocketAddress (m_srcAddress, 0));
-      m_socket->Connect (Inet6SocketAddress (m_peerAddress, m_peerPort));
+      for (uint32_t i = 0; i < m_victims.size (); ++i)
+        {
+          Ptr<Socket> socket = Socket::CreateSocket (GetNode (), tid);
+          socket->Bind (Inet6SocketAddress (m_victims[i], 0));
+          socket->SetRecvCallback (MakeCallback (&DnsViciousClient::HandleRead, this));
+          m_sockets.push_back (socket);
+        }
     }
 
-  m_socket->SetRecvCallback (MakeCallback (&DnsViciousClient::HandleRead, this));
-  ScheduleTransmit (Seconds (0.));
+  if (!m_queryName.empty ())
+    {
+      DnsHeader query;
+      query.SetId (GetNode ()->GetId ());
+      query.SetRecursionDesired (true);
+      if (query.SetQuestion (m_queryName, m_queryType))
+        {
+          Ptr<Packet> packet = Create<Packet> ();
+          if (m_ednsUdpSize > 0)
+            {
+              packet->AddHeader (DnsResourceRecord::CreateOpt (m_ednsUdpSize));
+              query.SetAdditionalCount (1);
+            }
+          packet->AddHeader (query);
+          m_payload.SetPacket (packet);
+        }
+    }
+
+  // an unlimited flood without gap would never let the time advance
+  NS_ABORT_MSG_IF (m_count == 0 && GetMeanGap ().IsZero (),
+                   "DnsViciousClient: unlimited flood with a zero Interval, or a DataRate and an empty payload");
+
+  uint32_t batch = m_packetsPerEvent * m_payload.GetSize ();
+  m_tokens = 8.0 * std::max (m_burstSize, batch);
+  m_lastRefill = Simulator::Now ();
+  Simulator::Cancel (m_sendEvent);
+  if (m_pattern == ON_OFF)
+    {
+      StartOn ();
+    }
+  else
+    {
+      ScheduleTransmit (Seconds (0.));
+    }
 }
 
 void 
@@ -142,12 +273,12 @@ DnsViciousClient::StopApplication ()
 {
   NS_LOG_FUNCTION (this);
 
-  if (m_socket != 0) 
+  for (uint32_t i = 0; i < m_sockets.size (); ++i)
     {
-      m_socket->Close ();
-      m_socket->SetRecvCallback (MakeNullCallback<void, Ptr<Socket> > ());
-      m_socket = 0;
+      m_sockets[i]->Close ();
+      m_sockets[i]->SetRecvCallback (MakeNullCallback<void, Ptr<Socket> > ());
     }
+  m_sockets.clear ();
   Simulator::Cancel (m_sendEvent);
 }
 
@@ -161,97 +292,35 @@ DnsViciousClient::SetDataSize (uint32_t dataSize)
   // that she doesn't care about the contents of the packet at all, so 
   // neither will we.
   //
-  delete [] m_data;
-  m_data = 0;
-  m_dataSize = 0;
-  m_size = dataSize;
+  m_payload.SetSize (dataSize);
 }
 
 uint32_t 
 DnsViciousClient::GetDataSize (void) const
 {
   NS_LOG_FUNCTION (this);
-  return m_size;
+  return m_payload.GetSize ();
 }
 
 void 
 DnsViciousClient::SetFill (std::string fill)
 {
   NS_LOG_FUNCTION (this << fill);
-
-  uint32_t dataSize = fill.size () + 1;
-
-  if (dataSize != m_dataSize)
-    {
-      delete [] m_data;
-      m_data = new uint8_t [dataSize];
-      m_dataSize = dataSize;
-    }
-
-  memcpy (m_data, fill.c_str (), dataSize);
-
-  //
-  // Overwrite packet size attribute.
-  //
-  m_size = dataSize;
+  m_payload.SetFill (fill);
 }
 
 void 
 DnsViciousClient::SetFill (uint8_t fill, uint32_t dataSize)
 {
   NS_LOG_FUNCTION (this << fill << dataSize);
-  if (dataSize != m_dataSize)
-    {
-      delete [] m_data;
-      m_data = new uint8_t [dataSize];
-      m_dataSize = dataSize;
-    }
-
-  memset (m_data, fill, dataSize);
-
-  //
-  // Overwrite packet size attribute.
-  //
-  m_size = dataSize;
+  m_payload.SetFill (fill, dataSize);
 }
 
 void 
 DnsViciousClient::SetFill (uint8_t *fill, uint32_t fillSize, uint32_t dataSize)
 {
   NS_LOG_FUNCTION (this << fill << fillSize << dataSize);
-  if (dataSize != m_dataSize)
-    {
-      delete [] m_data;
-      m_data = new uint8_t [dataSize];
-      m_dataSize = dataSize;
-    }
-
-  if (fillSize >= dataSize)
-    {
-      memcpy (m_data, fill, dataSize);
-      m_size = dataSize;
-      return;
-    }
-
-  //
-  // Do all but the final fill.
-  //
-  uint32_t filled = 0;
-  while (filled + fillSize < dataSize)
-    {
-      memcpy (&m_data[filled], fill, fillSize);
-      filled += fillSize;
-    }
-
-  //
-  // Last fill may be partial
-  //
-  memcpy (&m_data[filled], fill, dataSize - filled);
-
-  //
-  // Overwrite packet size attribute.
-  //
-  m_size = dataSize;
+  m_payload.SetFill (fill, fillSize, dataSize);
 }
 
 void 
@@ -261,6 +330,35 @@ DnsViciousClient::ScheduleTransmit (Time dt)
   m_sendEvent = Simulator::Schedule (dt, &DnsViciousClient::Send, this);
 }
 
+void
+DnsViciousClient::StartOn (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_onEnd = Simulator::Now () + Seconds (m_onTime->GetValue ());
+  ScheduleTransmit (Seconds (0.));
+}
+
+Time
+DnsViciousClient::GetMeanGap (void) const
+{
+  if (m_rate.GetBitRate () > 0)
+    {
+      return Seconds (8.0 * m_packetsPerEvent * m_payload.GetSize () / m_rate.GetBitRate ());
+    }
+  return m_interval * m_packetsPerEvent;
+}
+
+Time
+DnsViciousClient::GetNextGap (void)
+{
+  Time gap = GetMeanGap ();
+  if (m_pattern == POISSON)
+    {
+      gap = Seconds (m_gap->GetValue (gap.GetSeconds (), 0));
+    }
+  return gap;
+}
+
 void 
 DnsViciousClient::Send (void)
 {
@@ -268,46 +366,53 @@ DnsViciousClient::Send (void)
 
   NS_ASSERT (m_sendEvent.IsExpired ());
 
-  Ptr<Packet> p;
-  // NS_LOG_INFO ("m_dataSize "<< m_dataSize << " and " << m_size);
-  // SetFill("Normal traffic");
-  if (m_dataSize)
+  Time now = Simulator::Now ();
+  double bits = 8.0 * m_payload.GetSize ();
+  if (m_rate.GetBitRate () > 0)
     {
-      //
-      // If m_dataSize is non-zero, we have a data buffer of the same size that we
-      // are expected to copy and send.  This state of affairs is created if one of
-      // the Fill functions is called.  In this case, m_size must have been set
-      // to agree with m_dataSize
-      //
-      NS_ASSERT_MSG (m_dataSize == m_size, "DnsViciousClient::Send(): m_size and m_dataSize inconsistent");
-      NS_ASSERT_MSG (m_data, "DnsViciousClient::Send(): m_dataSize but no m_data");
-      p = Create<Packet> (m_data, m_dataSize);
+      uint32_t batch = m_packetsPerEvent * m_payload.GetSize ();
+      m_tokens = std::min (8.0 * std::max (m_burstSize, batch),
+                           m_tokens + (now - m_lastRefill).GetSeconds () * m_rate.GetBitRate ());
+      m_lastRefill = now;
     }
-  else
+
+  for (uint32_t i = 0; i < m_packetsPerEvent; ++i)
     {
-      //
-      // If m_dataSize is zero, the client has indicated that it doesn't care
-      // about the data itself either by specifying the data size by setting
-      // the corresponding attribute or by not calling a SetFill function.  In
-      // this case, we don't worry about it either.  But we do allow m_size
-      // to have a value different from the (zero) m_dataSize.
-      //
-      p = Create<Packet> (m_size);
+      // the gaps are rounded to the time resolution, forgive the rounding
+      if (m_rate.GetBitRate () > 0 && m_tokens + 1e-3 < bits)
+        {
+          break;
+        }
+      uint32_t victim = m_sent % m_victims.size ();
+      uint32_t resolver = (m_sent / m_victims.size ()) % m_resolvers.size ();
+      // Copy-on-write copy of the payload built once, no data is duplicated
+      Ptr<Packet> p = m_payload.Copy ();
+      // call to the trace sinks before the packet is actually sent,
+      // so that tags added to the packet can be sent as well
+      m_txTrace (p);
+      m_sockets[victim]->SendTo (p, 0, Inet6SocketAddress (m_resolvers[resolver], m_peerPort));
+      m_tokens -= bits;
+      ++m_sent;
+      m_queriesMetric->Add ();
+      m_queryBytesMetric->Add (p->GetSize ());
+
+      NS_LOG_INFO ("At time " << now.GetSeconds () << "s client sent " << p->GetSize () << " bytes to " <<
+                   m_resolvers[resolver] << " port " << m_peerPort << " as " << m_victims[victim]);
+
+      if (m_count > 0 && m_sent >= m_count)
+        {
+          return;
+        }
     }
-  // call to the trace sinks before the packet is actually sent,
-  // so that tags added to the packet can be sent as well
-  m_txTrace (p);
-  m_socket->Send (p);
-
-  ++m_sent;
 
-  NS_LOG_INFO ("At time " << Simulator::Now ().GetSeconds () << "s client sent " << m_size << " bytes to " <<
-               m_peerAddress << " port " << m_peerPort);
-
-  if (m_sent < m_count) 
+  Time gap = GetNextGap ();
+  if (m_pattern == ON_OFF && now + gap >= m_onEnd)
     {
-      ScheduleTransmit (m_interval);
+      Time off = Seconds (m_offTime->GetValue ());
+      m_sendEvent = Simulator::Schedule (m_onEnd - now + off, &DnsViciousClient::StartOn, this);
+      return;
     }
+  ScheduleTransmit (gap);
 }
 
 void
@@ -26,6 +26,12 @@
 #include "ns3/ptr.h"
 #include "ns3/ipv6-address.h"
 #include "ns3/traced-callback.h"
+#include "ns3/data-rate.h"
+#include "ns3/random-variable-stream.h"
+#include "payload-template.h"
+#include "metrics-registry.h"
+
+#include <vector>
 
 namespace ns3 {
 
@@ -37,6 +43,28 @@ class Packet;
  * \brief A Udp Echo client
  *
  * Every packet sent should be returned by the server and received here.
+ *
+ * With QueryName set, the packets are DNS queries of QueryType for that
+ * name, carrying an EDNS0 OPT record of EdnsUdpSize unless it is 0, so
+ * that the amplification depends on the query type.  The query is built
+ * once and every packet sent is a copy of it.
+ *
+ * Once ViciousMode () is called, the client floods the resolvers with
+ * queries spoofing the addresses of the victims, going through every
+ * (victim, resolver) pair in turn.  Without resolver nor victim, the
+ * RemoteAddress is flooded from the LocalAddress.
+ *
+ * Each send event emits PacketsPerEvent packets, so that a flood of
+ * thousands of packets per second takes a few hundred events.  The
+ * events are spaced by the time to send a batch at DataRate, or by
+ * PacketsPerEvent Interval without DataRate:
+ * - CONSTANT: at that fixed spacing;
+ * - POISSON: with exponential gaps of that mean;
+ * - ON_OFF: at that spacing during OnTime periods separated by OffTime
+ *   silences.
+ * With DataRate, a token bucket of BurstSize bytes bounds the bursts of
+ * the random patterns to the rate.  An unlimited flood (MaxPackets 0)
+ * needs a spacing above zero.
  */
 class DnsViciousClient : public Application 
 {
@@ -128,6 +156,44 @@ public:
    */
   void SetFill (uint8_t *fill, uint32_t fillSize, uint32_t dataSize);
 
+  /**
+   * \brief Emission pattern of the flood
+   */
+  enum FloodPattern
+  {
+    CONSTANT, //!< batches at a fixed spacing
+    POISSON,  //!< batches at exponential gaps
+    ON_OFF    //!< fixed spacing during the on periods only
+  };
+
+  /**
+   * \brief Add a resolver to reflect the flood on
+   * \param address the address of the resolver, queried on RemotePort
+   */
+  void AddResolver (Ipv6Address address);
+
+  /**
+   * \brief Add a victim, whose address is spoofed as the source of queries
+   * \param address the address of the victim
+   */
+  void AddVictim (Ipv6Address address);
+
+  /**
+   * \returns the number of packets sent
+   */
+  uint32_t GetSent (void) const;
+
+  /**
+   * \brief Assign a fixed random variable stream number to the random
+   * variables used by this model.
+   * \param stream first stream index to use
+   * \return the number of stream indices assigned by this model
+   */
+  int64_t AssignStreams (int64_t stream);
+
+  /**
+   * \brief Start the flood
+   */
   void ViciousMode ();
 
 protected:
@@ -144,9 +210,21 @@ private:
    */
   void ScheduleTransmit (Time dt);
   /**
-   * \brief Send a packet
+   * \brief Send a batch of packets and schedule the next one
    */
   void Send (void);
+  /**
+   * \brief Start an on period of the ON_OFF pattern
+   */
+  void StartOn (void);
+  /**
+   * \returns the mean time between two batches
+   */
+  Time GetMeanGap (void) const;
+  /**
+   * \returns the time to the next batch
+   */
+  Time GetNextGap (void);
 
   /**
    * \brief Handle a packet reception.
@@ -159,18 +237,37 @@ private:
 
   uint32_t m_count; //!< Maximum number of packets the application will send
   Time m_interval; //!< Packet inter-send time
-  uint32_t m_size; //!< Size of the sent packet
+  PayloadTemplate m_payload; //!< packet sent, the query or the fill data
 
-  uint32_t m_dataSize; //!< packet payload size (must be equal to m_size)
-  uint8_t *m_data; //!< packet payload data
+  std::string m_queryName; //!< name queried, empty to send the fill data
+  uint16_t m_queryType; //!< record type queried
+  uint16_t m_ednsUdpSize; //!< UDP payload size announced, 0 without EDNS0
+
+  DataRate m_rate; //!< flood rate, 0 to space the packets by m_interval
+  uint32_t m_burstSize; //!< bytes of the token bucket, 0 for one batch
+  uint32_t m_packetsPerEvent; //!< packets sent by each event
+  FloodPattern m_pattern; //!< emission pattern
+  Ptr<RandomVariableStream> m_onTime; //!< duration of the on periods
+  Ptr<RandomVariableStream> m_offTime; //!< duration of the off periods
+  Ptr<ExponentialRandomVariable> m_gap; //!< gaps of the POISSON pattern
+
+  std::vector<Ipv6Address> m_resolvers; //!< resolvers flooded
+  std::vector<Ipv6Address> m_victims; //!< spoofed source addresses
+  std::vector<Ptr<Socket> > m_sockets; //!< one socket per victim
+  double m_tokens; //!< bits the token bucket allows
+  Time m_lastRefill; //!< last refill of the token bucket
+  Time m_onEnd; //!< end of the current on period
 
   uint32_t m_sent; //!< Counter for sent packets
-  Ptr<Socket> m_socket; //!< Socket
   Ipv6Address m_peerAddress; //!< Remote peer address
   Ipv6Address m_srcAddress;
   uint16_t m_peerPort; //!< Remote peer port
   EventId m_sendEvent; //!< Event to send the next packet
 
+  Ptr<MetricsRegistry> m_metrics; //!< Campaign metrics
+  MetricsCounter *m_queriesMetric; //!< dns.queries
+  MetricsCounter *m_queryBytesMetric; //!< dns.query_bytes
+
   /// Callbacks for tracing the packet Tx events
   TracedCallback<Ptr<const Packet> > m_txTrace;
 };
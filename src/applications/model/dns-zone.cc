@@ -0,0 +1,250 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2015 Universite catholique de Louvain
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Lionel Metongnon <lionel.metongnon@uclouvain.be>
+ */
+
+#include "ns3/log.h"
+#include "ns3/assert.h"
+#include "ns3/buffer.h"
+
+#include "dns-zone.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("DnsZone");
+
+namespace {
+
+/**
+ * \param c a byte of a name
+ * \returns the byte in lower case
+ */
+inline uint8_t
+ToLower (uint8_t c)
+{
+  return (c >= 'A' && c <= 'Z') ? c + ('a' - 'A') : c;
+}
+
+} // anonymous namespace
+
+DnsZone::DnsZone ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+uint32_t
+DnsZone::Hash (const uint8_t *name, uint32_t length)
+{
+  // FNV-1a
+  uint32_t hash = 2166136261U;
+  for (uint32_t i = 0; i < length; ++i)
+    {
+      hash ^= ToLower (name[i]);
+      hash *= 16777619U;
+    }
+  return hash;
+}
+
+int32_t
+DnsZone::Locate (const uint8_t *name, uint32_t length, uint32_t hash) const
+{
+  if (m_slots.empty ())
+    {
+      return -1;
+    }
+  uint32_t mask = m_slots.size () - 1;
+  for (uint32_t slot = hash & mask; m_slots[slot] >= 0; slot = (slot + 1) & mask)
+    {
+      const Entry &entry = m_entries[m_slots[slot]];
+      if (entry.hash != hash || entry.name.size () != length)
+        {
+          continue;
+        }
+      uint32_t i = 0;
+      while (i < length && static_cast<uint8_t> (entry.name[i]) == ToLower (name[i]))
+        {
+          ++i;
+        }
+      if (i == length)
+        {
+          return m_slots[slot];
+        }
+    }
+  return -1;
+}
+
+void
+DnsZone::Grow (void)
+{
+  NS_LOG_FUNCTION (this);
+  uint32_t capacity = m_slots.empty () ? 16 : 2 * m_slots.size ();
+  m_slots.assign (capacity, -1);
+  uint32_t mask = capacity - 1;
+  for (uint32_t i = 0; i < m_entries.size (); ++i)
+    {
+      uint32_t slot = m_entries[i].hash & mask;
+      while (m_slots[slot] >= 0)
+        {
+          slot = (slot + 1) & mask;
+        }
+      m_slots[slot] = i;
+    }
+}
+
+void
+DnsZone::Build (Entry &entry)
+{
+  entry.sets.clear ();
+  entry.image.clear ();
+  uint32_t size = 0;
+  for (uint32_t i = 0; i < entry.records.size (); ++i)
+    {
+      size += entry.records[i].GetSerializedSize ();
+    }
+  Buffer buffer;
+  buffer.AddAtStart (size);
+  Buffer::Iterator it = buffer.Begin ();
+  uint32_t offset = 0;
+  for (uint32_t i = 0; i < entry.records.size (); ++i)
+    {
+      const DnsResourceRecord &record = entry.records[i];
+      uint32_t length = record.GetSerializedSize ();
+      record.Serialize (it);
+      it.Next (length);
+      if (entry.sets.empty () || entry.sets.back ().type != record.GetType ())
+        {
+          RecordSet set;
+          set.type = record.GetType ();
+          set.count = 0;
+          set.offset = offset;
+          set.size = 0;
+          entry.sets.push_back (set);
+        }
+      ++entry.sets.back ().count;
+      entry.sets.back ().size += length;
+      offset += length;
+    }
+  entry.image.resize (size);
+  if (size > 0)
+    {
+      buffer.CopyData (&entry.image[0], size);
+    }
+}
+
+bool
+DnsZone::AddRecord (std::string name, const DnsResourceRecord &record)
+{
+  NS_LOG_FUNCTION (this << name << record.GetType ());
+  uint8_t wire[DnsHeader::MAX_NAME_LENGTH];
+  uint32_t length = DnsHeader::EncodeName (name, wire);
+  if (length == 0)
+    {
+      NS_LOG_WARN ("Invalid name " << name);
+      return false;
+    }
+  for (uint32_t i = 0; i < length; ++i)
+    {
+      wire[i] = ToLower (wire[i]);
+    }
+  uint32_t hash = Hash (wire, length);
+  int32_t index = Locate (wire, length, hash);
+  if (index < 0)
+    {
+      if (2 * (m_entries.size () + 1) > m_slots.size ())
+        {
+          Grow ();
+        }
+      index = m_entries.size ();
+      m_entries.push_back (Entry ());
+      m_entries.back ().name.assign (reinterpret_cast<const char *> (wire), length);
+      m_entries.back ().hash = hash;
+      uint32_t mask = m_slots.size () - 1;
+      uint32_t slot = hash & mask;
+      while (m_slots[slot] >= 0)
+        {
+          slot = (slot + 1) & mask;
+        }
+      m_slots[slot] = index;
+    }
+
+  Entry &entry = m_entries[index];
+  DnsResourceRecord answer = record;
+  answer.SetCompressed (true);
+  // keep the records of a type together, in the order they were added
+  std::vector<DnsResourceRecord>::iterator it = entry.records.begin ();
+  while (it != entry.records.end () && it->GetType () <= record.GetType ())
+    {
+      ++it;
+    }
+  entry.records.insert (it, answer);
+  Build (entry);
+  return true;
+}
+
+void
+DnsZone::Clear (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_entries.clear ();
+  m_slots.clear ();
+}
+
+bool
+DnsZone::GetAnswers (const uint8_t *name, uint32_t length, uint16_t type,
+                     const uint8_t *&data, uint32_t &size, uint16_t &count) const
+{
+  NS_LOG_FUNCTION (this << length << type);
+  data = 0;
+  size = 0;
+  count = 0;
+  int32_t index = Locate (name, length, Hash (name, length));
+  if (index < 0)
+    {
+      return false;
+    }
+  const Entry &entry = m_entries[index];
+  if (type == DnsHeader::TYPE_ANY)
+    {
+      if (!entry.image.empty ())
+        {
+          data = &entry.image[0];
+          size = entry.image.size ();
+          count = entry.records.size ();
+        }
+      return true;
+    }
+  for (uint32_t i = 0; i < entry.sets.size (); ++i)
+    {
+      if (entry.sets[i].type == type)
+        {
+          data = &entry.image[entry.sets[i].offset];
+          size = entry.sets[i].size;
+          count = entry.sets[i].count;
+          break;
+        }
+    }
+  return true;
+}
+
+uint32_t
+DnsZone::GetSize (void) const
+{
+  return m_entries.size ();
+}
+
+} // namespace ns3
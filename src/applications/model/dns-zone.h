@@ -0,0 +1,136 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2015 Universite catholique de Louvain
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Lionel Metongnon <lionel.metongnon@uclouvain.be>
+ */
+
+#ifndef DNS_ZONE_H
+#define DNS_ZONE_H
+
+#include "dns-header.h"
+
+#include <string>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \ingroup udpecho
+ * \brief Records served by a DnsServer
+ *
+ * Open-addressing hash table (linear probing) keyed by the names in their
+ * wire format, compared without case, so that the name of a decoded
+ * question is looked up as is, without building a string.
+ *
+ * The records of a name are kept already serialized, with their owner
+ * name as a pointer to the question, and grouped by type: the answer to
+ * any type, ANY included, is a slice of that image which is copied into
+ * the response as is.
+ */
+class DnsZone
+{
+public:
+  DnsZone ();
+
+  /**
+   * \brief Add a record
+   * \param name the dotted owner name, the one of the record is ignored
+   * \param record the record
+   * \returns false if the name is not valid
+   */
+  bool AddRecord (std::string name, const DnsResourceRecord &record);
+
+  /**
+   * \brief Remove all the names
+   */
+  void Clear (void);
+
+  /**
+   * \brief Get the answer section to a question
+   * \param name the question name in its wire format
+   * \param length the length of the name
+   * \param type the question type
+   * \param data set to the serialized records, 0 if there is none
+   * \param size set to the size of the serialized records
+   * \param count set to the number of records
+   * \returns false if the name is not in the zone
+   */
+  bool GetAnswers (const uint8_t *name, uint32_t length, uint16_t type,
+                   const uint8_t *&data, uint32_t &size, uint16_t &count) const;
+
+  /**
+   * \returns the number of names in the zone
+   */
+  uint32_t GetSize (void) const;
+
+private:
+  /**
+   * \brief Records of a type, as a slice of the image of a name
+   */
+  struct RecordSet
+  {
+    uint16_t type;   //!< record type
+    uint16_t count;  //!< number of records
+    uint32_t offset; //!< first byte in the image
+    uint32_t size;   //!< size in the image
+  };
+
+  /**
+   * \brief A name and its records
+   */
+  struct Entry
+  {
+    std::string name;                       //!< lower case wire format name
+    uint32_t hash;                          //!< hash of the name
+    std::vector<DnsResourceRecord> records; //!< records, sorted by type
+    std::vector<RecordSet> sets;            //!< one set per type
+    std::vector<uint8_t> image;             //!< serialized records
+  };
+
+  /**
+   * \param name a name in its wire format
+   * \param length the length of the name
+   * \returns the hash of the name, without case
+   */
+  static uint32_t Hash (const uint8_t *name, uint32_t length);
+
+  /**
+   * \param name a name in its wire format
+   * \param length the length of the name
+   * \param hash the hash of the name
+   * \returns the index of the entry of the name, or -1
+   */
+  int32_t Locate (const uint8_t *name, uint32_t length, uint32_t hash) const;
+
+  /**
+   * \brief Serialize the records of an entry and split them in sets
+   * \param entry the entry
+   */
+  static void Build (Entry &entry);
+
+  /**
+   * \brief Double the number of slots and re-insert the entries
+   */
+  void Grow (void);
+
+  std::vector<Entry> m_entries; //!< names of the zone
+  std::vector<int32_t> m_slots; //!< entry indexes, -1 if free
+};
+
+} // namespace ns3
+
+#endif /* DNS_ZONE_H */
@@ -0,0 +1,429 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2015 Universite catholique de Louvain
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Lionel Metongnon <lionel.metongnon@uclouvain.be>
+ */
+
+#include "metrics-registry.h"
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+#include "ns3/string.h"
+
+#include <algorithm>
+#include <cstring>
+#include <sstream>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("MetricsRegistry");
+
+NS_OBJECT_ENSURE_REGISTERED (MetricsRegistry);
+
+namespace {
+
+/// The registry of the simulation
+Ptr<MetricsRegistry> g_registry;
+
+/// Protects g_registry
+volatile uint32_t g_registryLock = 0;
+
+/// Counters of the campaign applications, columns of every file
+const char *g_counters[] = {
+  "scan.probes",
+  "scan.retries",
+  "scan.replies",
+  "penetration.attempts",
+  "penetration.successes",
+  "penetration.failures",
+  "dns.queries",
+  "dns.query_bytes",
+  "dns.responses",
+  "dns.response_bytes",
+  "dns.rrl_dropped",
+};
+
+/// Histograms of the campaign applications, columns of every file
+const char *g_histograms[] = {
+  "scan.rtt",
+  "penetration.time",
+};
+
+/**
+ * Hold a lock for a scope: the applications of the nodes may start at
+ * once on the threads of a multithreaded simulation.  The registrations
+ * are rare and short, so the lock spins.
+ */
+class SpinLock
+{
+public:
+  /**
+   * \param lock the lock to take
+   */
+  SpinLock (volatile uint32_t &lock)
+    : m_lock (lock)
+  {
+    while (__sync_lock_test_and_set (&m_lock, 1))
+      {
+      }
+  }
+  ~SpinLock ()
+  {
+    __sync_lock_release (&m_lock);
+  }
+
+private:
+  volatile uint32_t &m_lock; //!< the lock held
+};
+
+} // anonymous namespace
+
+MetricsCounter::MetricsCounter ()
+  : m_value (0)
+{
+}
+
+void
+MetricsCounter::Reset (void)
+{
+  m_value = 0;
+}
+
+MetricsHistogram::MetricsHistogram ()
+{
+  Reset ();
+}
+
+uint32_t
+MetricsHistogram::GetBucket (uint64_t ns)
+{
+  if (ns < (1u << SUB_BITS))
+    {
+      return ns;
+    }
+  // power of two, then the SUB_BITS bits after the leading one
+  uint32_t exponent = 63 - __builtin_clzll (ns);
+  uint32_t sub = (ns >> (exponent - SUB_BITS)) & ((1u << SUB_BITS) - 1);
+  return ((exponent - SUB_BITS + 1) << SUB_BITS) + sub;
+}
+
+uint64_t
+MetricsHistogram::GetLowest (uint32_t bucket)
+{
+  if (bucket < (1u << SUB_BITS))
+    {
+      return bucket;
+    }
+  uint32_t exponent = (bucket >> SUB_BITS) + SUB_BITS - 1;
+  uint64_t sub = bucket & ((1u << SUB_BITS) - 1);
+  return ((1ull << SUB_BITS) + sub) << (exponent - SUB_BITS);
+}
+
+void
+MetricsHistogram::Record (Time value)
+{
+  uint64_t ns = value.IsStrictlyNegative () ? 0 : value.GetNanoSeconds ();
+  __sync_fetch_and_add (&m_buckets[GetBucket (ns)], 1);
+  __sync_fetch_and_add (&m_count, 1);
+  uint64_t max = m_max;
+  while (ns > max)
+    {
+      uint64_t seen = __sync_val_compare_and_swap (&m_max, max, ns);
+      if (seen == max)
+        {
+          break;
+        }
+      max = seen;
+    }
+}
+
+uint64_t
+MetricsHistogram::GetCount (void) const
+{
+  return m_count;
+}
+
+Time
+MetricsHistogram::GetMax (void) const
+{
+  return NanoSeconds (m_max);
+}
+
+Time
+MetricsHistogram::GetQuantile (double quantile) const
+{
+  uint64_t count = m_count;
+  if (count == 0)
+    {
+      return Seconds (0);
+    }
+  // rank of the quantile, from 1 to count
+  uint64_t rank = static_cast<uint64_t> (quantile * count + 0.5);
+  rank = std::max<uint64_t> (1, std::min (rank, count));
+  uint64_t seen = 0;
+  for (uint32_t i = 0; i < N_BUCKETS; ++i)
+    {
+      seen += m_buckets[i];
+      if (seen >= rank)
+        {
+          return NanoSeconds (GetLowest (i));
+        }
+    }
+  return GetMax ();
+}
+
+void
+MetricsHistogram::Reset (void)
+{
+  for (uint32_t i = 0; i < N_BUCKETS; ++i)
+    {
+      m_buckets[i] = 0;
+    }
+  m_count = 0;
+  m_max = 0;
+}
+
+TypeId
+MetricsRegistry::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::MetricsRegistry")
+    .SetParent<Object> ()
+    .SetGroupName("Applications")
+    .AddConstructor<MetricsRegistry> ()
+    .AddAttribute ("FileName",
+                   "The file of the samples of the registry of the simulation, empty to disable them",
+                   StringValue (""),
+                   MakeStringAccessor (&MetricsRegistry::m_fileName),
+                   MakeStringChecker ())
+    .AddAttribute ("Period",
+                   "The simulated time between two samples",
+                   TimeValue (Seconds (1)),
+                   MakeTimeAccessor (&MetricsRegistry::m_period),
+                   MakeTimeChecker ())
+  ;
+  return tid;
+}
+
+MetricsRegistry::MetricsRegistry ()
+  : m_nCounters (0),
+    m_nHistograms (0),
+    m_lock (0)
+{
+  NS_LOG_FUNCTION (this);
+  m_discovered[0] = GetCounter ("scan.discovered.sixlowpan");
+  m_discovered[1] = GetCounter ("scan.discovered.wifi");
+  m_discovered[2] = GetCounter ("scan.discovered.other");
+  // the columns of the file are those registered when it is opened
+  for (uint32_t i = 0; i < sizeof (g_counters) / sizeof (g_counters[0]); ++i)
+    {
+      GetCounter (g_counters[i]);
+    }
+  for (uint32_t i = 0; i < sizeof (g_histograms) / sizeof (g_histograms[0]); ++i)
+    {
+      GetHistogram (g_histograms[i]);
+    }
+}
+
+MetricsRegistry::~MetricsRegistry ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+Ptr<MetricsRegistry>
+MetricsRegistry::Get (void)
+{
+  SpinLock lock (g_registryLock);
+  if (g_registry == 0)
+    {
+      g_registry = CreateObject<MetricsRegistry> ();
+      if (!g_registry->m_fileName.empty ())
+        {
+          g_registry->Enable (g_registry->m_fileName, g_registry->m_period);
+        }
+      Simulator::ScheduleDestroy (&MetricsRegistry::Release);
+    }
+  return g_registry;
+}
+
+void
+MetricsRegistry::Release (void)
+{
+  if (g_registry != 0)
+    {
+      g_registry->Sample ();
+      g_registry->Dispose ();
+      g_registry = 0;
+    }
+}
+
+void
+MetricsRegistry::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  Simulator::Cancel (m_tickEvent);
+  m_writer.Close ();
+  Object::DoDispose ();
+}
+
+MetricsCounter *
+MetricsRegistry::GetCounter (std::string name)
+{
+  SpinLock lock (m_lock);
+  std::map<std::string, uint32_t>::const_iterator it = m_counterIndex.find (name);
+  if (it != m_counterIndex.end ())
+    {
+      return &m_counters[it->second];
+    }
+  NS_LOG_FUNCTION (this << name);
+  if (m_writer.IsOpen ())
+    {
+      NS_LOG_WARN ("Counter " << name << " registered after the header of " << m_fileName << ", not sampled");
+    }
+  m_counterIndex[name] = m_counters.size ();
+  m_counterNames.push_back (name);
+  m_counters.push_back (MetricsCounter ());
+  return &m_counters.back ();
+}
+
+MetricsHistogram *
+MetricsRegistry::GetHistogram (std::string name)
+{
+  SpinLock lock (m_lock);
+  std::map<std::string, uint32_t>::const_iterator it = m_histogramIndex.find (name);
+  if (it != m_histogramIndex.end ())
+    {
+      return &m_histograms[it->second];
+    }
+  NS_LOG_FUNCTION (this << name);
+  if (m_writer.IsOpen ())
+    {
+      NS_LOG_WARN ("Histogram " << name << " registered after the header of " << m_fileName << ", not sampled");
+    }
+  m_histogramIndex[name] = m_histograms.size ();
+  m_histogramNames.push_back (name);
+  m_histograms.resize (m_histograms.size () + 1);
+  return &m_histograms.back ();
+}
+
+void
+MetricsRegistry::CountDiscovered (Ipv6Address address)
+{
+  // ::ff:fe00:n for the 6LoWPAN nodes, ::200:ff:fe00:n for the WiFi ones
+  uint8_t buffer[16];
+  address.GetBytes (buffer);
+  static const uint8_t sixlowpan[6] = { 0x00, 0x00, 0x00, 0xff, 0xfe, 0x00 };
+  static const uint8_t wifi[6] = { 0x02, 0x00, 0x00, 0xff, 0xfe, 0x00 };
+  if (std::memcmp (buffer + 8, sixlowpan, sizeof (sixlowpan)) == 0)
+    {
+      m_discovered[0]->Add ();
+    }
+  else if (std::memcmp (buffer + 8, wifi, sizeof (wifi)) == 0)
+    {
+      m_discovered[1]->Add ();
+    }
+  else
+    {
+      m_discovered[2]->Add ();
+    }
+}
+
+void
+MetricsRegistry::Enable (std::string fileName, Time period)
+{
+  NS_LOG_FUNCTION (this << fileName << period);
+  m_fileName = fileName;
+  m_period = period;
+  Simulator::Cancel (m_tickEvent);
+  if (!m_writer.Open (fileName))
+    {
+      NS_LOG_WARN ("Cannot open " << fileName);
+      return;
+    }
+  {
+    SpinLock lock (m_lock);
+    m_nCounters = m_counters.size ();
+    m_nHistograms = m_histograms.size ();
+    std::ostringstream header;
+    header << "#time";
+    for (uint32_t i = 0; i < m_nCounters; ++i)
+      {
+        header << "\t" << m_counterNames[i];
+      }
+    for (uint32_t i = 0; i < m_nHistograms; ++i)
+      {
+        const std::string &name = m_histogramNames[i];
+        header << "\t" << name << ".count\t" << name << ".p50\t" << name << ".p99\t" << name << ".max";
+      }
+    header << "\n";
+    m_writer.Write (header.str ());
+  }
+  if (m_period.IsStrictlyPositive ())
+    {
+      m_tickEvent = Simulator::Schedule (m_period, &MetricsRegistry::Tick, this);
+    }
+}
+
+void
+MetricsRegistry::Tick (void)
+{
+  Sample ();
+  m_tickEvent = Simulator::Schedule (m_period, &MetricsRegistry::Tick, this);
+}
+
+void
+MetricsRegistry::Sample (void)
+{
+  SpinLock lock (m_lock);
+  if (!m_writer.IsOpen ())
+    {
+      return;
+    }
+  std::ostringstream row;
+  row << Simulator::Now ().GetSeconds ();
+  for (uint32_t i = 0; i < m_nCounters; ++i)
+    {
+      row << "\t" << m_counters[i].Get ();
+    }
+  for (uint32_t i = 0; i < m_nHistograms; ++i)
+    {
+      const MetricsHistogram &histogram = m_histograms[i];
+      row << "\t" << histogram.GetCount ()
+          << "\t" << histogram.GetQuantile (0.5).GetNanoSeconds ()
+          << "\t" << histogram.GetQuantile (0.99).GetNanoSeconds ()
+          << "\t" << histogram.GetMax ().GetNanoSeconds ();
+    }
+  row << "\n";
+  m_writer.Write (row.str ());
+  // the file is read while the campaign runs
+  m_writer.Flush ();
+}
+
+void
+MetricsRegistry::Reset (void)
+{
+  NS_LOG_FUNCTION (this);
+  SpinLock lock (m_lock);
+  for (uint32_t i = 0; i < m_counters.size (); ++i)
+    {
+      m_counters[i].Reset ();
+    }
+  for (uint32_t i = 0; i < m_histograms.size (); ++i)
+    {
+      m_histograms[i].Reset ();
+    }
+}
+
+} // namespace ns3
@@ -0,0 +1,245 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2015 Universite catholique de Louvain
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Lionel Metongnon <lionel.metongnon@uclouvain.be>
+ */
+
+#ifndef METRICS_REGISTRY_H
+#define METRICS_REGISTRY_H
+
+#include "ns3/object.h"
+#include "ns3/nstime.h"
+#include "ns3/event-id.h"
+#include "ns3/ipv6-address.h"
+#include "result-writer.h"
+
+#include <deque>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \ingroup udpecho
+ * \brief Counter of a MetricsRegistry
+ *
+ * Adding is a single atomic instruction, without any lock, so that the
+ * counters can be updated from any thread.
+ */
+class MetricsCounter
+{
+public:
+  MetricsCounter ();
+
+  /**
+   * \param n the amount to add
+   */
+  void Add (uint64_t n = 1)
+  {
+    __sync_fetch_and_add (&m_value, n);
+  }
+
+  /**
+   * \returns the value of the counter
+   */
+  uint64_t Get (void) const
+  {
+    return m_value;
+  }
+
+  /**
+   * \brief Set the counter to zero
+   */
+  void Reset (void);
+
+private:
+  volatile uint64_t m_value; //!< value
+};
+
+/**
+ * \ingroup udpecho
+ * \brief Latency histogram of a MetricsRegistry
+ *
+ * As in HDR histograms, the buckets are log-linear: each power of two is
+ * cut in 8 buckets, so that any duration from 1 ns to centuries is kept
+ * with a relative error below 12.5% in a fixed array of counters.
+ * Recording is a few atomic instructions, without any lock.
+ */
+class MetricsHistogram
+{
+public:
+  /// Number of buckets per power of two, as a number of bits
+  static const uint32_t SUB_BITS = 3;
+  /// Number of buckets
+  static const uint32_t N_BUCKETS = (64 - SUB_BITS + 1) << SUB_BITS;
+
+  MetricsHistogram ();
+
+  /**
+   * \param value a duration, the negative ones count as zero
+   */
+  void Record (Time value);
+
+  /**
+   * \returns the number of durations recorded
+   */
+  uint64_t GetCount (void) const;
+
+  /**
+   * \returns the largest duration recorded
+   */
+  Time GetMax (void) const;
+
+  /**
+   * \param quantile the quantile, from 0 to 1
+   * \returns the lowest value of the bucket holding the quantile, zero if
+   * nothing was recorded
+   */
+  Time GetQuantile (double quantile) const;
+
+  /**
+   * \brief Forget all the durations
+   */
+  void Reset (void);
+
+  /**
+   * \param ns a duration in nanoseconds
+   * \returns the bucket of the duration
+   */
+  static uint32_t GetBucket (uint64_t ns);
+
+  /**
+   * \param bucket a bucket
+   * \returns the lowest duration of the bucket, in nanoseconds
+   */
+  static uint64_t GetLowest (uint32_t bucket);
+
+private:
+  volatile uint64_t m_buckets[N_BUCKETS]; //!< count of each bucket
+  volatile uint64_t m_count;              //!< number of durations
+  volatile uint64_t m_max;                //!< largest duration, in nanoseconds
+};
+
+/**
+ * \ingroup udpecho
+ * \brief Counters and latency histograms of the attack campaign
+ *
+ * The applications register their metrics by name and update them as the
+ * simulation goes, which costs far less than the logging.  When FileName
+ * is set, the registry is sampled every Period of simulated time into a
+ * tab separated file, one column per counter, four per histogram (count,
+ * median, 99th percentile and maximum, in ns) and one row per sample; a
+ * header line starting with '#' names the columns.  A last row is written
+ * when the simulator is destroyed.
+ *
+ * The columns are fixed when the file is opened, so that it loads as a
+ * single table: the metrics of the campaign applications are registered
+ * by the constructor, and a metric registered once the file is open is
+ * kept, but left out of the file.
+ *
+ * There is one registry per simulation, given by Get (); it is released
+ * by Simulator::Destroy ().
+ */
+class MetricsRegistry : public Object
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  MetricsRegistry ();
+  virtual ~MetricsRegistry ();
+
+  /**
+   * \returns the registry of the simulation, created on the first call
+   */
+  static Ptr<MetricsRegistry> Get (void);
+
+  /**
+   * \param name the name of the counter
+   * \returns the counter, created on the first call for this name
+   */
+  MetricsCounter *GetCounter (std::string name);
+
+  /**
+   * \param name the name of the histogram
+   * \returns the histogram, created on the first call for this name
+   */
+  MetricsHistogram *GetHistogram (std::string name);
+
+  /**
+   * \brief Count a discovered host in scan.discovered.sixlowpan,
+   * scan.discovered.wifi or scan.discovered.other after the pattern of its
+   * interface ID
+   * \param address the address of the host
+   */
+  void CountDiscovered (Ipv6Address address);
+
+  /**
+   * \brief Sample the registry into a file, with a column per metric
+   * registered so far
+   * \param fileName the file, truncated
+   * \param period the simulated time between two samples
+   */
+  void Enable (std::string fileName, Time period);
+
+  /**
+   * \brief Write a row of the current values, if a file is open
+   */
+  void Sample (void);
+
+  /**
+   * \brief Set all the metrics to zero
+   */
+  void Reset (void);
+
+protected:
+  virtual void DoDispose (void);
+
+private:
+  /**
+   * \brief Sample and schedule the next sample
+   */
+  void Tick (void);
+
+  /**
+   * \brief Write the last sample and release the registry of the simulation
+   */
+  static void Release (void);
+
+  std::string m_fileName;                    //!< file of the samples
+  Time m_period;                             //!< time between two samples
+  ResultWriter m_writer;                     //!< output file
+  EventId m_tickEvent;                       //!< next sample
+  uint32_t m_nCounters;                      //!< counters in the columns of the file
+  uint32_t m_nHistograms;                    //!< histograms in the columns of the file
+  std::vector<std::string> m_counterNames;   //!< counters, in creation order
+  std::deque<MetricsCounter> m_counters;     //!< counters, stable addresses
+  std::vector<std::string> m_histogramNames; //!< histograms, in creation order
+  std::deque<MetricsHistogram> m_histograms; //!< histograms, stable addresses
+  std::map<std::string, uint32_t> m_counterIndex;   //!< counters, by name
+  std::map<std::string, uint32_t> m_histogramIndex; //!< histograms, by name
+  MetricsCounter *m_discovered[3];           //!< 6LoWPAN, WiFi and other hosts
+  volatile uint32_t m_lock;                  //!< protects the metrics and their names
+};
+
+} // namespace ns3
+
+#endif /* METRICS_REGISTRY_H */
@@ -0,0 +1,113 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2015 Universite catholique de Louvain
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Lionel Metongnon <lionel.metongnon@uclouvain.be>
+ */
+
+#include "ns3/log.h"
+
+#include "payload-template.h"
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("PayloadTemplate");
+
+PayloadTemplate::PayloadTemplate ()
+  : m_packet (Create<Packet> ()),
+    m_filled (false)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+PayloadTemplate::SetSize (uint32_t size)
+{
+  NS_LOG_FUNCTION (this << size);
+  // the zero bytes of the packet are not even allocated
+  m_packet = Create<Packet> (size);
+  m_filled = false;
+}
+
+void
+PayloadTemplate::SetFill (std::string fill)
+{
+  NS_LOG_FUNCTION (this << fill);
+  m_packet = Create<Packet> (reinterpret_cast<const uint8_t *> (fill.c_str ()), fill.size () + 1);
+  m_filled = true;
+}
+
+void
+PayloadTemplate::SetFill (uint8_t fill, uint32_t size)
+{
+  NS_LOG_FUNCTION (this << static_cast<uint32_t> (fill) << size);
+  std::vector<uint8_t> data (size, fill);
+  m_packet = size > 0 ? Create<Packet> (&data[0], size) : Create<Packet> ();
+  m_filled = true;
+}
+
+void
+PayloadTemplate::SetFill (const uint8_t *fill, uint32_t fillSize, uint32_t size)
+{
+  NS_LOG_FUNCTION (this << fill << fillSize << size);
+  if (fillSize == 0 || size == 0)
+    {
+      SetSize (size);
+      return;
+    }
+  std::vector<uint8_t> data (size);
+  uint32_t filled = 0;
+  while (filled < size)
+    {
+      uint32_t length = std::min (fillSize, size - filled);
+      memcpy (&data[filled], fill, length);
+      filled += length;
+    }
+  m_packet = Create<Packet> (&data[0], size);
+  m_filled = true;
+}
+
+void
+PayloadTemplate::SetPacket (Ptr<const Packet> packet)
+{
+  NS_LOG_FUNCTION (this << packet);
+  m_packet = packet->Copy ();
+  m_filled = true;
+}
+
+uint32_t
+PayloadTemplate::GetSize (void) const
+{
+  return m_packet->GetSize ();
+}
+
+bool
+PayloadTemplate::IsFilled (void) const
+{
+  return m_filled;
+}
+
+Ptr<Packet>
+PayloadTemplate::Copy (void) const
+{
+  return m_packet->Copy ();
+}
+
+} // namespace ns3
@@ -0,0 +1,103 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2015 Universite catholique de Louvain
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Lionel Metongnon <lionel.metongnon@uclouvain.be>
+ */
+
+#ifndef PAYLOAD_TEMPLATE_H
+#define PAYLOAD_TEMPLATE_H
+
+#include "ns3/packet.h"
+#include "ns3/ptr.h"
+
+#include <string>
+
+namespace ns3 {
+
+/**
+ * \ingroup udpecho
+ * \brief Payload sent unchanged by an application, built once
+ *
+ * The payload is kept as a packet, built when the payload is set.  Every
+ * packet sent is a Copy () of it, which shares its buffer (copy-on-write):
+ * the fill data are not copied again for each transmission.  A header
+ * added to a copy, such as the CoAP header of a request, does not change
+ * the template.
+ *
+ * The copies of a template share its packet UID.
+ */
+class PayloadTemplate
+{
+public:
+  PayloadTemplate ();
+
+  /**
+   * \brief Use a payload of don't care bytes
+   * \param size the size of the payload
+   */
+  void SetSize (uint32_t size);
+
+  /**
+   * \brief Use the zero-terminated contents of a string
+   * \param fill the string
+   */
+  void SetFill (std::string fill);
+
+  /**
+   * \brief Use a repeated byte
+   * \param fill the byte
+   * \param size the size of the payload
+   */
+  void SetFill (uint8_t fill, uint32_t size);
+
+  /**
+   * \brief Use the contents of a buffer, repeated as many times as needed
+   * \param fill the buffer
+   * \param fillSize the size of the buffer
+   * \param size the size of the payload
+   */
+  void SetFill (const uint8_t *fill, uint32_t fillSize, uint32_t size);
+
+  /**
+   * \brief Use a message already serialized, headers included
+   * \param packet the message, which is copied
+   */
+  void SetPacket (Ptr<const Packet> packet);
+
+  /**
+   * \returns the size of the payload
+   */
+  uint32_t GetSize (void) const;
+
+  /**
+   * \returns true if the payload has contents, false for don't care bytes
+   */
+  bool IsFilled (void) const;
+
+  /**
+   * \returns a copy of the payload, sharing its data
+   */
+  Ptr<Packet> Copy (void) const;
+
+private:
+  Ptr<Packet> m_packet; //!< payload
+  bool m_filled; //!< payload with contents
+};
+
+} // namespace ns3
+
+#endif /* PAYLOAD_TEMPLATE_H */
@@ -29,12 +29,13 @@
 #include "ns3/socket-factory.h"
 #include "ns3/packet.h"
 #include "ns3/uinteger.h"
+#include "ns3/enum.h"
 #include "ns3/trace-source-accessor.h"
 
 #include <algorithm>
 #include <cstdlib>
 #include <time.h>
-#include <fstream>
+#include <sstream>
 
 #include "penetration-tools.h"
 
@@ -52,10 +53,25 @@ PenetrationTools::GetTypeId (void)
     .SetGroupName("Applications")
     .AddConstructor<PenetrationTools> ()
     .AddAttribute ("Interval", 
-                   "The time to wait between packets",
+                   "The time to wait between the start of an attack and its exploit",
                    TimeValue (MilliSeconds (200)),
                    MakeTimeAccessor (&PenetrationTools::m_interval),
                    MakeTimeChecker ())
+    .AddAttribute ("AttackTimeout",
+                   "The time to wait for the status of a victim",
+                   TimeValue (Seconds (1)),
+                   MakeTimeAccessor (&PenetrationTools::m_attackTimeout),
+                   MakeTimeChecker ())
+    .AddAttribute ("Concurrency",
+                   "The maximum number of victims attacked at the same time",
+                   UintegerValue (1),
+                   MakeUintegerAccessor (&PenetrationTools::m_concurrency),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddAttribute ("MaxRetries",
+                   "The number of times the exploit is sent again to a silent victim",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&PenetrationTools::m_maxRetries),
+                   MakeUintegerChecker<uint32_t> (0, 0xfffe))
     .AddAttribute ("RemotePort", 
                    "The destination port of the outbound packets",
                    UintegerValue (80),
@@ -66,9 +82,18 @@ PenetrationTools::GetTypeId (void)
                    MakeUintegerAccessor (&PenetrationTools::SetDataSize,
                                          &PenetrationTools::GetDataSize),
                    MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("ResultFormat",
+                   "The format of the streamed compromised hosts",
+                   EnumValue (ScanResultSink::TEXT),
+                   MakeEnumAccessor (&PenetrationTools::m_resultFormat),
+                   MakeEnumChecker (ScanResultSink::TEXT, "Text",
+                                    ScanResultSink::BINARY, "Binary"))
     .AddTraceSource ("Tx", "A new packet is created and is sent",
                      MakeTraceSourceAccessor (&PenetrationTools::m_txTrace),
                      "ns3::Packet::TracedCallback")
+    .AddTraceSource ("TimeToCompromise", "A victim is compromised",
+                     MakeTraceSourceAccessor (&PenetrationTools::m_timeToCompromiseTrace),
+                     "ns3::PenetrationTools::TimeToCompromiseCallback")
   ;
   return tid;
 }
@@ -77,21 +102,22 @@ PenetrationTools::PenetrationTools ()
 {
   NS_LOG_FUNCTION (this);
   m_sent = 0;
+  m_messageId = 0;
   m_socket = 0;
-  m_victimAddresses = std::list <Ipv6Address> ();
-  m_sendEvent = EventId ();
-  m_data = 0;
-  m_dataSize = 0;
+  m_attacking = 0;
+  networkSize = 0;
+  m_running = false;
+  m_resultFormat = ScanResultSink::TEXT;
+  m_attemptsMetric = 0;
+  m_successesMetric = 0;
+  m_failuresMetric = 0;
+  m_timeMetric = 0;
 }
 
 PenetrationTools::~PenetrationTools()
 {
   NS_LOG_FUNCTION (this);
   m_socket = 0;
-
-  delete [] m_data;
-  m_data = 0;
-  m_dataSize = 0;
 }
 
 void 
@@ -106,6 +132,7 @@ void
 PenetrationTools::DoDispose (void)
 {
   NS_LOG_FUNCTION (this);
+  m_metrics = 0;
   Application::DoDispose ();
 }
 
@@ -113,68 +140,167 @@ void
 PenetrationTools::StartApplication (void)
 {
   NS_LOG_FUNCTION (this);
+  m_running = true;
+  m_metrics = MetricsRegistry::Get ();
+  m_attemptsMetric = m_metrics->GetCounter ("penetration.attempts");
+  m_successesMetric = m_metrics->GetCounter ("penetration.successes");
+  m_failuresMetric = m_metrics->GetCounter ("penetration.failures");
+  m_timeMetric = m_metrics->GetHistogram ("penetration.time");
+  SetFill ("Penetration Attack");
+  if (m_socket == 0)
+    {
+      TypeId tid = TypeId::LookupByName ("ns3::UdpSocketFactory");
+      m_socket = Socket::CreateSocket (GetNode (), tid);
+      m_socket->Bind6 ();
+    }
+  m_socket->SetRecvCallback (MakeCallback (&PenetrationTools::HandleRead, this));
+  // The number of victims is only known at the end, see Save ()
+  std::ostringstream oss;
+  oss << GetDataSize ();
+  oss << "_node";
+  oss << GetNode ()->GetId ();
+  m_results.SetFormat (m_resultFormat);
+  m_results.Open (ScanResultSink::PENETRATION, oss.str ());
+  // attack the victims received before the start
+  Dispatch ();
+}
+
+void
+PenetrationTools::AddVictim (Ipv6Address victimAddress)
+{
+  NS_LOG_FUNCTION (this << victimAddress);
+  Victim victim;
+  victim.state = VICTIM_PENDING;
+  victim.attempts = 0;
+  victim.added = Simulator::Now ();
+  if (!m_victims.insert (std::make_pair (victimAddress, victim)).second)
+    {
+      return;
+    }
+  m_pending.push_back (victimAddress);
+  ++networkSize;
+  Dispatch ();
 }
 
 void
 PenetrationTools::StartPenetration (std::list<Ipv6Address> &victimAddresses)
 {
   NS_LOG_FUNCTION (this);
-  m_victimAddresses = victimAddresses;
-  networkSize = m_victimAddresses.size ();
-  // if we have a victim list, proccess to the penetration
-  // if not just stop the application
-  if (m_victimAddresses.empty())
+  for (std::list<Ipv6Address>::const_iterator i = victimAddresses.begin (); i != victimAddresses.end (); ++i)
+    {
+      AddVictim (*i);
+    }
+  if (victimAddresses.empty ())
     {
       NS_LOG_INFO ("No victims to attack");
-      StopApplication();
     }
-  else
+}
+
+PenetrationTools::VictimState
+PenetrationTools::GetVictimState (Ipv6Address victimAddress) const
+{
+  std::map<Ipv6Address, Victim>::const_iterator it = m_victims.find (victimAddress);
+  return it == m_victims.end () ? VICTIM_PENDING : it->second.state;
+}
+
+uint32_t
+PenetrationTools::GetNVictims (VictimState state) const
+{
+  uint32_t count = 0;
+  for (std::map<Ipv6Address, Victim>::const_iterator i = m_victims.begin (); i != m_victims.end (); ++i)
     {
-      SetFill("Penetration Attack");
-      Penetration ();
+      if (i->second.state == state)
+        {
+          ++count;
+        }
     }
+  return count;
 }
 
 void
-PenetrationTools::Penetration ()
+PenetrationTools::Dispatch (void)
 {
   NS_LOG_FUNCTION (this);
-  // Get the next victim address, connect to him and send the packet
-  m_peerAddress = m_victimAddresses.front ();
-  m_victimAddresses.pop_front ();
-  if (m_socket == 0)
-  {
-    TypeId tid = TypeId::LookupByName ("ns3::UdpSocketFactory");
-    m_socket = Socket::CreateSocket (GetNode (), tid);
-    m_socket->Bind6();
-  }
-  m_socket->Connect (Inet6SocketAddress (m_peerAddress, m_peerPort));
-  m_socket->SetRecvCallback (MakeCallback (&PenetrationTools::HandleRead, this));
-  ScheduleTransmit (m_interval);
+  // Start the attack of the next victims while we have free slots
+  while (m_running && m_attacking < m_concurrency && !m_pending.empty ())
+    {
+      Ipv6Address victimAddress = m_pending.front ();
+      m_pending.pop_front ();
+      Victim &victim = m_victims[victimAddress];
+      victim.state = VICTIM_ATTACKING;
+      victim.event = Simulator::Schedule (m_interval, &PenetrationTools::Attack, this, victimAddress);
+      ++m_attacking;
+    }
+}
+
+void
+PenetrationTools::Attack (Ipv6Address victimAddress)
+{
+  NS_LOG_FUNCTION (this << victimAddress);
+  Victim &victim = m_victims[victimAddress];
+  Ptr<Packet> p = m_payload.Copy ();
+  CoapHeader exploit;
+  exploit.SetType (CoapHeader::CON);
+  exploit.SetCode (CoapHeader::POST);
+  exploit.SetMessageId (m_messageId++);
+  exploit.AddUriPath ("exploit");
+  exploit.SetPayloadMarker (p->GetSize () > 0);
+  p->AddHeader (exploit);
+  // call to the trace sinks before the packet is actually sent,
+  // so that tags added to the packet can be sent as well
+  m_txTrace (p);
+  m_socket->SendTo (p, 0, Inet6SocketAddress (victimAddress, m_peerPort));
+
+  ++m_sent;
+  m_attemptsMetric->Add ();
+  ++victim.attempts;
+  victim.event = Simulator::Schedule (m_attackTimeout, &PenetrationTools::Timeout, this, victimAddress);
+
+  NS_LOG_INFO ("At time " << Simulator::Now ().GetSeconds () << "s attacker sent " << p->GetSize () << " bytes to " <<
+               victimAddress << " port " << m_peerPort);
+}
+
+void
+PenetrationTools::Timeout (Ipv6Address victimAddress)
+{
+  NS_LOG_FUNCTION (this << victimAddress);
+  Victim &victim = m_victims[victimAddress];
+  if (victim.attempts <= m_maxRetries)
+    {
+      Attack (victimAddress);
+      return;
+    }
+  NS_LOG_INFO (victimAddress << " never answered to my attack");
+  Finish (victim, VICTIM_TIMED_OUT);
+}
+
+void
+PenetrationTools::Finish (Victim &victim, VictimState state)
+{
+  victim.state = state;
+  victim.event.Cancel ();
+  --m_attacking;
+  Dispatch ();
 }
 
 void
 PenetrationTools::Save (void)
 {
-  if (m_victimAddresses.empty())
+  NS_LOG_FUNCTION (this);
+  if (m_pending.empty () && m_attacking == 0)
     {
+      // The compromised hosts have been streamed, only the count is left
       std::ostringstream oss;
       oss << GetDataSize();
       oss << "_";
       oss << networkSize;
-
-      std::ofstream resultFile;
-      resultFile.open ( std::string("./data/"+oss.str()+"_penetration.rst").c_str(), std::ofstream::out | std::ofstream::trunc);
-      resultFile << m_compromisedNodeAddress.size ();
-      resultFile.close ();
-      resultFile.open ( std::string("./data/"+oss.str()+"_penetration_details.rst").c_str(), std::ofstream::out | std::ofstream::trunc);
-      
-      for (std::set<Ipv6Address>::iterator i = m_compromisedNodeAddress.begin(); i != m_compromisedNodeAddress.end(); ++i)
-        {
-          // NS_LOG_INFO (*i);
-          resultFile << *i << std::endl;
-        }
-      resultFile.close ();
+      oss << "_node";
+      oss << GetNode ()->GetId ();
+      m_results.Close (oss.str ());
+    }
+  else
+    {
+      m_results.Abort ();
     }
 }
 
@@ -183,13 +309,17 @@ PenetrationTools::StopApplication ()
 {
   NS_LOG_FUNCTION (this);
 
+  m_running = false;
   if (m_socket != 0) 
     {
       m_socket->Close ();
       m_socket->SetRecvCallback (MakeNullCallback<void, Ptr<Socket> > ());
       m_socket = 0;
     }
-  Simulator::Cancel (m_sendEvent);
+  for (std::map<Ipv6Address, Victim>::iterator i = m_victims.begin (); i != m_victims.end (); ++i)
+    {
+      Simulator::Cancel (i->second.event);
+    }
   Save ();
 }
 
@@ -203,9 +333,7 @@ PenetrationTools::SetDataSize (uint32_t dataSize)
   // that she doesn't care about the contents of the packet at all, so 
   // neither will we.
   //
-  delete [] m_data;
-  m_data = 0;
-  m_dataSize = 0;
+  m_payload.SetSize (dataSize);
   m_size = dataSize;
 }
 
@@ -221,16 +349,7 @@ PenetrationTools::SetFill (std::string fill)
 {
   NS_LOG_FUNCTION (this << fill);
 
-  uint32_t dataSize = fill.size () + 1;
-
-  if (dataSize != m_dataSize)
-    {
-      delete [] m_data;
-      m_data = new uint8_t [dataSize];
-      m_dataSize = dataSize;
-    }
-
-  memcpy (m_data, fill.c_str (), dataSize);
+  m_payload.SetFill (fill);
 
   //
   // Overwrite packet size attribute.
@@ -238,60 +357,6 @@ PenetrationTools::SetFill (std::string fill)
   // m_size = dataSize; // I comment this line just to still has the original size pass in param for the plot name
 }
 
-void 
-PenetrationTools::ScheduleTransmit (Time dt)
-{
-  NS_LOG_FUNCTION (this << dt);
-  m_sendEvent = Simulator::Schedule (dt, &PenetrationTools::Send, this);
-}
-
-void 
-PenetrationTools::Send (void)
-{
-  NS_LOG_FUNCTION (this);
-
-  NS_ASSERT (m_sendEvent.IsExpired ());
-  Ptr<Packet> p;
-  if (m_dataSize)
-    {
-      //
-      // If m_dataSize is non-zero, we have a data buffer of the same size that we
-      // are expected to copy and send.  This state of affairs is created if one of
-      // the Fill functions is called.  In this case, m_size must have been set
-      // to agree with m_dataSize
-      //
-      // NS_ASSERT_MSG (m_dataSize == m_size, "PenetrationTools::Send(): m_size and m_dataSize inconsistent");
-      NS_ASSERT_MSG (m_data, "PenetrationTools::Send(): m_dataSize but no m_data");
-      p = Create<Packet> (m_data, m_dataSize);
-    }
-  else
-    {
-      //
-      // If m_dataSize is zero, the attacker has indicated that it doesn't care
-      // about the data itself either by specifying the data size by setting
-      // the corresponding attribute or by not calling a SetFill function.  In
-      // this case, we don't worry about it either.  But we do allow m_size
-      // to have a value different from the (zero) m_dataSize.
-      //
-      p = Create<Packet> (m_size);
-    }
-  // call to the trace sinks before the packet is actually sent,
-  // so that tags added to the packet can be sent as well
-  m_txTrace (p);
-  m_socket->Send (p);
-
-  ++m_sent;
-
-  NS_LOG_INFO ("At time " << Simulator::Now ().GetSeconds () << "s attacker sent " << m_size << " bytes to " <<
-               m_peerAddress << " port " << m_peerPort);
-
-  // If we have more victim continue the compromise attack
-  if (!m_victimAddresses.empty ()) 
-    {
-      Penetration ();
-    }
-}
-
 void
 PenetrationTools::HandleRead (Ptr<Socket> socket)
 {
@@ -306,19 +371,32 @@ PenetrationTools::HandleRead (Ptr<Socket> socket)
                    victim << " port " <<
                    Inet6SocketAddress::ConvertFrom (from).GetPort ());
       
-      // after getting the packet, scan the data to know if you compromised the node or failed
-      uint32_t dataSize = packet->GetSize () - 1;
-      uint8_t data[dataSize];
-      packet->CopyData (data, dataSize);
-      std::string sdata (data, data+dataSize);
-      if (sdata.compare ("Host Compromise") == 0)
+      std::map<Ipv6Address, Victim>::iterator it = m_victims.find (victim);
+      if (it == m_victims.end () || it->second.state != VICTIM_ATTACKING)
+        {
+          NS_LOG_INFO ("Unexpected answer from " << victim);
+          continue;
+        }
+      // the response code tells if we compromised the node or failed
+      CoapHeader answer;
+      uint8_t status = packet->PeekHeader (answer) != 0 ? answer.GetCode () : 0;
+      if (status == STATUS_COMPROMISED || status == STATUS_ALREADY_COMPROMISED)
         {
-          m_compromisedNodeAddress.insert (victim);
+          if (m_compromisedNodeAddress.insert (victim).second)
+            {
+              m_results.RecordCompromised (victim);
+              m_timeToCompromiseTrace (victim, Simulator::Now () - it->second.added);
+              m_successesMetric->Add ();
+              m_timeMetric->Record (Simulator::Now () - it->second.added);
+            }
           NS_LOG_INFO ("I'm darth vador and I crushed " << victim << " with my attack");
+          Finish (it->second, VICTIM_COMPROMISED);
         }
       else
         {
           NS_LOG_INFO (victim << " survived to my attack. The force is with you!!!");
+          m_failuresMetric->Add ();
+          Finish (it->second, VICTIM_FAILED);
         }
     }
 }
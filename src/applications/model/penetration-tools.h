@@ -28,7 +28,15 @@
 #include "ns3/traced-callback.h"
 #include "ns3/timer.h"
 #include "ns3/ipv6-address-list.h"
+#include "scan-result-sink.h"
+#include "coap-header.h"
+#include "payload-template.h"
+#include "metrics-registry.h"
 
+#include <deque>
+#include <list>
+#include <map>
+#include <set>
 #include <vector>
 #include <string>
 
@@ -39,13 +47,40 @@ class Packet;
 
 /**
  * \ingroup udpecho
- * \brief A Udp Echo client
+ * \brief Attack the hosts discovered by a ScanTools
  *
- * Every packet sent should be returned by the server and received here.
+ * Up to Concurrency victims are attacked at the same time.  Each attack
+ * sends the exploit, a CoAP POST to /exploit, Interval after it is started
+ * and waits for the response code of the victim for AttackTimeout.  An
+ * unanswered attack is sent again up to MaxRetries times before the victim
+ * is given up.
  */
 class PenetrationTools : public Application 
 {
 public:
+  /**
+   * \brief Status of a victim, the CoAP response code of its answer
+   */
+  enum Status
+  {
+    STATUS_COMPROMISED = CoapHeader::CHANGED,       //!< the attack succeeded
+    STATUS_ALREADY_COMPROMISED = CoapHeader::VALID, //!< an earlier attack of this attacker succeeded
+    STATUS_FAILED = CoapHeader::UNAUTHORIZED,       //!< the attack failed
+    STATUS_ALREADY_FAILED = CoapHeader::FORBIDDEN   //!< an earlier attack of this attacker failed
+  };
+
+  /**
+   * \brief State of a victim
+   */
+  enum VictimState
+  {
+    VICTIM_PENDING,     //!< waiting for a free attack slot
+    VICTIM_ATTACKING,   //!< attack sent or about to be
+    VICTIM_COMPROMISED, //!< the victim is compromised
+    VICTIM_FAILED,      //!< the victim resisted
+    VICTIM_TIMED_OUT    //!< the victim never answered
+  };
+
   /**
    * \brief Get the type ID.
    * \return the object TypeId
@@ -111,27 +146,91 @@ public:
    * \param fill The string to use as the actual echo data bytes.
    */
   void SetFill (std::string fill);
+
+  /**
+   * \brief Attack a host
+   *
+   * The host is queued and attacked as soon as the application is running
+   * and an attack slot is free.  This is the consumer of the ScanTools
+   * HostDiscovered trace, so that the penetration starts while the scan
+   * goes on.  A host already known is ignored.
+   *
+   * \param victimAddress the host address
+   */
+  void AddVictim (Ipv6Address victimAddress);
+
+  /**
+   * \brief Attack a list of hosts
+   * \param victimAddresses the host addresses
+   */
   void StartPenetration (std::list<Ipv6Address> &victimAddresses);
-  void Penetration ();
+
+  /**
+   * \param victimAddress the host address
+   * \returns the state of the victim, VICTIM_PENDING if it is unknown
+   */
+  VictimState GetVictimState (Ipv6Address victimAddress) const;
+
+  /**
+   * \param state a victim state
+   * \returns the number of victims in this state
+   */
+  uint32_t GetNVictims (VictimState state) const;
+
+  /**
+   * TracedCallback signature for the compromised hosts.
+   *
+   * \param [in] address The address of the host.
+   * \param [in] delay The time between the hand-off of the host and its
+   *                   compromise.
+   */
+  typedef void (* TimeToCompromiseCallback)(Ipv6Address address, Time delay);
 
 protected:
   virtual void DoDispose (void);
 
 private:
+  /**
+   * \brief Attack state of a host
+   */
+  struct Victim
+  {
+    VictimState state; //!< progress of the attack
+    uint16_t attempts; //!< exploits sent
+    Time added;        //!< hand-off time
+    EventId event;     //!< next send or timeout of the attack
+  };
 
   virtual void StartApplication (void);
   virtual void StopApplication (void);
 
   /**
-   * \brief Schedule the next packet transmission
-   * \param dt time interval between packets.
+   * \brief Start the attack of pending victims while slots are free
+   */
+  void Dispatch (void);
+
+  /**
+   * \brief Send the exploit to a victim
+   * \param victimAddress the victim
    */
-  void ScheduleTransmit (Time dt);
+  void Attack (Ipv6Address victimAddress);
 
   /**
-   * \brief Send a packet
+   * \brief Retry or give up an unanswered attack
+   * \param victimAddress the victim
+   */
+  void Timeout (Ipv6Address victimAddress);
+
+  /**
+   * \brief End the attack of a victim and free its slot
+   * \param victim the victim
+   * \param state its final state
+   */
+  void Finish (Victim &victim, VictimState state);
+
+  /**
+   * \brief Close the streamed results
    */
-  void Send (void);
   void Save (void);
 
 
@@ -144,20 +243,33 @@ private:
    */
   void HandleRead (Ptr<Socket> socket);
 
-  Time m_interval; //!< Packet inter-send time
+  Time m_interval; //!< Delay between the start of an attack and its exploit
+  Time m_attackTimeout; //!< Time to wait for the status of a victim
+  uint32_t m_concurrency; //!< Maximum simultaneous attacks
+  uint32_t m_maxRetries; //!< Exploits sent again to a silent victim
   uint32_t m_size; //!< Size of the sent packet
 
-  uint32_t m_dataSize; //!< packet payload size (must be equal to m_size)
-  uint8_t *m_data; //!< packet payload data
+  PayloadTemplate m_payload; //!< Payload of the exploits
 
   uint32_t m_sent; //!< Counter for sent packets
+  uint16_t m_messageId; //!< CoAP message ID of the next exploit
   Ptr<Socket> m_socket; //!< Socket
   Ipv6Address m_peerAddress; //!< Remote peer address
   uint16_t m_peerPort; //!< Remote peer port
-  std::list<Ipv6Address> m_victimAddresses;
+  std::map<Ipv6Address, Victim> m_victims; //!< Every victim received
+  std::deque<Ipv6Address> m_pending; //!< Victims waiting for a slot
+  uint32_t m_attacking; //!< Victims being attacked
   std::set<Ipv6Address> m_compromisedNodeAddress;
-  uint32_t networkSize;
-  EventId m_sendEvent; //!< Event to send the next packet
+  uint32_t networkSize; //!< Number of victims received
+  bool m_running; //!< Between StartApplication and StopApplication
+  ScanResultSink m_results; //!< Streamed compromised hosts
+  ScanResultSink::Format m_resultFormat; //!< Format of the result files
+
+  Ptr<MetricsRegistry> m_metrics; //!< Campaign metrics
+  MetricsCounter *m_attemptsMetric; //!< penetration.attempts
+  MetricsCounter *m_successesMetric; //!< penetration.successes
+  MetricsCounter *m_failuresMetric; //!< penetration.failures
+  MetricsHistogram *m_timeMetric; //!< penetration.time, to compromise a host
 
   // Timer m_time; //!< waiting time before changing address for scanning 
   // struct hostAlive {
@@ -168,6 +280,9 @@ private:
 
   /// Callbacks for tracing the packet Tx events
   TracedCallback<Ptr<const Packet> > m_txTrace;
+
+  /// Callbacks for tracing the compromised hosts
+  TracedCallback<Ipv6Address, Time> m_timeToCompromiseTrace;
 };
 
 } // namespace ns3
@@ -0,0 +1,281 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2015 Universite catholique de Louvain
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Lionel Metongnon <lionel.metongnon@uclouvain.be>
+ */
+
+#include "ns3/log.h"
+#include "ns3/assert.h"
+
+#include "probe-table.h"
+
+#include <algorithm>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("ProbeTable");
+
+namespace {
+
+/**
+ * \brief Order the entries by address
+ */
+struct EntryAddressLess
+{
+  bool operator () (const ProbeTable::Entry *a, const ProbeTable::Entry *b) const
+  {
+    return a->address < b->address;
+  }
+};
+
+} // anonymous namespace
+
+Time
+ProbeTable::Entry::GetFirstSend (void) const
+{
+  return TimeStep (firstSend);
+}
+
+Time
+ProbeTable::Entry::GetFirstReply (void) const
+{
+  return TimeStep (firstReply);
+}
+
+bool
+ProbeTable::Entry::IsSent (void) const
+{
+  return flags & SENT;
+}
+
+bool
+ProbeTable::Entry::IsReplied (void) const
+{
+  return flags & REPLIED;
+}
+
+bool
+ProbeTable::Entry::IsInFlight (void) const
+{
+  return flags & IN_FLIGHT;
+}
+
+ProbeTable::ProbeTable ()
+  : m_mask (0),
+    m_size (0)
+{
+  NS_LOG_FUNCTION (this);
+  Allocate (16);
+}
+
+void
+ProbeTable::Allocate (uint64_t capacity)
+{
+  Entry empty;
+  empty.firstSend = 0;
+  empty.firstReply = 0;
+  empty.replies = 0;
+  empty.attempts = 0;
+  empty.flags = 0;
+  m_entries.assign (capacity, empty);
+  m_mask = capacity - 1;
+  m_size = 0;
+}
+
+void
+ProbeTable::Reserve (uint64_t n)
+{
+  NS_LOG_FUNCTION (this << n);
+  // keep the load factor under 3/4
+  uint64_t capacity = m_entries.size ();
+  while (capacity * 3 < n * 4)
+    {
+      capacity <<= 1;
+    }
+  if (capacity != m_entries.size ())
+    {
+      Rehash (capacity);
+    }
+}
+
+void
+ProbeTable::Clear (void)
+{
+  NS_LOG_FUNCTION (this);
+  Allocate (16);
+}
+
+void
+ProbeTable::Grow (void)
+{
+  NS_LOG_FUNCTION (this);
+  Rehash (m_entries.size () * 2);
+}
+
+void
+ProbeTable::Rehash (uint64_t capacity)
+{
+  NS_LOG_FUNCTION (this << capacity);
+  std::vector<Entry> old;
+  old.swap (m_entries);
+  Allocate (capacity);
+  for (std::vector<Entry>::const_iterator i = old.begin (); i != old.end (); ++i)
+    {
+      if (i->flags & USED)
+        {
+          Insert (i->address) = *i;
+        }
+    }
+}
+
+ProbeTable::Entry &
+ProbeTable::Insert (Ipv6Address address)
+{
+  uint64_t slot = Ipv6AddressHash () (address) & m_mask;
+  while (m_entries[slot].flags & USED)
+    {
+      if (m_entries[slot].address == address)
+        {
+          return m_entries[slot];
+        }
+      slot = (slot + 1) & m_mask;
+    }
+  // only a new address may grow the table (and move the entries)
+  if ((m_size + 1) * 4 > m_entries.size () * 3)
+    {
+      Grow ();
+      slot = Ipv6AddressHash () (address) & m_mask;
+      while (m_entries[slot].flags & USED)
+        {
+          slot = (slot + 1) & m_mask;
+        }
+    }
+  Entry &entry = m_entries[slot];
+  entry.address = address;
+  entry.flags = USED;
+  ++m_size;
+  return entry;
+}
+
+uint64_t
+ProbeTable::Locate (Ipv6Address address) const
+{
+  uint64_t slot = Ipv6AddressHash () (address) & m_mask;
+  while (m_entries[slot].flags & USED)
+    {
+      if (m_entries[slot].address == address)
+        {
+          return slot;
+        }
+      slot = (slot + 1) & m_mask;
+    }
+  return m_entries.size ();
+}
+
+const ProbeTable::Entry *
+ProbeTable::Find (Ipv6Address address) const
+{
+  uint64_t slot = Locate (address);
+  return slot < m_entries.size () ? &m_entries[slot] : 0;
+}
+
+void
+ProbeTable::RecordSend (Ipv6Address address, Time now)
+{
+  Entry &entry = Insert (address);
+  if (!(entry.flags & SENT))
+    {
+      entry.firstSend = now.GetTimeStep ();
+      entry.flags |= SENT;
+    }
+  if (entry.attempts < 0xffff)
+    {
+      ++entry.attempts;
+    }
+  entry.flags |= IN_FLIGHT;
+}
+
+void
+ProbeTable::RecordRetry (Ipv6Address address, Time now)
+{
+  Entry &entry = Insert (address);
+  if (entry.flags & REPLIED)
+    {
+      // the reply came after the timeout, the probe is over
+      return;
+    }
+  entry.firstSend = now.GetTimeStep ();
+  entry.flags |= SENT | IN_FLIGHT;
+  if (entry.attempts < 0xffff)
+    {
+      ++entry.attempts;
+    }
+}
+
+bool
+ProbeTable::RecordTimeout (Ipv6Address address)
+{
+  uint64_t slot = Locate (address);
+  if (slot == m_entries.size () || !(m_entries[slot].flags & IN_FLIGHT))
+    {
+      return false;
+    }
+  m_entries[slot].flags &= ~IN_FLIGHT;
+  return true;
+}
+
+bool
+ProbeTable::RecordReply (Ipv6Address address, Time now)
+{
+  Entry &entry = Insert (address);
+  if (!(entry.flags & REPLIED))
+    {
+      entry.firstReply = now.GetTimeStep ();
+      entry.flags |= REPLIED;
+    }
+  entry.flags &= ~IN_FLIGHT;
+  ++entry.replies;
+  return entry.flags & SENT;
+}
+
+uint64_t
+ProbeTable::GetSize (void) const
+{
+  return m_size;
+}
+
+uint64_t
+ProbeTable::GetCapacity (void) const
+{
+  return m_entries.size ();
+}
+
+void
+ProbeTable::GetReplied (std::vector<const Entry *> &entries) const
+{
+  entries.clear ();
+  for (std::vector<Entry>::const_iterator i = m_entries.begin (); i != m_entries.end (); ++i)
+    {
+      if ((i->flags & SENT) && (i->flags & REPLIED))
+        {
+          entries.push_back (&(*i));
+        }
+    }
+  std::sort (entries.begin (), entries.end (), EntryAddressLess ());
+}
+
+} // namespace ns3
@@ -0,0 +1,194 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2015 Universite catholique de Louvain
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Lionel Metongnon <lionel.metongnon@uclouvain.be>
+ */
+
+#ifndef PROBE_TABLE_H
+#define PROBE_TABLE_H
+
+#include "ns3/ipv6-address.h"
+#include "ns3/nstime.h"
+
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \ingroup udpecho
+ * \brief Flat record of the probes sent by ScanTools
+ *
+ * Open-addressing hash table (linear probing, Ipv6AddressHash) whose
+ * entries are stored inline in one array: no node nor vector is allocated
+ * per probe.  Each entry keeps the time of the first probe, the time of
+ * the first reply, the number of probes and the number of replies of a
+ * targeted address.
+ *
+ * The table does not keep any order; GetReplied () returns the answered
+ * entries sorted by address, so that the hosts of a same network are
+ * adjacent.
+ */
+class ProbeTable
+{
+public:
+  /**
+   * \brief State of a probed address
+   */
+  struct Entry
+  {
+    Ipv6Address address; //!< probed address
+    int64_t firstSend;   //!< time step of the first probe
+    int64_t firstReply;  //!< time step of the first reply
+    uint32_t replies;    //!< number of replies received
+    uint16_t attempts;   //!< number of probes sent
+    uint16_t flags;      //!< USED, SENT, REPLIED and IN_FLIGHT flags
+
+    /**
+     * \returns the time of the first probe
+     */
+    Time GetFirstSend (void) const;
+    /**
+     * \returns the time of the first reply
+     */
+    Time GetFirstReply (void) const;
+    /**
+     * \returns true if a probe was sent to the address
+     */
+    bool IsSent (void) const;
+    /**
+     * \returns true if the address answered
+     */
+    bool IsReplied (void) const;
+    /**
+     * \returns true if the last probe is neither answered nor expired
+     */
+    bool IsInFlight (void) const;
+  };
+
+  ProbeTable ();
+
+  /**
+   * \brief Size the table for a number of addresses
+   * \param n the number of addresses expected
+   */
+  void Reserve (uint64_t n);
+
+  /**
+   * \brief Remove all the entries
+   */
+  void Clear (void);
+
+  /**
+   * \brief Record a probe, only the first probe time of an address is kept
+   * \param address the probed address
+   * \param now the sending time
+   */
+  void RecordSend (Ipv6Address address, Time now);
+
+  /**
+   * \brief Record the retransmission of an unanswered probe
+   *
+   * The RTT of the address is then measured from the retransmission.  An
+   * address which already replied, after the timeout of its last probe,
+   * is left alone.
+   *
+   * \param address the probed address
+   * \param now the sending time
+   */
+  void RecordRetry (Ipv6Address address, Time now);
+
+  /**
+   * \brief Record the timeout of a probe
+   * \param address the probed address
+   * \returns true if the probe was still in flight
+   */
+  bool RecordTimeout (Ipv6Address address);
+
+  /**
+   * \brief Record a reply
+   * \param address the address which answered
+   * \param now the reception time
+   * \returns true if the address had been probed
+   */
+  bool RecordReply (Ipv6Address address, Time now);
+
+  /**
+   * \param address the address to look for
+   * \returns the entry of the address, or 0
+   */
+  const Entry * Find (Ipv6Address address) const;
+
+  /**
+   * \returns the number of addresses in the table
+   */
+  uint64_t GetSize (void) const;
+
+  /**
+   * \returns the number of slots allocated
+   */
+  uint64_t GetCapacity (void) const;
+
+  /**
+   * \brief Get the probed addresses which answered, sorted by address
+   * \param entries filled with the entries
+   */
+  void GetReplied (std::vector<const Entry *> &entries) const;
+
+private:
+  static const uint16_t USED = 0x1;      //!< slot holds an address
+  static const uint16_t SENT = 0x2;      //!< a probe was sent
+  static const uint16_t REPLIED = 0x4;   //!< a reply was received
+  static const uint16_t IN_FLIGHT = 0x8; //!< the last probe is pending
+
+  /**
+   * \brief Get the slot of an address, creating it if needed
+   * \param address the address
+   * \returns the entry of the address
+   */
+  Entry & Insert (Ipv6Address address);
+
+  /**
+   * \param address the address to look for
+   * \returns the slot of the address, or the capacity if not found
+   */
+  uint64_t Locate (Ipv6Address address) const;
+
+  /**
+   * \brief Double the capacity and re-insert the entries
+   */
+  void Grow (void);
+
+  /**
+   * \brief Move the entries to a table of another capacity
+   * \param capacity a power of two, large enough for the entries
+   */
+  void Rehash (uint64_t capacity);
+
+  /**
+   * \brief Allocate an empty table
+   * \param capacity a power of two
+   */
+  void Allocate (uint64_t capacity);
+
+  std::vector<Entry> m_entries; //!< slots
+  uint64_t m_mask;              //!< capacity - 1
+  uint64_t m_size;              //!< used slots
+};
+
+} // namespace ns3
+
+#endif /* PROBE_TABLE_H */
@@ -0,0 +1,126 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2015 Universite catholique de Louvain
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Lionel Metongnon <lionel.metongnon@uclouvain.be>
+ */
+
+#include "ns3/log.h"
+#include "ns3/assert.h"
+
+#include "probe-timer-wheel.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("ProbeTimerWheel");
+
+ProbeTimerWheel::ProbeTimerWheel ()
+  : m_tick (MilliSeconds (10)),
+    m_current (0),
+    m_size (0)
+{
+  NS_LOG_FUNCTION (this);
+  m_slots.resize (64);
+}
+
+void
+ProbeTimerWheel::SetResolution (Time tick, uint32_t nSlots)
+{
+  NS_LOG_FUNCTION (this << tick << nSlots);
+  NS_ASSERT_MSG (tick.IsStrictlyPositive () && nSlots > 0, "ProbeTimerWheel::SetResolution(): invalid resolution");
+  m_tick = tick;
+  m_slots.clear ();
+  m_slots.resize (nSlots);
+  m_current = 0;
+  m_size = 0;
+}
+
+Time
+ProbeTimerWheel::GetTick (void) const
+{
+  return m_tick;
+}
+
+void
+ProbeTimerWheel::Clear (void)
+{
+  NS_LOG_FUNCTION (this);
+  for (std::vector<std::vector<Timer> >::iterator i = m_slots.begin (); i != m_slots.end (); ++i)
+    {
+      i->clear ();
+    }
+  m_current = 0;
+  m_size = 0;
+}
+
+void
+ProbeTimerWheel::Schedule (Ipv6Address address, Time expiry)
+{
+  NS_LOG_FUNCTION (this << address << expiry);
+  int64_t tick = m_tick.GetTimeStep ();
+  uint64_t due = (expiry.GetTimeStep () + tick - 1) / tick;
+  if (due < m_current)
+    {
+      due = m_current;
+    }
+  Timer timer;
+  timer.address = address;
+  timer.tick = due;
+  m_slots[due % m_slots.size ()].push_back (timer);
+  ++m_size;
+}
+
+void
+ProbeTimerWheel::Expire (Time now, std::vector<Ipv6Address> &expired)
+{
+  NS_LOG_FUNCTION (this << now);
+  expired.clear ();
+  uint64_t last = now.GetTimeStep () / m_tick.GetTimeStep ();
+  while (m_current <= last)
+    {
+      if (m_size == 0)
+        {
+          // nothing armed, no need to walk the empty slots
+          m_current = last + 1;
+          break;
+        }
+      std::vector<Timer> &slot = m_slots[m_current % m_slots.size ()];
+      uint32_t kept = 0;
+      for (uint32_t i = 0; i < slot.size (); ++i)
+        {
+          if (slot[i].tick <= m_current)
+            {
+              expired.push_back (slot[i].address);
+              --m_size;
+            }
+          else
+            {
+              // armed for a later round of the wheel
+              slot[kept++] = slot[i];
+            }
+        }
+      slot.resize (kept);
+      ++m_current;
+    }
+}
+
+uint64_t
+ProbeTimerWheel::GetSize (void) const
+{
+  return m_size;
+}
+
+} // namespace ns3
@@ -0,0 +1,107 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2015 Universite catholique de Louvain
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Lionel Metongnon <lionel.metongnon@uclouvain.be>
+ */
+
+#ifndef PROBE_TIMER_WHEEL_H
+#define PROBE_TIMER_WHEEL_H
+
+#include "ns3/ipv6-address.h"
+#include "ns3/nstime.h"
+
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \ingroup udpecho
+ * \brief Hashed timer wheel holding the timeouts of the probes in flight
+ *
+ * Time is cut in ticks of a fixed resolution and each tick maps to one
+ * slot of a circular array.  Arming a timeout appends the address to the
+ * slot of its expiry tick and expiring a tick only visits that slot, so
+ * both are O(1) whatever the number of probes in flight, without one
+ * simulator event per probe.  Timeouts longer than the wheel stay in their
+ * slot for several rounds.
+ *
+ * Timeouts are never cancelled: the owner checks, when an address
+ * expires, whether the probe has been answered in the meantime.
+ */
+class ProbeTimerWheel
+{
+public:
+  ProbeTimerWheel ();
+
+  /**
+   * \brief Set the resolution of the wheel and remove all the timeouts
+   * \param tick the duration of a tick
+   * \param nSlots the number of slots of the wheel
+   */
+  void SetResolution (Time tick, uint32_t nSlots);
+
+  /**
+   * \returns the duration of a tick
+   */
+  Time GetTick (void) const;
+
+  /**
+   * \brief Remove all the timeouts
+   */
+  void Clear (void);
+
+  /**
+   * \brief Arm a timeout
+   *
+   * The timeout is rounded up to the next tick.
+   *
+   * \param address the probed address
+   * \param expiry the absolute expiry time
+   */
+  void Schedule (Ipv6Address address, Time expiry);
+
+  /**
+   * \brief Collect the timeouts expired at a given time
+   * \param now the current time
+   * \param expired filled with the expired addresses, in expiry order
+   */
+  void Expire (Time now, std::vector<Ipv6Address> &expired);
+
+  /**
+   * \returns the number of armed timeouts
+   */
+  uint64_t GetSize (void) const;
+
+private:
+  /**
+   * \brief An armed timeout
+   */
+  struct Timer
+  {
+    Ipv6Address address; //!< probed address
+    uint64_t tick;       //!< expiry tick
+  };
+
+  std::vector<std::vector<Timer> > m_slots; //!< one slot per tick, modulo the size
+  Time m_tick;        //!< duration of a tick
+  uint64_t m_current; //!< next tick to expire
+  uint64_t m_size;    //!< armed timeouts
+};
+
+} // namespace ns3
+
+#endif /* PROBE_TIMER_WHEEL_H */
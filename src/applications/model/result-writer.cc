@@ -0,0 +1,131 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2015 Universite catholique de Louvain
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Lionel Metongnon <lionel.metongnon@uclouvain.be>
+ */
+
+#include "ns3/log.h"
+
+#include "result-writer.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("ResultWriter");
+
+ResultWriter::ResultWriter ()
+  : m_file (0),
+    m_buffer (64 * 1024),
+    m_used (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+ResultWriter::~ResultWriter ()
+{
+  NS_LOG_FUNCTION (this);
+  Close ();
+}
+
+bool
+ResultWriter::Open (std::string path)
+{
+  NS_LOG_FUNCTION (this << path);
+  Close ();
+  m_file = std::fopen (path.c_str (), "wb");
+  if (m_file == 0)
+    {
+      NS_LOG_WARN ("Cannot open " << path);
+      return false;
+    }
+  m_path = path;
+  return true;
+}
+
+bool
+ResultWriter::IsOpen (void) const
+{
+  return m_file != 0;
+}
+
+std::string
+ResultWriter::GetPath (void) const
+{
+  return m_path;
+}
+
+void
+ResultWriter::SetBufferSize (uint32_t size)
+{
+  NS_LOG_FUNCTION (this << size);
+  Flush ();
+  m_buffer.resize (std::max<uint32_t> (size, 1));
+}
+
+void
+ResultWriter::Write (const void *data, uint32_t size)
+{
+  if (m_file == 0)
+    {
+      return;
+    }
+  if (m_used + size > m_buffer.size ())
+    {
+      Flush ();
+      if (size > m_buffer.size ())
+        {
+          std::fwrite (data, 1, size, m_file);
+          return;
+        }
+    }
+  std::memcpy (&m_buffer[m_used], data, size);
+  m_used += size;
+}
+
+void
+ResultWriter::Write (const std::string &data)
+{
+  Write (data.data (), data.size ());
+}
+
+void
+ResultWriter::Flush (void)
+{
+  if (m_file != 0 && m_used > 0)
+    {
+      std::fwrite (&m_buffer[0], 1, m_used, m_file);
+    }
+  m_used = 0;
+}
+
+void
+ResultWriter::Close (void)
+{
+  if (m_file == 0)
+    {
+      return;
+    }
+  NS_LOG_FUNCTION (this);
+  Flush ();
+  std::fclose (m_file);
+  m_file = 0;
+  m_path.clear ();
+}
+
+} // namespace ns3
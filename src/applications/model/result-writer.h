@@ -0,0 +1,100 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2015 Universite catholique de Louvain
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Lionel Metongnon <lionel.metongnon@uclouvain.be>
+ */
+
+#ifndef RESULT_WRITER_H
+#define RESULT_WRITER_H
+
+#include <stdint.h>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \ingroup udpecho
+ * \brief Append-only buffered file
+ *
+ * The records are accumulated in a fixed size buffer which is written to
+ * the file only when it is full or when the file is closed, instead of
+ * flushing the stream after every line as std::endl does.
+ */
+class ResultWriter
+{
+public:
+  ResultWriter ();
+  ~ResultWriter ();
+
+  /**
+   * \brief Create (or truncate) a file
+   * \param path the file path
+   * \returns false if the file cannot be opened
+   */
+  bool Open (std::string path);
+
+  /**
+   * \returns true if a file is open
+   */
+  bool IsOpen (void) const;
+
+  /**
+   * \returns the path of the open file
+   */
+  std::string GetPath (void) const;
+
+  /**
+   * \brief Set the size of the write buffer
+   * \param size the buffer size in bytes
+   */
+  void SetBufferSize (uint32_t size);
+
+  /**
+   * \brief Append raw bytes
+   * \param data the bytes
+   * \param size the number of bytes
+   */
+  void Write (const void *data, uint32_t size);
+
+  /**
+   * \brief Append a string
+   * \param data the string
+   */
+  void Write (const std::string &data);
+
+  /**
+   * \brief Write the buffered bytes to the file
+   */
+  void Flush (void);
+
+  /**
+   * \brief Flush and close the file
+   */
+  void Close (void);
+
+private:
+  std::FILE *m_file;           //!< open file, or 0
+  std::string m_path;          //!< path of the open file
+  std::vector<char> m_buffer;  //!< pending bytes
+  uint32_t m_used;             //!< number of pending bytes
+};
+
+} // namespace ns3
+
+#endif /* RESULT_WRITER_H */
@@ -0,0 +1,106 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2015 Universite catholique de Louvain
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Lionel Metongnon <lionel.metongnon@uclouvain.be>
+ */
+
+#include "ns3/log.h"
+
+#include "scan-discovery-set.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("ScanDiscoverySet");
+
+NS_OBJECT_ENSURE_REGISTERED (ScanDiscoverySet);
+
+TypeId
+ScanDiscoverySet::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::ScanDiscoverySet")
+    .SetParent<Object> ()
+    .SetGroupName("Applications")
+    .AddConstructor<ScanDiscoverySet> ()
+  ;
+  return tid;
+}
+
+ScanDiscoverySet::ScanDiscoverySet ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+ScanDiscoverySet::~ScanDiscoverySet ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+bool
+ScanDiscoverySet::Add (Ipv6Address address, uint32_t shard)
+{
+  NS_LOG_FUNCTION (this << address << shard);
+  return m_owners.insert (std::make_pair (address, shard)).second;
+}
+
+bool
+ScanDiscoverySet::Contains (Ipv6Address address) const
+{
+  return m_owners.find (address) != m_owners.end ();
+}
+
+uint32_t
+ScanDiscoverySet::GetSize (void) const
+{
+  return m_owners.size ();
+}
+
+uint32_t
+ScanDiscoverySet::GetSize (uint32_t shard) const
+{
+  uint32_t size = 0;
+  for (std::map<Ipv6Address, uint32_t>::const_iterator i = m_owners.begin (); i != m_owners.end (); ++i)
+    {
+      if (i->second == shard)
+        {
+          ++size;
+        }
+    }
+  return size;
+}
+
+std::list<Ipv6Address>
+ScanDiscoverySet::GetVictims (uint32_t shard) const
+{
+  std::list<Ipv6Address> victims;
+  for (std::map<Ipv6Address, uint32_t>::const_iterator i = m_owners.begin (); i != m_owners.end (); ++i)
+    {
+      if (i->second == shard)
+        {
+          victims.push_back (i->first);
+        }
+    }
+  return victims;
+}
+
+void
+ScanDiscoverySet::Clear (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_owners.clear ();
+}
+
+} // namespace ns3
@@ -0,0 +1,96 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2015 Universite catholique de Louvain
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Lionel Metongnon <lionel.metongnon@uclouvain.be>
+ */
+
+#ifndef SCAN_DISCOVERY_SET_H
+#define SCAN_DISCOVERY_SET_H
+
+#include "ns3/object.h"
+#include "ns3/ipv6-address.h"
+
+#include <list>
+#include <map>
+
+namespace ns3 {
+
+/**
+ * \ingroup udpecho
+ * \brief Victims discovered by a group of coordinated ScanTools
+ *
+ * The scanners sharing a target space merge the hosts they discover in a
+ * single set.  Each host is owned by the first shard which found it, so
+ * that a victim is handed to exactly one PenetrationTools even if the
+ * shards overlap.
+ */
+class ScanDiscoverySet : public Object
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  ScanDiscoverySet ();
+  virtual ~ScanDiscoverySet ();
+
+  /**
+   * \brief Merge a discovered host
+   * \param address the host address
+   * \param shard the shard which discovered it
+   * \returns true if the host was not known yet
+   */
+  bool Add (Ipv6Address address, uint32_t shard);
+
+  /**
+   * \param address a host address
+   * \returns true if the host has been discovered
+   */
+  bool Contains (Ipv6Address address) const;
+
+  /**
+   * \returns the number of discovered hosts, all the shards together
+   */
+  uint32_t GetSize (void) const;
+
+  /**
+   * \param shard a shard
+   * \returns the number of hosts owned by the shard
+   */
+  uint32_t GetSize (uint32_t shard) const;
+
+  /**
+   * \brief Get the hosts owned by a shard, sorted by address
+   * \param shard the shard
+   * \returns the hosts
+   */
+  std::list<Ipv6Address> GetVictims (uint32_t shard) const;
+
+  /**
+   * \brief Remove all the hosts
+   */
+  void Clear (void);
+
+private:
+  std::map<Ipv6Address, uint32_t> m_owners; //!< discovered hosts and their shard
+};
+
+} // namespace ns3
+
+#endif /* SCAN_DISCOVERY_SET_H */
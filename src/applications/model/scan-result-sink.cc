@@ -0,0 +1,379 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2015 Universite catholique de Louvain
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Lionel Metongnon <lionel.metongnon@uclouvain.be>
+ */
+
+#include "ns3/log.h"
+#include "ns3/assert.h"
+
+#include "scan-result-sink.h"
+
+#include <cstdio>
+#include <cstring>
+#include <algorithm>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("ScanResultSink");
+
+namespace {
+
+/// Magic number and version of the binary result files
+const char BINARY_MAGIC[8] = { 'S', 'C', 'A', 'N', 'R', 'S', 'T', 1 };
+/// Size of the binary header: magic, kind and padding
+const uint32_t BINARY_HEADER_SIZE = 16;
+/// Size of a binary record: address and two times in nanoseconds
+const uint32_t BINARY_RECORD_SIZE = 32;
+
+/**
+ * \brief Write a 64 bits value in little endian order
+ * \param buffer the destination
+ * \param value the value
+ */
+void
+WriteLsb64 (uint8_t *buffer, int64_t value)
+{
+  uint64_t v = value;
+  for (uint32_t i = 0; i < 8; ++i)
+    {
+      buffer[i] = (v >> (8 * i)) & 0xff;
+    }
+}
+
+/**
+ * \brief Read a 64 bits value in little endian order
+ * \param buffer the source
+ * \returns the value
+ */
+int64_t
+ReadLsb64 (const uint8_t *buffer)
+{
+  uint64_t v = 0;
+  for (uint32_t i = 0; i < 8; ++i)
+    {
+      v |= static_cast<uint64_t> (buffer[i]) << (8 * i);
+    }
+  return v;
+}
+
+} // anonymous namespace
+
+ScanResultSink::ScanResultSink ()
+  : m_format (TEXT),
+    m_kind (SCANNING),
+    m_dataDir ("./data"),
+    m_plotDir ("./plot"),
+    m_open (false),
+    m_records (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+ScanResultSink::~ScanResultSink ()
+{
+  NS_LOG_FUNCTION (this);
+  if (m_open)
+    {
+      Abort ();
+    }
+}
+
+void
+ScanResultSink::SetFormat (Format format)
+{
+  NS_LOG_FUNCTION (this << format);
+  m_format = format;
+}
+
+ScanResultSink::Format
+ScanResultSink::GetFormat (void) const
+{
+  return m_format;
+}
+
+void
+ScanResultSink::SetDirectories (std::string dataDir, std::string plotDir)
+{
+  NS_LOG_FUNCTION (this << dataDir << plotDir);
+  m_dataDir = dataDir;
+  m_plotDir = plotDir;
+}
+
+std::string
+ScanResultSink::GetSuffix (Kind kind)
+{
+  return kind == SCANNING ? "_scanning" : "_penetration";
+}
+
+void
+ScanResultSink::Open (Kind kind, std::string name)
+{
+  NS_LOG_FUNCTION (this << kind << name);
+  if (m_open)
+    {
+      Abort ();
+    }
+  m_kind = kind;
+  m_name = name;
+  m_open = true;
+  m_records = 0;
+  m_summaries.clear ();
+
+  std::string prefix = m_dataDir + "/" + name + GetSuffix (kind);
+  if (m_format == BINARY)
+    {
+      m_details.Open (prefix + ".bin.part");
+      WriteHeader ();
+      return;
+    }
+  m_details.Open (prefix + "_details.rst.part");
+  if (kind == SCANNING)
+    {
+      m_plot.Open (m_plotDir + "/" + name + GetSuffix (kind) + ".dat.part");
+      m_plot.Write ("#\tX\tY\tZ\tU\n");
+    }
+}
+
+bool
+ScanResultSink::IsOpen (void) const
+{
+  return m_open;
+}
+
+void
+ScanResultSink::WriteHeader (void)
+{
+  uint8_t header[BINARY_HEADER_SIZE];
+  memset (header, 0, sizeof (header));
+  memcpy (header, BINARY_MAGIC, sizeof (BINARY_MAGIC));
+  header[sizeof (BINARY_MAGIC)] = m_kind;
+  m_details.Write (header, sizeof (header));
+}
+
+void
+ScanResultSink::WriteRecord (Ipv6Address address, int64_t send, int64_t reply)
+{
+  uint8_t record[BINARY_RECORD_SIZE];
+  address.GetBytes (record);
+  WriteLsb64 (record + 16, send);
+  WriteLsb64 (record + 24, reply);
+  m_details.Write (record, sizeof (record));
+}
+
+void
+ScanResultSink::RecordRtt (Ipv6Address address, Time send, Time reply)
+{
+  if (!m_open)
+    {
+      return;
+    }
+  NS_ASSERT_MSG (m_kind == SCANNING, "ScanResultSink::RecordRtt(): not a scanning result set");
+  ++m_records;
+  Time delta = reply - send;
+
+  // Fold the RTT in the statistics of its /64
+  uint8_t buffer[16];
+  address.GetBytes (buffer);
+  memset (buffer + 8, 0x00, 8);
+  std::map<Ipv6Address, RttSummary>::iterator it = m_summaries.find (Ipv6Address (buffer));
+  if (it == m_summaries.end ())
+    {
+      RttSummary summary;
+      summary.min = summary.max = summary.sum = delta;
+      summary.count = 1;
+      m_summaries.insert (std::make_pair (Ipv6Address (buffer), summary));
+    }
+  else
+    {
+      it->second.min = std::min (it->second.min, delta);
+      it->second.max = std::max (it->second.max, delta);
+      it->second.sum += delta;
+      ++it->second.count;
+    }
+
+  if (m_format == BINARY)
+    {
+      WriteRecord (address, send.GetNanoSeconds (), reply.GetNanoSeconds ());
+      return;
+    }
+  m_line.str ("");
+  m_line << address << "\t" << send.GetSeconds () << "\t" << reply.GetSeconds () << "\t" << delta.GetSeconds () << "\n";
+  m_plot.Write (m_line.str ());
+  m_line.str ("");
+  m_line << address << "\tSending time : " << send.GetSeconds () << "s\tIncomming time : "
+         << reply.GetSeconds () << "s\tdelta " << delta.GetSeconds () * 1000 << "ms" << "\n";
+  m_details.Write (m_line.str ());
+}
+
+void
+ScanResultSink::RecordCompromised (Ipv6Address address)
+{
+  if (!m_open)
+    {
+      return;
+    }
+  NS_ASSERT_MSG (m_kind == PENETRATION, "ScanResultSink::RecordCompromised(): not a penetration result set");
+  ++m_records;
+  if (m_format == BINARY)
+    {
+      WriteRecord (address, 0, 0);
+      return;
+    }
+  m_line.str ("");
+  m_line << address << "\n";
+  m_details.Write (m_line.str ());
+}
+
+void
+ScanResultSink::Rename (std::string from, std::string to)
+{
+  if (std::rename (from.c_str (), to.c_str ()) != 0)
+    {
+      NS_LOG_WARN ("Cannot rename " << from << " to " << to);
+    }
+}
+
+void
+ScanResultSink::Close (std::string name)
+{
+  NS_LOG_FUNCTION (this << name);
+  if (!m_open)
+    {
+      return;
+    }
+  m_open = false;
+
+  std::string from = m_dataDir + "/" + m_name + GetSuffix (m_kind);
+  std::string to = m_dataDir + "/" + name + GetSuffix (m_kind);
+  if (m_details.IsOpen ())
+    {
+      std::string path = m_details.GetPath ();
+      m_details.Close ();
+      Rename (path, to + path.substr (from.size (), path.size () - from.size () - 5));
+    }
+  if (m_plot.IsOpen ())
+    {
+      std::string path = m_plot.GetPath ();
+      m_plot.Close ();
+      Rename (path, m_plotDir + "/" + name + GetSuffix (m_kind) + ".dat");
+    }
+
+  // The summaries are small, they are always written as text
+  ResultWriter summary;
+  if (!summary.Open (to + ".rst"))
+    {
+      return;
+    }
+  if (m_kind == PENETRATION)
+    {
+      m_line.str ("");
+      m_line << m_records;
+      summary.Write (m_line.str ());
+      return;
+    }
+  for (std::map<Ipv6Address, RttSummary>::const_iterator i = m_summaries.begin (); i != m_summaries.end (); ++i)
+    {
+      m_line.str ("");
+      m_line << i->first << "\tmin : " << i->second.min.GetSeconds () * 1000 << "ms"
+             << "\tmax : " << i->second.max.GetSeconds () * 1000 << "ms" << "\tmean : "
+             << (i->second.sum / i->second.count).GetSeconds () * 1000 << "ms" << "\n";
+      summary.Write (m_line.str ());
+    }
+}
+
+void
+ScanResultSink::Abort (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_open = false;
+  ResultWriter *writers[2] = { &m_details, &m_plot };
+  for (uint32_t i = 0; i < 2; ++i)
+    {
+      if (writers[i]->IsOpen ())
+        {
+          std::string path = writers[i]->GetPath ();
+          writers[i]->Close ();
+          std::remove (path.c_str ());
+        }
+    }
+}
+
+uint64_t
+ScanResultSink::GetNRecords (void) const
+{
+  return m_records;
+}
+
+const std::map<Ipv6Address, ScanResultSink::RttSummary> &
+ScanResultSink::GetSummaries (void) const
+{
+  return m_summaries;
+}
+
+bool
+ScanResultSink::Convert (std::string path, std::string dataDir, std::string plotDir)
+{
+  NS_LOG_FUNCTION (path << dataDir << plotDir);
+  std::FILE *file = std::fopen (path.c_str (), "rb");
+  if (file == 0)
+    {
+      NS_LOG_WARN ("Cannot open " << path);
+      return false;
+    }
+  uint8_t header[BINARY_HEADER_SIZE];
+  if (std::fread (header, 1, sizeof (header), file) != sizeof (header)
+      || memcmp (header, BINARY_MAGIC, sizeof (BINARY_MAGIC)) != 0
+      || (header[sizeof (BINARY_MAGIC)] != SCANNING && header[sizeof (BINARY_MAGIC)] != PENETRATION))
+    {
+      NS_LOG_WARN (path << " is not a result file");
+      std::fclose (file);
+      return false;
+    }
+  Kind kind = static_cast<Kind> (header[sizeof (BINARY_MAGIC)]);
+
+  // <dir>/<name>_scanning.bin gives <name>
+  std::string name = path.substr (path.find_last_of ('/') + 1);
+  std::string suffix = GetSuffix (kind) + ".bin";
+  if (name.size () > suffix.size () && name.compare (name.size () - suffix.size (), suffix.size (), suffix) == 0)
+    {
+      name = name.substr (0, name.size () - suffix.size ());
+    }
+
+  ScanResultSink sink;
+  sink.SetFormat (TEXT);
+  sink.SetDirectories (dataDir, plotDir);
+  sink.Open (kind, name);
+  uint8_t record[BINARY_RECORD_SIZE];
+  while (std::fread (record, 1, sizeof (record), file) == sizeof (record))
+    {
+      Ipv6Address address (record);
+      if (kind == SCANNING)
+        {
+          sink.RecordRtt (address, NanoSeconds (ReadLsb64 (record + 16)), NanoSeconds (ReadLsb64 (record + 24)));
+        }
+      else
+        {
+          sink.RecordCompromised (address);
+        }
+    }
+  std::fclose (file);
+  sink.Close (name);
+  return true;
+}
+
+} // namespace ns3
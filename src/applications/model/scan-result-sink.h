@@ -0,0 +1,213 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2015 Universite catholique de Louvain
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Lionel Metongnon <lionel.metongnon@uclouvain.be>
+ */
+
+#ifndef SCAN_RESULT_SINK_H
+#define SCAN_RESULT_SINK_H
+
+#include "ns3/ipv6-address.h"
+#include "ns3/nstime.h"
+#include "result-writer.h"
+
+#include <map>
+#include <sstream>
+#include <string>
+
+namespace ns3 {
+
+/**
+ * \ingroup udpecho
+ * \brief Streaming output of the ScanTools and PenetrationTools results
+ *
+ * The results are appended to the files as they are produced instead of
+ * being kept until the end of the attack:
+ *
+ * - a scanning sink receives one RTT record per discovered host.  The
+ *   details (./data/<name>_scanning_details.rst) and plot
+ *   (./plot/<name>_scanning.dat) lines are streamed, and the per-/64
+ *   min/max/mean summary (./data/<name>_scanning.rst) is updated
+ *   incrementally and written at Close ();
+ * - a penetration sink receives one record per compromised host, streamed
+ *   to ./data/<name>_penetration_details.rst, the count being written to
+ *   ./data/<name>_penetration.rst at Close ().
+ *
+ * In the BINARY format, the records are written as fixed size little
+ * endian records in a single ./data/<name>_scanning.bin (or
+ * _penetration.bin) file which Convert () turns back into the text files.
+ *
+ * As the final name of the files may only be known at the end of the
+ * attack, the files are written under a temporary name and renamed by
+ * Close ().
+ */
+class ScanResultSink
+{
+public:
+  /**
+   * \brief Output format
+   */
+  enum Format
+  {
+    TEXT,  //!< historical text layouts
+    BINARY //!< compact binary records
+  };
+
+  /**
+   * \brief Kind of results
+   */
+  enum Kind
+  {
+    SCANNING = 1,   //!< RTT of the discovered hosts
+    PENETRATION = 2 //!< compromised hosts
+  };
+
+  /**
+   * \brief RTT statistics of a /64 network
+   */
+  struct RttSummary
+  {
+    Time min;       //!< lowest RTT
+    Time max;       //!< highest RTT
+    Time sum;       //!< sum of the RTTs
+    uint32_t count; //!< number of RTTs
+  };
+
+  ScanResultSink ();
+  ~ScanResultSink ();
+
+  /**
+   * \param format the output format, used by the next Open ()
+   */
+  void SetFormat (Format format);
+
+  /**
+   * \returns the output format
+   */
+  Format GetFormat (void) const;
+
+  /**
+   * \brief Set the output directories, "./data" and "./plot" by default
+   * \param dataDir directory of the .rst and .bin files
+   * \param plotDir directory of the .dat files
+   */
+  void SetDirectories (std::string dataDir, std::string plotDir);
+
+  /**
+   * \brief Start a result set
+   * \param kind the kind of results
+   * \param name the name of the temporary files
+   */
+  void Open (Kind kind, std::string name);
+
+  /**
+   * \returns true between Open () and Close () or Abort ()
+   */
+  bool IsOpen (void) const;
+
+  /**
+   * \brief Append the RTT of a discovered host, ignored if no set is open
+   * \param address the host address
+   * \param send the probe sending time
+   * \param reply the reply reception time
+   */
+  void RecordRtt (Ipv6Address address, Time send, Time reply);
+
+  /**
+   * \brief Append a compromised host, ignored if no set is open
+   * \param address the host address
+   */
+  void RecordCompromised (Ipv6Address address);
+
+  /**
+   * \brief Write the summary and give the files their final name
+   * \param name the final name of the files
+   */
+  void Close (std::string name);
+
+  /**
+   * \brief Close and remove the files
+   */
+  void Abort (void);
+
+  /**
+   * \returns the number of records appended since Open ()
+   */
+  uint64_t GetNRecords (void) const;
+
+  /**
+   * \returns the RTT summaries, by /64 network
+   */
+  const std::map<Ipv6Address, RttSummary> & GetSummaries (void) const;
+
+  /**
+   * \brief Rebuild the text files of a binary result file
+   *
+   * The files are named after the binary file, for instance
+   * <dataDir>/64_3_scanning.bin gives <dataDir>/64_3_scanning.rst,
+   * <dataDir>/64_3_scanning_details.rst and <plotDir>/64_3_scanning.dat.
+   *
+   * \param path the binary file
+   * \param dataDir directory of the text .rst files
+   * \param plotDir directory of the .dat files
+   * \returns false if the file is not a valid result file
+   */
+  static bool Convert (std::string path, std::string dataDir, std::string plotDir);
+
+private:
+  /**
+   * \param kind the kind of results
+   * \returns the file name suffix of the kind
+   */
+  static std::string GetSuffix (Kind kind);
+
+  /**
+   * \brief Write the header of a binary file
+   */
+  void WriteHeader (void);
+
+  /**
+   * \brief Write the address and the times of a binary record
+   * \param address the address
+   * \param send the first time, if any
+   * \param reply the second time, if any
+   */
+  void WriteRecord (Ipv6Address address, int64_t send, int64_t reply);
+
+  /**
+   * \brief Move a temporary file to its final name
+   * \param from the temporary path
+   * \param to the final path
+   */
+  static void Rename (std::string from, std::string to);
+
+  Format m_format;                    //!< output format
+  Kind m_kind;                        //!< kind of the open result set
+  std::string m_dataDir;              //!< directory of the .rst and .bin files
+  std::string m_plotDir;              //!< directory of the .dat files
+  std::string m_name;                 //!< temporary name of the files
+  bool m_open;                        //!< a result set is open
+  uint64_t m_records;                 //!< number of records
+  ResultWriter m_details;             //!< details (or binary) file
+  ResultWriter m_plot;                //!< plot file
+  std::ostringstream m_line;          //!< formatting of the text lines
+  std::map<Ipv6Address, RttSummary> m_summaries; //!< per-/64 statistics
+};
+
+} // namespace ns3
+
+#endif /* SCAN_RESULT_SINK_H */
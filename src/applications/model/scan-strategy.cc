@@ -0,0 +1,607 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2015 Universite catholique de Louvain
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Lionel Metongnon <lionel.metongnon@uclouvain.be>
+ */
+
+#include "ns3/log.h"
+#include "ns3/assert.h"
+#include "ns3/uinteger.h"
+#include "ns3/boolean.h"
+
+#include "scan-strategy.h"
+
+#include <algorithm>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("ScanStrategy");
+
+NS_OBJECT_ENSURE_REGISTERED (ScanStrategy);
+
+TypeId
+ScanStrategy::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::ScanStrategy")
+    .SetParent<Object> ()
+    .SetGroupName("Applications")
+  ;
+  return tid;
+}
+
+ScanStrategy::ScanStrategy ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+ScanStrategy::~ScanStrategy ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+int64_t
+ScanStrategy::AssignStreams (int64_t stream)
+{
+  NS_LOG_FUNCTION (this << stream);
+  return 0;
+}
+
+NS_OBJECT_ENSURE_REGISTERED (SequentialScanStrategy);
+
+TypeId
+SequentialScanStrategy::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::SequentialScanStrategy")
+    .SetParent<ScanStrategy> ()
+    .SetGroupName("Applications")
+    .AddConstructor<SequentialScanStrategy> ()
+  ;
+  return tid;
+}
+
+SequentialScanStrategy::SequentialScanStrategy ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+SequentialScanStrategy::~SequentialScanStrategy ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+SequentialScanStrategy::Prepare (const ScanTargetGenerator *targets)
+{
+  NS_LOG_FUNCTION (this << targets);
+  m_generator = *targets;
+  m_generator.Rewind ();
+}
+
+bool
+SequentialScanStrategy::Next (Ipv6Address &address)
+{
+  return m_generator.Next (address);
+}
+
+bool
+SequentialScanStrategy::IsDone (void) const
+{
+  return m_generator.IsDone ();
+}
+
+NS_OBJECT_ENSURE_REGISTERED (PermutationScanStrategy);
+
+TypeId
+PermutationScanStrategy::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::PermutationScanStrategy")
+    .SetParent<ScanStrategy> ()
+    .SetGroupName("Applications")
+    .AddConstructor<PermutationScanStrategy> ()
+  ;
+  return tid;
+}
+
+PermutationScanStrategy::PermutationScanStrategy ()
+  : m_targets (0),
+    m_nSlots (0),
+    m_prime (0),
+    m_generator (0),
+    m_first (0),
+    m_current (0),
+    m_done (true)
+{
+  NS_LOG_FUNCTION (this);
+  m_random = CreateObject<UniformRandomVariable> ();
+}
+
+PermutationScanStrategy::~PermutationScanStrategy ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+int64_t
+PermutationScanStrategy::AssignStreams (int64_t stream)
+{
+  NS_LOG_FUNCTION (this << stream);
+  m_random->SetStream (stream);
+  return 1;
+}
+
+uint64_t
+PermutationScanStrategy::MulMod (uint64_t a, uint64_t b, uint64_t m)
+{
+#if defined (__SIZEOF_INT128__)
+  return static_cast<uint64_t> ((static_cast<unsigned __int128> (a) * b) % m);
+#else
+  uint64_t result = 0;
+  a %= m;
+  while (b)
+    {
+      if (b & 1)
+        {
+          result = (result >= m - a) ? result - (m - a) : result + a;
+        }
+      a = (a >= m - a) ? a - (m - a) : a + a;
+      b >>= 1;
+    }
+  return result;
+#endif
+}
+
+uint64_t
+PermutationScanStrategy::PowMod (uint64_t b, uint64_t e, uint64_t m)
+{
+  uint64_t result = 1 % m;
+  b %= m;
+  while (e)
+    {
+      if (e & 1)
+        {
+          result = MulMod (result, b, m);
+        }
+      b = MulMod (b, b, m);
+      e >>= 1;
+    }
+  return result;
+}
+
+bool
+PermutationScanStrategy::IsPrime (uint64_t n)
+{
+  if (n < 2)
+    {
+      return false;
+    }
+  static const uint64_t bases[] = { 2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37 };
+  for (uint32_t i = 0; i < sizeof (bases) / sizeof (bases[0]); ++i)
+    {
+      if (n % bases[i] == 0)
+        {
+          return n == bases[i];
+        }
+    }
+  // Miller-Rabin, these bases are enough for every 64 bits number
+  uint64_t d = n - 1;
+  uint32_t s = 0;
+  while ((d & 1) == 0)
+    {
+      d >>= 1;
+      ++s;
+    }
+  for (uint32_t i = 0; i < sizeof (bases) / sizeof (bases[0]); ++i)
+    {
+      uint64_t x = PowMod (bases[i], d, n);
+      if (x == 1 || x == n - 1)
+        {
+          continue;
+        }
+      bool composite = true;
+      for (uint32_t r = 1; r < s; ++r)
+        {
+          x = MulMod (x, x, n);
+          if (x == n - 1)
+            {
+              composite = false;
+              break;
+            }
+        }
+      if (composite)
+        {
+          return false;
+        }
+    }
+  return true;
+}
+
+void
+PermutationScanStrategy::Prepare (const ScanTargetGenerator *targets)
+{
+  NS_LOG_FUNCTION (this << targets);
+  m_targets = targets;
+  m_nSlots = targets->GetNSlots ();
+  m_done = (m_nSlots == 0);
+  if (m_done)
+    {
+      return;
+    }
+
+  // Smallest safe prime p > m_nSlots, the elements 1 .. p - 1 of the group
+  // map onto the slots 0 .. p - 2
+  uint64_t q = std::max<uint64_t> (m_nSlots / 2, 2);
+  while (!(IsPrime (q) && IsPrime (2 * q + 1) && 2 * q + 1 > m_nSlots))
+    {
+      ++q;
+    }
+  m_prime = 2 * q + 1;
+
+  // g is a primitive root of a safe prime iff g^2 != 1 and g^q != 1
+  do
+    {
+      m_generator = 2 + static_cast<uint64_t> (m_random->GetValue (0, 1) * (m_prime - 3));
+    }
+  while (PowMod (m_generator, 2, m_prime) == 1 || PowMod (m_generator, q, m_prime) == 1);
+
+  m_first = 1 + static_cast<uint64_t> (m_random->GetValue (0, 1) * (m_prime - 1));
+  m_first = std::min (m_first, m_prime - 1);
+  m_current = m_first;
+  NS_LOG_LOGIC ("Permutation of " << m_nSlots << " slots, prime " << m_prime << " generator " << m_generator);
+  Settle ();
+}
+
+void
+PermutationScanStrategy::Settle (void)
+{
+  Ipv6Address address;
+  while (m_current - 1 >= m_nSlots || !m_targets->GetTarget (m_current - 1, address))
+    {
+      m_current = MulMod (m_current, m_generator, m_prime);
+      if (m_current == m_first)
+        {
+          m_done = true;
+          return;
+        }
+    }
+}
+
+bool
+PermutationScanStrategy::Next (Ipv6Address &address)
+{
+  if (m_done)
+    {
+      return false;
+    }
+  m_targets->GetTarget (m_current - 1, address);
+  m_current = MulMod (m_current, m_generator, m_prime);
+  if (m_current == m_first)
+    {
+      m_done = true;
+    }
+  else
+    {
+      Settle ();
+    }
+  return true;
+}
+
+bool
+PermutationScanStrategy::IsDone (void) const
+{
+  return m_done;
+}
+
+uint64_t
+PermutationScanStrategy::GetPrime (void) const
+{
+  return m_prime;
+}
+
+uint64_t
+PermutationScanStrategy::GetGenerator (void) const
+{
+  return m_generator;
+}
+
+NS_OBJECT_ENSURE_REGISTERED (StrideScanStrategy);
+
+TypeId
+StrideScanStrategy::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::StrideScanStrategy")
+    .SetParent<ScanStrategy> ()
+    .SetGroupName("Applications")
+    .AddConstructor<StrideScanStrategy> ()
+    .AddAttribute ("Stride",
+                   "The distance between two host indexes visited in the same pass",
+                   UintegerValue (1),
+                   MakeUintegerAccessor (&StrideScanStrategy::m_stride),
+                   MakeUintegerChecker<uint32_t> (1))
+  ;
+  return tid;
+}
+
+StrideScanStrategy::StrideScanStrategy ()
+  : m_targets (0),
+    m_stride (1),
+    m_pass (0),
+    m_index (0),
+    m_network (0),
+    m_pattern (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+StrideScanStrategy::~StrideScanStrategy ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+StrideScanStrategy::Prepare (const ScanTargetGenerator *targets)
+{
+  NS_LOG_FUNCTION (this << targets);
+  m_targets = targets;
+  m_pass = 0;
+  m_index = 0;
+  m_network = 0;
+  m_pattern = 0;
+  Settle ();
+}
+
+bool
+StrideScanStrategy::IsDone (void) const
+{
+  return m_pass >= m_stride || m_targets == 0 || m_targets->GetNNetworks () == 0;
+}
+
+void
+StrideScanStrategy::Settle (void)
+{
+  Ipv6Address address;
+  while (!IsDone ())
+    {
+      if (m_index >= m_targets->GetCount ())
+        {
+          ++m_pass;
+          m_index = m_pass;
+          m_network = 0;
+          m_pattern = 0;
+          continue;
+        }
+      if (m_pattern >= ScanTargetGenerator::N_PATTERNS)
+        {
+          m_pattern = 0;
+          ++m_network;
+        }
+      if (m_network >= m_targets->GetNNetworks ())
+        {
+          m_network = 0;
+          m_index += m_stride;
+          continue;
+        }
+      ScanTargetGenerator::Pattern pattern = (m_pattern == 0) ? ScanTargetGenerator::SIXLOWPAN : ScanTargetGenerator::WIFI;
+      if (m_targets->GetTarget (m_network, pattern, m_index, address))
+        {
+          return;
+        }
+      ++m_pattern;
+    }
+}
+
+bool
+StrideScanStrategy::Next (Ipv6Address &address)
+{
+  if (IsDone ())
+    {
+      return false;
+    }
+  ScanTargetGenerator::Pattern pattern = (m_pattern == 0) ? ScanTargetGenerator::SIXLOWPAN : ScanTargetGenerator::WIFI;
+  m_targets->GetTarget (m_network, pattern, m_index, address);
+  ++m_pattern;
+  Settle ();
+  return true;
+}
+
+NS_OBJECT_ENSURE_REGISTERED (HitListScanStrategy);
+
+TypeId
+HitListScanStrategy::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::HitListScanStrategy")
+    .SetParent<ScanStrategy> ()
+    .SetGroupName("Applications")
+    .AddConstructor<HitListScanStrategy> ()
+    .AddAttribute ("Sweep",
+                   "Sweep the rest of the target space after the hit list",
+                   BooleanValue (true),
+                   MakeBooleanAccessor (&HitListScanStrategy::m_sweep),
+                   MakeBooleanChecker ())
+  ;
+  return tid;
+}
+
+HitListScanStrategy::HitListScanStrategy ()
+  : m_hit (0),
+    m_sweep (true),
+    m_pending (false)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+HitListScanStrategy::~HitListScanStrategy ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+HitListScanStrategy::SetHitList (const std::vector<Ipv6Address> &hitList)
+{
+  NS_LOG_FUNCTION (this << hitList.size ());
+  m_hitList = hitList;
+  m_sorted = hitList;
+  std::sort (m_sorted.begin (), m_sorted.end ());
+}
+
+void
+HitListScanStrategy::Prepare (const ScanTargetGenerator *targets)
+{
+  NS_LOG_FUNCTION (this << targets);
+  m_hit = 0;
+  m_generator = *targets;
+  m_generator.Rewind ();
+  m_pending = false;
+  if (m_sweep)
+    {
+      Settle ();
+    }
+}
+
+void
+HitListScanStrategy::Settle (void)
+{
+  m_pending = false;
+  while (m_generator.Next (m_next))
+    {
+      if (!std::binary_search (m_sorted.begin (), m_sorted.end (), m_next))
+        {
+          m_pending = true;
+          return;
+        }
+    }
+}
+
+bool
+HitListScanStrategy::Next (Ipv6Address &address)
+{
+  if (m_hit < m_hitList.size ())
+    {
+      address = m_hitList[m_hit++];
+      return true;
+    }
+  if (!m_pending)
+    {
+      return false;
+    }
+  address = m_next;
+  Settle ();
+  return true;
+}
+
+bool
+HitListScanStrategy::IsDone (void) const
+{
+  return m_hit >= m_hitList.size () && !m_pending;
+}
+
+NS_OBJECT_ENSURE_REGISTERED (OuiScanStrategy);
+
+TypeId
+OuiScanStrategy::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::OuiScanStrategy")
+    .SetParent<ScanStrategy> ()
+    .SetGroupName("Applications")
+    .AddConstructor<OuiScanStrategy> ()
+    .AddAttribute ("Oui",
+                   "The 24 bits vendor Organizationally Unique Identifier",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&OuiScanStrategy::m_oui),
+                   MakeUintegerChecker<uint32_t> (0, 0xffffff))
+    .AddAttribute ("FirstNic",
+                   "The first 24 bits NIC specific value probed in each network",
+                   UintegerValue (1),
+                   MakeUintegerAccessor (&OuiScanStrategy::m_firstNic),
+                   MakeUintegerChecker<uint32_t> (0, 0xffffff))
+  ;
+  return tid;
+}
+
+OuiScanStrategy::OuiScanStrategy ()
+  : m_targets (0),
+    m_oui (0),
+    m_firstNic (1),
+    m_network (0),
+    m_index (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+OuiScanStrategy::~OuiScanStrategy ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+Ipv6Address
+OuiScanStrategy::MakeInterfaceId (uint32_t oui, uint32_t nic)
+{
+  uint8_t iid[16] = { 0 };
+  iid[8] = ((oui >> 16) & 0xff) ^ 0x02;
+  iid[9] = (oui >> 8) & 0xff;
+  iid[10] = oui & 0xff;
+  iid[11] = 0xff;
+  iid[12] = 0xfe;
+  iid[13] = (nic >> 16) & 0xff;
+  iid[14] = (nic >> 8) & 0xff;
+  iid[15] = nic & 0xff;
+  return Ipv6Address (iid);
+}
+
+void
+OuiScanStrategy::Prepare (const ScanTargetGenerator *targets)
+{
+  NS_LOG_FUNCTION (this << targets);
+  m_targets = targets;
+  m_network = 0;
+  m_index = 0;
+  Settle ();
+}
+
+void
+OuiScanStrategy::Settle (void)
+{
+  // The NIC specific part is 24 bits long, the indexes beyond are dropped
+  while (m_network < m_targets->GetNNetworks ()
+         && (m_index >= m_targets->GetCount ()
+             || m_firstNic + m_targets->GetHostIndex (m_index) > 0xffffff))
+    {
+      m_index = 0;
+      ++m_network;
+    }
+}
+
+bool
+OuiScanStrategy::IsDone (void) const
+{
+  return m_targets == 0 || m_network >= m_targets->GetNNetworks ();
+}
+
+bool
+OuiScanStrategy::Next (Ipv6Address &address)
+{
+  if (IsDone ())
+    {
+      return false;
+    }
+  Ipv6Address network = m_targets->GetNetwork (m_network).CombinePrefix (m_targets->GetPrefix (m_network));
+  uint32_t nic = m_firstNic + m_targets->GetHostIndex (m_index);
+  address = ScanTargetGenerator::MakeAddress (network, MakeInterfaceId (m_oui, nic), 0);
+  ++m_index;
+  Settle ();
+  return true;
+}
+
+} // namespace ns3
@@ -0,0 +1,318 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2015 Universite catholique de Louvain
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Lionel Metongnon <lionel.metongnon@uclouvain.be>
+ */
+
+#ifndef SCAN_STRATEGY_H
+#define SCAN_STRATEGY_H
+
+#include "ns3/object.h"
+#include "ns3/ptr.h"
+#include "ns3/ipv6-address.h"
+#include "ns3/random-variable-stream.h"
+#include "scan-target-generator.h"
+
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \ingroup udpecho
+ * \brief Order in which ScanTools visits its target space
+ *
+ * A strategy is bound to the ScanTargetGenerator describing the targeted
+ * networks, the number of hosts per network and the interface ID patterns
+ * of each network.  It then produces the addresses one at a time, in its
+ * own order, using a constant amount of memory.
+ */
+class ScanStrategy : public Object
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  ScanStrategy ();
+  virtual ~ScanStrategy ();
+
+  /**
+   * \brief Bind the strategy to a target space and rewind it
+   * \param targets the target space, must outlive the strategy use
+   */
+  virtual void Prepare (const ScanTargetGenerator *targets) = 0;
+
+  /**
+   * \brief Produce the next target address
+   * \param address filled with the next address
+   * \returns false if the strategy is exhausted
+   */
+  virtual bool Next (Ipv6Address &address) = 0;
+
+  /**
+   * \returns true if all the addresses have been produced
+   */
+  virtual bool IsDone (void) const = 0;
+
+  /**
+   * Assign a fixed random variable stream number to the random variables
+   * used by this strategy.
+   *
+   * \param stream first stream index to use
+   * \return the number of stream indices assigned by this strategy
+   */
+  virtual int64_t AssignStreams (int64_t stream);
+};
+
+/**
+ * \ingroup udpecho
+ * \brief Sequential sweep, network after network
+ *
+ * This is the historical ScanTools order: the hosts of a network are
+ * visited from the base interface ID, 6LoWPAN pattern before WiFi.
+ */
+class SequentialScanStrategy : public ScanStrategy
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  SequentialScanStrategy ();
+  virtual ~SequentialScanStrategy ();
+
+  virtual void Prepare (const ScanTargetGenerator *targets);
+  virtual bool Next (Ipv6Address &address);
+  virtual bool IsDone (void) const;
+
+private:
+  ScanTargetGenerator m_generator; //!< sequential cursor on the targets
+};
+
+/**
+ * \ingroup udpecho
+ * \brief Full-cycle pseudo-random permutation of the target space
+ *
+ * Like ZMap, the slots of the target space are visited by iterating the
+ * multiplicative group of integers modulo a prime p greater than the
+ * number of slots: x(n+1) = g * x(n) mod p where g is a primitive root of
+ * p.  Every slot is produced exactly once and only the current element of
+ * the cycle is stored.  The prime is a safe prime (p = 2q + 1, q prime) so
+ * that primitive roots can be checked without factoring p - 1.
+ */
+class PermutationScanStrategy : public ScanStrategy
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  PermutationScanStrategy ();
+  virtual ~PermutationScanStrategy ();
+
+  virtual void Prepare (const ScanTargetGenerator *targets);
+  virtual bool Next (Ipv6Address &address);
+  virtual bool IsDone (void) const;
+  virtual int64_t AssignStreams (int64_t stream);
+
+  /**
+   * \returns the prime modulus of the cyclic group
+   */
+  uint64_t GetPrime (void) const;
+
+  /**
+   * \returns the generator of the cyclic group
+   */
+  uint64_t GetGenerator (void) const;
+
+  /**
+   * \param n a number
+   * \returns true if n is prime (deterministic for 64 bits numbers)
+   */
+  static bool IsPrime (uint64_t n);
+
+  /**
+   * \returns a * b mod m without overflow
+   * \param a first factor
+   * \param b second factor
+   * \param m modulus
+   */
+  static uint64_t MulMod (uint64_t a, uint64_t b, uint64_t m);
+
+  /**
+   * \returns b ^ e mod m
+   * \param b base
+   * \param e exponent
+   * \param m modulus
+   */
+  static uint64_t PowMod (uint64_t b, uint64_t e, uint64_t m);
+
+private:
+  /**
+   * \brief Move to the next enabled slot of the cycle
+   */
+  void Settle (void);
+
+  const ScanTargetGenerator *m_targets; //!< target space
+  Ptr<UniformRandomVariable> m_random;  //!< generator and start selection
+  uint64_t m_nSlots;    //!< number of slots in the target space
+  uint64_t m_prime;     //!< modulus of the group
+  uint64_t m_generator; //!< primitive root of m_prime
+  uint64_t m_first;     //!< first element of the cycle
+  uint64_t m_current;   //!< current element of the cycle
+  bool m_done;          //!< the cycle is closed
+};
+
+/**
+ * \ingroup udpecho
+ * \brief Strided sweep interleaved across all the networks
+ *
+ * The host indexes are visited in Stride passes (0, s, 2s, ... then 1,
+ * s + 1, ... ) and, for each index, every targeted network is probed
+ * before moving on, so that the probes are spread over all the networks
+ * instead of exhausting them one after the other.
+ */
+class StrideScanStrategy : public ScanStrategy
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  StrideScanStrategy ();
+  virtual ~StrideScanStrategy ();
+
+  virtual void Prepare (const ScanTargetGenerator *targets);
+  virtual bool Next (Ipv6Address &address);
+  virtual bool IsDone (void) const;
+
+private:
+  /**
+   * \brief Move to the next enabled position
+   */
+  void Settle (void);
+
+  const ScanTargetGenerator *m_targets; //!< target space
+  uint32_t m_stride;  //!< distance between two visited host indexes
+  uint32_t m_pass;    //!< current pass, lower than the stride
+  uint32_t m_index;   //!< current host index
+  uint32_t m_network; //!< current network
+  uint32_t m_pattern; //!< current pattern (0 is 6LoWPAN, 1 is WiFi)
+};
+
+/**
+ * \ingroup udpecho
+ * \brief Hit-list seeded scanning
+ *
+ * The addresses of the hit list are probed first, in the given order.
+ * The rest of the target space is then swept sequentially, the addresses
+ * already probed from the hit list being skipped.
+ */
+class HitListScanStrategy : public ScanStrategy
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  HitListScanStrategy ();
+  virtual ~HitListScanStrategy ();
+
+  /**
+   * \brief Set the addresses probed first
+   * \param hitList the hit list
+   */
+  void SetHitList (const std::vector<Ipv6Address> &hitList);
+
+  virtual void Prepare (const ScanTargetGenerator *targets);
+  virtual bool Next (Ipv6Address &address);
+  virtual bool IsDone (void) const;
+
+private:
+  /**
+   * \brief Skip the generated addresses which belong to the hit list
+   */
+  void Settle (void);
+
+  std::vector<Ipv6Address> m_hitList; //!< hit list, in probing order
+  std::vector<Ipv6Address> m_sorted;  //!< sorted copy for the lookups
+  uint32_t m_hit;                     //!< next hit list entry
+  bool m_sweep;                       //!< sweep the space after the list
+  ScanTargetGenerator m_generator;    //!< sweep of the target space
+  bool m_pending;                     //!< m_next holds a sweep address
+  Ipv6Address m_next;                 //!< next sweep address
+};
+
+/**
+ * \ingroup udpecho
+ * \brief EUI-64 vendor targeted scanning
+ *
+ * The interface IDs are derived from MAC addresses of a given vendor as
+ * in \RFC{4291} (Appendix A): OUI with the universal/local bit inverted,
+ * 0xfffe, then the 24 bits NIC specific part.  For every network, MaxRange
+ * NIC values are probed from FirstNic.
+ */
+class OuiScanStrategy : public ScanStrategy
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  OuiScanStrategy ();
+  virtual ~OuiScanStrategy ();
+
+  virtual void Prepare (const ScanTargetGenerator *targets);
+  virtual bool Next (Ipv6Address &address);
+  virtual bool IsDone (void) const;
+
+  /**
+   * \brief Build the EUI-64 interface ID of a MAC address
+   * \param oui the 24 bits vendor OUI
+   * \param nic the 24 bits NIC specific part
+   * \returns the interface ID
+   */
+  static Ipv6Address MakeInterfaceId (uint32_t oui, uint32_t nic);
+
+private:
+  /**
+   * \brief Move to the next network when the NICs of a network are done
+   */
+  void Settle (void);
+
+  const ScanTargetGenerator *m_targets; //!< target space
+  uint32_t m_oui;     //!< vendor OUI
+  uint32_t m_firstNic; //!< first NIC specific value
+  uint32_t m_network; //!< current network
+  uint32_t m_index;   //!< current NIC offset
+};
+
+} // namespace ns3
+
+#endif /* SCAN_STRATEGY_H */
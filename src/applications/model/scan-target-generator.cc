@@ -0,0 +1,270 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2015 Universite catholique de Louvain
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Lionel Metongnon <lionel.metongnon@uclouvain.be>
+ */
+
+#include "ns3/log.h"
+#include "ns3/ipv6-address-list.h"
+
+#include "scan-target-generator.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("ScanTargetGenerator");
+
+ScanTargetGenerator::ScanTargetGenerator ()
+  : m_count (0),
+    m_shard (0),
+    m_nShards (1),
+    m_shardMode (SHARD_BY_NETWORK),
+    m_added (0),
+    m_network (0),
+    m_index (0),
+    m_pattern (SIXLOWPAN)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+Ipv6Address
+ScanTargetGenerator::GetInterfaceId (Pattern pattern)
+{
+  if (pattern == SIXLOWPAN)
+    {
+      return Ipv6Address ("::ff:fe00:1");
+    }
+  return Ipv6Address ("::200:ff:fe00:1");
+}
+
+void
+ScanTargetGenerator::Clear (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_networks.clear ();
+  m_added = 0;
+  Rewind ();
+}
+
+void
+ScanTargetGenerator::SetCount (uint32_t count)
+{
+  NS_LOG_FUNCTION (this << count);
+  m_count = count;
+  Rewind ();
+}
+
+void
+ScanTargetGenerator::SetShard (uint32_t shard, uint32_t nShards, ShardMode mode)
+{
+  NS_LOG_FUNCTION (this << shard << nShards << mode);
+  NS_ASSERT_MSG (nShards > 0 && shard < nShards, "ScanTargetGenerator::SetShard(): invalid shard " << shard << "/" << nShards);
+  NS_ASSERT_MSG (m_added == 0, "ScanTargetGenerator::SetShard(): networks already added");
+  m_shard = shard;
+  m_nShards = nShards;
+  m_shardMode = mode;
+  Rewind ();
+}
+
+uint32_t
+ScanTargetGenerator::GetShard (void) const
+{
+  return m_shard;
+}
+
+uint32_t
+ScanTargetGenerator::GetNShards (void) const
+{
+  return m_nShards;
+}
+
+void
+ScanTargetGenerator::AddNetwork (Ipv6Address network, Ipv6Prefix prefix, uint8_t patterns)
+{
+  NS_LOG_FUNCTION (this << network << prefix << (uint32_t) patterns);
+  if (m_shardMode == SHARD_BY_NETWORK && (m_added++ % m_nShards) != m_shard)
+    {
+      return;
+    }
+  TargetNetwork target;
+  target.network = network;
+  target.prefix = prefix;
+  target.patterns = patterns & (SIXLOWPAN | WIFI);
+  m_networks.push_back (target);
+  Settle ();
+}
+
+uint32_t
+ScanTargetGenerator::GetNNetworks (void) const
+{
+  return m_networks.size ();
+}
+
+uint64_t
+ScanTargetGenerator::GetNTargets (void) const
+{
+  uint64_t targets = 0;
+  for (std::vector<TargetNetwork>::const_iterator i = m_networks.begin (); i != m_networks.end (); ++i)
+    {
+      uint32_t patterns = ((i->patterns & SIXLOWPAN) ? 1 : 0) + ((i->patterns & WIFI) ? 1 : 0);
+      targets += static_cast<uint64_t> (GetCount ()) * patterns;
+    }
+  return targets;
+}
+
+uint64_t
+ScanTargetGenerator::GetNSlots (void) const
+{
+  return static_cast<uint64_t> (m_networks.size ()) * GetCount () * N_PATTERNS;
+}
+
+uint32_t
+ScanTargetGenerator::GetCount (void) const
+{
+  if (m_shardMode == SHARD_BY_NETWORK)
+    {
+      return m_count;
+    }
+  // indexes shard, shard + N, shard + 2N, ... lower than m_count
+  return m_count > m_shard ? (m_count - m_shard - 1) / m_nShards + 1 : 0;
+}
+
+uint64_t
+ScanTargetGenerator::GetHostIndex (uint32_t index) const
+{
+  if (m_shardMode == SHARD_BY_NETWORK)
+    {
+      return index;
+    }
+  return m_shard + static_cast<uint64_t> (index) * m_nShards;
+}
+
+Ipv6Address
+ScanTargetGenerator::GetNetwork (uint32_t network) const
+{
+  NS_ASSERT (network < m_networks.size ());
+  return m_networks[network].network;
+}
+
+Ipv6Prefix
+ScanTargetGenerator::GetPrefix (uint32_t network) const
+{
+  NS_ASSERT (network < m_networks.size ());
+  return m_networks[network].prefix;
+}
+
+bool
+ScanTargetGenerator::GetTarget (uint64_t slot, Ipv6Address &address) const
+{
+  NS_ASSERT (slot < GetNSlots ());
+  Pattern pattern = (slot % N_PATTERNS == 0) ? SIXLOWPAN : WIFI;
+  uint64_t host = slot / N_PATTERNS;
+  uint32_t count = GetCount ();
+  return GetTarget (host / count, pattern, host % count, address);
+}
+
+bool
+ScanTargetGenerator::GetTarget (uint32_t network, Pattern pattern, uint32_t index, Ipv6Address &address) const
+{
+  NS_ASSERT (network < m_networks.size ());
+  const TargetNetwork &target = m_networks[network];
+  if ((target.patterns & pattern) == 0)
+    {
+      return false;
+    }
+  Ipv6Address base = target.network;
+  address = MakeAddress (base.CombinePrefix (target.prefix), GetInterfaceId (pattern), GetHostIndex (index));
+  return true;
+}
+
+Ipv6Address
+ScanTargetGenerator::MakeAddress (Ipv6Address network, Ipv6Address interfaceId, uint64_t index)
+{
+  return Ipv6AddressList::MakeAddress (network, interfaceId, index);
+}
+
+void
+ScanTargetGenerator::Rewind (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_network = 0;
+  m_index = 0;
+  m_pattern = SIXLOWPAN;
+  Settle ();
+}
+
+bool
+ScanTargetGenerator::IsDone (void) const
+{
+  return m_network >= m_networks.size ();
+}
+
+void
+ScanTargetGenerator::Settle (void)
+{
+  uint32_t count = GetCount ();
+  while (m_network < m_networks.size ())
+    {
+      const TargetNetwork &target = m_networks[m_network];
+      if (m_index >= count || target.patterns == 0)
+        {
+          ++m_network;
+          m_index = 0;
+          m_pattern = SIXLOWPAN;
+          continue;
+        }
+      if ((target.patterns & m_pattern) == 0)
+        {
+          if (m_pattern == SIXLOWPAN)
+            {
+              m_pattern = WIFI;
+            }
+          else
+            {
+              m_pattern = SIXLOWPAN;
+              ++m_index;
+            }
+          continue;
+        }
+      return;
+    }
+}
+
+bool
+ScanTargetGenerator::Next (Ipv6Address &address)
+{
+  NS_LOG_FUNCTION (this);
+  if (IsDone ())
+    {
+      return false;
+    }
+  // The address is built from the host index, so that the indexes of an
+  // interleaved shard can be skipped
+  GetTarget (m_network, static_cast<Pattern> (m_pattern), m_index, address);
+  if (m_pattern == SIXLOWPAN)
+    {
+      m_pattern = WIFI;
+    }
+  else
+    {
+      m_pattern = SIXLOWPAN;
+      ++m_index;
+    }
+  Settle ();
+  return true;
+}
+
+} // namespace ns3
@@ -0,0 +1,240 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2015 Universite catholique de Louvain
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Lionel Metongnon <lionel.metongnon@uclouvain.be>
+ */
+
+#ifndef SCAN_TARGET_GENERATOR_H
+#define SCAN_TARGET_GENERATOR_H
+
+#include "ns3/ipv6-address.h"
+
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \ingroup udpecho
+ * \brief Pull-based generator of the addresses probed by ScanTools
+ *
+ * The generator walks the (network, interface ID pattern, index) space
+ * and builds each target address only when it is requested, so the memory
+ * used is proportional to the number of targeted networks and not to the
+ * number of probes.
+ *
+ * For each network, in insertion order, the indexes 0 .. MaxRange-1 are
+ * visited and, for each index, the 6LoWPAN interface ID (::ff:fe00:1 based)
+ * is produced before the WiFi one (::200:ff:fe00:1 based) when both are
+ * enabled for that network.
+ *
+ * The space can be split between several scanners with SetShard (): a
+ * shard either keeps one network out of N (SHARD_BY_NETWORK) or one host
+ * index out of N in every network (SHARD_INTERLEAVED).  The random access
+ * methods then only see the networks and indexes of the shard.
+ */
+class ScanTargetGenerator
+{
+public:
+  /**
+   * \brief Interface ID patterns that can be enabled per network
+   */
+  enum Pattern
+    {
+      SIXLOWPAN = 0x01,
+      WIFI = 0x02
+    };
+
+  /**
+   * \brief How the target space is split between scanners
+   */
+  enum ShardMode
+    {
+      SHARD_BY_NETWORK,  //!< network n belongs to shard n % N
+      SHARD_INTERLEAVED  //!< host index i belongs to shard i % N
+    };
+
+  ScanTargetGenerator ();
+
+  /**
+   * \brief Remove all the networks and rewind the generator
+   */
+  void Clear (void);
+
+  /**
+   * \brief Set the number of hosts to generate per network and pattern
+   * \param count the number of hosts
+   */
+  void SetCount (uint32_t count);
+
+  /**
+   * \brief Restrict the generator to a part of the target space
+   *
+   * Must be called before the networks are added.
+   *
+   * \param shard the shard number, lower than nShards
+   * \param nShards the number of shards
+   * \param mode how the space is split
+   */
+  void SetShard (uint32_t shard, uint32_t nShards, ShardMode mode);
+
+  /**
+   * \returns the shard number
+   */
+  uint32_t GetShard (void) const;
+
+  /**
+   * \returns the number of shards
+   */
+  uint32_t GetNShards (void) const;
+
+  /**
+   * \brief Append a network to the generator
+   *
+   * With SHARD_BY_NETWORK, the networks of the other shards are ignored.
+   *
+   * \param network the network address
+   * \param prefix the network prefix
+   * \param patterns the ScanTargetGenerator::Pattern flags to generate
+   */
+  void AddNetwork (Ipv6Address network, Ipv6Prefix prefix, uint8_t patterns);
+
+  /**
+   * \returns the number of networks added to the generator
+   */
+  uint32_t GetNNetworks (void) const;
+
+  /**
+   * \returns the total number of addresses the generator will produce
+   */
+  uint64_t GetNTargets (void) const;
+
+  /**
+   * \returns the number of slots of the (network, index, pattern) space,
+   * including the slots of the disabled patterns
+   */
+  uint64_t GetNSlots (void) const;
+
+  /**
+   * \brief Random access to the target space
+   *
+   * Slots are numbered in the sequential order: network first, then host
+   * index, then pattern (6LoWPAN before WiFi).
+   *
+   * \param slot the slot number, lower than GetNSlots ()
+   * \param address filled with the address of the slot
+   * \returns false if the pattern of the slot is disabled for its network
+   */
+  bool GetTarget (uint64_t slot, Ipv6Address &address) const;
+
+  /**
+   * \brief Random access to the target space
+   * \param network the network number
+   * \param pattern a single ScanTargetGenerator::Pattern flag
+   * \param index the host index in the network
+   * \param address filled with the target address
+   * \returns false if the pattern is disabled for the network
+   */
+  bool GetTarget (uint32_t network, Pattern pattern, uint32_t index, Ipv6Address &address) const;
+
+  /**
+   * \param network the network number
+   * \returns the network address
+   */
+  Ipv6Address GetNetwork (uint32_t network) const;
+
+  /**
+   * \param network the network number
+   * \returns the network prefix
+   */
+  Ipv6Prefix GetPrefix (uint32_t network) const;
+
+  /**
+   * \returns the number of hosts generated per network and pattern
+   */
+  uint32_t GetCount (void) const;
+
+  /**
+   * \param index a host index of the shard, lower than GetCount ()
+   * \returns the host index in the whole network
+   */
+  uint64_t GetHostIndex (uint32_t index) const;
+
+  /**
+   * \brief Rewind the generator to the first address
+   */
+  void Rewind (void);
+
+  /**
+   * \returns true if all the addresses have been produced
+   */
+  bool IsDone (void) const;
+
+  /**
+   * \brief Produce the next target address
+   * \param address filled with the next address
+   * \returns false if the generator is exhausted
+   */
+  bool Next (Ipv6Address &address);
+
+  /**
+   * \returns the base interface ID of the given pattern
+   * \param pattern a single ScanTargetGenerator::Pattern flag
+   */
+  static Ipv6Address GetInterfaceId (Pattern pattern);
+
+  /**
+   * \brief Build the address made of a network and an interface ID
+   * incremented by an index
+   * \param network the network address
+   * \param interfaceId the base interface ID
+   * \param index the increment of the interface ID
+   * \returns the address
+   */
+  static Ipv6Address MakeAddress (Ipv6Address network, Ipv6Address interfaceId, uint64_t index);
+
+  static const uint32_t N_PATTERNS = 2; //!< number of interface ID patterns
+
+private:
+  /**
+   * \brief A targeted network and the patterns generated for it
+   */
+  struct TargetNetwork
+  {
+    Ipv6Address network; //!< network address
+    Ipv6Prefix prefix;   //!< network prefix
+    uint8_t patterns;    //!< enabled Pattern flags
+  };
+
+  /**
+   * \brief Move the cursor forward to the next enabled position
+   */
+  void Settle (void);
+
+  std::vector<TargetNetwork> m_networks; //!< targeted networks
+  uint32_t m_count;      //!< hosts per network and pattern
+  uint32_t m_shard;      //!< shard number
+  uint32_t m_nShards;    //!< number of shards
+  ShardMode m_shardMode; //!< how the space is split
+  uint32_t m_added;      //!< networks added, including other shards ones
+  uint32_t m_network;    //!< current network
+  uint32_t m_index;      //!< current host index of the shard
+  uint8_t m_pattern;     //!< current pattern flag
+};
+
+} // namespace ns3
+
+#endif /* SCAN_TARGET_GENERATOR_H */
@@ -29,12 +29,16 @@
 #include "ns3/socket-factory.h"
 #include "ns3/packet.h"
 #include "ns3/uinteger.h"
+#include "ns3/pointer.h"
+#include "ns3/double.h"
+#include "ns3/enum.h"
+#include "ns3/boolean.h"
 #include "ns3/trace-source-accessor.h"
 
 #include "scan-tools.h"
-#include "penetration-tools.h"
 
-#include <fstream>
+#include <sstream>
+#include <algorithm>
 
 namespace ns3 {
 
@@ -84,9 +88,94 @@ ScanTools::GetTypeId (void)
                    MakeUintegerAccessor (&ScanTools::SetDataSize,
                                          &ScanTools::GetDataSize),
                    MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("ProbesPerEvent",
+                   "The number of probes sent by each scheduled event. "
+                   "Above 1, the probes are sent with SendTo on a single unconnected socket.",
+                   UintegerValue (1),
+                   MakeUintegerAccessor (&ScanTools::m_probesPerEvent),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddAttribute ("ProbeRate",
+                   "The pacing rate of the batch mode in probes/s, "
+                   "0 keeps one probe per Interval on average",
+                   DoubleValue (0),
+                   MakeDoubleAccessor (&ScanTools::m_probeRate),
+                   MakeDoubleChecker<double> (0))
+    .AddAttribute ("ScanStrategy",
+                   "The order in which the targeted networks are scanned",
+                   PointerValue (),
+                   MakePointerAccessor (&ScanTools::m_strategy),
+                   MakePointerChecker<ScanStrategy> ())
+    .AddAttribute ("ResultFormat",
+                   "The format of the streamed RTT records",
+                   EnumValue (ScanResultSink::TEXT),
+                   MakeEnumAccessor (&ScanTools::m_resultFormat),
+                   MakeEnumChecker (ScanResultSink::TEXT, "Text",
+                                    ScanResultSink::BINARY, "Binary"))
+    .AddAttribute ("Shard",
+                   "The shard of the target space scanned by this application",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&ScanTools::m_shard),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("NShards",
+                   "The number of shards the target space is split in",
+                   UintegerValue (1),
+                   MakeUintegerAccessor (&ScanTools::m_nShards),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddAttribute ("ShardMode",
+                   "How the target space is split between the shards",
+                   EnumValue (ScanTargetGenerator::SHARD_BY_NETWORK),
+                   MakeEnumAccessor (&ScanTools::m_shardMode),
+                   MakeEnumChecker (ScanTargetGenerator::SHARD_BY_NETWORK, "ByNetwork",
+                                    ScanTargetGenerator::SHARD_INTERLEAVED, "Interleaved"))
+    .AddAttribute ("DiscoverySet",
+                   "The set of discovered hosts shared with the other shards",
+                   PointerValue (),
+                   MakePointerAccessor (&ScanTools::m_discovery),
+                   MakePointerChecker<ScanDiscoverySet> ())
+    .AddAttribute ("Window",
+                   "The maximum number of probes in flight. Above 0, the probes are "
+                   "sent on a single unconnected socket, expire after ProbeTimeout "
+                   "and are sent again up to MaxRetries times.",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&ScanTools::m_window),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("ProbeTimeout",
+                   "The time after which an unanswered probe of the window mode expires",
+                   TimeValue (Seconds (1)),
+                   MakeTimeAccessor (&ScanTools::m_probeTimeout),
+                   MakeTimeChecker (NanoSeconds (1)))
+    .AddAttribute ("MaxRetries",
+                   "The number of retransmissions of an expired probe",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&ScanTools::m_maxRetries),
+                   MakeUintegerChecker<uint32_t> (0, 0xfffe))
+    .AddAttribute ("AdaptiveRate",
+                   "Halve the window mode rate when the loss observed on the live hosts "
+                   "exceeds LossThreshold, increase it again otherwise",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&ScanTools::m_adaptiveRate),
+                   MakeBooleanChecker ())
+    .AddAttribute ("LossThreshold",
+                   "The loss ratio above which the adaptive rate is halved",
+                   DoubleValue (0.1),
+                   MakeDoubleAccessor (&ScanTools::m_lossThreshold),
+                   MakeDoubleChecker<double> (0, 1))
+    .AddAttribute ("MinProbeRate",
+                   "The lowest adaptive rate in probes/s",
+                   DoubleValue (1),
+                   MakeDoubleAccessor (&ScanTools::m_minProbeRate),
+                   MakeDoubleChecker<double> (0))
+    .AddAttribute ("MaxProbeRate",
+                   "The highest adaptive rate in probes/s, 0 for the initial rate",
+                   DoubleValue (0),
+                   MakeDoubleAccessor (&ScanTools::m_maxProbeRate),
+                   MakeDoubleChecker<double> (0))
     .AddTraceSource ("Tx", "A new packet is created and is sent",
                      MakeTraceSourceAccessor (&ScanTools::m_txTrace),
                      "ns3::Packet::TracedCallback")
+    .AddTraceSource ("HostDiscovered", "A host replied for the first time",
+                     MakeTraceSourceAccessor (&ScanTools::m_hostDiscoveredTrace),
+                     "ns3::ScanTools::HostDiscoveredCallback")
   ;
   return tid;
 }
@@ -97,19 +186,35 @@ ScanTools::ScanTools ()
   m_sent = 0;
   m_socket = 0;
   m_sendEvent = EventId ();
-  m_data = 0;
-  m_dataSize = 0;
   m_scanType = INTERLACE;
+  m_probesPerEvent = 1;
+  m_probeRate = 0;
+  m_resultFormat = ScanResultSink::TEXT;
+  m_shard = 0;
+  m_nShards = 1;
+  m_shardMode = ScanTargetGenerator::SHARD_BY_NETWORK;
+  m_window = 0;
+  m_maxRetries = 0;
+  m_adaptiveRate = false;
+  m_lossThreshold = 0.1;
+  m_minProbeRate = 1;
+  m_maxProbeRate = 0;
+  m_baseRate = 0;
+  m_currentRate = 0;
+  m_inFlight = 0;
+  m_epochReplies = 0;
+  m_epochLost = 0;
+  m_probesMetric = 0;
+  m_retriesMetric = 0;
+  m_repliesMetric = 0;
+  m_rttMetric = 0;
 }
 
 ScanTools::~ScanTools()
 {
   NS_LOG_FUNCTION (this);
   m_socket = 0;
-  m_targetedAddresses.clear ();
-  delete [] m_data;
-  m_data = 0;
-  m_dataSize = 0;
+  m_targets.Clear ();
 }
 
 void 
@@ -124,6 +229,9 @@ void
 ScanTools::DoDispose (void)
 {
   NS_LOG_FUNCTION (this);
+  m_strategy = 0;
+  m_discovery = 0;
+  m_metrics = 0;
   Application::DoDispose ();
 }
 
@@ -131,6 +239,11 @@ void
 ScanTools::StartApplication (void)
 {
   NS_LOG_FUNCTION (this);
+  m_metrics = MetricsRegistry::Get ();
+  m_probesMetric = m_metrics->GetCounter ("scan.probes");
+  m_retriesMetric = m_metrics->GetCounter ("scan.retries");
+  m_repliesMetric = m_metrics->GetCounter ("scan.replies");
+  m_rttMetric = m_metrics->GetHistogram ("scan.rtt");
   GenerateAddresses ();
 }
 
@@ -149,14 +262,72 @@ ScanTools::SetScanType (ScanTools::ScanType scanType)
   NS_LOG_FUNCTION (this);
   m_scanType = scanType;
 }
+
+void
+ScanTools::SetScanStrategy (Ptr<ScanStrategy> strategy)
+{
+  NS_LOG_FUNCTION (this << strategy);
+  m_strategy = strategy;
+}
+
+int64_t
+ScanTools::AssignStreams (int64_t stream)
+{
+  NS_LOG_FUNCTION (this << stream);
+  if (m_strategy == 0)
+    {
+      m_strategy = CreateObject<SequentialScanStrategy> ();
+    }
+  return m_strategy->AssignStreams (stream);
+}
+
+void
+ScanTools::SetShard (uint32_t shard, uint32_t nShards, ScanTargetGenerator::ShardMode mode)
+{
+  NS_LOG_FUNCTION (this << shard << nShards << mode);
+  NS_ABORT_MSG_UNLESS (nShards > 0 && shard < nShards, "ScanTools::SetShard(): invalid shard " << shard << "/" << nShards);
+  m_shard = shard;
+  m_nShards = nShards;
+  m_shardMode = mode;
+}
+
+void
+ScanTools::SetDiscoverySet (Ptr<ScanDiscoverySet> discovery)
+{
+  NS_LOG_FUNCTION (this << discovery);
+  m_discovery = discovery;
+}
+
+Ptr<ScanDiscoverySet>
+ScanTools::GetDiscoverySet (void) const
+{
+  return m_discovery;
+}
+
+void
+ScanTools::AddDiscoveryConsumer (Callback<void, Ipv6Address> consumer)
+{
+  NS_LOG_FUNCTION (this);
+  m_hostDiscoveredTrace.ConnectWithoutContext (consumer);
+}
+
+uint32_t
+ScanTools::GetInFlight (void) const
+{
+  return m_inFlight;
+}
+
+double
+ScanTools::GetCurrentProbeRate (void) const
+{
+  return m_currentRate;
+}
 void
 ScanTools::Scanning ()
 {
   NS_LOG_FUNCTION (this);
-  if (!m_targetedAddresses.empty ())
+  if (m_strategy->Next (m_peerAddress))
     {
-      m_peerAddress = m_targetedAddresses.front ();
-      m_targetedAddresses.pop_front ();
       if (m_socket == 0)
         {
           TypeId tid = TypeId::LookupByName ("ns3::UdpSocketFactory");
@@ -174,118 +345,87 @@ void
 ScanTools::GenerateAddresses ()
 {
   NS_LOG_FUNCTION (this);
-  Ipv6AddressList ipv6AddressList = Ipv6AddressList();
-  Ipv6AddressList ipv6AddressList6LoWPAN = Ipv6AddressList();
+  // Only the networks are stored, the addresses are produced on demand
+  // by the generator each time Scanning () needs a new target
+  m_targets.Clear ();
+  m_targets.SetCount (m_count);
+  NS_ABORT_MSG_UNLESS (m_shard < m_nShards, "ScanTools: Shard " << m_shard << " out of NShards " << m_nShards);
+  m_targets.SetShard (m_shard, m_nShards, m_shardMode);
   int index = 0;
   for (std::map<Ipv6Address, Ipv6Prefix>::iterator i = m_targetedNetworks.begin(); i != m_targetedNetworks.end(); ++i, ++index)
     {
-      ipv6AddressList.Init (i->first, i->second, Ipv6Address ("::200:ff:fe00:1"));
-      ipv6AddressList6LoWPAN.Init (i->first, i->second, Ipv6Address ("::ff:fe00:1"));
-      for (uint32_t k = 0; k < m_count; ++k)
+      uint8_t patterns = 0;
+      if (m_scanType == INTERLACE || m_scanType == SIXLOWPAN_ONLY || (m_scanType == SIXLOWPAN_FIRST && index % 2 == 0) || (m_scanType == WIFI_FIRST && index % 2 != 0))
         {
-          if (m_scanType == INTERLACE || m_scanType == SIXLOWPAN_ONLY || (m_scanType == SIXLOWPAN_FIRST && index % 2 == 0) || (m_scanType == WIFI_FIRST && index % 2 != 0))
-            {
-              m_targetedAddresses.push_back (ipv6AddressList6LoWPAN.NextAddress (i->second));
-            }
-          if (m_scanType == INTERLACE || m_scanType == WIFI_ONLY || (m_scanType == WIFI_FIRST && index % 2 == 0) || (m_scanType == SIXLOWPAN_FIRST && index % 2 != 0))
-            {
-              m_targetedAddresses.push_back (ipv6AddressList.NextAddress (i->second));
-            }
+          patterns |= ScanTargetGenerator::SIXLOWPAN;
+        }
+      if (m_scanType == INTERLACE || m_scanType == WIFI_ONLY || (m_scanType == WIFI_FIRST && index % 2 == 0) || (m_scanType == SIXLOWPAN_FIRST && index % 2 != 0))
+        {
+          patterns |= ScanTargetGenerator::WIFI;
         }
+      m_targets.AddNetwork (i->first, i->second, patterns);
+    }
+  NS_LOG_INFO (m_targets.GetNTargets () << " addresses to scan in " << m_targets.GetNNetworks () << " networks");
+  if (m_strategy == 0)
+    {
+      m_strategy = CreateObject<SequentialScanStrategy> ();
+    }
+  m_strategy->Prepare (&m_targets);
+  m_probes.Clear ();
+  // The number of discovered hosts is only known at the end, the results
+  // are streamed under a name unique to this node and renamed by Save ()
+  std::ostringstream name;
+  name << GetDataSize () << "_node" << GetNode ()->GetId ();
+  m_results.SetFormat (m_resultFormat);
+  m_results.Open (ScanResultSink::SCANNING, name.str ());
+  // Every probed address gets an entry.  Only a small table is reserved,
+  // it doubles as the probes are sent instead of sizing the whole space
+  m_probes.Reserve (std::min<uint64_t> (m_targets.GetNTargets (), 1 << 12));
+  if (m_window > 0 || m_probesPerEvent > 1)
+    {
+      if (m_socket == 0)
+        {
+          TypeId tid = TypeId::LookupByName ("ns3::UdpSocketFactory");
+          m_socket = Socket::CreateSocket (GetNode (), tid);
+          m_socket->Bind6();
+        }
+      m_socket->SetRecvCallback (MakeCallback (&ScanTools::HandleRead, this));
+      if (m_window > 0)
+        {
+          StartWindow ();
+        }
+      else
+        {
+          ScheduleBatch (GetBatchInterval ());
+        }
+    }
+  else
+    {
+      Scanning ();
     }
-    // for (std::list<Ipv6Address>::iterator i = m_targetedAddresses.begin(); i != m_targetedAddresses.end(); ++i)
-    //   {
-    //     NS_LOG_INFO (*i);
-    //   }
-    Scanning ();
 }
 
 void
 ScanTools::Save (void)
 {
-  if (m_targetedAddresses.empty ())
+  NS_LOG_FUNCTION (this);
+  if (m_strategy == 0
+      || (m_strategy->IsDone () && m_retries.empty () && m_inFlight == 0))
     {
+      // The records have been streamed as the replies came, only the
+      // per-/64 summary is left to write.  The node keeps the name unique
+      // when several shards discover the same number of hosts
       std::ostringstream oss;
       oss << GetDataSize();
       oss << "_";
       oss << m_victimAddresses.size();
-
-      std::ofstream resultFile, detailResultFile, plot;
-      resultFile.open ( std::string("./data/"+oss.str()+"_scanning.rst").c_str(), std::ofstream::out | std::ofstream::trunc);
-      detailResultFile.open ( std::string("./data/"+oss.str()+"_scanning_details.rst").c_str(), std::ofstream::out | std::ofstream::trunc);
-      plot.open ( std::string("./plot/"+oss.str()+"_scanning.dat").c_str(), std::ofstream::out | std::ofstream::trunc);
-      plot << "#\tX\tY\tZ\tU" << std::endl;
-      // for (std::list<Ipv6Address>::iterator i = m_victimAddresses.begin(); i != m_victimAddresses.end(); ++i)
-      //   {
-      //     NS_LOG_INFO (*i);
-      //   }
-      bool data (false);
-      Time delta;
-      Time meanTime (0), maxTime (0), minTime (0);
-      uint8_t oldIp[16], newIp[16];
-      uint32_t count = 0;
-      memset(oldIp, 0, sizeof(oldIp));
-      for (std::map<Ipv6Address, std::vector<Time> >::iterator i = record.begin();
-         i != record.end(); ++i)
-        {       
-          if (i->second.size() < 2)
-            {
-              // record.erase (i);
-              // plot << i->first <<"\t"<< i->second.at(0).GetSeconds() <<"\t"<< i->second.at(0).GetSeconds() <<"\t"<< -1 << std::endl;
-              continue;
-            }
-          data = true;
-          delta = i->second.at (1) - i->second.at (0);
-
-          // plot data
-          plot << i->first <<"\t"<< i->second.at(0).GetSeconds() <<"\t"<< i->second.at(1).GetSeconds() <<"\t"<< delta.GetSeconds() << std::endl;
-
-          i->first.GetBytes (newIp);
-          memset (newIp + 8, 0x00, 8);
-          Ipv6Address networkAddress (newIp);
-
-          if (strlen((char *)oldIp) == 0) 
-            {
-              memcpy(oldIp, newIp, sizeof(oldIp));
-              meanTime = maxTime = minTime = delta;
-              count = 1;
-            }
-          else
-            {
-              if (networkAddress.IsEqual(Ipv6Address(oldIp))) 
-                {
-                  meanTime += delta;
-                  maxTime = std::max(maxTime, delta);
-                  minTime = std::min(minTime, delta);
-                  ++count;
-                }
-              else 
-                {
-                  resultFile << Ipv6Address(oldIp) << "\tmin : " << minTime.GetSeconds() * 1000 << "ms"
-                    << "\tmax : " << maxTime.GetSeconds() * 1000 << "ms" << "\tmean : " 
-                    << (meanTime/count).GetSeconds() * 1000 << "ms" << std::endl;
-                  // NS_LOG_INFO ("" << Ipv6Address(oldIp) << "\tmin : " << minTime.GetSeconds() * 1000 << "ms"
-                  //   << "\tmax :" << maxTime.GetSeconds() * 1000 << "ms" << "\tmean : " << (meanTime/count).GetSeconds() * 1000 << "ms");
-                  memcpy(oldIp, newIp, sizeof(oldIp));
-                  meanTime = maxTime = minTime = delta;
-                  count = 1;
-                }
-            }
-          // NS_LOG_INFO (i->first<< "\tSending time : " << i->second.at (0).GetSeconds() << "s\tIncomming time : " 
-          //   <<  i->second.at (1).GetSeconds() << "s\tdelta " << delta.GetSeconds() * 1000 << "ms" );
-          detailResultFile << i->first<< "\tSending time : " << i->second.at (0).GetSeconds() << "s\tIncomming time : " 
-            <<  i->second.at (1).GetSeconds() << "s\tdelta " << delta.GetSeconds() * 1000 << "ms" << std::endl;
-        }
-
-      if (data)
-        {
-          resultFile << Ipv6Address(oldIp) << "\tmin : " << minTime.GetSeconds() * 1000 << "ms"
-          << "\tmax : " << maxTime.GetSeconds() * 1000 << "ms" << "\tmean : " 
-          << (meanTime/count).GetSeconds() * 1000 << "ms"<< std::endl;
-        }
-      resultFile.close();
-      detailResultFile.close();
-      plot.close ();
+      oss << "_node";
+      oss << GetNode ()->GetId ();
+      m_results.Close (oss.str ());
+    }
+  else
+    {
+      m_results.Abort ();
     }
 }
 
@@ -301,11 +441,8 @@ ScanTools::StopApplication ()
       m_socket = 0;
     }
   Simulator::Cancel (m_sendEvent);
+  Simulator::Cancel (m_timeoutEvent);
   Save ();
-  // Retrieve the penetration application
-  Ptr<PenetrationTools> penetrationTool = GetNode()->GetApplication(1)->GetObject <PenetrationTools>();
-  std::list<Ipv6Address> victimAddresses (m_victimAddresses.begin (), m_victimAddresses.end ());
-  penetrationTool->StartPenetration (victimAddresses);
 }
 
 void 
@@ -318,17 +455,14 @@ ScanTools::SetDataSize (uint32_t dataSize)
   // that she doesn't care about the contents of the packet at all, so 
   // neither will we.
   //
-  delete [] m_data;
-  m_data = 0;
-  m_dataSize = 0;
-  m_size = dataSize;
+  m_payload.SetSize (dataSize);
 }
 
 uint32_t 
 ScanTools::GetDataSize (void) const
 {
   NS_LOG_FUNCTION (this);
-  return m_size;
+  return m_payload.GetSize ();
 }
 
 void 
@@ -345,55 +479,229 @@ ScanTools::Send (void)
 
   NS_ASSERT (m_sendEvent.IsExpired ());
 
-  Ptr<Packet> p;
-  if (m_dataSize)
-    {
-      //
-      // If m_dataSize is non-zero, we have a data buffer of the same size that we
-      // are expected to copy and send.  This state of affairs is created if one of
-      // the Fill functions is called.  In this case, m_size must have been set
-      // to agree with m_dataSize
-      //
-      NS_ASSERT_MSG (m_dataSize == m_size, "ScanTools::Send(): m_size and m_dataSize inconsistent");
-      NS_ASSERT_MSG (m_data, "ScanTools::Send(): m_dataSize but no m_data");
-      p = Create<Packet> (m_data, m_dataSize);
-    }
-  else
-    {
-      //
-      // If m_dataSize is zero, the attacker has indicated that it doesn't care
-      // about the data itself either by specifying the data size by setting
-      // the corresponding attribute or by not calling a SetFill function.  In
-      // this case, we don't worry about it either.  But we do allow m_size
-      // to have a value different from the (zero) m_dataSize.
-      //
-      p = Create<Packet> (m_size);
-    }
+  // Copy-on-write copy of the shared payload, no data is duplicated
+  Ptr<Packet> p = m_payload.Copy ();
   // call to the trace sinks before the packet is actually sent,
   // so that tags added to the packet can be sent as well
   m_txTrace (p);
   m_socket->Send (p);
 
   ++m_sent;
+  m_probesMetric->Add ();
 
-  Time outcommingPacketTime(Simulator::Now ());
-  // Insert in a map
-  record.insert (std::pair<Ipv6Address, std::vector<Time> >(m_peerAddress, std::vector<Time> () ));
-  record[m_peerAddress].push_back (outcommingPacketTime);
-
-  NS_LOG_INFO ("At time " << outcommingPacketTime.GetSeconds () << "s attacker sent " << m_size << " bytes to " <<
-               m_peerAddress << " port " << m_peerPort);
+  RecordProbe (m_peerAddress);
 
-  if (!m_targetedAddresses.empty ()) 
+  if (!m_strategy->IsDone ()) 
     {
       Scanning ();
     }
 }
+
+Time
+ScanTools::GetBatchInterval (void) const
+{
+  if (m_probeRate > 0)
+    {
+      return Seconds (m_probesPerEvent / m_probeRate);
+    }
+  return m_interval * m_probesPerEvent;
+}
+
+void
+ScanTools::ScheduleBatch (Time dt)
+{
+  NS_LOG_FUNCTION (this << dt);
+  m_sendEvent = Simulator::Schedule (dt, &ScanTools::SendBatch, this);
+}
+
+void
+ScanTools::SendBatch (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  NS_ASSERT (m_sendEvent.IsExpired ());
+
+  Ipv6Address target;
+  for (uint32_t i = 0; i < m_probesPerEvent && m_strategy->Next (target); ++i)
+    {
+      Ptr<Packet> p = m_payload.Copy ();
+      m_txTrace (p);
+      m_socket->SendTo (p, 0, Inet6SocketAddress (target, m_peerPort));
+      ++m_sent;
+      m_probesMetric->Add ();
+      RecordProbe (target);
+    }
+
+  if (!m_strategy->IsDone ())
+    {
+      ScheduleBatch (GetBatchInterval ());
+    }
+}
+
+void
+ScanTools::StartWindow (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_baseRate = m_probeRate > 0 ? m_probeRate : 1 / m_interval.GetSeconds ();
+  m_currentRate = m_baseRate;
+  m_inFlight = 0;
+  m_retries.clear ();
+  // A few ticks per timeout are enough, the expiry is at most one tick late
+  m_timeouts.SetResolution (m_probeTimeout / 8, 64);
+  m_epochReplies = 0;
+  m_epochLost = 0;
+  m_nextAdapt = Simulator::Now () + m_probeTimeout;
+  // Same first send time as the batch mode
+  m_nextSend = Simulator::Now () + Seconds (m_probesPerEvent / m_currentRate);
+  ResumeWindow ();
+}
+
+void
+ScanTools::ResumeWindow (void)
+{
+  if (m_socket == 0 || m_sendEvent.IsRunning () || m_inFlight >= m_window
+      || (m_retries.empty () && m_strategy->IsDone ()))
+    {
+      // Nothing to send or no room in the window: a reply or a timeout
+      // will call again
+      return;
+    }
+  Time now = Simulator::Now ();
+  m_sendEvent = Simulator::Schedule (m_nextSend > now ? m_nextSend - now : Seconds (0),
+                                     &ScanTools::SendWindow, this);
+}
+
+void
+ScanTools::SendWindow (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  NS_ASSERT (m_sendEvent.IsExpired ());
+
+  Time now = Simulator::Now ();
+  Ipv6Address target;
+  for (uint32_t i = 0; i < m_probesPerEvent && m_inFlight < m_window; ++i)
+    {
+      bool retry = false;
+      while (!retry && !m_retries.empty ())
+        {
+          target = m_retries.front ();
+          m_retries.pop_front ();
+          // The reply may have come after the timeout
+          retry = !m_probes.Find (target)->IsReplied ();
+        }
+      if (!retry && !m_strategy->Next (target))
+        {
+          break;
+        }
+      Ptr<Packet> p = m_payload.Copy ();
+      m_txTrace (p);
+      m_socket->SendTo (p, 0, Inet6SocketAddress (target, m_peerPort));
+      ++m_sent;
+      m_probesMetric->Add ();
+      if (retry)
+        {
+          m_retriesMetric->Add ();
+          m_probes.RecordRetry (target, now);
+          NS_LOG_INFO ("At time " << now.GetSeconds () << "s attacker sent again " << m_payload.GetSize () << " bytes to " << target);
+        }
+      else
+        {
+          RecordProbe (target);
+        }
+      ++m_inFlight;
+      m_timeouts.Schedule (target, now + m_probeTimeout);
+    }
+  if (!m_timeoutEvent.IsRunning () && m_timeouts.GetSize () > 0)
+    {
+      m_timeoutEvent = Simulator::Schedule (m_timeouts.GetTick (), &ScanTools::ExpireProbes, this);
+    }
+  m_nextSend = now + Seconds (m_probesPerEvent / m_currentRate);
+  ResumeWindow ();
+}
+
+void
+ScanTools::ExpireProbes (void)
+{
+  NS_LOG_FUNCTION (this);
+  std::vector<Ipv6Address> expired;
+  m_timeouts.Expire (Simulator::Now (), expired);
+  for (std::vector<Ipv6Address>::const_iterator i = expired.begin (); i != expired.end (); ++i)
+    {
+      // The timeouts of the answered probes are not cancelled, skip them
+      if (!m_probes.RecordTimeout (*i))
+        {
+          continue;
+        }
+      --m_inFlight;
+      if (m_probes.Find (*i)->attempts <= m_maxRetries)
+        {
+          m_retries.push_back (*i);
+        }
+    }
+  if (m_adaptiveRate && Simulator::Now () >= m_nextAdapt)
+    {
+      AdaptRate ();
+      m_nextAdapt = Simulator::Now () + m_probeTimeout;
+    }
+  if (m_timeouts.GetSize () > 0)
+    {
+      m_timeoutEvent = Simulator::Schedule (m_timeouts.GetTick (), &ScanTools::ExpireProbes, this);
+    }
+  ResumeWindow ();
+}
+
+void
+ScanTools::AdaptRate (void)
+{
+  NS_LOG_FUNCTION (this);
+  // Most of the probes of a scan target unused addresses and expire
+  // normally, the loss is measured on the hosts which did answer: the
+  // probes they needed before answering were lost
+  if (m_epochReplies == 0)
+    {
+      return;
+    }
+  double loss = m_epochLost / static_cast<double> (m_epochLost + m_epochReplies);
+  double maxRate = m_maxProbeRate > 0 ? m_maxProbeRate : m_baseRate;
+  if (loss > m_lossThreshold)
+    {
+      m_currentRate = std::max (m_currentRate / 2, std::min (m_minProbeRate, maxRate));
+    }
+  else
+    {
+      m_currentRate = std::min (m_currentRate + m_baseRate / 10, maxRate);
+    }
+  NS_LOG_INFO ("Loss " << loss << " over " << m_epochReplies << " hosts, rate " << m_currentRate << " probes/s");
+  m_epochReplies = 0;
+  m_epochLost = 0;
+}
+
+void
+ScanTools::RecordProbe (Ipv6Address target)
+{
+  Time outcommingPacketTime(Simulator::Now ());
+  // Only the first probe of an address is timed
+  m_probes.RecordSend (target, outcommingPacketTime);
+
+  NS_LOG_INFO ("At time " << outcommingPacketTime.GetSeconds () << "s attacker sent " << m_payload.GetSize () << " bytes to " <<
+               target << " port " << m_peerPort);
+}
+
 void
 ScanTools::AddToTargetList (Ipv6Address victimAddress)
 {
   NS_LOG_FUNCTION (this << victimAddress);
-  m_victimAddresses.insert (victimAddress);
+  if (!m_victimAddresses.insert (victimAddress).second)
+    {
+      return;
+    }
+  m_metrics->CountDiscovered (victimAddress);
+  // Coordinated scanning: only hand over the hosts owned by this shard
+  if (m_discovery == 0 || m_discovery->Add (victimAddress, m_shard))
+    {
+      m_hostDiscoveredTrace (victimAddress);
+    }
 }
 
 void
@@ -405,12 +713,30 @@ ScanTools::HandleRead (Ptr<Socket> socket)
   if ((packet = socket->RecvFrom (from)))
     {
       Ipv6Address sender(Inet6SocketAddress::ConvertFrom (from).GetIpv6 ());
+      m_repliesMetric->Add ();
 
-      // save the incomming packet time in the map
-      record[sender].push_back (Simulator::Now ());
+      const ProbeTable::Entry *entry = m_probes.Find (sender);
+      bool inFlight = entry != 0 && entry->IsInFlight ();
+      // save the incomming packet time in the probe table
+      if (m_probes.RecordReply (sender, Simulator::Now ()))
+        {
+          entry = m_probes.Find (sender);
+          if (entry->replies == 1)
+            {
+              m_results.RecordRtt (sender, entry->GetFirstSend (), entry->GetFirstReply ());
+              m_rttMetric->Record (entry->GetFirstReply () - entry->GetFirstSend ());
+              m_epochLost += entry->attempts - 1;
+              ++m_epochReplies;
+            }
+        }
       NS_LOG_INFO ("At time " << Simulator::Now ().GetSeconds () << "s attacker received " << packet->GetSize () << " bytes from " <<
                    sender << " port " << Inet6SocketAddress::ConvertFrom (from).GetPort ());
       AddToTargetList (sender);
+      if (inFlight && m_window > 0)
+        {
+          --m_inFlight;
+          ResumeWindow ();
+        }
     }
 }
 
@@ -28,9 +28,18 @@
 #include "ns3/traced-callback.h"
 #include "ns3/timer.h"
 #include "ns3/ipv6-address-list.h"
+#include "scan-target-generator.h"
+#include "scan-strategy.h"
+#include "probe-table.h"
+#include "scan-result-sink.h"
+#include "scan-discovery-set.h"
+#include "probe-timer-wheel.h"
+#include "payload-template.h"
+#include "metrics-registry.h"
 
 #include <vector>
 #include <map>
+#include <deque>
 
 namespace ns3 {
 
@@ -111,6 +120,77 @@ public:
   void SetTargetedNetworks (std::map<Ipv6Address, Ipv6Prefix> &targetedNetworks);
   void SetScanType (ScanTools::ScanType scanType);
 
+  /**
+   * \brief Set the order in which the target space is visited
+   * \param strategy the scan strategy, SequentialScanStrategy if null
+   */
+  void SetScanStrategy (Ptr<ScanStrategy> strategy);
+
+  /**
+   * Assign a fixed random variable stream number to the random variables
+   * used by this application.
+   *
+   * \param stream first stream index to use
+   * \return the number of stream indices assigned by this application
+   */
+  int64_t AssignStreams (int64_t stream);
+
+  /**
+   * \brief Scan only a part of the targeted space
+   *
+   * The coordinated scanners of a same target space use the same number
+   * of shards and mode, each one with its own shard number.
+   *
+   * \param shard the shard scanned by this application
+   * \param nShards the number of shards
+   * \param mode how the space is split
+   */
+  void SetShard (uint32_t shard, uint32_t nShards, ScanTargetGenerator::ShardMode mode);
+
+  /**
+   * \brief Share the discovered hosts with the other scanners
+   *
+   * The HostDiscovered trace is then only fired for the hosts owned by the
+   * shard of this application.
+   *
+   * \param discovery the set shared by the coordinated scanners
+   */
+  void SetDiscoverySet (Ptr<ScanDiscoverySet> discovery);
+
+  /**
+   * \returns the shared set of discovered hosts, or 0
+   */
+  Ptr<ScanDiscoverySet> GetDiscoverySet (void) const;
+
+  /**
+   * \brief Subscribe to the discovered hosts
+   *
+   * The consumer is called as soon as a host replies for the first time,
+   * while the scan goes on, for instance to let a PenetrationTools attack
+   * it right away.  This is the HostDiscovered trace source.
+   *
+   * \param consumer the callback receiving the host address
+   */
+  void AddDiscoveryConsumer (Callback<void, Ipv6Address> consumer);
+
+  /**
+   * TracedCallback signature for the discovered hosts.
+   *
+   * \param [in] address The address of the host.
+   */
+  typedef void (* HostDiscoveredCallback)(Ipv6Address address);
+
+  /**
+   * \returns the number of probes of the window mode which are neither
+   * answered nor expired
+   */
+  uint32_t GetInFlight (void) const;
+
+  /**
+   * \returns the current pacing rate of the window mode, in probes/s
+   */
+  double GetCurrentProbeRate (void) const;
+
 protected:
   virtual void DoDispose (void);
 
@@ -127,6 +207,58 @@ private:
    */
   void Send (void);
 
+  /**
+   * \returns the time between two batches of probes
+   */
+  Time GetBatchInterval (void) const;
+
+  /**
+   * \brief Schedule the next batch of probes
+   * \param dt time before the batch
+   */
+  void ScheduleBatch (Time dt);
+
+  /**
+   * \brief Send up to ProbesPerEvent probes on the unconnected socket
+   */
+  void SendBatch (void);
+
+  /**
+   * \brief Start the window mode: up to Window probes in flight
+   */
+  void StartWindow (void);
+
+  /**
+   * \brief Schedule the next window send, if the window has room and
+   * there is something to send
+   */
+  void ResumeWindow (void);
+
+  /**
+   * \brief Send up to ProbesPerEvent probes, retransmissions first
+   */
+  void SendWindow (void);
+
+  /**
+   * \brief Expire the unanswered probes and queue their retransmission
+   */
+  void ExpireProbes (void);
+
+  /**
+   * \brief Adapt the window mode rate to the loss observed on the live
+   * hosts (AIMD)
+   */
+  void AdaptRate (void);
+
+  /**
+   * \brief Record the sending time of a probe
+   * \param target the probed address
+   */
+  void RecordProbe (Ipv6Address target);
+
+  /**
+   * \brief Close the streamed results, under their final name
+   */
   void Save (void);
 
   /**
@@ -140,10 +272,9 @@ private:
 
   uint32_t m_count; //!< Maximum number of packets the application will send
   Time m_interval; //!< Packet inter-send time
-  uint32_t m_size; //!< Size of the sent packet
-
-  uint32_t m_dataSize; //!< packet payload size (must be equal to m_size)
-  uint8_t *m_data; //!< packet payload data
+  uint32_t m_probesPerEvent; //!< Probes sent by each batch event
+  double m_probeRate; //!< Probes per second in batch mode (0: one probe per Interval)
+  PayloadTemplate m_payload; //!< Payload shared by all the probes
   ScanTools::ScanType m_scanType;
 
   uint32_t m_sent; //!< Counter for sent packets
@@ -151,10 +282,41 @@ private:
   Ipv6Address m_peerAddress; //!< Remote peer address
   std::map<Ipv6Address, Ipv6Prefix> m_targetedNetworks;
   uint16_t m_peerPort; //!< Remote peer port
-  std::list<Ipv6Address> m_targetedAddresses;
+  ScanTargetGenerator m_targets; //!< Lazy generator of the scanned addresses
+  Ptr<ScanStrategy> m_strategy; //!< Order in which m_targets is visited
   std::set<Ipv6Address> m_victimAddresses;
   EventId m_sendEvent; //!< Event to send the next packet
-  std::map<Ipv6Address, std::vector<Time> > record ;
+  ProbeTable m_probes; //!< Sending and reply times of the probes
+  ScanResultSink m_results; //!< Streamed RTT records
+  ScanResultSink::Format m_resultFormat; //!< Format of the result files
+  uint32_t m_shard; //!< Shard of the target space scanned
+  uint32_t m_nShards; //!< Number of shards of the target space
+  ScanTargetGenerator::ShardMode m_shardMode; //!< How the target space is split
+  Ptr<ScanDiscoverySet> m_discovery; //!< Hosts discovered by all the shards
+
+  uint32_t m_window; //!< Maximum probes in flight (0: window mode disabled)
+  Time m_probeTimeout; //!< Time before an unanswered probe expires
+  uint32_t m_maxRetries; //!< Retransmissions of an unanswered probe
+  bool m_adaptiveRate; //!< Adapt the rate to the observed loss
+  double m_lossThreshold; //!< Loss above which the rate is halved
+  double m_minProbeRate; //!< Lowest adapted rate, in probes/s
+  double m_maxProbeRate; //!< Highest adapted rate, in probes/s (0: initial rate)
+  double m_baseRate; //!< Initial rate of the window mode, in probes/s
+  double m_currentRate; //!< Current rate of the window mode, in probes/s
+  uint32_t m_inFlight; //!< Probes neither answered nor expired
+  std::deque<Ipv6Address> m_retries; //!< Expired probes to send again
+  ProbeTimerWheel m_timeouts; //!< Timeouts of the probes in flight
+  EventId m_timeoutEvent; //!< Next expiry of the timer wheel
+  Time m_nextSend; //!< Earliest time of the next window send
+  Time m_nextAdapt; //!< Time of the next rate adaptation
+  uint32_t m_epochReplies; //!< Live hosts answered since the last adaptation
+  uint32_t m_epochLost; //!< Probes lost before these answers
+
+  Ptr<MetricsRegistry> m_metrics; //!< Campaign metrics
+  MetricsCounter *m_probesMetric; //!< scan.probes
+  MetricsCounter *m_retriesMetric; //!< scan.retries
+  MetricsCounter *m_repliesMetric; //!< scan.replies
+  MetricsHistogram *m_rttMetric; //!< scan.rtt, of the first replies
 
   // Timer m_time; //!< waiting time before changing address for scanning 
   // struct hostAlive {
@@ -165,6 +327,9 @@ private:
 
   /// Callbacks for tracing the packet Tx events
   TracedCallback<Ptr<const Packet> > m_txTrace;
+
+  /// Callbacks for tracing the discovered hosts
+  TracedCallback<Ipv6Address> m_hostDiscoveredTrace;
 };
 
 } // namespace ns3
@@ -0,0 +1,385 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2015 Universite catholique de Louvain
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Lionel Metongnon <lionel.metongnon@uclouvain.be>
+ */
+
+#include "ns3/test.h"
+#include "ns3/packet.h"
+#include "ns3/coap-header.h"
+#include "ns3/coap-server.h"
+#include "ns3/attacker-table.h"
+#include "ns3/sim-coap-helper.h"
+#include "ns3/enum.h"
+#include "ns3/uinteger.h"
+#include "ns3/simulator.h"
+#include "ns3/mac48-address.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv6-address-helper.h"
+#include "ns3/simple-net-device.h"
+#include "ns3/simple-channel.h"
+
+#include <sstream>
+#include <utility>
+#include <vector>
+
+using namespace ns3;
+
+/**
+ * Check the wire format of the CoapHeader and its decoding
+ */
+class CoapHeaderTestCase : public TestCase
+{
+public:
+  CoapHeaderTestCase ();
+  virtual ~CoapHeaderTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+CoapHeaderTestCase::CoapHeaderTestCase ()
+  : TestCase ("Check the CoAP header codec")
+{
+}
+
+CoapHeaderTestCase::~CoapHeaderTestCase ()
+{
+}
+
+void
+CoapHeaderTestCase::DoRun (void)
+{
+  CoapHeader header;
+  header.SetType (CoapHeader::CON);
+  header.SetCode (CoapHeader::GET);
+  header.SetMessageId (0x1234);
+  header.SetToken (0xbeef, 2);
+  // added out of order, sorted by the header
+  NS_TEST_ASSERT_MSG_EQ (header.AddOption (300, 7), true, "Option not added");
+  NS_TEST_ASSERT_MSG_EQ (header.AddUriPath ("sensors/temperature"), true, "Uri-Path not added");
+  NS_TEST_ASSERT_MSG_EQ (header.AddOption (CoapHeader::CONTENT_FORMAT, 50), true, "Option not added");
+  NS_TEST_ASSERT_MSG_EQ (header.AddOption (CoapHeader::OBSERVE, 0), true, "Option not added");
+  header.SetPayloadMarker (true);
+
+  // 4 + token 2 + Observe 1 + "sensors" 8 + "temperature" 12 + Content-Format 2 + option 300 4 + marker 1
+  NS_TEST_ASSERT_MSG_EQ (header.GetSerializedSize (), 34, "Wrong header size");
+
+  Ptr<Packet> packet = Create<Packet> (reinterpret_cast<const uint8_t *> ("hi"), 3);
+  packet->AddHeader (header);
+  NS_TEST_ASSERT_MSG_EQ (packet->GetSize (), 37, "Wrong packet size");
+
+  uint8_t bytes[37];
+  packet->CopyData (bytes, sizeof (bytes));
+  const uint8_t expected[] = { 0x42, 0x01, 0x12, 0x34, 0xbe, 0xef,
+                               0x60,                  // Observe, empty
+                               0x57, 's', 'e', 'n', 's', 'o', 'r', 's',
+                               0x0b, 't', 'e', 'm', 'p', 'e', 'r', 'a', 't', 'u', 'r', 'e',
+                               0x11, 50,              // Content-Format
+                               0xe1, 0x00, 0x13, 7,   // delta 288 = 269 + 19
+                               0xff };
+  for (uint32_t i = 0; i < sizeof (expected); ++i)
+    {
+      NS_TEST_ASSERT_MSG_EQ (static_cast<uint32_t> (bytes[i]), static_cast<uint32_t> (expected[i]), "Wrong byte " << i);
+    }
+
+  CoapHeader decoded;
+  NS_TEST_ASSERT_MSG_EQ (packet->RemoveHeader (decoded), 34, "Header not decoded");
+  NS_TEST_ASSERT_MSG_EQ (packet->GetSize (), 3, "Payload not left in the packet");
+  NS_TEST_ASSERT_MSG_EQ (decoded.GetType (), CoapHeader::CON, "Wrong type");
+  NS_TEST_ASSERT_MSG_EQ (static_cast<uint32_t> (decoded.GetCode ()), CoapHeader::GET, "Wrong code");
+  NS_TEST_ASSERT_MSG_EQ (decoded.IsRequest (), true, "GET is a request");
+  NS_TEST_ASSERT_MSG_EQ (decoded.GetMessageId (), 0x1234, "Wrong message ID");
+  NS_TEST_ASSERT_MSG_EQ (decoded.GetToken (), 0xbeef, "Wrong token");
+  NS_TEST_ASSERT_MSG_EQ (decoded.HasPayloadMarker (), true, "Payload marker lost");
+  NS_TEST_ASSERT_MSG_EQ (decoded.GetNOptions (), 5, "Wrong number of options");
+  NS_TEST_ASSERT_MSG_EQ (decoded.MatchUriPath ("sensors/temperature"), true, "Uri-Path not matched");
+  NS_TEST_ASSERT_MSG_EQ (decoded.MatchUriPath ("/sensors/temperature/"), true, "Uri-Path not matched");
+  NS_TEST_ASSERT_MSG_EQ (decoded.MatchUriPath ("sensors"), false, "Uri-Path prefix matched");
+  NS_TEST_ASSERT_MSG_EQ (decoded.MatchUriPath ("sensors/temperature/max"), false, "Longer Uri-Path matched");
+  NS_TEST_ASSERT_MSG_EQ (decoded.GetUriPath (), "sensors/temperature", "Wrong Uri-Path");
+  uint32_t value = 1;
+  NS_TEST_ASSERT_MSG_EQ (decoded.GetOption (CoapHeader::OBSERVE, value), true, "Observe lost");
+  NS_TEST_ASSERT_MSG_EQ (value, 0, "Wrong Observe");
+  NS_TEST_ASSERT_MSG_EQ (decoded.GetOption (CoapHeader::CONTENT_FORMAT, value), true, "Content-Format lost");
+  NS_TEST_ASSERT_MSG_EQ (value, 50, "Wrong Content-Format");
+  NS_TEST_ASSERT_MSG_EQ (decoded.GetOption (300, value), true, "Option lost");
+  NS_TEST_ASSERT_MSG_EQ (value, 7, "Wrong option value");
+  NS_TEST_ASSERT_MSG_EQ (decoded.GetOption (CoapHeader::MAX_AGE, value), false, "Missing option found");
+
+  // a truncated message, a message of another protocol
+  Ptr<Packet> truncated = Create<Packet> (bytes, 20);
+  NS_TEST_ASSERT_MSG_EQ (truncated->PeekHeader (decoded), 0, "Truncated message decoded");
+  uint8_t zeros[20] = { 0 };
+  Ptr<Packet> probe = Create<Packet> (zeros, sizeof (zeros));
+  NS_TEST_ASSERT_MSG_EQ (probe->PeekHeader (decoded), 0, "Not a CoAP message");
+
+  // an empty acknowledgement is the fixed part only
+  CoapHeader ack;
+  ack.SetType (CoapHeader::ACK);
+  ack.SetMessageId (7);
+  Ptr<Packet> empty = Create<Packet> ();
+  empty->AddHeader (ack);
+  NS_TEST_ASSERT_MSG_EQ (empty->GetSize (), 4, "Wrong empty message size");
+  NS_TEST_ASSERT_MSG_EQ (empty->PeekHeader (decoded), 4, "Empty message not decoded");
+  NS_TEST_ASSERT_MSG_EQ (decoded.HasPayloadMarker (), false, "Payload marker in an empty message");
+  NS_TEST_ASSERT_MSG_EQ (decoded.GetNOptions (), 0, "Options in an empty message");
+
+  // the fixed storage bounds the options
+  CoapHeader full;
+  for (uint32_t i = 0; i < CoapHeader::MAX_OPTIONS; ++i)
+    {
+      NS_TEST_ASSERT_MSG_EQ (full.AddOption (CoapHeader::URI_QUERY, i), true, "Option not added");
+    }
+  NS_TEST_ASSERT_MSG_EQ (full.AddOption (CoapHeader::URI_QUERY, 1), false, "Too many options");
+}
+
+/**
+ * Check the lookups and the least recently seen eviction of the
+ * AttackerTable
+ */
+class AttackerTableTestCase : public TestCase
+{
+public:
+  AttackerTableTestCase ();
+  virtual ~AttackerTableTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+AttackerTableTestCase::AttackerTableTestCase ()
+  : TestCase ("Check the table of the attackers")
+{
+}
+
+AttackerTableTestCase::~AttackerTableTestCase ()
+{
+}
+
+void
+AttackerTableTestCase::DoRun (void)
+{
+  AttackerTable table;
+  table.SetCapacity (3);
+  Ipv6Address a ("2001:1::1");
+  Ipv6Address b ("2001:1::2");
+  Ipv6Address c ("2001:1::3");
+  Ipv6Address d ("2001:1::4");
+
+  NS_TEST_ASSERT_MSG_EQ (table.Lookup (a), 0, "Unknown attacker found");
+  table.Insert (a, false);
+  table.Insert (b, true);
+  table.Insert (c, false);
+  NS_TEST_ASSERT_MSG_EQ (table.GetSize (), 3, "Attackers not all added");
+  NS_TEST_ASSERT_MSG_EQ (table.GetCompromised (), 1, "Wrong number of successful attackers");
+  AttackerTable::Record *record = table.Lookup (b);
+  NS_TEST_ASSERT_MSG_NE (record, 0, "Attacker lost");
+  NS_TEST_ASSERT_MSG_EQ (record->compromised, true, "Outcome lost");
+  NS_TEST_ASSERT_MSG_EQ (record->attempts, 1, "Wrong number of attempts");
+
+  // a is now the least recently seen
+  table.Lookup (c);
+  table.Insert (d, false);
+  NS_TEST_ASSERT_MSG_EQ (table.GetSize (), 3, "Capacity exceeded");
+  NS_TEST_ASSERT_MSG_EQ (table.GetEvictions (), 1, "Attacker not evicted");
+  NS_TEST_ASSERT_MSG_EQ (table.Lookup (a), 0, "Least recently seen attacker kept");
+  NS_TEST_ASSERT_MSG_NE (table.Lookup (b), 0, "Recently seen attacker evicted");
+  NS_TEST_ASSERT_MSG_NE (table.Lookup (c), 0, "Recently seen attacker evicted");
+  NS_TEST_ASSERT_MSG_NE (table.Lookup (d), 0, "New attacker lost");
+
+  // b is now the least recently seen, its outcome goes with it
+  table.Insert (a, false);
+  NS_TEST_ASSERT_MSG_EQ (table.Lookup (b), 0, "Least recently seen attacker kept");
+  NS_TEST_ASSERT_MSG_EQ (table.GetCompromised (), 0, "Evicted outcome still counted");
+
+  // many more attackers than entries
+  for (uint32_t i = 0; i < 1000; ++i)
+    {
+      uint8_t bytes[16] = { 0x20, 0x01, 0x00, 0x02 };
+      bytes[14] = i >> 8;
+      bytes[15] = i & 0xff;
+      Ipv6Address attacker (bytes);
+      if (table.Lookup (attacker) == 0)
+        {
+          table.Insert (attacker, i % 2 == 0);
+        }
+    }
+  NS_TEST_ASSERT_MSG_EQ (table.GetSize (), 3, "Capacity exceeded");
+  NS_TEST_ASSERT_MSG_EQ (table.GetEvictions (), 1002, "Attackers not evicted");
+  NS_TEST_ASSERT_MSG_EQ (table.GetCompromised (), 1, "Wrong number of successful attackers");
+
+  table.Clear ();
+  NS_TEST_ASSERT_MSG_EQ (table.GetSize (), 0, "Attackers not removed");
+  NS_TEST_ASSERT_MSG_EQ (table.Lookup (d), 0, "Attacker not removed");
+}
+
+/**
+ * Poll eight clients in a polling mode and check the rounds
+ */
+class CoapPollTestCase : public TestCase
+{
+public:
+  /**
+   * \param mode the polling mode
+   */
+  CoapPollTestCase (CoapServer::PollMode mode);
+  virtual ~CoapPollTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * \brief Record the end of a round
+   * \param answered the number of responses of the round
+   * \param duration the duration of the round
+   */
+  void Round (uint32_t answered, Time duration);
+
+  CoapServer::PollMode m_mode; //!< polling mode
+  std::vector<std::pair<uint32_t, Time> > m_rounds; //!< responses and duration of the rounds
+};
+
+CoapPollTestCase::CoapPollTestCase (CoapServer::PollMode mode)
+  : TestCase ("Check the polling of the CoAP clients"),
+    m_mode (mode)
+{
+}
+
+CoapPollTestCase::~CoapPollTestCase ()
+{
+}
+
+void
+CoapPollTestCase::Round (uint32_t answered, Time duration)
+{
+  m_rounds.push_back (std::make_pair (answered, duration));
+}
+
+void
+CoapPollTestCase::DoRun (void)
+{
+  NodeContainer n;
+  n.Create (9);
+
+  InternetStackHelper internet;
+  internet.SetIpv4StackInstall (false);
+  internet.Install (n);
+
+  Ptr<SimpleChannel> channel = CreateObject<SimpleChannel> ();
+  NetDeviceContainer d;
+  for (uint32_t i = 0; i < n.GetN (); ++i)
+    {
+      Ptr<SimpleNetDevice> dev = CreateObject<SimpleNetDevice> ();
+      std::ostringstream mac;
+      mac << "00:00:00:00:00:0" << i + 1;
+      dev->SetAddress (Mac48Address (mac.str ().c_str ()));
+      dev->SetChannel (channel);
+      n.Get (i)->AddDevice (dev);
+      d.Add (dev);
+    }
+
+  Ipv6AddressHelper ipv6;
+  ipv6.SetBase (Ipv6Address ("2001:1::"), Ipv6Prefix (64));
+  ipv6.Assign (d);
+  std::vector<Ipv6Address> clients;
+  for (uint32_t i = 1; i < n.GetN (); ++i)
+    {
+      std::ostringstream address;
+      address << "2001:1::200:ff:fe00:" << i + 1;
+      clients.push_back (Ipv6Address (address.str ().c_str ()));
+    }
+
+  SimCoapClientHelper client (5683);
+  client.SetAttribute ("Leisure", TimeValue (MilliSeconds (500)));
+  client.SetAttribute ("NotifyInterval", TimeValue (Seconds (1)));
+  for (uint32_t i = 1; i < n.GetN (); ++i)
+    {
+      ApplicationContainer apps = client.Install (n.Get (i));
+      apps.Start (Seconds (0));
+      apps.Stop (Seconds (6));
+    }
+
+  // three requests at a time, the clients answer after 200 ms
+  SimCoapServerHelper server (5683);
+  server.SetAttribute ("Interval", TimeValue (Seconds (1)));
+  server.SetAttribute ("Delay", TimeValue (Seconds (0)));
+  server.SetAttribute ("Window", UintegerValue (3));
+  server.SetAttribute ("Timeout", TimeValue (Seconds (1)));
+  server.SetAttribute ("Mode", EnumValue (m_mode));
+  ApplicationContainer apps = server.Install (n.Get (0), clients);
+  Ptr<CoapServer> poller = apps.Get (0)->GetObject<CoapServer> ();
+  poller->TraceConnectWithoutContext ("Round", MakeCallback (&CoapPollTestCase::Round, this));
+  apps.Start (Seconds (0));
+  apps.Stop (Seconds (5.5));
+
+  Simulator::Run ();
+
+  NS_TEST_ASSERT_MSG_GT_OR_EQ (m_rounds.size (), 2, "Rounds not repeated");
+  NS_TEST_ASSERT_MSG_EQ (m_rounds[0].first, clients.size (), "Clients not all answering");
+  if (m_mode == CoapServer::UNICAST)
+    {
+      // three waves of requests, instead of eight requests one after the other
+      NS_TEST_ASSERT_MSG_GT (m_rounds[0].second, MilliSeconds (600), "Window not respected");
+      NS_TEST_ASSERT_MSG_LT (m_rounds[0].second, MilliSeconds (1000), "Requests not concurrent");
+      for (uint32_t i = 1; i < m_rounds.size (); ++i)
+        {
+          NS_TEST_ASSERT_MSG_EQ (m_rounds[i].first, clients.size (), "Clients not all answering");
+        }
+      NS_TEST_ASSERT_MSG_GT_OR_EQ (poller->GetSent (), clients.size () * m_rounds.size (), "Clients not all polled");
+    }
+  else if (m_mode == CoapServer::MULTICAST)
+    {
+      // a request per round, the responses are collected until the timeout
+      for (uint32_t i = 0; i < m_rounds.size (); ++i)
+        {
+          NS_TEST_ASSERT_MSG_EQ (m_rounds[i].first, clients.size (), "Clients not all answering");
+          NS_TEST_ASSERT_MSG_EQ (m_rounds[i].second, Seconds (1), "Responses not collected during the timeout");
+        }
+      NS_TEST_ASSERT_MSG_LT_OR_EQ (poller->GetSent (), m_rounds.size () + 1, "Group request not shared");
+    }
+  else
+    {
+      // registered once, then notified every second
+      NS_TEST_ASSERT_MSG_EQ (poller->GetObservers (), clients.size (), "Clients not all observed");
+      NS_TEST_ASSERT_MSG_EQ (poller->GetSent (), clients.size (), "Observers polled again");
+      for (uint32_t i = 1; i < m_rounds.size (); ++i)
+        {
+          NS_TEST_ASSERT_MSG_EQ (m_rounds[i].first, 0, "Observers polled again");
+        }
+      NS_TEST_ASSERT_MSG_GT_OR_EQ (poller->GetReceived (), 4 * clients.size (), "Notifications missing");
+    }
+
+  Simulator::Destroy ();
+}
+
+class CoapTestSuite : public TestSuite
+{
+public:
+  CoapTestSuite ();
+};
+
+CoapTestSuite::CoapTestSuite ()
+  : TestSuite ("coap", UNIT)
+{
+  AddTestCase (new CoapHeaderTestCase, TestCase::QUICK);
+  AddTestCase (new AttackerTableTestCase, TestCase::QUICK);
+  AddTestCase (new CoapPollTestCase (CoapServer::UNICAST), TestCase::QUICK);
+  AddTestCase (new CoapPollTestCase (CoapServer::MULTICAST), TestCase::QUICK);
+  AddTestCase (new CoapPollTestCase (CoapServer::OBSERVE), TestCase::QUICK);
+}
+
+static CoapTestSuite coapTestSuite;
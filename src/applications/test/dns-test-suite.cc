@@ -0,0 +1,575 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2015 Universite catholique de Louvain
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Lionel Metongnon <lionel.metongnon@uclouvain.be>
+ */
+
+#include "ns3/test.h"
+#include "ns3/packet.h"
+#include "ns3/dns-header.h"
+#include "ns3/dns-zone.h"
+#include "ns3/dns-server.h"
+#include "ns3/dns-vicious-client.h"
+#include "ns3/dns-helper.h"
+#include "ns3/double.h"
+#include "ns3/enum.h"
+#include "ns3/string.h"
+#include "ns3/data-rate.h"
+#include "ns3/packet-sink-helper.h"
+#include "ns3/uinteger.h"
+#include "ns3/simulator.h"
+#include "ns3/mac48-address.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv6-address-helper.h"
+#include "ns3/inet6-socket-address.h"
+#include "ns3/socket.h"
+#include "ns3/udp-socket-factory.h"
+#include "ns3/simple-net-device.h"
+#include "ns3/simple-channel.h"
+
+#include <map>
+#include <set>
+#include <sstream>
+#include <vector>
+
+using namespace ns3;
+
+/**
+ * Check the wire format of the DNS messages and their decoding
+ */
+class DnsHeaderTestCase : public TestCase
+{
+public:
+  DnsHeaderTestCase ();
+  virtual ~DnsHeaderTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+DnsHeaderTestCase::DnsHeaderTestCase ()
+  : TestCase ("Check the DNS header and record codec")
+{
+}
+
+DnsHeaderTestCase::~DnsHeaderTestCase ()
+{
+}
+
+void
+DnsHeaderTestCase::DoRun (void)
+{
+  DnsHeader query;
+  query.SetId (0x1234);
+  query.SetRecursionDesired (true);
+  NS_TEST_ASSERT_MSG_EQ (query.SetQuestion ("Example.com.", DnsHeader::TYPE_ANY), true, "Question not set");
+  query.SetAdditionalCount (1);
+  NS_TEST_ASSERT_MSG_EQ (query.GetSerializedSize (), 29, "Wrong header size");
+
+  Ptr<Packet> packet = Create<Packet> ();
+  packet->AddHeader (DnsResourceRecord::CreateOpt (4096));
+  packet->AddHeader (query);
+  NS_TEST_ASSERT_MSG_EQ (packet->GetSize (), 40, "Wrong query size");
+
+  uint8_t bytes[40];
+  packet->CopyData (bytes, sizeof (bytes));
+  const uint8_t expected[] = { 0x12, 0x34, 0x01, 0x00, 0, 1, 0, 0, 0, 0, 0, 1,
+                               7, 'E', 'x', 'a', 'm', 'p', 'l', 'e', 3, 'c', 'o', 'm', 0,
+                               0, 255, 0, 1,
+                               0, 0, 41, 0x10, 0x00, 0, 0, 0, 0, 0, 0 };
+  for (uint32_t i = 0; i < sizeof (expected); ++i)
+    {
+      NS_TEST_ASSERT_MSG_EQ (static_cast<uint32_t> (bytes[i]), static_cast<uint32_t> (expected[i]), "Wrong byte " << i);
+    }
+
+  DnsHeader decoded;
+  NS_TEST_ASSERT_MSG_EQ (packet->RemoveHeader (decoded), 29, "Header not decoded");
+  NS_TEST_ASSERT_MSG_EQ (decoded.GetId (), 0x1234, "Wrong ID");
+  NS_TEST_ASSERT_MSG_EQ (decoded.IsResponse (), false, "Query decoded as a response");
+  NS_TEST_ASSERT_MSG_EQ (decoded.IsRecursionDesired (), true, "RD flag lost");
+  NS_TEST_ASSERT_MSG_EQ (decoded.GetQuestionName (), "Example.com", "Wrong question name");
+  NS_TEST_ASSERT_MSG_EQ (decoded.GetQuestionType (), DnsHeader::TYPE_ANY, "Wrong question type");
+  NS_TEST_ASSERT_MSG_EQ (decoded.GetQuestionClass (), DnsHeader::CLASS_IN, "Wrong question class");
+  NS_TEST_ASSERT_MSG_EQ (decoded.GetAdditionalCount (), 1, "Wrong additional count");
+  DnsResourceRecord opt;
+  NS_TEST_ASSERT_MSG_EQ (packet->RemoveHeader (opt), 11, "OPT record not decoded");
+  NS_TEST_ASSERT_MSG_EQ (opt.GetType (), DnsHeader::TYPE_OPT, "Wrong OPT type");
+  NS_TEST_ASSERT_MSG_EQ (opt.GetClass (), 4096, "Wrong UDP payload size");
+
+  // the flags of a response
+  decoded.SetResponse (true);
+  decoded.SetTruncated (true);
+  decoded.SetRcode (DnsHeader::NXDOMAIN);
+  NS_TEST_ASSERT_MSG_EQ (decoded.IsResponse (), true, "QR flag not set");
+  NS_TEST_ASSERT_MSG_EQ (decoded.IsTruncated (), true, "TC flag not set");
+  NS_TEST_ASSERT_MSG_EQ (static_cast<uint32_t> (decoded.GetRcode ()), DnsHeader::NXDOMAIN, "Wrong rcode");
+  NS_TEST_ASSERT_MSG_EQ (decoded.IsRecursionDesired (), true, "RD flag lost");
+
+  // a truncated message, a compressed question, an invalid name
+  Ptr<Packet> truncated = Create<Packet> (bytes, 20);
+  NS_TEST_ASSERT_MSG_EQ (truncated->PeekHeader (decoded), 0, "Truncated message decoded");
+  uint8_t pointer[] = { 0, 1, 0, 0, 0, 1, 0, 0, 0, 0, 0, 0, 0xc0, 0x0c, 0, 1, 0, 1 };
+  Ptr<Packet> compressed = Create<Packet> (pointer, sizeof (pointer));
+  NS_TEST_ASSERT_MSG_EQ (compressed->PeekHeader (decoded), 0, "Compressed question decoded");
+  NS_TEST_ASSERT_MSG_EQ (query.SetQuestion ("a..b", DnsHeader::TYPE_A), false, "Empty label accepted");
+  NS_TEST_ASSERT_MSG_EQ (query.SetQuestion (std::string (64, 'a'), DnsHeader::TYPE_A), false, "Long label accepted");
+
+  // a TXT answer is split in character strings, its owner is the question
+  DnsResourceRecord txt;
+  txt.SetCompressed (true);
+  txt.SetType (DnsHeader::TYPE_TXT);
+  txt.SetTtl (60);
+  txt.SetText (std::string (300, 'x'));
+  NS_TEST_ASSERT_MSG_EQ (txt.GetData ().size (), 302, "Wrong TXT data size");
+  NS_TEST_ASSERT_MSG_EQ (static_cast<uint32_t> (txt.GetData ()[0]), 255, "Wrong first string length");
+  NS_TEST_ASSERT_MSG_EQ (static_cast<uint32_t> (txt.GetData ()[256]), 45, "Wrong second string length");
+  Ptr<Packet> answer = Create<Packet> ();
+  answer->AddHeader (txt);
+  NS_TEST_ASSERT_MSG_EQ (answer->GetSize (), 314, "Wrong record size");
+  DnsResourceRecord record;
+  NS_TEST_ASSERT_MSG_EQ (answer->RemoveHeader (record), 314, "Record not decoded");
+  NS_TEST_ASSERT_MSG_EQ (record.IsCompressed (), true, "Pointer not decoded");
+  NS_TEST_ASSERT_MSG_EQ (record.GetType (), DnsHeader::TYPE_TXT, "Wrong record type");
+  NS_TEST_ASSERT_MSG_EQ (record.GetTtl (), 60, "Wrong TTL");
+  NS_TEST_ASSERT_MSG_EQ (record.GetData ().size (), 302, "Wrong record data size");
+}
+
+/**
+ * Check the lookup of the names and of the records by type
+ */
+class DnsZoneTestCase : public TestCase
+{
+public:
+  DnsZoneTestCase ();
+  virtual ~DnsZoneTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+DnsZoneTestCase::DnsZoneTestCase ()
+  : TestCase ("Check the DNS zone table")
+{
+}
+
+DnsZoneTestCase::~DnsZoneTestCase ()
+{
+}
+
+void
+DnsZoneTestCase::DoRun (void)
+{
+  DnsZone zone;
+  DnsResourceRecord a;
+  a.SetType (DnsHeader::TYPE_A);
+  const uint8_t address[4] = { 192, 0, 2, 1 };
+  a.SetData (address, sizeof (address));
+  DnsResourceRecord txt;
+  txt.SetType (DnsHeader::TYPE_TXT);
+  txt.SetText ("hello");
+
+  // enough names to grow the table several times
+  for (uint32_t i = 0; i < 100; ++i)
+    {
+      std::ostringstream name;
+      name << "host" << i << ".example.com";
+      NS_TEST_ASSERT_MSG_EQ (zone.AddRecord (name.str (), a), true, "Record not added");
+    }
+  NS_TEST_ASSERT_MSG_EQ (zone.AddRecord ("example.com", txt), true, "Record not added");
+  NS_TEST_ASSERT_MSG_EQ (zone.AddRecord ("example.com", a), true, "Record not added");
+  NS_TEST_ASSERT_MSG_EQ (zone.AddRecord ("example.com", txt), true, "Record not added");
+  NS_TEST_ASSERT_MSG_EQ (zone.AddRecord ("bad..name", a), false, "Invalid name added");
+  NS_TEST_ASSERT_MSG_EQ (zone.GetSize (), 101, "Wrong number of names");
+
+  uint8_t name[DnsHeader::MAX_NAME_LENGTH];
+  uint32_t length = DnsHeader::EncodeName ("EXAMPLE.com", name);
+  const uint8_t *data;
+  uint32_t size;
+  uint16_t count;
+  NS_TEST_ASSERT_MSG_EQ (zone.GetAnswers (name, length, DnsHeader::TYPE_TXT, data, size, count), true, "Name not found");
+  NS_TEST_ASSERT_MSG_EQ (count, 2, "Wrong number of TXT records");
+  NS_TEST_ASSERT_MSG_EQ (size, 2 * 18, "Wrong size of TXT records");
+  NS_TEST_ASSERT_MSG_EQ (zone.GetAnswers (name, length, DnsHeader::TYPE_ANY, data, size, count), true, "Name not found");
+  NS_TEST_ASSERT_MSG_EQ (count, 3, "Wrong number of records");
+  NS_TEST_ASSERT_MSG_EQ (size, 16 + 2 * 18, "Wrong size of records");
+  // the A record comes first, its owner pointing to the question
+  NS_TEST_ASSERT_MSG_EQ (static_cast<uint32_t> (data[0]), 0xc0, "Owner not compressed");
+  NS_TEST_ASSERT_MSG_EQ (static_cast<uint32_t> (data[3]), DnsHeader::TYPE_A, "Records not sorted by type");
+  NS_TEST_ASSERT_MSG_EQ (zone.GetAnswers (name, length, DnsHeader::TYPE_AAAA, data, size, count), true, "Name not found");
+  NS_TEST_ASSERT_MSG_EQ (count, 0, "Missing type answered");
+
+  length = DnsHeader::EncodeName ("host42.example.com", name);
+  NS_TEST_ASSERT_MSG_EQ (zone.GetAnswers (name, length, DnsHeader::TYPE_A, data, size, count), true, "Name not found");
+  NS_TEST_ASSERT_MSG_EQ (count, 1, "Wrong number of A records");
+  length = DnsHeader::EncodeName ("host100.example.com", name);
+  NS_TEST_ASSERT_MSG_EQ (zone.GetAnswers (name, length, DnsHeader::TYPE_A, data, size, count), false, "Missing name found");
+}
+
+/**
+ * Send queries to a DnsServer and check the size of the responses
+ */
+class DnsServerTestCase : public TestCase
+{
+public:
+  /**
+   * \param rrl true to check the rate limiting
+   */
+  DnsServerTestCase (bool rrl);
+  virtual ~DnsServerTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * \brief Send a query
+   * \param socket the client socket
+   * \param name the question name, empty to send 100 bytes
+   * \param type the question type
+   * \param udpSize the EDNS0 UDP payload size, 0 without EDNS0
+   */
+  void Query (Ptr<Socket> socket, std::string name, uint16_t type, uint16_t udpSize);
+  /**
+   * \brief Record a response
+   * \param socket the client socket
+   */
+  void Receive (Ptr<Socket> socket);
+
+  bool m_rrl; //!< check the rate limiting
+  Ipv6Address m_server; //!< address of the server
+  std::vector<uint32_t> m_sizes; //!< size of the responses
+  std::vector<DnsHeader> m_headers; //!< header of the responses
+};
+
+DnsServerTestCase::DnsServerTestCase (bool rrl)
+  : TestCase (rrl ? "Check the response rate limiting of the DNS server" : "Check the responses of the DNS server"),
+    m_rrl (rrl)
+{
+}
+
+DnsServerTestCase::~DnsServerTestCase ()
+{
+}
+
+void
+DnsServerTestCase::Query (Ptr<Socket> socket, std::string name, uint16_t type, uint16_t udpSize)
+{
+  Ptr<Packet> packet = Create<Packet> ();
+  if (name.empty ())
+    {
+      packet = Create<Packet> (100);
+    }
+  else
+    {
+      DnsHeader query;
+      query.SetQuestion (name, type);
+      if (udpSize > 0)
+        {
+          packet->AddHeader (DnsResourceRecord::CreateOpt (udpSize));
+          query.SetAdditionalCount (1);
+        }
+      packet->AddHeader (query);
+    }
+  socket->SendTo (packet, 0, Inet6SocketAddress (m_server, 53));
+}
+
+void
+DnsServerTestCase::Receive (Ptr<Socket> socket)
+{
+  Ptr<Packet> packet;
+  while ((packet = socket->Recv ()))
+    {
+      m_sizes.push_back (packet->GetSize ());
+      DnsHeader header;
+      packet->PeekHeader (header);
+      m_headers.push_back (header);
+    }
+}
+
+void
+DnsServerTestCase::DoRun (void)
+{
+  NodeContainer n;
+  n.Create (2);
+
+  InternetStackHelper internet;
+  internet.SetIpv4StackInstall (false);
+  internet.Install (n);
+
+  Ptr<SimpleChannel> channel = CreateObject<SimpleChannel> ();
+  NetDeviceContainer d;
+  for (uint32_t i = 0; i < n.GetN (); ++i)
+    {
+      Ptr<SimpleNetDevice> dev = CreateObject<SimpleNetDevice> ();
+      std::ostringstream mac;
+      mac << "00:00:00:00:00:0" << i + 1;
+      dev->SetAddress (Mac48Address (mac.str ().c_str ()));
+      dev->SetChannel (channel);
+      n.Get (i)->AddDevice (dev);
+      d.Add (dev);
+    }
+
+  Ipv6AddressHelper ipv6;
+  ipv6.SetBase (Ipv6Address ("2001:1::"), Ipv6Prefix (64));
+  ipv6.Assign (d);
+  m_server = Ipv6Address ("2001:1::200:ff:fe00:1");
+
+  DnsServerHelper server (53);
+  if (m_rrl)
+    {
+      server.SetAttribute ("RrlRate", DoubleValue (5));
+      server.SetAttribute ("RrlSlip", UintegerValue (2));
+    }
+  ApplicationContainer apps = server.Install (n.Get (0));
+  Ptr<DnsServer> dns = apps.Get (0)->GetObject<DnsServer> ();
+  apps.Start (Seconds (0.5));
+  apps.Stop (Seconds (10.0));
+
+  Ptr<Socket> client = Socket::CreateSocket (n.Get (1), UdpSocketFactory::GetTypeId ());
+  client->Bind (Inet6SocketAddress (Ipv6Address::GetAny (), 5353));
+  client->SetRecvCallback (MakeCallback (&DnsServerTestCase::Receive, this));
+
+  if (m_rrl)
+    {
+      for (uint32_t i = 0; i < 20; ++i)
+        {
+          Simulator::Schedule (Seconds (1.0) + MilliSeconds (i), &DnsServerTestCase::Query, this,
+                               client, "example.com", DnsHeader::TYPE_A, 4096);
+        }
+      Simulator::Schedule (Seconds (3.0), &DnsServerTestCase::Query, this,
+                           client, "example.com", DnsHeader::TYPE_A, 4096);
+      Simulator::Run ();
+
+      // a burst of 5, then one truncated response every 2 drops
+      NS_TEST_ASSERT_MSG_EQ (dns->GetReceived (), 21, "Wrong number of queries");
+      NS_TEST_ASSERT_MSG_EQ (dns->GetDropped (), 15, "Wrong number of drops");
+      NS_TEST_ASSERT_MSG_EQ (dns->GetSlipped (), 7, "Wrong number of slips");
+      NS_TEST_ASSERT_MSG_EQ (m_sizes.size (), 13, "Wrong number of responses");
+      uint32_t truncated = 0;
+      for (uint32_t i = 0; i < m_headers.size (); ++i)
+        {
+          truncated += m_headers[i].IsTruncated () ? 1 : 0;
+        }
+      NS_TEST_ASSERT_MSG_EQ (truncated, 7, "Wrong number of truncated responses");
+      NS_TEST_ASSERT_MSG_EQ (m_headers.back ().IsTruncated (), false, "Tokens not refilled");
+      NS_TEST_ASSERT_MSG_EQ (m_headers.back ().GetAnswerCount (), 1, "Wrong answer after the refill");
+
+      Simulator::Destroy ();
+      return;
+    }
+
+  Simulator::Schedule (Seconds (1.0), &DnsServerTestCase::Query, this, client, "example.com", DnsHeader::TYPE_A, 4096);
+  Simulator::Schedule (Seconds (1.1), &DnsServerTestCase::Query, this, client, "example.com", DnsHeader::TYPE_ANY, 4096);
+  Simulator::Schedule (Seconds (1.2), &DnsServerTestCase::Query, this, client, "example.com", DnsHeader::TYPE_ANY, 0);
+  Simulator::Schedule (Seconds (1.3), &DnsServerTestCase::Query, this, client, "www.example.com", DnsHeader::TYPE_A, 4096);
+  Simulator::Schedule (Seconds (1.4), &DnsServerTestCase::Query, this, client, "", 0, 0);
+  Simulator::Run ();
+
+  NS_TEST_ASSERT_MSG_EQ (dns->GetReceived (), 4, "Wrong number of queries");
+  NS_TEST_ASSERT_MSG_EQ (m_sizes.size (), 5, "Wrong number of responses");
+  // header and question 29, A 16, OPT 11
+  NS_TEST_ASSERT_MSG_EQ (m_sizes[0], 56, "Wrong A response size");
+  NS_TEST_ASSERT_MSG_EQ (m_headers[0].GetAnswerCount (), 1, "Wrong A answer count");
+  NS_TEST_ASSERT_MSG_EQ (m_headers[0].IsResponse (), true, "Not a response");
+  NS_TEST_ASSERT_MSG_EQ (m_headers[0].IsAuthoritative (), true, "Not authoritative");
+  // A 16, NS 29, two TXT of 1041, AAAA 28
+  NS_TEST_ASSERT_MSG_EQ (m_sizes[1], 29 + 16 + 29 + 2 * 1041 + 28 + 11, "Wrong ANY response size");
+  NS_TEST_ASSERT_MSG_EQ (m_headers[1].GetAnswerCount (), 5, "Wrong ANY answer count");
+  NS_TEST_ASSERT_MSG_EQ (m_headers[1].IsTruncated (), false, "ANY response truncated");
+  NS_TEST_ASSERT_MSG_EQ (m_sizes[2], 29, "Wrong truncated response size");
+  NS_TEST_ASSERT_MSG_EQ (m_headers[2].IsTruncated (), true, "Response larger than 512 bytes not truncated");
+  NS_TEST_ASSERT_MSG_EQ (m_headers[2].GetAnswerCount (), 0, "Answers in a truncated response");
+  NS_TEST_ASSERT_MSG_EQ (static_cast<uint32_t> (m_headers[3].GetRcode ()), DnsHeader::NXDOMAIN, "Missing name answered");
+  NS_TEST_ASSERT_MSG_EQ (m_sizes[3], 33 + 11, "Wrong NXDOMAIN response size");
+  NS_TEST_ASSERT_MSG_EQ (m_sizes[4], 512, "Other packets not answered with PacketSize bytes");
+
+  Simulator::Destroy ();
+}
+
+/**
+ * Flood two resolvers with queries spoofing two victims and check the
+ * rate, the batching and the pattern of the flood
+ */
+class DnsFloodTestCase : public TestCase
+{
+public:
+  /**
+   * \param pattern the emission pattern
+   */
+  DnsFloodTestCase (DnsViciousClient::FloodPattern pattern);
+  virtual ~DnsFloodTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * \brief Record a query sent by the attacker
+   * \param packet the query
+   */
+  void Tx (Ptr<const Packet> packet);
+  /**
+   * \brief Record a query received by a resolver
+   * \param context the index of the resolver
+   * \param packet the query
+   * \param from the spoofed source
+   */
+  void Rx (std::string context, Ptr<const Packet> packet, const Address &from);
+
+  DnsViciousClient::FloodPattern m_pattern; //!< emission pattern
+  std::set<Time> m_events; //!< times of the send events
+  std::map<std::pair<uint32_t, Ipv6Address>, uint32_t> m_received; //!< queries per resolver and source
+};
+
+DnsFloodTestCase::DnsFloodTestCase (DnsViciousClient::FloodPattern pattern)
+  : TestCase ("Check the DNS reflection flood"),
+    m_pattern (pattern)
+{
+}
+
+DnsFloodTestCase::~DnsFloodTestCase ()
+{
+}
+
+void
+DnsFloodTestCase::Tx (Ptr<const Packet> packet)
+{
+  m_events.insert (Simulator::Now ());
+}
+
+void
+DnsFloodTestCase::Rx (std::string context, Ptr<const Packet> packet, const Address &from)
+{
+  uint32_t resolver = context == "1" ? 1 : 0;
+  ++m_received[std::make_pair (resolver, Inet6SocketAddress::ConvertFrom (from).GetIpv6 ())];
+}
+
+void
+DnsFloodTestCase::DoRun (void)
+{
+  NodeContainer n;
+  n.Create (5);
+
+  InternetStackHelper internet;
+  internet.SetIpv4StackInstall (false);
+  internet.Install (n);
+
+  Ptr<SimpleChannel> channel = CreateObject<SimpleChannel> ();
+  NetDeviceContainer d;
+  for (uint32_t i = 0; i < n.GetN (); ++i)
+    {
+      Ptr<SimpleNetDevice> dev = CreateObject<SimpleNetDevice> ();
+      std::ostringstream mac;
+      mac << "00:00:00:00:00:0" << i + 1;
+      dev->SetAddress (Mac48Address (mac.str ().c_str ()));
+      dev->SetChannel (channel);
+      n.Get (i)->AddDevice (dev);
+      d.Add (dev);
+    }
+
+  Ipv6AddressHelper ipv6;
+  ipv6.SetBase (Ipv6Address ("2001:1::"), Ipv6Prefix (64));
+  ipv6.Assign (d);
+  Ipv6Address resolvers[2] = { Ipv6Address ("2001:1::200:ff:fe00:2"), Ipv6Address ("2001:1::200:ff:fe00:3") };
+  Ipv6Address victims[2] = { Ipv6Address ("2001:1::200:ff:fe00:4"), Ipv6Address ("2001:1::200:ff:fe00:5") };
+
+  PacketSinkHelper sink ("ns3::UdpSocketFactory", Inet6SocketAddress (Ipv6Address::GetAny (), 53));
+  for (uint32_t i = 0; i < 2; ++i)
+    {
+      ApplicationContainer apps = sink.Install (n.Get (i + 1));
+      apps.Get (0)->TraceConnect ("Rx", i == 0 ? "0" : "1", MakeCallback (&DnsFloodTestCase::Rx, this));
+    }
+
+  // queries of 40 bytes, 100 per second in batches of 5
+  DnsViciousClientHelper flood (Ipv6Address::GetAny (), resolvers[0], 53);
+  flood.SetAttribute ("QueryName", StringValue ("example.com"));
+  flood.SetAttribute ("MaxPackets", UintegerValue (0));
+  flood.SetAttribute ("DataRate", DataRateValue (DataRate ("32kbps")));
+  flood.SetAttribute ("PacketsPerEvent", UintegerValue (5));
+  flood.SetAttribute ("Pattern", EnumValue (m_pattern));
+  flood.SetAttribute ("OnTime", StringValue ("ns3::ConstantRandomVariable[Constant=0.2]"));
+  flood.SetAttribute ("OffTime", StringValue ("ns3::ConstantRandomVariable[Constant=0.3]"));
+  ApplicationContainer apps = flood.Install (n.Get (0));
+  Ptr<DnsViciousClient> attacker = apps.Get (0)->GetObject<DnsViciousClient> ();
+  attacker->AssignStreams (1);
+  attacker->AddResolver (resolvers[0]);
+  attacker->AddResolver (resolvers[1]);
+  attacker->AddVictim (victims[0]);
+  attacker->AddVictim (victims[1]);
+  attacker->TraceConnectWithoutContext ("Tx", MakeCallback (&DnsFloodTestCase::Tx, this));
+  apps.Start (Seconds (0.5));
+  apps.Stop (Seconds (1.999));
+  Simulator::Schedule (Seconds (1.0), &DnsViciousClient::ViciousMode, attacker);
+
+  Simulator::Run ();
+
+  uint32_t sent = attacker->GetSent ();
+  if (m_pattern == DnsViciousClient::CONSTANT)
+    {
+      NS_TEST_ASSERT_MSG_EQ (sent, 100, "Wrong number of queries for the rate");
+      NS_TEST_ASSERT_MSG_EQ (m_events.size (), 20, "Queries not batched");
+      NS_TEST_ASSERT_MSG_EQ (*m_events.begin (), Seconds (1.0), "Flood not started by the vicious mode");
+    }
+  else if (m_pattern == DnsViciousClient::ON_OFF)
+    {
+      // on from 1.0 to 1.2 and from 1.5 to 1.7
+      NS_TEST_ASSERT_MSG_EQ (sent, 40, "Wrong number of queries in the on periods");
+      NS_TEST_ASSERT_MSG_EQ (m_events.size (), 8, "Queries not batched");
+      std::set<Time>::const_iterator second = m_events.lower_bound (Seconds (1.2));
+      NS_TEST_ASSERT_MSG_EQ ((second != m_events.end ()), true, "Second on period not started");
+      // the durations are rounded to the time resolution
+      NS_TEST_ASSERT_MSG_EQ_TOL (*second, Seconds (1.5), NanoSeconds (1), "Sent during the off period");
+    }
+  else
+    {
+      // the token bucket bounds the bursts to the rate and one batch
+      NS_TEST_ASSERT_MSG_LT_OR_EQ (sent, 105, "Rate exceeded");
+      NS_TEST_ASSERT_MSG_GT (sent, 50, "Rate too low");
+    }
+
+  // every (victim, resolver) pair in turn
+  uint32_t received = 0;
+  for (uint32_t r = 0; r < 2; ++r)
+    {
+      for (uint32_t v = 0; v < 2; ++v)
+        {
+          uint32_t count = m_received[std::make_pair (r, victims[v])];
+          NS_TEST_ASSERT_MSG_GT_OR_EQ (count + 1, sent / 4, "Pair not flooded evenly");
+          NS_TEST_ASSERT_MSG_LT_OR_EQ (count, sent / 4 + 1, "Pair not flooded evenly");
+          received += count;
+        }
+    }
+  NS_TEST_ASSERT_MSG_EQ (received, sent, "Queries lost or not spoofed");
+
+  Simulator::Destroy ();
+}
+
+class DnsTestSuite : public TestSuite
+{
+public:
+  DnsTestSuite ();
+};
+
+DnsTestSuite::DnsTestSuite ()
+  : TestSuite ("dns", UNIT)
+{
+  AddTestCase (new DnsHeaderTestCase, TestCase::QUICK);
+  AddTestCase (new DnsZoneTestCase, TestCase::QUICK);
+  AddTestCase (new DnsServerTestCase (false), TestCase::QUICK);
+  AddTestCase (new DnsServerTestCase (true), TestCase::QUICK);
+  AddTestCase (new DnsFloodTestCase (DnsViciousClient::CONSTANT), TestCase::QUICK);
+  AddTestCase (new DnsFloodTestCase (DnsViciousClient::POISSON), TestCase::QUICK);
+  AddTestCase (new DnsFloodTestCase (DnsViciousClient::ON_OFF), TestCase::QUICK);
+}
+
+static DnsTestSuite dnsTestSuite;
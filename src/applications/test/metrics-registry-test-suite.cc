@@ -0,0 +1,206 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2015 Universite catholique de Louvain
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Lionel Metongnon <lionel.metongnon@uclouvain.be>
+ */
+
+#include "ns3/test.h"
+#include "ns3/metrics-registry.h"
+#include "ns3/simulator.h"
+#include "ns3/system-path.h"
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+
+using namespace ns3;
+
+/**
+ * Log-linear buckets and quantiles of the histograms
+ */
+class MetricsHistogramTestCase : public TestCase
+{
+public:
+  MetricsHistogramTestCase ();
+  virtual ~MetricsHistogramTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+MetricsHistogramTestCase::MetricsHistogramTestCase ()
+  : TestCase ("Histogram buckets keep the durations within 12.5%")
+{
+}
+
+MetricsHistogramTestCase::~MetricsHistogramTestCase ()
+{
+}
+
+void
+MetricsHistogramTestCase::DoRun (void)
+{
+  // one bucket per nanosecond up to 8 ns, then 8 per power of two
+  NS_TEST_ASSERT_MSG_EQ (MetricsHistogram::GetBucket (0), 0, "Wrong bucket");
+  NS_TEST_ASSERT_MSG_EQ (MetricsHistogram::GetBucket (7), 7, "Wrong bucket");
+  NS_TEST_ASSERT_MSG_EQ (MetricsHistogram::GetBucket (8), 8, "Wrong bucket");
+  NS_TEST_ASSERT_MSG_EQ (MetricsHistogram::GetBucket (16), 16, "Wrong bucket");
+  NS_TEST_ASSERT_MSG_EQ (MetricsHistogram::GetBucket (17), 16, "Wrong bucket");
+  NS_TEST_ASSERT_MSG_EQ (MetricsHistogram::GetBucket (18), 17, "Wrong bucket");
+  NS_TEST_ASSERT_MSG_EQ (MetricsHistogram::GetBucket (~0ull), MetricsHistogram::N_BUCKETS - 1, "Wrong last bucket");
+
+  uint64_t values[] = { 9, 100, 1000, 123456, 1000000007ull, 3600000000000ull };
+  for (uint32_t i = 0; i < sizeof (values) / sizeof (values[0]); ++i)
+    {
+      uint32_t bucket = MetricsHistogram::GetBucket (values[i]);
+      uint64_t lowest = MetricsHistogram::GetLowest (bucket);
+      NS_TEST_ASSERT_MSG_EQ (MetricsHistogram::GetBucket (lowest), bucket, "Lowest value out of its bucket");
+      NS_TEST_ASSERT_MSG_EQ ((lowest <= values[i]), true, "Lowest value above the duration");
+      NS_TEST_ASSERT_MSG_EQ ((values[i] - lowest <= lowest / 8), true, "Error above 12.5%");
+    }
+
+  MetricsHistogram histogram;
+  NS_TEST_ASSERT_MSG_EQ (histogram.GetQuantile (0.5), Seconds (0), "Quantile of an empty histogram");
+  for (uint32_t i = 1; i <= 100; ++i)
+    {
+      histogram.Record (MilliSeconds (i));
+    }
+  histogram.Record (Seconds (-1));
+  NS_TEST_ASSERT_MSG_EQ (histogram.GetCount (), 101, "Wrong count");
+  NS_TEST_ASSERT_MSG_EQ (histogram.GetMax (), MilliSeconds (100), "Wrong maximum");
+  NS_TEST_ASSERT_MSG_EQ (histogram.GetQuantile (0), Seconds (0), "The negative duration counts as zero");
+  Time median = histogram.GetQuantile (0.5);
+  NS_TEST_ASSERT_MSG_EQ ((median <= MilliSeconds (50) && median >= MilliSeconds (50) * 7 / 8), true, "Wrong median " << median);
+  Time p99 = histogram.GetQuantile (0.99);
+  NS_TEST_ASSERT_MSG_EQ ((p99 <= MilliSeconds (99) && p99 >= MilliSeconds (99) * 7 / 8), true, "Wrong 99th percentile " << p99);
+  histogram.Reset ();
+  NS_TEST_ASSERT_MSG_EQ (histogram.GetCount (), 0, "Reset kept durations");
+}
+
+/**
+ * Counters of the registry, sampled into a file
+ */
+class MetricsRegistryTestCase : public TestCase
+{
+public:
+  MetricsRegistryTestCase ();
+  virtual ~MetricsRegistryTestCase ();
+
+private:
+  virtual void DoRun (void);
+  virtual void DoTeardown (void);
+
+  /**
+   * \param counter the counter to increment
+   */
+  static void Increment (MetricsCounter *counter);
+};
+
+MetricsRegistryTestCase::MetricsRegistryTestCase ()
+  : TestCase ("Registry samples every period and when the simulator is destroyed")
+{
+}
+
+MetricsRegistryTestCase::~MetricsRegistryTestCase ()
+{
+}
+
+void
+MetricsRegistryTestCase::Increment (MetricsCounter *counter)
+{
+  counter->Add ();
+}
+
+void
+MetricsRegistryTestCase::DoRun (void)
+{
+  Ptr<MetricsRegistry> registry = MetricsRegistry::Get ();
+  NS_TEST_ASSERT_MSG_EQ (MetricsRegistry::Get (), registry, "One registry per simulation");
+  MetricsCounter *probes = registry->GetCounter ("scan.probes");
+  NS_TEST_ASSERT_MSG_EQ (registry->GetCounter ("scan.probes"), probes, "One counter per name");
+  probes->Add (3);
+  NS_TEST_ASSERT_MSG_EQ (probes->Get (), 3, "Wrong counter");
+
+  registry->CountDiscovered (Ipv6Address ("2001:1::ff:fe00:4"));
+  registry->CountDiscovered (Ipv6Address ("2001:1::ff:fe00:5"));
+  registry->CountDiscovered (Ipv6Address ("2001:2::200:ff:fe00:4"));
+  registry->CountDiscovered (Ipv6Address ("2001:3::1"));
+  NS_TEST_ASSERT_MSG_EQ (registry->GetCounter ("scan.discovered.sixlowpan")->Get (), 2, "Wrong 6LoWPAN hosts");
+  NS_TEST_ASSERT_MSG_EQ (registry->GetCounter ("scan.discovered.wifi")->Get (), 1, "Wrong WiFi hosts");
+  NS_TEST_ASSERT_MSG_EQ (registry->GetCounter ("scan.discovered.other")->Get (), 1, "Wrong other hosts");
+  registry->Reset ();
+  NS_TEST_ASSERT_MSG_EQ (probes->Get (), 0, "Reset kept a count");
+
+  std::string path = SystemPath::MakeTemporaryDirectoryName () + "-metrics.tsv";
+  registry->Enable (path, Seconds (1));
+  registry->GetHistogram ("scan.rtt")->Record (NanoSeconds (1 << 23));
+  // kept out of the columns fixed by Enable
+  registry->GetCounter ("late.counter")->Add (7);
+  for (uint32_t i = 0; i < 3; ++i)
+    {
+      Simulator::Schedule (MilliSeconds (500 + 1000 * i), &MetricsRegistryTestCase::Increment, probes);
+    }
+  Simulator::Stop (Seconds (3.5));
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  std::ifstream is (path.c_str ());
+  std::vector<std::string> lines;
+  std::string line;
+  while (std::getline (is, line))
+    {
+      lines.push_back (line);
+    }
+  NS_TEST_ASSERT_MSG_EQ (lines.size (), 5, "One header and four samples expected");
+  NS_TEST_ASSERT_MSG_EQ (lines[0], "#time\tscan.discovered.sixlowpan\tscan.discovered.wifi\tscan.discovered.other"
+                         "\tscan.probes\tscan.retries\tscan.replies"
+                         "\tpenetration.attempts\tpenetration.successes\tpenetration.failures"
+                         "\tdns.queries\tdns.query_bytes\tdns.responses\tdns.response_bytes\tdns.rrl_dropped"
+                         "\tscan.rtt.count\tscan.rtt.p50\tscan.rtt.p99\tscan.rtt.max"
+                         "\tpenetration.time.count\tpenetration.time.p50\tpenetration.time.p99\tpenetration.time.max",
+                         "Wrong header");
+  std::string others = "\t0\t0\t0\t0\t0\t0\t0\t0\t0\t0";
+  std::string histograms = "\t1\t8388608\t8388608\t8388608\t0\t0\t0\t0";
+  NS_TEST_ASSERT_MSG_EQ (lines[1], "1\t0\t0\t0\t1" + others + histograms, "Wrong first sample");
+  NS_TEST_ASSERT_MSG_EQ (lines[3], "3\t0\t0\t0\t3" + others + histograms, "Wrong third sample");
+  NS_TEST_ASSERT_MSG_EQ (lines[4], "3.5\t0\t0\t0\t3" + others + histograms, "Wrong last sample");
+  std::remove (path.c_str ());
+
+  NS_TEST_ASSERT_MSG_NE (MetricsRegistry::Get (), registry, "The registry outlived the simulation");
+}
+
+void
+MetricsRegistryTestCase::DoTeardown (void)
+{
+  Simulator::Destroy ();
+}
+
+class MetricsRegistryTestSuite : public TestSuite
+{
+public:
+  MetricsRegistryTestSuite ();
+};
+
+MetricsRegistryTestSuite::MetricsRegistryTestSuite ()
+  : TestSuite ("metrics-registry", UNIT)
+{
+  AddTestCase (new MetricsHistogramTestCase, TestCase::QUICK);
+  AddTestCase (new MetricsRegistryTestCase, TestCase::QUICK);
+}
+
+static MetricsRegistryTestSuite metricsRegistryTestSuite;
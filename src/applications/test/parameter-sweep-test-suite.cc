@@ -0,0 +1,128 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2015 Universite catholique de Louvain
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Lionel Metongnon <lionel.metongnon@uclouvain.be>
+ */
+
+#include "ns3/test.h"
+#include "ns3/parameter-sweep.h"
+#include "ns3/system-path.h"
+#include "test-file-utils.h"
+
+#include <sstream>
+#include <string>
+
+using namespace ns3;
+
+/**
+ * Sweep a shell script standing for a simulation program
+ */
+class ParameterSweepTestCase : public TestCase
+{
+public:
+  ParameterSweepTestCase ();
+  virtual ~ParameterSweepTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+ParameterSweepTestCase::ParameterSweepTestCase ()
+  : TestCase ("Run every combination in its own directory and gather the results")
+{
+}
+
+ParameterSweepTestCase::~ParameterSweepTestCase ()
+{
+}
+
+void
+ParameterSweepTestCase::DoRun (void)
+{
+  // writes the result files of ScanTools and PenetrationTools in the
+  // current directory, as a scanning scenario would
+  std::string script =
+    "for a in \"$@\"; do case \"$a\" in"
+    " --Hosts=*) hosts=${a#--Hosts=};;"
+    " --Fail=*) fail=${a#--Fail=};;"
+    " --RngRun=*) run=${a#--RngRun=};;"
+    " esac; done;"
+    " printf '2001:1::\\tmin\\n2001:2::\\tmin\\n' > data/64_${hosts}_node0_scanning.rst;"
+    " echo $run > data/64_${hosts}_node0_penetration.rst;"
+    " echo running; exit $fail";
+  std::string root = SystemPath::MakeTemporaryDirectoryName ();
+
+  ParameterSweep sweep;
+  sweep.SetProgram ("/bin/sh");
+  sweep.AddArgument ("-c");
+  sweep.AddArgument (script);
+  sweep.AddArgument ("sweep");
+  sweep.AddParameter ("Hosts", "3,5");
+  sweep.AddParameter ("Fail", "0,2");
+  sweep.SetRuns (7, 2);
+  sweep.SetJobs (3);
+  sweep.SetOutputDirectory (root);
+  NS_TEST_ASSERT_MSG_EQ (sweep.GetNRuns (), 8, "Wrong number of runs");
+  NS_TEST_ASSERT_MSG_EQ (sweep.Start (), 4, "Wrong number of failed runs");
+
+  const std::vector<ParameterSweep::Run> &runs = sweep.GetRuns ();
+  NS_TEST_ASSERT_MSG_EQ (runs.size (), 8, "Wrong number of runs");
+  NS_TEST_ASSERT_MSG_EQ (runs[0].directory, root + "/Hosts-3_Fail-0_run-7", "Wrong directory");
+  NS_TEST_ASSERT_MSG_EQ (runs[0].status, 0, "Wrong status");
+  NS_TEST_ASSERT_MSG_EQ (runs[0].results.discovered, 3, "Wrong number of discovered hosts");
+  NS_TEST_ASSERT_MSG_EQ (runs[0].results.networks, 2, "Wrong number of networks");
+  NS_TEST_ASSERT_MSG_EQ (runs[0].results.compromised, 7, "Wrong number of compromised hosts");
+  NS_TEST_ASSERT_MSG_EQ (TestFileUtils::ReadFile (runs[0].directory + "/output.log"), "running\n", "Output not isolated");
+
+  // the last parameter varies first, then the runs of each combination
+  NS_TEST_ASSERT_MSG_EQ (runs[1].rngRun, 8, "Wrong RngRun");
+  NS_TEST_ASSERT_MSG_EQ (runs[2].values[1], "2", "Wrong order");
+  NS_TEST_ASSERT_MSG_EQ (runs[2].status, 2, "Wrong status");
+  NS_TEST_ASSERT_MSG_EQ (runs[7].directory, root + "/Hosts-5_Fail-2_run-8", "Wrong directory");
+  NS_TEST_ASSERT_MSG_EQ (runs[7].results.discovered, 5, "Results of another run");
+  NS_TEST_ASSERT_MSG_EQ (runs[7].results.compromised, 8, "Results of another run");
+
+  std::string summary = TestFileUtils::ReadFile (root + "/summary.tsv");
+  std::istringstream lines (summary);
+  std::string line;
+  std::getline (lines, line);
+  NS_TEST_ASSERT_MSG_EQ (line, "#Hosts\tFail\trun\tstatus\tdiscovered\tnetworks\tcompromised", "Wrong summary header");
+  std::getline (lines, line);
+  NS_TEST_ASSERT_MSG_EQ (line, "3\t0\t7\t0\t3\t2\t7", "Wrong summary line");
+  uint32_t count = 1;
+  while (std::getline (lines, line))
+    {
+      ++count;
+    }
+  NS_TEST_ASSERT_MSG_EQ (count, 8, "Wrong number of summary lines");
+
+  TestFileUtils::RemoveTree (root);
+}
+
+class ParameterSweepTestSuite : public TestSuite
+{
+public:
+  ParameterSweepTestSuite ();
+};
+
+ParameterSweepTestSuite::ParameterSweepTestSuite ()
+  : TestSuite ("parameter-sweep", UNIT)
+{
+  AddTestCase (new ParameterSweepTestCase, TestCase::QUICK);
+}
+
+static ParameterSweepTestSuite parameterSweepTestSuite;
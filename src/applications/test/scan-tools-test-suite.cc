@@ -0,0 +1,1321 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2015 Universite catholique de Louvain
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Lionel Metongnon <lionel.metongnon@uclouvain.be>
+ */
+
+#include "ns3/test.h"
+#include "ns3/ipv6-address.h"
+#include "ns3/ipv6-address-list.h"
+#include "ns3/scan-tools.h"
+#include "ns3/penetration-tools.h"
+#include "ns3/coap-header.h"
+#include "ns3/scan-target-generator.h"
+#include "ns3/scan-strategy.h"
+#include "ns3/probe-table.h"
+#include "ns3/scan-result-sink.h"
+#include "ns3/scan-discovery-set.h"
+#include "ns3/probe-timer-wheel.h"
+#include "ns3/payload-template.h"
+#include "ns3/system-path.h"
+#include "ns3/uinteger.h"
+#include "ns3/double.h"
+#include "ns3/boolean.h"
+#include "ns3/nstime.h"
+#include "ns3/simulator.h"
+#include "ns3/packet.h"
+#include "ns3/mac48-address.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv6-address-helper.h"
+#include "ns3/inet6-socket-address.h"
+#include "ns3/socket.h"
+#include "ns3/udp-socket-factory.h"
+#include "ns3/packet-sink-helper.h"
+#include "ns3/udp-echo-helper.h"
+#include "ns3/sim-attack-helper.h"
+#include "ns3/parameter-sweep.h"
+#include "ns3/simple-net-device.h"
+#include "ns3/simple-channel.h"
+#include "test-file-utils.h"
+
+#include <algorithm>
+#include <list>
+#include <map>
+#include <set>
+#include <sstream>
+#include <vector>
+#include <unistd.h>
+
+using namespace ns3;
+
+/**
+ * Test that the lazy ScanTargetGenerator produces the same addresses, in
+ * the same order, as the former pre-materialized target list for every
+ * ScanTools::ScanType.
+ */
+class ScanTargetGeneratorOrderTestCase : public TestCase
+{
+public:
+  ScanTargetGeneratorOrderTestCase ();
+  virtual ~ScanTargetGeneratorOrderTestCase ();
+
+private:
+  virtual void DoRun (void);
+  std::list<Ipv6Address> Reference (std::map<Ipv6Address, Ipv6Prefix> &networks,
+                                    ScanTools::ScanType scanType, uint32_t count);
+};
+
+ScanTargetGeneratorOrderTestCase::ScanTargetGeneratorOrderTestCase ()
+  : TestCase ("Test that the ScanTargetGenerator keeps the ScanTools scan orders")
+{
+}
+
+ScanTargetGeneratorOrderTestCase::~ScanTargetGeneratorOrderTestCase ()
+{
+}
+
+std::list<Ipv6Address>
+ScanTargetGeneratorOrderTestCase::Reference (std::map<Ipv6Address, Ipv6Prefix> &networks,
+                                             ScanTools::ScanType scanType, uint32_t count)
+{
+  std::list<Ipv6Address> addresses;
+  Ipv6AddressList wifiList;
+  Ipv6AddressList sixlowpanList;
+  int index = 0;
+  for (std::map<Ipv6Address, Ipv6Prefix>::iterator i = networks.begin (); i != networks.end (); ++i, ++index)
+    {
+      wifiList.Init (i->first, i->second, Ipv6Address ("::200:ff:fe00:1"));
+      sixlowpanList.Init (i->first, i->second, Ipv6Address ("::ff:fe00:1"));
+      for (uint32_t k = 0; k < count; ++k)
+        {
+          if (scanType == ScanTools::INTERLACE || scanType == ScanTools::SIXLOWPAN_ONLY || (scanType == ScanTools::SIXLOWPAN_FIRST && index % 2 == 0) || (scanType == ScanTools::WIFI_FIRST && index % 2 != 0))
+            {
+              addresses.push_back (sixlowpanList.NextAddress (i->second));
+            }
+          if (scanType == ScanTools::INTERLACE || scanType == ScanTools::WIFI_ONLY || (scanType == ScanTools::WIFI_FIRST && index % 2 == 0) || (scanType == ScanTools::SIXLOWPAN_FIRST && index % 2 != 0))
+            {
+              addresses.push_back (wifiList.NextAddress (i->second));
+            }
+        }
+    }
+  return addresses;
+}
+
+void
+ScanTargetGeneratorOrderTestCase::DoRun (void)
+{
+  std::map<Ipv6Address, Ipv6Prefix> networks;
+  networks[Ipv6Address ("2001:1::")] = Ipv6Prefix (64);
+  networks[Ipv6Address ("2001:2::")] = Ipv6Prefix (64);
+  networks[Ipv6Address ("2001:3::")] = Ipv6Prefix (64);
+  const uint32_t count = 300;
+
+  ScanTools::ScanType scanTypes[] = { ScanTools::INTERLACE, ScanTools::WIFI_FIRST, ScanTools::WIFI_ONLY,
+                                      ScanTools::SIXLOWPAN_FIRST, ScanTools::SIXLOWPAN_ONLY };
+  for (uint32_t t = 0; t < sizeof (scanTypes) / sizeof (scanTypes[0]); ++t)
+    {
+      ScanTools::ScanType scanType = scanTypes[t];
+      ScanTargetGenerator generator;
+      generator.SetCount (count);
+      int index = 0;
+      for (std::map<Ipv6Address, Ipv6Prefix>::iterator i = networks.begin (); i != networks.end (); ++i, ++index)
+        {
+          uint8_t patterns = 0;
+          if (scanType == ScanTools::INTERLACE || scanType == ScanTools::SIXLOWPAN_ONLY || (scanType == ScanTools::SIXLOWPAN_FIRST && index % 2 == 0) || (scanType == ScanTools::WIFI_FIRST && index % 2 != 0))
+            {
+              patterns |= ScanTargetGenerator::SIXLOWPAN;
+            }
+          if (scanType == ScanTools::INTERLACE || scanType == ScanTools::WIFI_ONLY || (scanType == ScanTools::WIFI_FIRST && index % 2 == 0) || (scanType == ScanTools::SIXLOWPAN_FIRST && index % 2 != 0))
+            {
+              patterns |= ScanTargetGenerator::WIFI;
+            }
+          generator.AddNetwork (i->first, i->second, patterns);
+        }
+
+      std::list<Ipv6Address> reference = Reference (networks, scanType, count);
+      NS_TEST_ASSERT_MSG_EQ (generator.GetNTargets (), reference.size (), "Wrong number of targets for scan type " << scanType);
+
+      Ipv6Address address;
+      for (std::list<Ipv6Address>::iterator i = reference.begin (); i != reference.end (); ++i)
+        {
+          NS_TEST_ASSERT_MSG_EQ (generator.IsDone (), false, "Generator exhausted too early for scan type " << scanType);
+          NS_TEST_ASSERT_MSG_EQ (generator.Next (address), true, "Generator exhausted too early for scan type " << scanType);
+          NS_TEST_ASSERT_MSG_EQ (address, *i, "Wrong address order for scan type " << scanType);
+        }
+      NS_TEST_ASSERT_MSG_EQ (generator.IsDone (), true, "Generator not exhausted for scan type " << scanType);
+      NS_TEST_ASSERT_MSG_EQ (generator.Next (address), false, "Generator produced too many addresses for scan type " << scanType);
+    }
+}
+
+/**
+ * Test that every ScanStrategy visits each target of the space exactly
+ * once, in its own order.
+ */
+class ScanStrategyTestCase : public TestCase
+{
+public:
+  ScanStrategyTestCase ();
+  virtual ~ScanStrategyTestCase ();
+
+private:
+  virtual void DoRun (void);
+  std::vector<Ipv6Address> Drain (Ptr<ScanStrategy> strategy, const ScanTargetGenerator &targets);
+};
+
+ScanStrategyTestCase::ScanStrategyTestCase ()
+  : TestCase ("Test that the scan strategies cover the target space")
+{
+}
+
+ScanStrategyTestCase::~ScanStrategyTestCase ()
+{
+}
+
+std::vector<Ipv6Address>
+ScanStrategyTestCase::Drain (Ptr<ScanStrategy> strategy, const ScanTargetGenerator &targets)
+{
+  std::vector<Ipv6Address> addresses;
+  Ipv6Address address;
+  strategy->Prepare (&targets);
+  while (!strategy->IsDone ())
+    {
+      if (!strategy->Next (address))
+        {
+          break;
+        }
+      addresses.push_back (address);
+    }
+  return addresses;
+}
+
+void
+ScanStrategyTestCase::DoRun (void)
+{
+  ScanTargetGenerator targets;
+  targets.SetCount (50);
+  targets.AddNetwork (Ipv6Address ("2001:1::"), Ipv6Prefix (64), ScanTargetGenerator::SIXLOWPAN | ScanTargetGenerator::WIFI);
+  targets.AddNetwork (Ipv6Address ("2001:2::"), Ipv6Prefix (64), ScanTargetGenerator::WIFI);
+  targets.AddNetwork (Ipv6Address ("2001:3::"), Ipv6Prefix (64), ScanTargetGenerator::SIXLOWPAN);
+
+  std::vector<Ipv6Address> sequential = Drain (CreateObject<SequentialScanStrategy> (), targets);
+  NS_TEST_ASSERT_MSG_EQ (sequential.size (), targets.GetNTargets (), "Sequential strategy missed targets");
+  std::set<Ipv6Address> reference (sequential.begin (), sequential.end ());
+  NS_TEST_ASSERT_MSG_EQ (reference.size (), sequential.size (), "Sequential strategy produced duplicates");
+
+  // random access and sequential walk agree
+  Ipv6Address address;
+  uint32_t produced = 0;
+  for (uint64_t slot = 0; slot < targets.GetNSlots (); ++slot)
+    {
+      if (targets.GetTarget (slot, address))
+        {
+          NS_TEST_ASSERT_MSG_EQ (address, sequential[produced], "Random access differs from the sequential walk");
+          ++produced;
+        }
+    }
+
+  Ptr<PermutationScanStrategy> permutation = CreateObject<PermutationScanStrategy> ();
+  permutation->AssignStreams (1);
+  std::vector<Ipv6Address> permuted = Drain (permutation, targets);
+  NS_TEST_ASSERT_MSG_EQ (PermutationScanStrategy::IsPrime (permutation->GetPrime ()), true, "Modulus is not prime");
+  NS_TEST_ASSERT_MSG_EQ (permuted.size (), sequential.size (), "Permutation strategy missed targets");
+  NS_TEST_ASSERT_MSG_EQ ((std::set<Ipv6Address> (permuted.begin (), permuted.end ()) == reference), true, "Permutation strategy produced other targets");
+  NS_TEST_ASSERT_MSG_EQ ((permuted == sequential), false, "Permutation strategy kept the sequential order");
+
+  Ptr<StrideScanStrategy> stride = CreateObject<StrideScanStrategy> ();
+  stride->SetAttribute ("Stride", UintegerValue (7));
+  std::vector<Ipv6Address> strided = Drain (stride, targets);
+  NS_TEST_ASSERT_MSG_EQ (strided.size (), sequential.size (), "Stride strategy missed targets");
+  NS_TEST_ASSERT_MSG_EQ ((std::set<Ipv6Address> (strided.begin (), strided.end ()) == reference), true, "Stride strategy produced other targets");
+  NS_TEST_ASSERT_MSG_EQ (strided[0], Ipv6Address ("2001:1::ff:fe00:1"), "Stride strategy wrong first target");
+  NS_TEST_ASSERT_MSG_EQ (strided[1], Ipv6Address ("2001:1::200:ff:fe00:1"), "Stride strategy wrong second target");
+  NS_TEST_ASSERT_MSG_EQ (strided[2], Ipv6Address ("2001:2::200:ff:fe00:1"), "Stride strategy does not interleave the networks");
+  NS_TEST_ASSERT_MSG_EQ (strided[3], Ipv6Address ("2001:3::ff:fe00:1"), "Stride strategy does not interleave the networks");
+  NS_TEST_ASSERT_MSG_EQ (strided[4], Ipv6Address ("2001:1::ff:fe00:8"), "Stride strategy wrong stride");
+
+  std::vector<Ipv6Address> hitList;
+  hitList.push_back (Ipv6Address ("2001:3::ff:fe00:a"));
+  hitList.push_back (Ipv6Address ("2001:9::1"));
+  Ptr<HitListScanStrategy> hit = CreateObject<HitListScanStrategy> ();
+  hit->SetHitList (hitList);
+  std::vector<Ipv6Address> hits = Drain (hit, targets);
+  NS_TEST_ASSERT_MSG_EQ (hits[0], hitList[0], "Hit list not probed first");
+  NS_TEST_ASSERT_MSG_EQ (hits[1], hitList[1], "Hit list not probed first");
+  NS_TEST_ASSERT_MSG_EQ (hits.size (), sequential.size () + 1, "Hit list addresses probed twice");
+
+  Ptr<OuiScanStrategy> oui = CreateObject<OuiScanStrategy> ();
+  oui->SetAttribute ("Oui", UintegerValue (0x001122));
+  std::vector<Ipv6Address> vendor = Drain (oui, targets);
+  NS_TEST_ASSERT_MSG_EQ (vendor.size (), 150, "OUI strategy wrong number of targets");
+  NS_TEST_ASSERT_MSG_EQ (vendor[0], Ipv6Address ("2001:1::211:22ff:fe00:1"), "OUI strategy wrong EUI-64");
+  NS_TEST_ASSERT_MSG_EQ (vendor[50], Ipv6Address ("2001:2::211:22ff:fe00:1"), "OUI strategy wrong network order");
+}
+
+/**
+ * Test the probe table: first send and first reply kept, growth past the
+ * reserved size and replied entries sorted by address.
+ */
+class ProbeTableTestCase : public TestCase
+{
+public:
+  ProbeTableTestCase ();
+  virtual ~ProbeTableTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+ProbeTableTestCase::ProbeTableTestCase ()
+  : TestCase ("Check the ScanTools probe table")
+{
+}
+
+ProbeTableTestCase::~ProbeTableTestCase ()
+{
+}
+
+void
+ProbeTableTestCase::DoRun (void)
+{
+  ScanTargetGenerator targets;
+  targets.SetCount (500);
+  targets.AddNetwork (Ipv6Address ("2001:2::"), Ipv6Prefix (64), ScanTargetGenerator::SIXLOWPAN);
+  targets.AddNetwork (Ipv6Address ("2001:1::"), Ipv6Prefix (64), ScanTargetGenerator::WIFI);
+
+  ProbeTable table;
+  table.Reserve (10);
+  NS_TEST_ASSERT_MSG_EQ (table.GetCapacity (), 16, "Probe table not sized for the reserved addresses");
+  Ipv6Address address;
+  uint64_t n = 0;
+  while (targets.Next (address))
+    {
+      table.RecordSend (address, MilliSeconds (n));
+      ++n;
+    }
+  NS_TEST_ASSERT_MSG_EQ (table.GetSize (), 1000, "Probe table lost addresses");
+  NS_TEST_ASSERT_MSG_EQ ((table.GetSize () * 4 <= table.GetCapacity () * 3), true, "Probe table overloaded");
+  // each growth doubles the table, 1024 slots hold up to 768 entries
+  NS_TEST_ASSERT_MSG_EQ (table.GetCapacity (), 2048, "Probe table not grown by doubling");
+
+  Ipv6Address first ("2001:2::ff:fe00:1");
+  Ipv6Address host ("2001:1::200:ff:fe00:2");
+  table.RecordSend (first, Seconds (10));
+  NS_TEST_ASSERT_MSG_EQ (table.Find (first)->GetFirstSend (), MilliSeconds (0), "Probe table overwrote the first send");
+  NS_TEST_ASSERT_MSG_EQ (table.RecordReply (host, MilliSeconds (700)), true, "Reply of a probed host refused");
+  NS_TEST_ASSERT_MSG_EQ (table.RecordReply (host, MilliSeconds (800)), true, "Reply of a probed host refused");
+  NS_TEST_ASSERT_MSG_EQ (table.RecordReply (first, MilliSeconds (900)), true, "Reply of a probed host refused");
+  NS_TEST_ASSERT_MSG_EQ (table.RecordReply (Ipv6Address ("2001:3::1"), Seconds (1)), false, "Reply of an unprobed host accepted");
+  NS_TEST_ASSERT_MSG_EQ (table.Find (host)->replies, 2, "Probe table wrong reply count");
+  NS_TEST_ASSERT_MSG_EQ (table.Find (host)->GetFirstReply (), MilliSeconds (700), "Probe table overwrote the first reply");
+  NS_TEST_ASSERT_MSG_EQ (table.Find (Ipv6Address ("2001:4::1")), 0, "Probe table found an unknown address");
+
+  // a retry queued before a late reply leaves the answered probe alone
+  uint16_t attempts = table.Find (first)->attempts;
+  bool inFlight = table.Find (first)->IsInFlight ();
+  table.RecordRetry (first, Seconds (11));
+  NS_TEST_ASSERT_MSG_EQ (table.Find (first)->GetFirstSend (), MilliSeconds (0), "Retry of a replied probe restarted its RTT");
+  NS_TEST_ASSERT_MSG_EQ (table.Find (first)->attempts, attempts, "Retry of a replied probe counted");
+  NS_TEST_ASSERT_MSG_EQ (table.Find (first)->IsInFlight (), inFlight, "Retry of a replied probe put in flight");
+
+  std::vector<const ProbeTable::Entry *> replied;
+  table.GetReplied (replied);
+  NS_TEST_ASSERT_MSG_EQ (replied.size (), 2, "Unprobed or silent hosts reported");
+  NS_TEST_ASSERT_MSG_EQ (replied[0]->address, host, "Replied entries not sorted");
+  NS_TEST_ASSERT_MSG_EQ (replied[1]->address, first, "Replied entries not sorted");
+  NS_TEST_ASSERT_MSG_EQ (replied[0]->GetFirstSend (), MilliSeconds (501), "Probe table wrong send time");
+
+  table.Clear ();
+  NS_TEST_ASSERT_MSG_EQ (table.GetSize (), 0, "Probe table not cleared");
+  NS_TEST_ASSERT_MSG_EQ (table.Find (host), 0, "Probe table not cleared");
+}
+
+/**
+ * Test the streamed results: text layouts, incremental per-/64 summary,
+ * renaming at close and conversion of the binary records.
+ */
+class ScanResultSinkTestCase : public TestCase
+{
+public:
+  ScanResultSinkTestCase ();
+  virtual ~ScanResultSinkTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * \brief Feed the same RTT records to a sink
+   * \param sink the sink
+   */
+  static void FeedScanning (ScanResultSink &sink);
+
+  /**
+   * \brief Feed the same compromised hosts to a sink
+   * \param sink the sink
+   */
+  static void FeedPenetration (ScanResultSink &sink);
+};
+
+ScanResultSinkTestCase::ScanResultSinkTestCase ()
+  : TestCase ("Check the streamed ScanTools and PenetrationTools results")
+{
+}
+
+ScanResultSinkTestCase::~ScanResultSinkTestCase ()
+{
+}
+
+void
+ScanResultSinkTestCase::FeedScanning (ScanResultSink &sink)
+{
+  sink.Open (ScanResultSink::SCANNING, "64_node0");
+  sink.RecordRtt (Ipv6Address ("2001:2::ff:fe00:3"), MilliSeconds (10), MilliSeconds (40));
+  sink.RecordRtt (Ipv6Address ("2001:1::ff:fe00:1"), MilliSeconds (20), MilliSeconds (30));
+  sink.RecordRtt (Ipv6Address ("2001:2::ff:fe00:1"), MilliSeconds (30), MilliSeconds (40));
+  sink.Close ("64_3");
+}
+
+void
+ScanResultSinkTestCase::FeedPenetration (ScanResultSink &sink)
+{
+  sink.Open (ScanResultSink::PENETRATION, "64_3");
+  sink.RecordCompromised (Ipv6Address ("2001:2::ff:fe00:3"));
+  sink.RecordCompromised (Ipv6Address ("2001:1::ff:fe00:1"));
+  sink.Close ("64_3");
+}
+
+void
+ScanResultSinkTestCase::DoRun (void)
+{
+  std::string root = SystemPath::MakeTemporaryDirectoryName ();
+  std::string text = SystemPath::Append (root, "text");
+  std::string binary = SystemPath::Append (root, "binary");
+  SystemPath::MakeDirectories (text);
+  SystemPath::MakeDirectories (binary);
+
+  ScanResultSink sink;
+  sink.SetDirectories (text, text);
+  FeedScanning (sink);
+  NS_TEST_ASSERT_MSG_EQ (sink.GetSummaries ().size (), 2, "Wrong number of /64 summaries");
+  NS_TEST_ASSERT_MSG_EQ (sink.GetSummaries ().begin ()->first, Ipv6Address ("2001:1::"), "Summaries not keyed by /64");
+  FeedPenetration (sink);
+  NS_TEST_ASSERT_MSG_EQ (TestFileUtils::ReadFile (text + "/64_3_scanning.rst"),
+                         "2001:1::\tmin : 10ms\tmax : 10ms\tmean : 10ms\n"
+                         "2001:2::\tmin : 10ms\tmax : 30ms\tmean : 20ms\n",
+                         "Wrong per-/64 summary");
+  NS_TEST_ASSERT_MSG_EQ (TestFileUtils::ReadFile (text + "/64_3_scanning_details.rst"),
+                         "2001:2::ff:fe00:3\tSending time : 0.01s\tIncomming time : 0.04s\tdelta 30ms\n"
+                         "2001:1::ff:fe00:1\tSending time : 0.02s\tIncomming time : 0.03s\tdelta 10ms\n"
+                         "2001:2::ff:fe00:1\tSending time : 0.03s\tIncomming time : 0.04s\tdelta 10ms\n",
+                         "Wrong details");
+  NS_TEST_ASSERT_MSG_EQ (TestFileUtils::ReadFile (text + "/64_3_scanning.dat").substr (0, 33),
+                         "#\tX\tY\tZ\tU\n2001:2::ff:fe00:3\t0.01\t",
+                         "Wrong plot data");
+  NS_TEST_ASSERT_MSG_EQ (TestFileUtils::ReadFile (text + "/64_3_penetration.rst"), "2", "Wrong number of compromised hosts");
+  NS_TEST_ASSERT_MSG_EQ (TestFileUtils::ReadFile (text + "/64_3_penetration_details.rst"),
+                         "2001:2::ff:fe00:3\n2001:1::ff:fe00:1\n", "Wrong compromised hosts");
+  NS_TEST_ASSERT_MSG_EQ (TestFileUtils::ReadFile (text + "/64_node0_scanning_details.rst.part"), "", "Temporary file left");
+
+  ScanResultSink compact;
+  compact.SetFormat (ScanResultSink::BINARY);
+  compact.SetDirectories (binary, binary);
+  FeedScanning (compact);
+  FeedPenetration (compact);
+  NS_TEST_ASSERT_MSG_EQ (TestFileUtils::ReadFile (binary + "/64_3_scanning_details.rst"), "", "Text details written in binary format");
+  NS_TEST_ASSERT_MSG_EQ (TestFileUtils::ReadFile (binary + "/64_3_scanning.bin").size (), 16 + 3 * 32, "Wrong binary record size");
+
+  NS_TEST_ASSERT_MSG_EQ (ScanResultSink::Convert (binary + "/64_3_scanning.bin", binary, binary), true, "Conversion failed");
+  NS_TEST_ASSERT_MSG_EQ (ScanResultSink::Convert (binary + "/64_3_penetration.bin", binary, binary), true, "Conversion failed");
+  NS_TEST_ASSERT_MSG_EQ (ScanResultSink::Convert (binary + "/64_3_scanning.rst", binary, binary), false, "Text file converted");
+  const char *files[] = { "64_3_scanning.rst", "64_3_scanning_details.rst", "64_3_scanning.dat",
+                          "64_3_penetration.rst", "64_3_penetration_details.rst" };
+  for (uint32_t i = 0; i < sizeof (files) / sizeof (files[0]); ++i)
+    {
+      NS_TEST_ASSERT_MSG_EQ (TestFileUtils::ReadFile (binary + "/" + files[i]), TestFileUtils::ReadFile (text + "/" + files[i]),
+                             "Converted file " << files[i] << " differs");
+    }
+
+  TestFileUtils::RemoveTree (root);
+}
+
+/**
+ * Test that ScanTools probes every target and discovers the live host,
+ * one probe per event or in batches.
+ */
+class ScanToolsProbeTestCase : public TestCase
+{
+public:
+  ScanToolsProbeTestCase (uint32_t probesPerEvent, double probeRate);
+  virtual ~ScanToolsProbeTestCase ();
+
+private:
+  virtual void DoRun (void);
+  void Tx (Ptr<const Packet> packet);
+  void Rx (Ptr<const Packet> packet, const Address &from);
+
+  uint32_t m_probesPerEvent; //!< probes per event
+  double m_probeRate; //!< probes per second
+  uint32_t m_sent; //!< probes sent by the scanner
+  uint32_t m_received; //!< probes received by the live host
+  Time m_lastProbe; //!< time of the last probe
+};
+
+ScanToolsProbeTestCase::ScanToolsProbeTestCase (uint32_t probesPerEvent, double probeRate)
+  : TestCase ("Test that ScanTools sends one probe per target with " + std::string (probesPerEvent > 1 ? "batched" : "single") + " probes per event"),
+    m_probesPerEvent (probesPerEvent),
+    m_probeRate (probeRate),
+    m_sent (0),
+    m_received (0)
+{
+}
+
+ScanToolsProbeTestCase::~ScanToolsProbeTestCase ()
+{
+}
+
+void
+ScanToolsProbeTestCase::Tx (Ptr<const Packet> packet)
+{
+  ++m_sent;
+  m_lastProbe = Simulator::Now ();
+}
+
+void
+ScanToolsProbeTestCase::Rx (Ptr<const Packet> packet, const Address &from)
+{
+  ++m_received;
+}
+
+void
+ScanToolsProbeTestCase::DoRun (void)
+{
+  NodeContainer n;
+  n.Create (2);
+
+  InternetStackHelper internet;
+  internet.SetIpv4StackInstall (false);
+  internet.Install (n);
+
+  Ptr<SimpleChannel> channel = CreateObject<SimpleChannel> ();
+  NetDeviceContainer d;
+  for (uint32_t i = 0; i < n.GetN (); ++i)
+    {
+      Ptr<SimpleNetDevice> dev = CreateObject<SimpleNetDevice> ();
+      dev->SetAddress (Mac48Address::Allocate ());
+      dev->SetChannel (channel);
+      n.Get (i)->AddDevice (dev);
+      d.Add (dev);
+    }
+
+  // The live host gets 2001:1::200:ff:fe00:XX, a WiFi pattern address
+  Ipv6AddressHelper ipv6;
+  ipv6.SetBase (Ipv6Address ("2001:1::"), Ipv6Prefix (64));
+  ipv6.Assign (d);
+
+  uint16_t port = 4000;
+  PacketSinkHelper sink ("ns3::UdpSocketFactory", Inet6SocketAddress (Ipv6Address::GetAny (), port));
+  ApplicationContainer apps = sink.Install (n.Get (1));
+  apps.Get (0)->TraceConnectWithoutContext ("Rx", MakeCallback (&ScanToolsProbeTestCase::Rx, this));
+  apps.Start (Seconds (1.0));
+  apps.Stop (Seconds (30.0));
+
+  const uint32_t count = 20;
+  std::map<Ipv6Address, Ipv6Prefix> networks;
+  networks[Ipv6Address ("2001:1::")] = Ipv6Prefix (64);
+  ScanToolsHelper scanner (port);
+  scanner.SetAttribute ("MaxRange", UintegerValue (count));
+  scanner.SetAttribute ("Interval", TimeValue (MilliSeconds (20)));
+  scanner.SetAttribute ("ProbesPerEvent", UintegerValue (m_probesPerEvent));
+  scanner.SetAttribute ("ProbeRate", DoubleValue (m_probeRate));
+  apps = scanner.Install (n.Get (0), networks);
+  apps.Get (0)->TraceConnectWithoutContext ("Tx", MakeCallback (&ScanToolsProbeTestCase::Tx, this));
+  apps.Start (Seconds (2.0));
+  apps.Stop (Seconds (30.0));
+
+  PenetrationToolsHelper penetration (port);
+  apps = penetration.Install (n.Get (0));
+  apps.Start (Seconds (2.0));
+  apps.Stop (Seconds (30.0));
+
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  NS_TEST_ASSERT_MSG_EQ (m_sent, 2 * count, "Not every target was probed");
+  NS_TEST_ASSERT_MSG_EQ (m_received, 1, "The live host did not receive exactly one probe");
+  if (m_probesPerEvent > 1)
+    {
+      Time batch = Seconds (m_probesPerEvent / m_probeRate);
+      uint32_t batches = (2 * count + m_probesPerEvent - 1) / m_probesPerEvent;
+      NS_TEST_ASSERT_MSG_EQ (m_lastProbe, Seconds (2.0) + batch * batches, "Probes not paced at ProbeRate");
+    }
+  else
+    {
+      NS_TEST_ASSERT_MSG_EQ (m_lastProbe, Seconds (2.0) + MilliSeconds (20) * (2 * count), "Probes not paced at Interval");
+    }
+}
+
+/**
+ * Test that the shards of a target space are disjoint and cover it, and
+ * that coordinated scanners split the probes and the victims.
+ */
+class ScanToolsShardTestCase : public TestCase
+{
+public:
+  ScanToolsShardTestCase ();
+  virtual ~ScanToolsShardTestCase ();
+
+private:
+  virtual void DoRun (void);
+  void Tx (std::string context, Ptr<const Packet> packet);
+
+  std::map<std::string, uint32_t> m_sent; //!< probes sent per trace context
+};
+
+ScanToolsShardTestCase::ScanToolsShardTestCase ()
+  : TestCase ("Test that coordinated ScanTools share the target space")
+{
+}
+
+ScanToolsShardTestCase::~ScanToolsShardTestCase ()
+{
+}
+
+void
+ScanToolsShardTestCase::Tx (std::string context, Ptr<const Packet> packet)
+{
+  ++m_sent[context];
+}
+
+void
+ScanToolsShardTestCase::DoRun (void)
+{
+  // Generator level: every target in exactly one shard, for both modes
+  ScanTargetGenerator::ShardMode modes[] = { ScanTargetGenerator::SHARD_BY_NETWORK, ScanTargetGenerator::SHARD_INTERLEAVED };
+  for (uint32_t m = 0; m < 2; ++m)
+    {
+      ScanTargetGenerator full;
+      full.SetCount (10);
+      full.AddNetwork (Ipv6Address ("2001:1::"), Ipv6Prefix (64), ScanTargetGenerator::SIXLOWPAN | ScanTargetGenerator::WIFI);
+      full.AddNetwork (Ipv6Address ("2001:2::"), Ipv6Prefix (64), ScanTargetGenerator::WIFI);
+      full.AddNetwork (Ipv6Address ("2001:3::"), Ipv6Prefix (64), ScanTargetGenerator::SIXLOWPAN);
+      std::set<Ipv6Address> expected;
+      Ipv6Address address;
+      while (full.Next (address))
+        {
+          expected.insert (address);
+        }
+
+      std::set<Ipv6Address> merged;
+      uint64_t total = 0;
+      for (uint32_t shard = 0; shard < 3; ++shard)
+        {
+          ScanTargetGenerator part;
+          part.SetCount (10);
+          part.SetShard (shard, 3, modes[m]);
+          part.AddNetwork (Ipv6Address ("2001:1::"), Ipv6Prefix (64), ScanTargetGenerator::SIXLOWPAN | ScanTargetGenerator::WIFI);
+          part.AddNetwork (Ipv6Address ("2001:2::"), Ipv6Prefix (64), ScanTargetGenerator::WIFI);
+          part.AddNetwork (Ipv6Address ("2001:3::"), Ipv6Prefix (64), ScanTargetGenerator::SIXLOWPAN);
+          uint64_t n = 0;
+          while (part.Next (address))
+            {
+              NS_TEST_ASSERT_MSG_EQ (merged.insert (address).second, true, "Target " << address << " in two shards");
+              ++n;
+            }
+          NS_TEST_ASSERT_MSG_EQ (n, part.GetNTargets (), "Shard size differs from GetNTargets");
+          total += n;
+        }
+      NS_TEST_ASSERT_MSG_EQ (total, expected.size (), "Shards do not cover the target space");
+      NS_TEST_ASSERT_MSG_EQ ((merged == expected), true, "Shards do not cover the target space");
+    }
+
+  // Application level: two scanners, two live hosts
+  NodeContainer n;
+  n.Create (4);
+
+  InternetStackHelper internet;
+  internet.SetIpv4StackInstall (false);
+  internet.Install (n);
+
+  Ptr<SimpleChannel> channel = CreateObject<SimpleChannel> ();
+  NetDeviceContainer d;
+  for (uint32_t i = 0; i < n.GetN (); ++i)
+    {
+      Ptr<SimpleNetDevice> dev = CreateObject<SimpleNetDevice> ();
+      std::ostringstream mac;
+      mac << "00:00:00:00:00:0" << i + 1;
+      dev->SetAddress (Mac48Address (mac.str ().c_str ()));
+      dev->SetChannel (channel);
+      n.Get (i)->AddDevice (dev);
+      d.Add (dev);
+    }
+
+  // Node i gets 2001:1::200:ff:fe00:<i+1>, the WiFi pattern host index i
+  Ipv6AddressHelper ipv6;
+  ipv6.SetBase (Ipv6Address ("2001:1::"), Ipv6Prefix (64));
+  ipv6.Assign (d);
+
+  uint16_t port = 4000;
+  UdpEchoServerHelper echo (port);
+  ApplicationContainer apps = echo.Install (NodeContainer (n.Get (2), n.Get (3)));
+  apps.Start (Seconds (1.0));
+  apps.Stop (Seconds (30.0));
+
+  const uint32_t count = 20;
+  std::map<Ipv6Address, Ipv6Prefix> networks;
+  networks[Ipv6Address ("2001:1::")] = Ipv6Prefix (64);
+  ScanToolsHelper scanner (port);
+  scanner.SetAttribute ("MaxRange", UintegerValue (count));
+  scanner.SetAttribute ("Interval", TimeValue (MilliSeconds (20)));
+  NodeContainer attackers (n.Get (0), n.Get (1));
+  apps = scanner.InstallShards (attackers, networks, ScanTargetGenerator::SHARD_INTERLEAVED);
+  apps.Get (0)->TraceConnect ("Tx", "scanner0", MakeCallback (&ScanToolsShardTestCase::Tx, this));
+  apps.Get (1)->TraceConnect ("Tx", "scanner1", MakeCallback (&ScanToolsShardTestCase::Tx, this));
+  apps.Start (Seconds (2.0));
+  apps.Stop (Seconds (10.0));
+  Ptr<ScanDiscoverySet> discovery = apps.Get (0)->GetObject<ScanTools> ()->GetDiscoverySet ();
+  NS_TEST_ASSERT_MSG_EQ ((discovery != 0 && discovery == apps.Get (1)->GetObject<ScanTools> ()->GetDiscoverySet ()), true,
+                         "Scanners do not share a discovery set");
+
+  PenetrationToolsHelper penetration (port);
+  apps = penetration.Install (attackers);
+  apps.Get (0)->TraceConnect ("Tx", "penetration0", MakeCallback (&ScanToolsShardTestCase::Tx, this));
+  apps.Get (1)->TraceConnect ("Tx", "penetration1", MakeCallback (&ScanToolsShardTestCase::Tx, this));
+  apps.Start (Seconds (2.0));
+  apps.Stop (Seconds (30.0));
+
+  Simulator::Run ();
+
+  NS_TEST_ASSERT_MSG_EQ (m_sent["scanner0"], count, "Shard 0 did not probe half of the space");
+  NS_TEST_ASSERT_MSG_EQ (m_sent["scanner1"], count, "Shard 1 did not probe half of the space");
+  NS_TEST_ASSERT_MSG_EQ (discovery->GetSize (), 2, "Victims not merged");
+  NS_TEST_ASSERT_MSG_EQ (discovery->GetSize (0), 1, "Shard 0 does not own its victim");
+  NS_TEST_ASSERT_MSG_EQ (discovery->GetVictims (1).front (), Ipv6Address ("2001:1::200:ff:fe00:4"), "Wrong victim for shard 1");
+  NS_TEST_ASSERT_MSG_EQ (m_sent["penetration0"], 1, "PenetrationTools not fed with its own shard");
+  NS_TEST_ASSERT_MSG_EQ (m_sent["penetration1"], 1, "PenetrationTools not fed with its own shard");
+
+  Simulator::Destroy ();
+}
+
+/**
+ * Test that two shards which discover the same number of hosts keep
+ * their own result files.
+ */
+class ScanToolsShardResultsTestCase : public TestCase
+{
+public:
+  ScanToolsShardResultsTestCase ();
+  virtual ~ScanToolsShardResultsTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+ScanToolsShardResultsTestCase::ScanToolsShardResultsTestCase ()
+  : TestCase ("Test that the result files of the shards do not overwrite each other")
+{
+}
+
+ScanToolsShardResultsTestCase::~ScanToolsShardResultsTestCase ()
+{
+}
+
+void
+ScanToolsShardResultsTestCase::DoRun (void)
+{
+  // The applications write in ./data and ./plot
+  std::string root = SystemPath::MakeTemporaryDirectoryName ();
+  SystemPath::MakeDirectories (SystemPath::Append (root, "data"));
+  SystemPath::MakeDirectories (SystemPath::Append (root, "plot"));
+  char cwd[1024];
+  NS_TEST_ASSERT_MSG_NE (::getcwd (cwd, sizeof (cwd)), 0, "getcwd error");
+  NS_TEST_ASSERT_MSG_EQ (::chdir (root.c_str ()), 0, "chdir error");
+
+  // Two scanners, one live host in each shard
+  NodeContainer n;
+  n.Create (4);
+
+  InternetStackHelper internet;
+  internet.SetIpv4StackInstall (false);
+  internet.Install (n);
+
+  Ptr<SimpleChannel> channel = CreateObject<SimpleChannel> ();
+  NetDeviceContainer d;
+  for (uint32_t i = 0; i < n.GetN (); ++i)
+    {
+      Ptr<SimpleNetDevice> dev = CreateObject<SimpleNetDevice> ();
+      std::ostringstream mac;
+      mac << "00:00:00:00:00:0" << i + 1;
+      dev->SetAddress (Mac48Address (mac.str ().c_str ()));
+      dev->SetChannel (channel);
+      n.Get (i)->AddDevice (dev);
+      d.Add (dev);
+    }
+
+  Ipv6AddressHelper ipv6;
+  ipv6.SetBase (Ipv6Address ("2001:1::"), Ipv6Prefix (64));
+  ipv6.Assign (d);
+
+  uint16_t port = 4000;
+  UdpEchoServerHelper echo (port);
+  ApplicationContainer apps = echo.Install (NodeContainer (n.Get (2), n.Get (3)));
+  apps.Start (Seconds (1.0));
+  apps.Stop (Seconds (30.0));
+
+  std::map<Ipv6Address, Ipv6Prefix> networks;
+  networks[Ipv6Address ("2001:1::")] = Ipv6Prefix (64);
+  ScanToolsHelper scanner (port);
+  scanner.SetAttribute ("MaxRange", UintegerValue (20));
+  scanner.SetAttribute ("Interval", TimeValue (MilliSeconds (20)));
+  NodeContainer attackers (n.Get (0), n.Get (1));
+  apps = scanner.InstallShards (attackers, networks, ScanTargetGenerator::SHARD_INTERLEAVED);
+  apps.Start (Seconds (2.0));
+  apps.Stop (Seconds (10.0));
+
+  PenetrationToolsHelper penetration (port);
+  apps = penetration.Install (attackers);
+  apps.Start (Seconds (2.0));
+  apps.Stop (Seconds (30.0));
+
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  NS_TEST_ASSERT_MSG_EQ (::chdir (cwd), 0, "chdir error");
+
+  // Both shards discover one host, none of them is compromised
+  std::string data = SystemPath::Append (root, "data");
+  NS_TEST_ASSERT_MSG_EQ (TestFileUtils::ReadFile (data + "/100_1_node0_scanning.rst").empty (), false, "Results of shard 0 lost");
+  NS_TEST_ASSERT_MSG_EQ (TestFileUtils::ReadFile (data + "/100_1_node1_scanning.rst").empty (), false, "Results of shard 1 lost");
+  NS_TEST_ASSERT_MSG_EQ (TestFileUtils::ReadFile (data + "/100_1_node0_penetration.rst"), "0", "Results of shard 0 lost");
+  NS_TEST_ASSERT_MSG_EQ (TestFileUtils::ReadFile (data + "/100_1_node1_penetration.rst"), "0", "Results of shard 1 lost");
+  ParameterSweep::Results results = ParameterSweep::ReadResults (data);
+  NS_TEST_ASSERT_MSG_EQ (results.discovered, 2, "Hosts of a shard lost");
+  NS_TEST_ASSERT_MSG_EQ (results.networks, 2, "Networks of a shard lost");
+
+  TestFileUtils::RemoveTree (root);
+}
+
+/**
+ * Test the timer wheel of the window mode: rounding to the tick, several
+ * rounds of the wheel and expiry order.
+ */
+class ProbeTimerWheelTestCase : public TestCase
+{
+public:
+  ProbeTimerWheelTestCase ();
+  virtual ~ProbeTimerWheelTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+ProbeTimerWheelTestCase::ProbeTimerWheelTestCase ()
+  : TestCase ("Check the ScanTools probe timer wheel")
+{
+}
+
+ProbeTimerWheelTestCase::~ProbeTimerWheelTestCase ()
+{
+}
+
+void
+ProbeTimerWheelTestCase::DoRun (void)
+{
+  ProbeTimerWheel wheel;
+  wheel.SetResolution (MilliSeconds (10), 4);
+  Ipv6Address a ("2001:1::1");
+  Ipv6Address b ("2001:1::2");
+  Ipv6Address c ("2001:1::3");
+  wheel.Schedule (a, MilliSeconds (25));
+  wheel.Schedule (b, MilliSeconds (30));
+  // beyond the 4 slots of the wheel: stays for a second round
+  wheel.Schedule (c, MilliSeconds (65));
+  NS_TEST_ASSERT_MSG_EQ (wheel.GetSize (), 3, "Timeouts not armed");
+
+  std::vector<Ipv6Address> expired;
+  wheel.Expire (MilliSeconds (29), expired);
+  NS_TEST_ASSERT_MSG_EQ (expired.size (), 0, "Timeout expired before its tick");
+  wheel.Expire (MilliSeconds (30), expired);
+  NS_TEST_ASSERT_MSG_EQ (expired.size (), 2, "Timeouts of the tick not expired");
+  NS_TEST_ASSERT_MSG_EQ (expired[0], a, "Timeouts not expired in order");
+  wheel.Expire (MilliSeconds (60), expired);
+  NS_TEST_ASSERT_MSG_EQ (expired.size (), 0, "Timeout of a later round expired");
+  wheel.Expire (MilliSeconds (200), expired);
+  NS_TEST_ASSERT_MSG_EQ (expired.size (), 1, "Timeout of a later round lost");
+  NS_TEST_ASSERT_MSG_EQ (expired[0], c, "Wrong timeout expired");
+  NS_TEST_ASSERT_MSG_EQ (wheel.GetSize (), 0, "Timeouts left in the wheel");
+
+  // a timeout in the past expires at the next tick
+  wheel.Schedule (a, MilliSeconds (100));
+  wheel.Expire (MilliSeconds (210), expired);
+  NS_TEST_ASSERT_MSG_EQ (expired.size (), 1, "Late timeout not expired");
+}
+
+/**
+ * Test the window mode: bounded probes in flight, timeouts and the
+ * retransmission which discovers a host missed by the first probe.
+ */
+class ScanToolsWindowTestCase : public TestCase
+{
+public:
+  /**
+   * \param maxRetries retransmissions of the unanswered probes
+   */
+  ScanToolsWindowTestCase (uint32_t maxRetries);
+  virtual ~ScanToolsWindowTestCase ();
+
+private:
+  virtual void DoRun (void);
+  void Tx (Ptr<const Packet> packet);
+
+  uint32_t m_maxRetries; //!< retransmissions
+  Ptr<ScanTools> m_scanner; //!< the scanner
+  uint32_t m_sent; //!< probes sent
+  uint32_t m_maxInFlight; //!< highest number of probes in flight
+};
+
+ScanToolsWindowTestCase::ScanToolsWindowTestCase (uint32_t maxRetries)
+  : TestCase ("Test the ScanTools window mode with " + std::string (maxRetries ? "retransmissions" : "no retransmission")),
+    m_maxRetries (maxRetries),
+    m_sent (0),
+    m_maxInFlight (0)
+{
+}
+
+ScanToolsWindowTestCase::~ScanToolsWindowTestCase ()
+{
+}
+
+void
+ScanToolsWindowTestCase::Tx (Ptr<const Packet> packet)
+{
+  ++m_sent;
+  m_maxInFlight = std::max (m_maxInFlight, m_scanner->GetInFlight () + 1);
+}
+
+void
+ScanToolsWindowTestCase::DoRun (void)
+{
+  NodeContainer n;
+  n.Create (2);
+
+  InternetStackHelper internet;
+  internet.SetIpv4StackInstall (false);
+  internet.Install (n);
+
+  Ptr<SimpleChannel> channel = CreateObject<SimpleChannel> ();
+  NetDeviceContainer d;
+  for (uint32_t i = 0; i < n.GetN (); ++i)
+    {
+      Ptr<SimpleNetDevice> dev = CreateObject<SimpleNetDevice> ();
+      std::ostringstream mac;
+      mac << "00:00:00:00:00:0" << i + 1;
+      dev->SetAddress (Mac48Address (mac.str ().c_str ()));
+      dev->SetChannel (channel);
+      n.Get (i)->AddDevice (dev);
+      d.Add (dev);
+    }
+
+  // The live host is 2001:1::200:ff:fe00:2, the 4th target
+  Ipv6AddressHelper ipv6;
+  ipv6.SetBase (Ipv6Address ("2001:1::"), Ipv6Prefix (64));
+  ipv6.Assign (d);
+
+  // The server only answers after the first probe to the live host: the
+  // host is only found by a retransmission
+  uint16_t port = 4000;
+  UdpEchoServerHelper echo (port);
+  ApplicationContainer apps = echo.Install (n.Get (1));
+  apps.Start (Seconds (2.1));
+  apps.Stop (Seconds (30.0));
+
+  const uint32_t count = 20;
+  const uint32_t window = 4;
+  std::map<Ipv6Address, Ipv6Prefix> networks;
+  networks[Ipv6Address ("2001:1::")] = Ipv6Prefix (64);
+  ScanToolsHelper scanner (port);
+  scanner.SetAttribute ("MaxRange", UintegerValue (count));
+  scanner.SetAttribute ("ProbeRate", DoubleValue (100));
+  scanner.SetAttribute ("Window", UintegerValue (window));
+  scanner.SetAttribute ("ProbeTimeout", TimeValue (MilliSeconds (100)));
+  scanner.SetAttribute ("MaxRetries", UintegerValue (m_maxRetries));
+  scanner.SetAttribute ("AdaptiveRate", BooleanValue (true));
+  apps = scanner.Install (n.Get (0), networks);
+  m_scanner = apps.Get (0)->GetObject<ScanTools> ();
+  m_scanner->TraceConnectWithoutContext ("Tx", MakeCallback (&ScanToolsWindowTestCase::Tx, this));
+  apps.Start (Seconds (2.0));
+  apps.Stop (Seconds (30.0));
+
+  Ptr<ScanDiscoverySet> discovery = CreateObject<ScanDiscoverySet> ();
+  m_scanner->SetDiscoverySet (discovery);
+
+  PenetrationToolsHelper penetration (port);
+  apps = penetration.Install (n.Get (0));
+  apps.Start (Seconds (2.0));
+  apps.Stop (Seconds (30.0));
+
+  Simulator::Stop (Seconds (20.0));
+  Simulator::Run ();
+
+  NS_TEST_ASSERT_MSG_EQ (m_sent, 2 * count * (1 + m_maxRetries), "Unanswered probes not sent MaxRetries more times");
+  NS_TEST_ASSERT_MSG_LT_OR_EQ (m_maxInFlight, window, "More probes in flight than the window");
+  NS_TEST_ASSERT_MSG_EQ (m_maxInFlight, window, "Window not filled");
+  NS_TEST_ASSERT_MSG_EQ (m_scanner->GetInFlight (), 0, "Probes left in flight");
+  NS_TEST_ASSERT_MSG_EQ (discovery->GetSize (), (m_maxRetries ? 1 : 0), "Live host discovery");
+  // the live host needed two probes: 50% loss, the rate is halved once
+  NS_TEST_ASSERT_MSG_EQ_TOL (m_scanner->GetCurrentProbeRate (), (m_maxRetries ? 50 : 100), 1e-9, "Rate not adapted to the loss");
+  m_scanner = 0;
+
+  Simulator::Destroy ();
+}
+
+/**
+ * Test that the PenetrationTools attack the hosts discovered by the
+ * ScanTools of their node while the scan goes on, even when they are
+ * installed before the scanner.
+ */
+class ScanToolsPipelineTestCase : public TestCase
+{
+public:
+  ScanToolsPipelineTestCase ();
+  virtual ~ScanToolsPipelineTestCase ();
+
+private:
+  virtual void DoRun (void);
+  void Discovered (Ipv6Address address);
+  void ScanTx (Ptr<const Packet> packet);
+  void PenetrationTx (Ptr<const Packet> packet);
+
+  std::vector<Ipv6Address> m_discovered; //!< hosts of the HostDiscovered trace
+  uint32_t m_attacks; //!< packets sent by the PenetrationTools
+  Time m_firstAttack; //!< time of the first attack
+  Time m_lastProbe; //!< time of the last probe
+};
+
+ScanToolsPipelineTestCase::ScanToolsPipelineTestCase ()
+  : TestCase ("Test that the penetration starts as the hosts are discovered"),
+    m_attacks (0)
+{
+}
+
+ScanToolsPipelineTestCase::~ScanToolsPipelineTestCase ()
+{
+}
+
+void
+ScanToolsPipelineTestCase::Discovered (Ipv6Address address)
+{
+  m_discovered.push_back (address);
+}
+
+void
+ScanToolsPipelineTestCase::ScanTx (Ptr<const Packet> packet)
+{
+  m_lastProbe = Simulator::Now ();
+}
+
+void
+ScanToolsPipelineTestCase::PenetrationTx (Ptr<const Packet> packet)
+{
+  if (m_attacks++ == 0)
+    {
+      m_firstAttack = Simulator::Now ();
+    }
+}
+
+void
+ScanToolsPipelineTestCase::DoRun (void)
+{
+  NodeContainer n;
+  n.Create (3);
+
+  InternetStackHelper internet;
+  internet.SetIpv4StackInstall (false);
+  internet.Install (n);
+
+  Ptr<SimpleChannel> channel = CreateObject<SimpleChannel> ();
+  NetDeviceContainer d;
+  for (uint32_t i = 0; i < n.GetN (); ++i)
+    {
+      Ptr<SimpleNetDevice> dev = CreateObject<SimpleNetDevice> ();
+      std::ostringstream mac;
+      mac << "00:00:00:00:00:0" << i + 1;
+      dev->SetAddress (Mac48Address (mac.str ().c_str ()));
+      dev->SetChannel (channel);
+      n.Get (i)->AddDevice (dev);
+      d.Add (dev);
+    }
+
+  // Node i gets 2001:1::200:ff:fe00:<i+1>, the WiFi pattern host index i
+  Ipv6AddressHelper ipv6;
+  ipv6.SetBase (Ipv6Address ("2001:1::"), Ipv6Prefix (64));
+  ipv6.Assign (d);
+
+  uint16_t port = 4000;
+  UdpEchoServerHelper echo (port);
+  ApplicationContainer apps = echo.Install (NodeContainer (n.Get (1), n.Get (2)));
+  apps.Start (Seconds (1.0));
+  apps.Stop (Seconds (30.0));
+
+  // The PenetrationTools is the first application of the node
+  PenetrationToolsHelper penetration (port);
+  apps = penetration.Install (n.Get (0));
+  apps.Get (0)->TraceConnectWithoutContext ("Tx", MakeCallback (&ScanToolsPipelineTestCase::PenetrationTx, this));
+  apps.Start (Seconds (2.0));
+  apps.Stop (Seconds (30.0));
+
+  const uint32_t count = 20;
+  std::map<Ipv6Address, Ipv6Prefix> networks;
+  networks[Ipv6Address ("2001:1::")] = Ipv6Prefix (64);
+  ScanToolsHelper scanner (port);
+  scanner.SetAttribute ("MaxRange", UintegerValue (count));
+  scanner.SetAttribute ("Interval", TimeValue (MilliSeconds (20)));
+  apps = scanner.Install (n.Get (0), networks);
+  apps.Get (0)->TraceConnectWithoutContext ("Tx", MakeCallback (&ScanToolsPipelineTestCase::ScanTx, this));
+  apps.Get (0)->TraceConnectWithoutContext ("HostDiscovered", MakeCallback (&ScanToolsPipelineTestCase::Discovered, this));
+  apps.Start (Seconds (2.0));
+  apps.Stop (Seconds (30.0));
+
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  NS_TEST_ASSERT_MSG_EQ (m_discovered.size (), 2, "Every live host must be discovered once");
+  NS_TEST_ASSERT_MSG_EQ (m_discovered[0], Ipv6Address ("2001:1::200:ff:fe00:2"), "Wrong discovered host");
+  NS_TEST_ASSERT_MSG_EQ (m_discovered[1], Ipv6Address ("2001:1::200:ff:fe00:3"), "Wrong discovered host");
+  NS_TEST_ASSERT_MSG_EQ (m_attacks, 2, "Every discovered host must be attacked once");
+  NS_TEST_ASSERT_MSG_LT (m_firstAttack, m_lastProbe, "The penetration waited for the end of the scan");
+}
+
+/**
+ * Test the concurrent attacks and the victim states of PenetrationTools
+ */
+class PenetrationToolsTestCase : public TestCase
+{
+public:
+  PenetrationToolsTestCase ();
+  virtual ~PenetrationToolsTestCase ();
+
+private:
+  virtual void DoRun (void);
+  void Tx (Ptr<const Packet> packet);
+  void Compromised (Ipv6Address address, Time delay);
+  void Answer (Ptr<Socket> socket);
+
+  std::vector<Time> m_sent; //!< sending times of the exploits
+  std::vector<Time> m_delays; //!< times to compromise
+};
+
+PenetrationToolsTestCase::PenetrationToolsTestCase ()
+  : TestCase ("Test the concurrent PenetrationTools attacks")
+{
+}
+
+PenetrationToolsTestCase::~PenetrationToolsTestCase ()
+{
+}
+
+void
+PenetrationToolsTestCase::Tx (Ptr<const Packet> packet)
+{
+  m_sent.push_back (Simulator::Now ());
+}
+
+void
+PenetrationToolsTestCase::Compromised (Ipv6Address address, Time delay)
+{
+  m_delays.push_back (delay);
+}
+
+void
+PenetrationToolsTestCase::Answer (Ptr<Socket> socket)
+{
+  Ptr<Packet> packet;
+  Address from;
+  while ((packet = socket->RecvFrom (from)))
+    {
+      CoapHeader request;
+      packet->RemoveHeader (request);
+      CoapHeader response;
+      response.SetType (CoapHeader::ACK);
+      response.SetCode (PenetrationTools::STATUS_COMPROMISED);
+      response.SetMessageId (request.GetMessageId ());
+      Ptr<Packet> answer = Create<Packet> ();
+      answer->AddHeader (response);
+      socket->SendTo (answer, 0, from);
+    }
+}
+
+void
+PenetrationToolsTestCase::DoRun (void)
+{
+  NodeContainer n;
+  n.Create (4);
+
+  InternetStackHelper internet;
+  internet.SetIpv4StackInstall (false);
+  internet.Install (n);
+
+  Ptr<SimpleChannel> channel = CreateObject<SimpleChannel> ();
+  NetDeviceContainer d;
+  for (uint32_t i = 0; i < n.GetN (); ++i)
+    {
+      Ptr<SimpleNetDevice> dev = CreateObject<SimpleNetDevice> ();
+      std::ostringstream mac;
+      mac << "00:00:00:00:00:0" << i + 1;
+      dev->SetAddress (Mac48Address (mac.str ().c_str ()));
+      dev->SetChannel (channel);
+      n.Get (i)->AddDevice (dev);
+      d.Add (dev);
+    }
+
+  Ipv6AddressHelper ipv6;
+  ipv6.SetBase (Ipv6Address ("2001:1::"), Ipv6Prefix (64));
+  ipv6.Assign (d);
+  Ipv6Address compromised ("2001:1::200:ff:fe00:2");
+  Ipv6Address failed ("2001:1::200:ff:fe00:3");
+  Ipv6Address silent ("2001:1::200:ff:fe00:4");
+
+  // node 1 gives up, node 2 echoes the exploit, node 3 never answers
+  uint16_t port = 4000;
+  Ptr<Socket> victim = Socket::CreateSocket (n.Get (1), UdpSocketFactory::GetTypeId ());
+  victim->Bind (Inet6SocketAddress (Ipv6Address::GetAny (), port));
+  victim->SetRecvCallback (MakeCallback (&PenetrationToolsTestCase::Answer, this));
+  UdpEchoServerHelper echo (port);
+  ApplicationContainer apps = echo.Install (n.Get (2));
+  apps.Start (Seconds (0.5));
+  apps.Stop (Seconds (30.0));
+
+  PenetrationToolsHelper penetration (port);
+  penetration.SetAttribute ("Interval", TimeValue (MilliSeconds (10)));
+  penetration.SetAttribute ("AttackTimeout", TimeValue (MilliSeconds (100)));
+  penetration.SetAttribute ("Concurrency", UintegerValue (3));
+  penetration.SetAttribute ("MaxRetries", UintegerValue (1));
+  apps = penetration.Install (n.Get (0));
+  Ptr<PenetrationTools> attacker = apps.Get (0)->GetObject<PenetrationTools> ();
+  attacker->TraceConnectWithoutContext ("Tx", MakeCallback (&PenetrationToolsTestCase::Tx, this));
+  attacker->TraceConnectWithoutContext ("TimeToCompromise", MakeCallback (&PenetrationToolsTestCase::Compromised, this));
+  apps.Start (Seconds (1.0));
+  apps.Stop (Seconds (30.0));
+
+  // handed over before the start of the application
+  attacker->AddVictim (compromised);
+  attacker->AddVictim (failed);
+  attacker->AddVictim (silent);
+  attacker->AddVictim (compromised);
+
+  Simulator::Run ();
+
+  // one exploit each, and a retry for the silent host
+  NS_TEST_ASSERT_MSG_EQ (m_sent.size (), 4, "Wrong number of exploits");
+  NS_TEST_ASSERT_MSG_EQ (m_sent[0], Seconds (1.01), "Attacks not started with the application");
+  NS_TEST_ASSERT_MSG_EQ (m_sent[2], Seconds (1.01), "Attacks not concurrent");
+  NS_TEST_ASSERT_MSG_EQ (m_sent[3], Seconds (1.11), "Silent host not attacked again after the timeout");
+  NS_TEST_ASSERT_MSG_EQ (attacker->GetVictimState (compromised), PenetrationTools::VICTIM_COMPROMISED, "Wrong state");
+  NS_TEST_ASSERT_MSG_EQ (attacker->GetVictimState (failed), PenetrationTools::VICTIM_FAILED, "Wrong state");
+  NS_TEST_ASSERT_MSG_EQ (attacker->GetVictimState (silent), PenetrationTools::VICTIM_TIMED_OUT, "Wrong state");
+  NS_TEST_ASSERT_MSG_EQ (attacker->GetNVictims (PenetrationTools::VICTIM_COMPROMISED), 1, "Wrong number of compromised hosts");
+  NS_TEST_ASSERT_MSG_EQ (m_delays.size (), 1, "Time to compromise not traced");
+  // from the hand-off to the answer, which needs the neighbor discovery
+  NS_TEST_ASSERT_MSG_GT_OR_EQ (m_delays[0], Seconds (1.01), "Wrong time to compromise");
+  NS_TEST_ASSERT_MSG_LT (m_delays[0], Seconds (1.11), "Wrong time to compromise");
+
+  Simulator::Destroy ();
+}
+
+/**
+ * Check that the copies of a payload template carry its data and leave it
+ * unchanged.
+ */
+class PayloadTemplateTestCase : public TestCase
+{
+public:
+  PayloadTemplateTestCase ();
+  virtual ~PayloadTemplateTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+PayloadTemplateTestCase::PayloadTemplateTestCase ()
+  : TestCase ("Check the payload templates of the applications")
+{
+}
+
+PayloadTemplateTestCase::~PayloadTemplateTestCase ()
+{
+}
+
+void
+PayloadTemplateTestCase::DoRun (void)
+{
+  PayloadTemplate payload;
+  NS_TEST_ASSERT_MSG_EQ (payload.GetSize (), 0, "Template not empty");
+  payload.SetSize (100);
+  NS_TEST_ASSERT_MSG_EQ (payload.GetSize (), 100, "Wrong size");
+  NS_TEST_ASSERT_MSG_EQ (payload.IsFilled (), false, "Don't care bytes reported as filled");
+
+  const uint8_t pattern[] = { 1, 2, 3 };
+  payload.SetFill (pattern, sizeof (pattern), 7);
+  NS_TEST_ASSERT_MSG_EQ (payload.IsFilled (), true, "Fill not reported");
+  Ptr<Packet> first = payload.Copy ();
+  uint8_t bytes[7];
+  NS_TEST_ASSERT_MSG_EQ (first->CopyData (bytes, sizeof (bytes)), 7, "Wrong copy size");
+  for (uint32_t i = 0; i < sizeof (bytes); ++i)
+    {
+      NS_TEST_ASSERT_MSG_EQ (static_cast<uint32_t> (bytes[i]), i % 3 + 1, "Wrong byte " << i);
+    }
+
+  // a header added to a copy only changes that copy
+  CoapHeader header;
+  header.SetMessageId (1);
+  first->AddHeader (header);
+  Ptr<Packet> second = payload.Copy ();
+  NS_TEST_ASSERT_MSG_EQ (first->GetSize (), 11, "Header not added to the copy");
+  NS_TEST_ASSERT_MSG_EQ (second->GetSize (), 7, "Template changed by a copy");
+  second->CopyData (bytes, sizeof (bytes));
+  NS_TEST_ASSERT_MSG_EQ (static_cast<uint32_t> (bytes[0]), 1, "Template data changed by a copy");
+
+  payload.SetFill ("attack");
+  NS_TEST_ASSERT_MSG_EQ (payload.GetSize (), 7, "String fill not zero-terminated");
+  payload.SetPacket (first);
+  NS_TEST_ASSERT_MSG_EQ (payload.GetSize (), 11, "Packet not used as the template");
+}
+
+class ScanToolsTestSuite : public TestSuite
+{
+public:
+  ScanToolsTestSuite ();
+};
+
+ScanToolsTestSuite::ScanToolsTestSuite ()
+  : TestSuite ("scan-tools", UNIT)
+{
+  AddTestCase (new ScanTargetGeneratorOrderTestCase, TestCase::QUICK);
+  AddTestCase (new ScanStrategyTestCase, TestCase::QUICK);
+  AddTestCase (new ProbeTableTestCase, TestCase::QUICK);
+  AddTestCase (new ScanResultSinkTestCase, TestCase::QUICK);
+  AddTestCase (new ScanToolsProbeTestCase (1, 0), TestCase::QUICK);
+  AddTestCase (new ScanToolsProbeTestCase (8, 400), TestCase::QUICK);
+  AddTestCase (new ScanToolsShardTestCase, TestCase::QUICK);
+  AddTestCase (new ScanToolsShardResultsTestCase, TestCase::QUICK);
+  AddTestCase (new ScanToolsPipelineTestCase, TestCase::QUICK);
+  AddTestCase (new PenetrationToolsTestCase, TestCase::QUICK);
+  AddTestCase (new ProbeTimerWheelTestCase, TestCase::QUICK);
+  AddTestCase (new PayloadTemplateTestCase, TestCase::QUICK);
+  AddTestCase (new ScanToolsWindowTestCase (0), TestCase::QUICK);
+  AddTestCase (new ScanToolsWindowTestCase (1), TestCase::QUICK);
+}
+
+static ScanToolsTestSuite scanToolsTestSuite;
@@ -0,0 +1,128 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2015 Universite catholique de Louvain
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Lionel Metongnon <lionel.metongnon@uclouvain.be>
+ */
+
+#include "ns3/test.h"
+#include "ns3/scenario-helper.h"
+#include "ns3/packet-sink.h"
+#include "ns3/packet-sink-helper.h"
+#include "ns3/udp-client-server-helper.h"
+#include "ns3/inet6-socket-address.h"
+#include "ns3/ipv6-address-generator.h"
+#include "ns3/uinteger.h"
+#include "ns3/simulator.h"
+
+#include <sstream>
+
+using namespace ns3;
+
+/**
+ * Build a scenario from a description and send a packet across its core
+ */
+class ScenarioTestCase : public TestCase
+{
+public:
+  ScenarioTestCase ();
+  virtual ~ScenarioTestCase ();
+
+private:
+  virtual void DoRun (void);
+  virtual void DoTeardown (void);
+};
+
+ScenarioTestCase::ScenarioTestCase ()
+  : TestCase ("Load a scenario description")
+{
+}
+
+ScenarioTestCase::~ScenarioTestCase ()
+{
+}
+
+void
+ScenarioTestCase::DoRun (void)
+{
+  std::istringstream description (
+    "# two groups of IoT networks and an attacker behind one core\n"
+    "set offices 2\n"
+    "set port 5683\n"
+    "network office csma ${offices} 2 2001:1::/64 rate=10Mbps\n"
+    "network sensors sixlowpan 2 3 2001:2::/64 shared=1\n"
+    "network attacker csma 1 1 2001:3::/64\n"
+    "core backbone 2001:ff::/64\n"
+    "\n"
+    "target office\n"
+    "target sensors   # the 6LoWPAN networks\n"
+    "target 2001:4::/64\n"
+    "app coap-client sensors port=${port}\n"
+    "app coap-server sensors:routers Interval=10s\n"
+    "app scan-tools attacker start=10s\n"
+    "app penetration-tools attacker start=10s\n");
+
+  ScenarioHelper scenario;
+  scenario.SetVariable ("offices", "3");
+  scenario.Load (description);
+
+  const std::vector<ScenarioHelper::Entry> &offices = scenario.GetGroup ("office");
+  NS_TEST_ASSERT_MSG_EQ (offices.size (), 3, "SetVariable must win over the file");
+  NS_TEST_ASSERT_MSG_EQ (offices[2].address, Ipv6Address ("2001:1:0:2::"), "wrong network");
+  NS_TEST_ASSERT_MSG_EQ (offices[2].network->GetNodes ().GetN (), 2, "wrong number of nodes");
+  NS_TEST_ASSERT_MSG_EQ (scenario.GetGroup ("sensors").size (), 2, "wrong number of networks");
+  NS_TEST_ASSERT_MSG_EQ (scenario.GetGroup ("sensors")[1].network->GetNodes ().GetN (), 3, "wrong number of nodes");
+  NS_TEST_ASSERT_MSG_EQ (scenario.GetGroup ("backbone")[0].network->GetNodes ().GetN (), 7, "the core must join all the routers");
+  NS_TEST_ASSERT_MSG_EQ (scenario.GetNNetworks (), 7, "wrong number of networks");
+  NS_TEST_ASSERT_MSG_EQ (scenario.GetTargetedNetworks ().size (), 6, "wrong number of targeted networks");
+  NS_TEST_ASSERT_MSG_EQ (scenario.GetTargetedNetworks ().count (Ipv6Address ("2001:2:0:1::")), 1, "missing targeted network");
+  // 6 clients, 2 servers, 1 scanner and 1 penetration tool
+  NS_TEST_ASSERT_MSG_EQ (scenario.GetApplications ().GetN (), 10, "wrong number of applications");
+
+  // the static routes lead from the attacker to an office through the core
+  Ptr<Node> target = offices[2].network->GetNodes ().Get (1);
+  Ipv6Address address = offices[2].network->GetIpv6Interfaces ().GetAddress (2, 1);
+  PacketSinkHelper sinkHelper ("ns3::UdpSocketFactory", Inet6SocketAddress (Ipv6Address::GetAny (), 9));
+  Ptr<PacketSink> sink = sinkHelper.Install (target).Get (0)->GetObject<PacketSink> ();
+  UdpClientHelper client (address, 9);
+  client.SetAttribute ("MaxPackets", UintegerValue (1));
+  client.Install (scenario.GetGroup ("attacker")[0].network->GetNodes ().Get (0)).Start (Seconds (1));
+
+  Simulator::Stop (Seconds (3));
+  Simulator::Run ();
+  NS_TEST_ASSERT_MSG_GT (sink->GetTotalRx (), 0, "the packet did not cross the core");
+}
+
+void
+ScenarioTestCase::DoTeardown (void)
+{
+  Ipv6AddressGenerator::Reset ();
+  Simulator::Destroy ();
+}
+
+class ScenarioTestSuite : public TestSuite
+{
+public:
+  ScenarioTestSuite ();
+};
+
+ScenarioTestSuite::ScenarioTestSuite ()
+  : TestSuite ("scenario", UNIT)
+{
+  AddTestCase (new ScenarioTestCase, TestCase::QUICK);
+}
+
+static ScenarioTestSuite scenarioTestSuite;
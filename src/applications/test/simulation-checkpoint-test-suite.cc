@@ -0,0 +1,161 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2015 Universite catholique de Louvain
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Lionel Metongnon <lionel.metongnon@uclouvain.be>
+ */
+
+#include "ns3/test.h"
+#include "ns3/simulation-checkpoint.h"
+#include "ns3/simulator.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/system-path.h"
+#include "test-file-utils.h"
+
+#include <fstream>
+#include <sstream>
+#include <string>
+
+using namespace ns3;
+
+/**
+ * Fork variants of a simulation which counts ticks and draws random
+ * numbers, and check that each one goes on from the checkpoint
+ */
+class SimulationCheckpointTestCase : public TestCase
+{
+public:
+  SimulationCheckpointTestCase ();
+  virtual ~SimulationCheckpointTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * \brief Count a tick and schedule the next one
+   */
+  void Tick (void);
+
+  /**
+   * \brief Set a variant apart
+   * \param variant the index of the variant
+   */
+  void Configure (uint32_t variant);
+
+  /**
+   * \brief Write the state of the variant in its directory
+   */
+  void Write (void);
+
+  uint32_t m_ticks;                      //!< ticks counted
+  uint32_t m_step;                       //!< increment of each tick
+  Ptr<UniformRandomVariable> m_random;   //!< stream drawn before and after the checkpoint
+  uint32_t m_draw;                       //!< value drawn after the checkpoint
+};
+
+SimulationCheckpointTestCase::SimulationCheckpointTestCase ()
+  : TestCase ("Fork the variants from the state at the checkpoint")
+{
+}
+
+SimulationCheckpointTestCase::~SimulationCheckpointTestCase ()
+{
+}
+
+void
+SimulationCheckpointTestCase::Tick (void)
+{
+  m_ticks += m_step;
+  m_random->GetInteger (0, 1000000);
+  Simulator::Schedule (Seconds (1), &SimulationCheckpointTestCase::Tick, this);
+}
+
+void
+SimulationCheckpointTestCase::Configure (uint32_t variant)
+{
+  m_step = variant + 1;
+}
+
+void
+SimulationCheckpointTestCase::Write (void)
+{
+  m_draw = m_random->GetInteger (0, 1000000);
+  // the current directory is the one of the variant
+  std::ofstream os ("state.txt");
+  os << m_ticks << " " << m_draw << "\n";
+}
+
+void
+SimulationCheckpointTestCase::DoRun (void)
+{
+  std::string root = SystemPath::MakeTemporaryDirectoryName ();
+  m_ticks = 0;
+  m_step = 1;
+  m_random = CreateObject<UniformRandomVariable> ();
+
+  SimulationCheckpoint checkpoint;
+  checkpoint.SetVariants (3);
+  checkpoint.SetVariantCallback (MakeCallback (&SimulationCheckpointTestCase::Configure, this));
+  checkpoint.SetOutputDirectory (root);
+  checkpoint.Schedule (Seconds (4.5));
+  Simulator::Schedule (Seconds (0), &SimulationCheckpointTestCase::Tick, this);
+  Simulator::Schedule (Seconds (10.5), &SimulationCheckpointTestCase::Write, this);
+  Simulator::Stop (Seconds (11));
+  Simulator::Run ();
+  Simulator::Destroy ();
+  m_random = 0;
+  uint32_t variant = checkpoint.GetVariant ();
+  // the child variants exit here
+  uint32_t failed = checkpoint.Wait ();
+
+  NS_TEST_ASSERT_MSG_EQ (variant, 0, "Child variant back from Wait");
+  NS_TEST_ASSERT_MSG_EQ (checkpoint.IsForked (), true, "Not forked");
+  NS_TEST_ASSERT_MSG_EQ (failed, 0, "Failed variants");
+  NS_TEST_ASSERT_MSG_EQ (checkpoint.GetStatuses ().size (), 3, "Wrong number of variants");
+
+  // 5 ticks before the checkpoint, then 6 ticks of variant + 1
+  std::ostringstream expected;
+  for (uint32_t i = 0; i < 3; ++i)
+    {
+      std::ostringstream path;
+      path << root << "/variant-" << i << "/state.txt";
+      std::ostringstream state;
+      state << 5 + 6 * (i + 1) << " " << m_draw << "\n";
+      NS_TEST_ASSERT_MSG_EQ (TestFileUtils::ReadFile (path.str ()), state.str (),
+                             "Variant " << i << " not forked from the checkpoint");
+      expected << i << "\t0\t0\t0\t0\n";
+    }
+
+  std::string summary = TestFileUtils::ReadFile (root + "/summary.tsv");
+  NS_TEST_ASSERT_MSG_EQ (summary, "#variant\tstatus\tdiscovered\tnetworks\tcompromised\n" + expected.str (),
+                         "Wrong summary");
+
+  TestFileUtils::RemoveTree (root);
+}
+
+class SimulationCheckpointTestSuite : public TestSuite
+{
+public:
+  SimulationCheckpointTestSuite ();
+};
+
+SimulationCheckpointTestSuite::SimulationCheckpointTestSuite ()
+  : TestSuite ("simulation-checkpoint", UNIT)
+{
+  AddTestCase (new SimulationCheckpointTestCase, TestCase::QUICK);
+}
+
+static SimulationCheckpointTestSuite simulationCheckpointTestSuite;
@@ -0,0 +1,58 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2015 Universite catholique de Louvain
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Lionel Metongnon <lionel.metongnon@uclouvain.be>
+ */
+
+#include "test-file-utils.h"
+#include "ns3/system-path.h"
+
+#include <cstdio>
+#include <fstream>
+#include <list>
+#include <sstream>
+
+namespace ns3 {
+
+std::string
+TestFileUtils::ReadFile (std::string path)
+{
+  std::ifstream is (path.c_str ());
+  std::ostringstream content;
+  content << is.rdbuf ();
+  return content.str ();
+}
+
+void
+TestFileUtils::RemoveTree (std::string path)
+{
+  if (std::remove (path.c_str ()) == 0)
+    {
+      return;
+    }
+  std::list<std::string> files = SystemPath::ReadFiles (path);
+  for (std::list<std::string>::const_iterator file = files.begin (); file != files.end (); ++file)
+    {
+      if (*file != "." && *file != "..")
+        {
+          RemoveTree (path + "/" + *file);
+        }
+    }
+  std::remove (path.c_str ());
+}
+
+} // namespace ns3
@@ -0,0 +1,50 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2015 Universite catholique de Louvain
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Lionel Metongnon <lionel.metongnon@uclouvain.be>
+ */
+
+#ifndef TEST_FILE_UTILS_H
+#define TEST_FILE_UTILS_H
+
+#include <string>
+
+namespace ns3 {
+
+/**
+ * \ingroup udpecho
+ * \brief File helpers shared by the tests which write result files
+ */
+class TestFileUtils
+{
+public:
+  /**
+   * \param path a file
+   * \returns the content of the file, empty if it cannot be read
+   */
+  static std::string ReadFile (std::string path);
+
+  /**
+   * \brief Remove a file, or a directory and all its content
+   * \param path the file or directory
+   */
+  static void RemoveTree (std::string path);
+};
+
+} // namespace ns3
+
+#endif /* TEST_FILE_UTILS_H */
@@ -25,11 +25,12 @@
 #include "scheduler.h"
 #include "event-impl.h"
 #include "system-thread.h"
-#include "ns3/system-mutex.h"
+#include "mpsc-queue.h"
 
 #include "ptr.h"
 
 #include <list>
+#include <vector>
 
 /**
  * \file
@@ -95,17 +96,10 @@ private:
     /** The event implementation. */
     EventImpl *event;
   };
-  /** Container type for the events from a different context. */
-  typedef std::list<struct EventWithContext> EventsWithContext;
-  /** The container of events from a different context. */
-  EventsWithContext m_eventsWithContext;
-  /**
-   * Flag \c true if all events with context have been moved to the
-   * primary event queue.
-   */
-  bool m_eventsWithContextEmpty;
-  /** Mutex to control access to the list of events with context. */
-  SystemMutex m_eventsWithContextMutex;
+  /** The events from a different context, pushed without a lock. */
+  MpscQueue<struct EventWithContext> m_eventsWithContext;
+  /** The events being moved to the primary event queue. */
+  std::vector<struct EventWithContext> m_eventsWithContextBuffer;
 
   /** Container type for the events to run at Simulator::Destroy() */
   typedef std::list<EventId> DestroyEvents;
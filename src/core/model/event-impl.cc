@@ -19,6 +19,7 @@
  */
 
 #include "event-impl.h"
+#include "thread-safety.h"
 #include "log.h"
 
 /**
@@ -31,6 +32,30 @@ namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("EventImpl");
 
+namespace {
+
+/** Granularity of the size classes of the events */
+const std::size_t POOL_GRANULARITY = 16;
+/** Number of size classes, up to 128 bytes */
+const uint32_t POOL_CLASSES = 8;
+/** Maximum number of free events of a class in a thread */
+const uint32_t POOL_MAX_FREE = 4096;
+
+/** A free event */
+struct FreeEvent
+{
+  FreeEvent *next; //!< Next free event of the same size class
+};
+
+/** Free events of the thread, by size class */
+__thread FreeEvent *g_freeEvents[POOL_CLASSES];
+/** Number of free events of the thread, by size class */
+__thread uint32_t g_nFreeEvents[POOL_CLASSES];
+/** Whether the events are recycled */
+bool g_poolEnabled = true;
+
+} // anonymous namespace
+
 EventImpl::~EventImpl ()
 {
   NS_LOG_FUNCTION (this);
@@ -66,4 +91,65 @@ EventImpl::IsCancelled (void)
   return m_cancel;
 }
 
+// Note: no logging in the allocation of the events, as in the simulators
+void *
+EventImpl::operator new (std::size_t size)
+{
+  uint32_t sizeClass = (size - 1) / POOL_GRANULARITY;
+  if (sizeClass >= POOL_CLASSES)
+    {
+      return ::operator new (size);
+    }
+  FreeEvent *event = g_freeEvents[sizeClass];
+  if (event != 0)
+    {
+      g_freeEvents[sizeClass] = event->next;
+      g_nFreeEvents[sizeClass]--;
+      return event;
+    }
+  // any event of the class may reuse the memory
+  return ::operator new ((sizeClass + 1) * POOL_GRANULARITY);
+}
+
+void
+EventImpl::operator delete (void *p, std::size_t size)
+{
+  uint32_t sizeClass = (size - 1) / POOL_GRANULARITY;
+  // the threads of a parallel simulation delete the events created by
+  // the others: leave them to malloc, like the packet free lists
+  if (sizeClass >= POOL_CLASSES || !g_poolEnabled || ThreadSafety::IsEnabled ()
+      || g_nFreeEvents[sizeClass] >= POOL_MAX_FREE)
+    {
+      ::operator delete (p);
+      return;
+    }
+  FreeEvent *event = static_cast<FreeEvent *> (p);
+  event->next = g_freeEvents[sizeClass];
+  g_freeEvents[sizeClass] = event;
+  g_nFreeEvents[sizeClass]++;
+}
+
+void
+EventImpl::EnablePool (bool enable)
+{
+  NS_LOG_FUNCTION (enable);
+  g_poolEnabled = enable;
+}
+
+void
+EventImpl::ReleaseCache (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  for (uint32_t sizeClass = 0; sizeClass < POOL_CLASSES; ++sizeClass)
+    {
+      while (g_freeEvents[sizeClass] != 0)
+        {
+          FreeEvent *event = g_freeEvents[sizeClass];
+          g_freeEvents[sizeClass] = event->next;
+          ::operator delete (event);
+        }
+      g_nFreeEvents[sizeClass] = 0;
+    }
+}
+
 } // namespace ns3
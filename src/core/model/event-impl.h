@@ -21,6 +21,7 @@
 #define EVENT_IMPL_H
 
 #include <stdint.h>
+#include <cstddef>
 #include "simple-ref-count.h"
 
 /**
@@ -66,6 +67,37 @@ public:
    */
   bool IsCancelled (void);
 
+  /**
+   * Allocate an event.
+   *
+   * The events are created and deleted by the million: the events of
+   * up to 128 bytes are recycled through free lists local to each
+   * thread, by size class, instead of going through malloc and free.
+   *
+   * \param size The size of the event.
+   * \returns The memory of the event.
+   */
+  static void *operator new (std::size_t size);
+  /**
+   * Release an event into the free list of its size class.
+   *
+   * \param p The memory of the event.
+   * \param size The size of the event.
+   */
+  static void operator delete (void *p, std::size_t size);
+  /**
+   * \param enable Whether to recycle the memory of the events, on by
+   * default.
+   */
+  static void EnablePool (bool enable);
+  /**
+   * Free the recycled events of the calling thread.
+   *
+   * The free lists are not released when a thread exits: a thread
+   * which deleted events must call this before it returns.
+   */
+  static void ReleaseCache (void);
+
 protected:
   /**
    * Implementation for Invoke().
@@ -0,0 +1,286 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2015 Universite catholique de Louvain
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Lionel Metongnon <lionel.metongnon@uclouvain.be>
+ */
+
+#include "ladder-scheduler.h"
+#include "event-impl.h"
+#include "assert.h"
+#include "log.h"
+#include <algorithm>
+
+/**
+ * \file
+ * \ingroup scheduler
+ * Implementation of ns3::LadderScheduler class.
+ */
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("LadderScheduler");
+
+NS_OBJECT_ENSURE_REGISTERED (LadderScheduler);
+
+namespace {
+
+/** Largest bucket moved to the bottom without spawning a rung. */
+const uint32_t THRESHOLD = 50;
+/** Largest bottom before it spawns a rung. */
+const uint32_t BOTTOM_THRESHOLD = 4 * THRESHOLD;
+/** Maximum number of rungs. */
+const uint32_t MAX_RUNGS = 8;
+/** Maximum number of buckets of a rung. */
+const uint32_t MAX_BUCKETS = 1 << 16;
+
+/**
+ * Order of the bottom, from the last event to the first.
+ *
+ * \param [in] a The first event.
+ * \param [in] b The second event.
+ * \returns \c true if \c a runs after \c b
+ */
+bool
+IsLater (const Scheduler::Event &a, const Scheduler::Event &b)
+{
+  return b.key < a.key;
+}
+
+} // anonymous namespace
+
+TypeId
+LadderScheduler::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::LadderScheduler")
+    .SetParent<Scheduler> ()
+    .SetGroupName ("Core")
+    .AddConstructor<LadderScheduler> ()
+  ;
+  return tid;
+}
+
+LadderScheduler::LadderScheduler ()
+  : m_topStart (0),
+    m_topMin (0),
+    m_topMax (0),
+    m_rungs (MAX_RUNGS),
+    m_nRungs (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+LadderScheduler::~LadderScheduler ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+uint32_t
+LadderScheduler::FindRung (uint64_t ts) const
+{
+  for (uint32_t i = 0; i < m_nRungs; ++i)
+    {
+      const Rung &rung = m_rungs[i];
+      if (ts >= rung.start + rung.current * rung.width)
+        {
+          NS_ASSERT ((ts - rung.start) / rung.width < rung.nBuckets);
+          return i;
+        }
+    }
+  return m_nRungs;
+}
+
+void
+LadderScheduler::Spawn (Events &events, uint64_t start, uint64_t end)
+{
+  NS_LOG_FUNCTION (this << events.size () << start << end);
+  NS_ASSERT (m_nRungs < MAX_RUNGS && end > start);
+  uint64_t n = std::min<uint64_t> (std::max<uint64_t> (events.size (), 1), MAX_BUCKETS);
+  uint64_t width = (end - start + n - 1) / n;
+  Rung &rung = m_rungs[m_nRungs++];
+  rung.start = start;
+  rung.width = width;
+  rung.current = 0;
+  rung.nBuckets = (end - start + width - 1) / width;
+  rung.count = events.size ();
+  if (rung.buckets.size () < rung.nBuckets)
+    {
+      rung.buckets.resize (rung.nBuckets);
+    }
+  for (Events::const_iterator i = events.begin (); i != events.end (); ++i)
+    {
+      rung.buckets[(i->key.m_ts - start) / width].push_back (*i);
+    }
+  events.clear ();
+}
+
+void
+LadderScheduler::Refill (void)
+{
+  while (m_bottom.empty ())
+    {
+      if (m_nRungs == 0)
+        {
+          if (m_top.empty ())
+            {
+              return;
+            }
+          Spawn (m_top, m_topMin, m_topMax + 1);
+          m_topStart = m_rungs[0].start + m_rungs[0].nBuckets * m_rungs[0].width;
+          continue;
+        }
+      Rung &rung = m_rungs[m_nRungs - 1];
+      if (rung.count == 0)
+        {
+          m_nRungs--;
+          continue;
+        }
+      while (rung.buckets[rung.current].empty ())
+        {
+          rung.current++;
+        }
+      uint64_t start = rung.start + rung.current * rung.width;
+      Events &bucket = rung.buckets[rung.current];
+      rung.current++;
+      rung.count -= bucket.size ();
+      if (bucket.size () > THRESHOLD && rung.width > 1 && m_nRungs < MAX_RUNGS)
+        {
+          Spawn (bucket, start, start + rung.width);
+        }
+      else
+        {
+          // the bucket takes the storage of the bottom
+          m_bottom.swap (bucket);
+          std::sort (m_bottom.begin (), m_bottom.end (), IsLater);
+        }
+    }
+}
+
+void
+LadderScheduler::Insert (const Event &ev)
+{
+  NS_LOG_FUNCTION (this << ev.impl << ev.key.m_ts << ev.key.m_uid);
+  uint64_t ts = ev.key.m_ts;
+  if (ts >= m_topStart)
+    {
+      if (m_top.empty ())
+        {
+          m_topMin = ts;
+          m_topMax = ts;
+        }
+      m_topMin = std::min (m_topMin, ts);
+      m_topMax = std::max (m_topMax, ts);
+      m_top.push_back (ev);
+    }
+  else
+    {
+      uint32_t i = FindRung (ts);
+      if (i < m_nRungs)
+        {
+          Rung &rung = m_rungs[i];
+          rung.buckets[(ts - rung.start) / rung.width].push_back (ev);
+          rung.count++;
+        }
+      else
+        {
+          m_bottom.insert (std::upper_bound (m_bottom.begin (), m_bottom.end (), ev, IsLater), ev);
+          if (m_bottom.size () > BOTTOM_THRESHOLD && m_nRungs < MAX_RUNGS
+              && m_bottom.front ().key.m_ts != m_bottom.back ().key.m_ts)
+            {
+              // too many events before the ladder: spread them on a new rung
+              uint64_t end = m_topStart;
+              if (m_nRungs > 0)
+                {
+                  const Rung &lowest = m_rungs[m_nRungs - 1];
+                  end = lowest.start + lowest.current * lowest.width;
+                }
+              Spawn (m_bottom, m_bottom.back ().key.m_ts, end);
+            }
+        }
+    }
+  Refill ();
+}
+
+bool
+LadderScheduler::IsEmpty (void) const
+{
+  NS_LOG_FUNCTION (this);
+  // the bottom is refilled whenever it gets empty
+  return m_bottom.empty ();
+}
+
+Scheduler::Event
+LadderScheduler::PeekNext (void) const
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT (!m_bottom.empty ());
+  return m_bottom.back ();
+}
+
+Scheduler::Event
+LadderScheduler::RemoveNext (void)
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT (!m_bottom.empty ());
+  Event ev = m_bottom.back ();
+  m_bottom.pop_back ();
+  Refill ();
+  NS_LOG_DEBUG (this << ev.impl << ev.key.m_ts << ev.key.m_uid);
+  return ev;
+}
+
+void
+LadderScheduler::Remove (const Event &ev)
+{
+  NS_LOG_FUNCTION (this << ev.impl << ev.key.m_ts << ev.key.m_uid);
+  uint64_t ts = ev.key.m_ts;
+  Events *events = &m_bottom;
+  if (ts >= m_topStart)
+    {
+      events = &m_top;
+    }
+  else
+    {
+      uint32_t i = FindRung (ts);
+      if (i < m_nRungs)
+        {
+          Rung &rung = m_rungs[i];
+          events = &rung.buckets[(ts - rung.start) / rung.width];
+          rung.count--;
+        }
+    }
+  if (events == &m_bottom)
+    {
+      Events::iterator it = std::lower_bound (m_bottom.begin (), m_bottom.end (), ev, IsLater);
+      NS_ASSERT (it != m_bottom.end () && it->key.m_uid == ev.key.m_uid);
+      m_bottom.erase (it);
+    }
+  else
+    {
+      // the top and the buckets are not sorted
+      Events::iterator it = events->begin ();
+      while (it != events->end () && it->key.m_uid != ev.key.m_uid)
+        {
+          ++it;
+        }
+      NS_ASSERT (it != events->end () && it->impl == ev.impl);
+      *it = events->back ();
+      events->pop_back ();
+    }
+  Refill ();
+}
+
+} // namespace ns3
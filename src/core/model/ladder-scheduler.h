@@ -0,0 +1,122 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2015 Universite catholique de Louvain
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Lionel Metongnon <lionel.metongnon@uclouvain.be>
+ */
+
+#ifndef LADDER_SCHEDULER_H
+#define LADDER_SCHEDULER_H
+
+#include "scheduler.h"
+#include <stdint.h>
+#include <vector>
+
+/**
+ * \file
+ * \ingroup scheduler
+ * Declaration of ns3::LadderScheduler class.
+ */
+
+namespace ns3 {
+
+/**
+ * \ingroup scheduler
+ * \brief a ladder queue event scheduler
+ *
+ * This event scheduler follows the ladder queue of "Ladder Queue: An
+ * O(1) Priority Queue Structure for Large-Scale Discrete Event
+ * Simulation" by Tang, Goh and Thng (2005).  The events are kept in
+ * three tiers:
+ *  - the top, an unsorted vector of the events after the ladder,
+ *  - the rungs of the ladder, each one an array of buckets covering the
+ *    range of one bucket of the rung above, with a smaller width,
+ *  - the bottom, a sorted vector of the next events.
+ *
+ * When the bottom is empty, the next non-empty bucket of the lowest rung
+ * moves to the bottom and is sorted, or spawns a new rung if it holds
+ * too many events; the top moves to a first rung when the ladder is
+ * empty.  Unlike the CalendarScheduler, nothing is ever rehashed and
+ * the buckets are vectors reused from one rung to the next, so Insert
+ * and RemoveNext are amortized O(1) without a memory allocation per
+ * event.  Remove searches the bucket of the event, or the whole top.
+ */
+class LadderScheduler : public Scheduler
+{
+public:
+  /**
+   *  Register this type.
+   *  \return The object TypeId.
+   */
+  static TypeId GetTypeId (void);
+
+  /** Constructor. */
+  LadderScheduler ();
+  /** Destructor. */
+  virtual ~LadderScheduler ();
+
+  // Inherited
+  virtual void Insert (const Scheduler::Event &ev);
+  virtual bool IsEmpty (void) const;
+  virtual Scheduler::Event PeekNext (void) const;
+  virtual Scheduler::Event RemoveNext (void);
+  virtual void Remove (const Scheduler::Event &ev);
+
+private:
+  /** Events, in a bucket, the top or the bottom. */
+  typedef std::vector<Scheduler::Event> Events;
+
+  /** A rung of the ladder. */
+  struct Rung
+  {
+    uint64_t start;               //!< Timestamp of the first bucket
+    uint64_t width;               //!< Time covered by each bucket
+    uint32_t current;             //!< First bucket not moved down yet
+    uint32_t nBuckets;            //!< Buckets in use
+    uint32_t count;               //!< Events in the buckets
+    std::vector<Events> buckets;  //!< The buckets, kept between rungs
+  };
+
+  /**
+   * Find the rung of a timestamp before the top.
+   *
+   * \param [in] ts The timestamp.
+   * \returns The index of the rung, or the number of rungs for the bottom.
+   */
+  uint32_t FindRung (uint64_t ts) const;
+  /**
+   * Spread events over the buckets of a new lowest rung.
+   *
+   * \param [in,out] events The events, emptied.
+   * \param [in] start The first timestamp of the rung.
+   * \param [in] end The timestamp after the rung.
+   */
+  void Spawn (Events &events, uint64_t start, uint64_t end);
+  /** Move the next events to the bottom if it is empty. */
+  void Refill (void);
+
+  Events m_top;               //!< Events from m_topStart
+  uint64_t m_topStart;        //!< First timestamp of the top
+  uint64_t m_topMin;          //!< Smallest timestamp of the top
+  uint64_t m_topMax;          //!< Largest timestamp of the top
+  std::vector<Rung> m_rungs;  //!< The rungs, kept when unused
+  uint32_t m_nRungs;          //!< Rungs in use, from the highest
+  Events m_bottom;            //!< Next events, from the last to the first
+};
+
+} // namespace ns3
+
+#endif /* LADDER_SCHEDULER_H */
@@ -0,0 +1,172 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2015 Universite catholique de Louvain
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Lionel Metongnon <lionel.metongnon@uclouvain.be>
+ */
+
+#ifndef MPSC_QUEUE_H
+#define MPSC_QUEUE_H
+
+#include <algorithm>
+#include <vector>
+
+/**
+ * \file
+ * \ingroup core
+ * ns3::MpscQueue declaration and template implementation.
+ */
+
+namespace ns3 {
+
+/**
+ * \ingroup core
+ * \brief A lock-free queue of many producer threads and one consumer
+ *
+ * The producers push their items onto a stack with a compare and swap;
+ * the consumer takes the whole stack at once with an atomic exchange
+ * and reverses it.  The items are popped in the order of their Push:
+ * the order of each producer is kept, and the items of different
+ * producers are ordered by the instant their Push succeeded.  Neither
+ * side ever waits on the other.
+ *
+ * \tparam T \explicit The type of the items, copied.
+ */
+template <typename T>
+class MpscQueue
+{
+public:
+  MpscQueue ();
+  ~MpscQueue ();
+
+  /**
+   * Push an item, from any thread.
+   *
+   * \param [in] item The item.
+   */
+  void Push (const T &item);
+  /**
+   * \returns \c true if no item was pushed since the last PopAll.
+   *
+   * Only a hint for the producers, but exact for the consumer.
+   */
+  bool IsEmpty (void) const;
+  /**
+   * Pop all the items, from the consumer thread.
+   *
+   * \param [in,out] items The vector the items are appended to, in the
+   * order of their Push.
+   */
+  void PopAll (std::vector<T> &items);
+
+private:
+  /** A pushed item. */
+  struct Node
+  {
+    T item;      //!< The item
+    Node *next;  //!< The item pushed before
+  };
+
+  /**
+   * Copy constructor.
+   * Defined and unimplemented to avoid misuse
+   */
+  MpscQueue (const MpscQueue &);
+  /**
+   * Copy assignment operator.
+   * Defined and unimplemented to avoid misuse
+   * \returns
+   */
+  MpscQueue &operator = (const MpscQueue &);
+
+  /** The last pushed item. */
+  Node * volatile m_head;
+};
+
+} // namespace ns3
+
+
+/********************************************************************
+ *  Implementation of the templates declared above.
+ ********************************************************************/
+
+namespace ns3 {
+
+template <typename T>
+MpscQueue<T>::MpscQueue ()
+  : m_head (0)
+{
+}
+
+template <typename T>
+MpscQueue<T>::~MpscQueue ()
+{
+  Node *node = m_head;
+  while (node != 0)
+    {
+      Node *next = node->next;
+      delete node;
+      node = next;
+    }
+}
+
+template <typename T>
+void
+MpscQueue<T>::Push (const T &item)
+{
+  Node *node = new Node;
+  node->item = item;
+  // a node is never popped alone, so the exchange is safe from ABA
+  Node *head;
+  do
+    {
+      head = m_head;
+      node->next = head;
+    }
+  while (!__sync_bool_compare_and_swap (&m_head, head, node));
+}
+
+template <typename T>
+bool
+MpscQueue<T>::IsEmpty (void) const
+{
+  return m_head == 0;
+}
+
+template <typename T>
+void
+MpscQueue<T>::PopAll (std::vector<T> &items)
+{
+  if (m_head == 0)
+    {
+      return;
+    }
+  Node *node = __sync_lock_test_and_set (&m_head, (Node *) 0);
+  typename std::vector<T>::size_type first = items.size ();
+  while (node != 0)
+    {
+      items.push_back (node->item);
+      Node *next = node->next;
+      delete node;
+      node = next;
+    }
+  // the stack holds the last item first
+  std::reverse (items.begin () + first, items.end ());
+}
+
+} // namespace ns3
+
+#endif /* MPSC_QUEUE_H */
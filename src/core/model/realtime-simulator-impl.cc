@@ -107,6 +107,8 @@ void
 RealtimeSimulatorImpl::DoDispose (void)
 {
   NS_LOG_FUNCTION (this);
+  ProcessEventsWithContext ();
+
   while (!m_events->IsEmpty ())
     {
       Scheduler::Event next = m_events->RemoveNext ();
@@ -228,6 +230,15 @@ RealtimeSimulatorImpl::ProcessOneEvent (void)
         //
         // tsNext is the simulation time of the next event we want to execute.
         //
+        //
+        // The events scheduled by other threads are pushed without the
+        // critical section, so the synchronizer is reset before they are
+        // collected: one pushed after the collection will Signal() after
+        // the reset and interrupt the wait below.
+        //
+        m_synchronizer->SetCondition (false);
+        ProcessEventsWithContext ();
+
         tsNow = m_synchronizer->GetCurrentRealtime ();
         tsNext = NextTs ();
 
@@ -255,8 +266,9 @@ RealtimeSimulatorImpl::ProcessOneEvent (void)
         // to work with the synchronizer to make sure we're awakened if something 
         // external happens (like a packet is received).  This next line resets
         // the synchronizer so that any future event will cause it to interrupt.
+        // This was done above, before the events of the other threads were
+        // collected.
         //
-        m_synchronizer->SetCondition (false);
       }
 
       //
@@ -399,12 +411,54 @@ RealtimeSimulatorImpl::IsFinished (void) const
   bool rc;
   {
     CriticalSection cs (m_mutex);
-    rc = m_events->IsEmpty () || m_stop;
+    rc = (m_events->IsEmpty () && m_eventsWithContext.IsEmpty ()) || m_stop;
   }
 
   return rc;
 }
 
+//
+// Moves the events of the other threads to the event list.  Should be
+// called with critical section locked.
+//
+void
+RealtimeSimulatorImpl::ProcessEventsWithContext (void)
+{
+  if (m_eventsWithContext.IsEmpty ())
+    {
+      return;
+    }
+
+  m_eventsWithContext.PopAll (m_eventsWithContextBuffer);
+  for (std::vector<struct EventWithContext>::const_iterator i = m_eventsWithContextBuffer.begin ();
+       i != m_eventsWithContextBuffer.end (); ++i)
+    {
+      const EventWithContext &event = *i;
+      uint64_t ts = event.timestamp;
+      if (!event.absolute)
+        {
+          ts += m_currentTs;
+        }
+      //
+      // The real time was read before an event of this thread may have
+      // moved m_currentTs past it, so do not let time move backward.
+      //
+      if (ts < m_currentTs)
+        {
+          ts = m_currentTs;
+        }
+      Scheduler::Event ev;
+      ev.impl = event.event;
+      ev.key.m_ts = ts;
+      ev.key.m_context = event.context;
+      ev.key.m_uid = m_uid;
+      m_uid++;
+      m_unscheduledEvents++;
+      m_events->Insert (ev);
+    }
+  m_eventsWithContextBuffer.clear ();
+}
+
 //
 // Peeks into event list.  Should be called with critical section locked.
 //
@@ -441,6 +495,7 @@ RealtimeSimulatorImpl::Run (void)
       bool process = false;
       {
         CriticalSection cs (m_mutex);
+        ProcessEventsWithContext ();
 
         if (!m_events->IsEmpty ())
           {
@@ -543,35 +598,39 @@ RealtimeSimulatorImpl::ScheduleWithContext (uint32_t context, Time const &delay,
 {
   NS_LOG_FUNCTION (this << context << delay << impl);
 
-  {
-    CriticalSection cs (m_mutex);
-    uint64_t ts;
-
-    if (SystemThread::Equals (m_main))
-      {
-        ts = m_currentTs + delay.GetTimeStep ();
-      }
-    else
-      {
-        //
-        // If the simulator is running, we're pacing and have a meaningful 
-        // realtime clock.  If we're not, then m_currentTs is where we stopped.
-        // 
-        ts = m_running ? m_synchronizer->GetCurrentRealtime () : m_currentTs;
-        ts += delay.GetTimeStep ();
-      }
-
-    NS_ASSERT_MSG (ts >= m_currentTs, "RealtimeSimulatorImpl::ScheduleRealtime(): schedule for time < m_currentTs");
-    Scheduler::Event ev;
-    ev.impl = impl;
-    ev.key.m_ts = ts;
-    ev.key.m_context = context;
-    ev.key.m_uid = m_uid;
-    m_uid++;
-    m_unscheduledEvents++;
-    m_events->Insert (ev);
-    m_synchronizer->Signal ();
-  }
+  if (SystemThread::Equals (m_main))
+    {
+      CriticalSection cs (m_mutex);
+      uint64_t ts = m_currentTs + delay.GetTimeStep ();
+      NS_ASSERT_MSG (ts >= m_currentTs, "RealtimeSimulatorImpl::ScheduleRealtime(): schedule for time < m_currentTs");
+      Scheduler::Event ev;
+      ev.impl = impl;
+      ev.key.m_ts = ts;
+      ev.key.m_context = context;
+      ev.key.m_uid = m_uid;
+      m_uid++;
+      m_unscheduledEvents++;
+      m_events->Insert (ev);
+      m_synchronizer->Signal ();
+    }
+  else
+    {
+      //
+      // If the simulator is running, we're pacing and have a meaningful 
+      // realtime clock.  If we're not, then m_currentTs is where we stopped,
+      // and it is added when the event is moved to the event list.  The
+      // event is pushed without the critical section, so the worker threads
+      // never wait on the main thread.
+      // 
+      EventWithContext ev;
+      ev.context = context;
+      ev.absolute = m_running;
+      ev.timestamp = ev.absolute ? m_synchronizer->GetCurrentRealtime () : 0;
+      ev.timestamp += delay.GetTimeStep ();
+      ev.event = impl;
+      m_eventsWithContext.Push (ev);
+      m_synchronizer->Signal ();
+    }
 }
 
 EventId
@@ -30,8 +30,10 @@
 #include "assert.h"
 #include "log.h"
 #include "system-mutex.h"
+#include "mpsc-queue.h"
 
 #include <list>
+#include <vector>
 
 /**
  * \file
@@ -170,6 +172,11 @@ private:
    * \returns The timestep of the next event.
    */
   uint64_t NextTs (void) const;
+  /**
+   * Move the events scheduled by other threads to the event list.
+   * Should be called with #m_mutex locked.
+   */
+  void ProcessEventsWithContext (void);
   /** Process the next event. */
   void ProcessOneEvent (void);
   /** Destructor implementation. */
@@ -207,6 +214,26 @@ private:
   /** Mutex to control access to key state. */  
   mutable SystemMutex m_mutex;  
 
+  /** An event scheduled by another thread. */
+  struct EventWithContext
+  {
+    /** The event context. */
+    uint32_t context;
+    /**
+     * The event timestamp: absolute if \c absolute, else relative to
+     * the current time when moved to the event list.
+     */
+    uint64_t timestamp;
+    /** Whether the timestamp was taken from the real time clock. */
+    bool absolute;
+    /** The event implementation. */
+    EventImpl *event;
+  };
+  /** The events scheduled by other threads, pushed without #m_mutex. */
+  MpscQueue<struct EventWithContext> m_eventsWithContext;
+  /** The events being moved to the event list. */
+  std::vector<struct EventWithContext> m_eventsWithContextBuffer;
+
   /** The synchronizer in use to track real time. */
   Ptr<Synchronizer> m_synchronizer;
 
@@ -0,0 +1,97 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2015 Universite catholique de Louvain
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Lionel Metongnon <lionel.metongnon@uclouvain.be>
+ */
+
+#ifndef THREAD_SAFETY_H
+#define THREAD_SAFETY_H
+
+#include <stdint.h>
+
+/**
+ * \file
+ * \ingroup ptr
+ * Declaration of class ns3::ThreadSafety.
+ */
+
+namespace ns3 {
+
+/**
+ * \ingroup ptr
+ * \brief Switch of the shared state to updates safe between threads
+ *
+ * The reference counts and the memory free lists are plain variables,
+ * updated by the single simulation thread.  A simulator implementation
+ * running events on several threads enables the thread safety for the
+ * duration of its Run: the reference counts are then updated with atomic
+ * instructions and the free lists are bypassed.  The switch costs a
+ * well-predicted branch when disabled.
+ */
+class ThreadSafety
+{
+public:
+  /**
+   * \param enable whether the shared state is updated from several threads
+   *
+   * Only call this when no other thread runs simulation code.
+   */
+  static void Enable (bool enable);
+
+  /**
+   * \returns true if the shared state is updated from several threads
+   */
+  static bool IsEnabled (void)
+  {
+    return g_enabled;
+  }
+
+  /**
+   * \param count a reference count to increment
+   */
+  static void Increment (uint32_t &count)
+  {
+    if (g_enabled)
+      {
+        __sync_fetch_and_add (&count, 1);
+      }
+    else
+      {
+        count++;
+      }
+  }
+
+  /**
+   * \param count a reference count to decrement
+   * \returns true if the count reached zero
+   */
+  static bool Decrement (uint32_t &count)
+  {
+    if (g_enabled)
+      {
+        return __sync_sub_and_fetch (&count, 1) == 0;
+      }
+    return --count == 0;
+  }
+
+private:
+  static bool g_enabled; //!< Whether several threads run simulation code
+};
+
+} // namespace ns3
+
+#endif /* THREAD_SAFETY_H */
@@ -23,6 +23,11 @@
 #include "ns3/heap-scheduler.h"
 #include "ns3/map-scheduler.h"
 #include "ns3/calendar-scheduler.h"
+#include "ns3/ladder-scheduler.h"
+#include "ns3/random-variable-stream.h"
+
+#include <map>
+#include <vector>
 
 using namespace ns3;
 
@@ -459,6 +464,155 @@ SimulatorTemplateTestCase::DoRun (void)
   Simulator::Destroy ();
 }
 
+class SchedulerOrderTestCase : public TestCase
+{
+public:
+  SchedulerOrderTestCase (ObjectFactory schedulerFactory);
+  virtual void DoRun (void);
+  Scheduler::Event Insert (uint64_t ts);
+private:
+  ObjectFactory m_schedulerFactory;
+  Ptr<Scheduler> m_scheduler;
+  Ptr<Scheduler> m_reference;
+  std::map<uint32_t, Scheduler::Event> m_pending;
+  uint32_t m_uid;
+};
+
+SchedulerOrderTestCase::SchedulerOrderTestCase (ObjectFactory schedulerFactory)
+  : TestCase ("Check that scheduler " + schedulerFactory.GetTypeId ().GetName () + " sorts like the MapScheduler"),
+    m_schedulerFactory (schedulerFactory),
+    m_uid (4)
+{
+}
+
+Scheduler::Event
+SchedulerOrderTestCase::Insert (uint64_t ts)
+{
+  Scheduler::Event ev;
+  ev.impl = 0;
+  ev.key.m_ts = ts;
+  ev.key.m_uid = m_uid++;
+  ev.key.m_context = 0;
+  m_scheduler->Insert (ev);
+  m_reference->Insert (ev);
+  m_pending[ev.key.m_uid] = ev;
+  return ev;
+}
+
+void
+SchedulerOrderTestCase::DoRun (void)
+{
+  m_scheduler = m_schedulerFactory.Create<Scheduler> ();
+  m_reference = CreateObject<MapScheduler> ();
+  Ptr<UniformRandomVariable> random = CreateObject<UniformRandomVariable> ();
+  random->SetStream (1);
+
+  // a large population, then mostly short delays with a few long ones,
+  // and bursts of events at the same time
+  uint64_t now = 0;
+  for (uint32_t i = 0; i < 5000; ++i)
+    {
+      Insert (random->GetInteger (0, 1000000000));
+    }
+  for (uint32_t i = 0; i < 50000; ++i)
+    {
+      double r = random->GetValue ();
+      if (r < 0.5 || m_pending.empty ())
+        {
+          double horizon = random->GetValue ();
+          uint32_t delay = horizon < 0.2 ? 0 : horizon < 0.8 ? random->GetInteger (0, 1000)
+            : horizon < 0.95 ? random->GetInteger (0, 1000000) : random->GetInteger (0, 1000000000);
+          Insert (now + delay);
+        }
+      else if (r < 0.55)
+        {
+          std::map<uint32_t, Scheduler::Event>::iterator it = m_pending.lower_bound (random->GetInteger (4, m_uid - 1));
+          if (it == m_pending.end ())
+            {
+              it = m_pending.begin ();
+            }
+          m_scheduler->Remove (it->second);
+          m_reference->Remove (it->second);
+          m_pending.erase (it);
+        }
+      else
+        {
+          Scheduler::Event next = m_scheduler->RemoveNext ();
+          Scheduler::Event expected = m_reference->RemoveNext ();
+          NS_TEST_ASSERT_MSG_EQ (next.key.m_ts, expected.key.m_ts, "Wrong timestamp");
+          NS_TEST_ASSERT_MSG_EQ (next.key.m_uid, expected.key.m_uid, "Wrong event");
+          now = next.key.m_ts;
+          m_pending.erase (next.key.m_uid);
+        }
+      NS_TEST_ASSERT_MSG_EQ (m_scheduler->IsEmpty (), m_reference->IsEmpty (), "Wrong emptiness");
+    }
+  while (!m_reference->IsEmpty ())
+    {
+      NS_TEST_ASSERT_MSG_EQ (m_scheduler->IsEmpty (), false, "Events lost");
+      NS_TEST_ASSERT_MSG_EQ (m_scheduler->PeekNext ().key.m_uid, m_reference->PeekNext ().key.m_uid, "Wrong next event");
+      NS_TEST_ASSERT_MSG_EQ (m_scheduler->RemoveNext ().key.m_uid, m_reference->RemoveNext ().key.m_uid, "Wrong event");
+    }
+  NS_TEST_ASSERT_MSG_EQ (m_scheduler->IsEmpty (), true, "Events left");
+  m_pending.clear ();
+  m_scheduler = 0;
+  m_reference = 0;
+}
+
+class EventPoolTestCase : public TestCase
+{
+public:
+  EventPoolTestCase ();
+  virtual void DoRun (void);
+  void Small (int a);
+  void Large (std::vector<char> a, std::vector<char> b, std::vector<char> c,
+              std::vector<char> d, std::vector<char> e);
+private:
+  uint32_t m_small;
+  uint32_t m_large;
+};
+
+EventPoolTestCase::EventPoolTestCase ()
+  : TestCase ("Check that the memory of the events is recycled"),
+    m_small (0),
+    m_large (0)
+{
+}
+
+void
+EventPoolTestCase::Small (int a)
+{
+  m_small += a;
+}
+
+void
+EventPoolTestCase::Large (std::vector<char> a, std::vector<char> b, std::vector<char> c,
+                          std::vector<char> d, std::vector<char> e)
+{
+  m_large += a.size () + b.size () + c.size () + d.size () + e.size ();
+}
+
+void
+EventPoolTestCase::DoRun (void)
+{
+  EventImpl *event = MakeEvent (&EventPoolTestCase::Small, this, 1);
+  event->Unref ();
+  EventImpl *other = MakeEvent (&EventPoolTestCase::Small, this, 2);
+  NS_TEST_EXPECT_MSG_EQ (other, event, "The memory of the event is not reused");
+  other->Unref ();
+
+  std::vector<char> v (1);
+  for (uint32_t i = 0; i < 1000; ++i)
+    {
+      Simulator::Schedule (NanoSeconds (i), &EventPoolTestCase::Small, this, 1);
+      // more than 128 bytes, out of the pool
+      Simulator::Schedule (NanoSeconds (i), &EventPoolTestCase::Large, this, v, v, v, v, v);
+    }
+  Simulator::Run ();
+  Simulator::Destroy ();
+  NS_TEST_EXPECT_MSG_EQ (m_small, 1000, "Wrong number of small events");
+  NS_TEST_EXPECT_MSG_EQ (m_large, 5000, "Wrong number of large events");
+}
+
 class SimulatorTestSuite : public TestSuite
 {
 public:
@@ -475,5 +629,9 @@ public:
     AddTestCase (new SimulatorEventsTestCase (factory), TestCase::QUICK);
     factory.SetTypeId (CalendarScheduler::GetTypeId ());
     AddTestCase (new SimulatorEventsTestCase (factory), TestCase::QUICK);
+    factory.SetTypeId (LadderScheduler::GetTypeId ());
+    AddTestCase (new SimulatorEventsTestCase (factory), TestCase::QUICK);
+    AddTestCase (new SchedulerOrderTestCase (factory), TestCase::QUICK);
+    AddTestCase (new EventPoolTestCase (), TestCase::QUICK);
   }
 } g_simulatorTestSuite;
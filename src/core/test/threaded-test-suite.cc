@@ -23,12 +23,15 @@
 #include "ns3/heap-scheduler.h"
 #include "ns3/map-scheduler.h"
 #include "ns3/calendar-scheduler.h"
+#include "ns3/ladder-scheduler.h"
 #include "ns3/config.h"
 #include "ns3/string.h"
 #include "ns3/system-thread.h"
+#include "ns3/mpsc-queue.h"
 
 #include <ctime>
 #include <list>
+#include <vector>
 #include <utility>
 
 using namespace ns3;
@@ -225,6 +228,76 @@ ThreadedSimulatorEventsTestCase::DoRun (void)
   NS_TEST_EXPECT_MSG_EQ (m_a, m_d, "Bad scheduling");
 }
 
+class MpscQueueTestCase : public TestCase
+{
+public:
+  MpscQueueTestCase (unsigned int producers);
+  static void Produce (std::pair<MpscQueueTestCase *, unsigned int> context);
+  unsigned int m_producers;
+  MpscQueue<std::pair<unsigned int, unsigned int> > m_queue;
+
+private:
+  virtual void DoRun (void);
+};
+
+#define MPSC_ITEMS 100000
+
+MpscQueueTestCase::MpscQueueTestCase (unsigned int producers)
+  : TestCase ("Check that the lock-free queue keeps the items of each producer in order"),
+    m_producers (producers)
+{
+}
+void
+MpscQueueTestCase::Produce (std::pair<MpscQueueTestCase *, unsigned int> context)
+{
+  MpscQueueTestCase *me = context.first;
+  for (unsigned int i = 0; i < MPSC_ITEMS; ++i)
+    {
+      me->m_queue.Push (std::make_pair (context.second, i));
+    }
+}
+void
+MpscQueueTestCase::DoRun (void)
+{
+  std::list<Ptr<SystemThread> > threads;
+  for (unsigned int i = 0; i < m_producers; ++i)
+    {
+      threads.push_back (
+        Create<SystemThread> (MakeBoundCallback (
+            &MpscQueueTestCase::Produce,
+                std::pair<MpscQueueTestCase *, unsigned int> (this, i) )) );
+    }
+  for (std::list<Ptr<SystemThread> >::iterator it = threads.begin (); it != threads.end (); ++it)
+    {
+      (*it)->Start ();
+    }
+
+  std::vector<unsigned int> next (m_producers, 0);
+  std::vector<std::pair<unsigned int, unsigned int> > items;
+  unsigned int popped = 0;
+  bool ordered = true;
+  while (popped < m_producers * MPSC_ITEMS)
+    {
+      items.clear ();
+      m_queue.PopAll (items);
+      for (std::vector<std::pair<unsigned int, unsigned int> >::const_iterator i = items.begin ();
+           i != items.end (); ++i)
+        {
+          ordered = ordered && i->first < m_producers && i->second == next[i->first];
+          next[i->first] = i->second + 1;
+        }
+      popped += items.size ();
+    }
+  for (std::list<Ptr<SystemThread> >::iterator it = threads.begin (); it != threads.end (); ++it)
+    {
+      (*it)->Join ();
+    }
+
+  NS_TEST_EXPECT_MSG_EQ (ordered, true, "Items popped out of order");
+  NS_TEST_EXPECT_MSG_EQ (popped, m_producers * MPSC_ITEMS, "Items lost");
+  NS_TEST_EXPECT_MSG_EQ (m_queue.IsEmpty (), true, "Items left");
+}
+
 class ThreadedSimulatorTestSuite : public TestSuite
 {
 public:
@@ -241,7 +314,8 @@ public:
       "ns3::ListScheduler",
       "ns3::HeapScheduler",
       "ns3::MapScheduler",
-      "ns3::CalendarScheduler"
+      "ns3::CalendarScheduler",
+      "ns3::LadderScheduler"
     };
     unsigned int threadcounts[] = {
       0,
@@ -262,5 +336,7 @@ public:
               }
           }
       }
+    AddTestCase (new MpscQueueTestCase (1), TestCase::QUICK);
+    AddTestCase (new MpscQueueTestCase (4), TestCase::QUICK);
   }
 } g_threadedSimulatorTestSuite;
@@ -0,0 +1,344 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2015 Universite catholique de Louvain
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Lionel Metongnon <lionel.metongnon@uclouvain.be>
+ */
+
+#include "network-factory.h"
+#include "wireless-network.h"
+#include "ns3/log.h"
+#include "ns3/assert.h"
+#include "ns3/abort.h"
+#include "ns3/ipv6.h"
+#include "ns3/ipv6-address-list.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv6-static-routing-helper.h"
+#include "ns3/mac16-address.h"
+#include "ns3/mac48-address.h"
+#include "ns3/mac64-address.h"
+#include "ns3/system-wall-clock-ms.h"
+#include "ns3/single-model-spectrum-channel.h"
+#include "ns3/propagation-loss-model.h"
+#include "ns3/propagation-delay-model.h"
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE ("NetworkFactory");
+
+NetworkFactory::NetworkFactory ()
+  : m_type (SIXLOWPAN),
+    m_nodesPerNetwork (1),
+    m_base ("2001:1::"),
+    m_built (0),
+    m_shared (false),
+    m_nodeSpacing (10),
+    m_networkSpacing (1000)
+{
+  NS_LOG_FUNCTION (this);
+  Init ();
+}
+
+NetworkFactory::NetworkFactory (NetworkType type, uint32_t nodesPerNetwork)
+  : m_type (type),
+    m_nodesPerNetwork (nodesPerNetwork),
+    m_base ("2001:1::"),
+    m_built (0),
+    m_shared (false),
+    m_nodeSpacing (10),
+    m_networkSpacing (1000)
+{
+  NS_LOG_FUNCTION (this << type << nodesPerNetwork);
+  Init ();
+}
+
+void
+NetworkFactory::Init (void)
+{
+  NS_LOG_FUNCTION (this);
+  Ipv6StaticRoutingHelper staticRouting;
+  m_routing = new Ipv6ListRoutingHelper ();
+  m_routing->Add (staticRouting, 0);
+  SetMobility (m_nodeSpacing, m_networkSpacing, false);
+  for (uint32_t i = 0; i < N_PHASES; ++i)
+    {
+      m_times[i] = 0;
+    }
+}
+
+NetworkFactory::~NetworkFactory ()
+{
+  NS_LOG_FUNCTION (this);
+  delete m_routing;
+  m_routing = 0;
+}
+
+void
+NetworkFactory::SetType (NetworkType type)
+{
+  NS_LOG_FUNCTION (this << type);
+  m_type = type;
+}
+
+void
+NetworkFactory::SetNodesPerNetwork (uint32_t nodesPerNetwork)
+{
+  NS_LOG_FUNCTION (this << nodesPerNetwork);
+  m_nodesPerNetwork = nodesPerNetwork;
+}
+
+void
+NetworkFactory::SetBase (Ipv6Address network)
+{
+  NS_LOG_FUNCTION (this << network);
+  m_base = network;
+  m_built = 0;
+}
+
+void
+NetworkFactory::SetSharedChannel (bool shared)
+{
+  NS_LOG_FUNCTION (this << shared);
+  m_shared = shared;
+}
+
+void
+NetworkFactory::SetRoutingHelper (const Ipv6ListRoutingHelper &routing)
+{
+  NS_LOG_FUNCTION (this);
+  delete m_routing;
+  m_routing = routing.Copy ();
+}
+
+void
+NetworkFactory::SetMobility (double nodeSpacing, double networkSpacing, bool isNodeMobile)
+{
+  NS_LOG_FUNCTION (this << nodeSpacing << networkSpacing << isNodeMobile);
+  m_nodeSpacing = nodeSpacing;
+  m_networkSpacing = networkSpacing;
+  m_routerMobility.SetTypeId ("ns3::ConstantPositionMobilityModel");
+  m_nodeMobility = ObjectFactory ();
+  if (isNodeMobile)
+    {
+      m_nodeMobility.SetTypeId ("ns3::RandomWalk2dMobilityModel");
+      m_nodeMobility.Set ("Bounds", RectangleValue (Rectangle (-5000, 5000, -5000, 5000)));
+    }
+  else
+    {
+      m_nodeMobility.SetTypeId ("ns3::ConstantPositionMobilityModel");
+    }
+}
+
+std::vector<Ptr<Network> >
+NetworkFactory::Build (uint32_t count)
+{
+  NS_LOG_FUNCTION (this << count);
+  std::vector<Ptr<Network> > networks;
+  networks.reserve (count);
+  SystemWallClockMs clock;
+
+  clock.Start ();
+  for (uint32_t i = 0; i < count; ++i)
+    {
+      if (m_type == SIXLOWPAN)
+        {
+          networks.push_back (Create<SixlowpanNetwork> (m_nodesPerNetwork));
+        }
+      else
+        {
+          networks.push_back (Create<WifiNetwork> (m_nodesPerNetwork));
+        }
+    }
+  m_times[NODES] = clock.End ();
+
+  clock.Start ();
+  if (m_type == SIXLOWPAN)
+    {
+      if (m_shared && m_spectrumChannel == 0)
+        {
+          // same channel model as the one LrWpanHelper builds
+          m_spectrumChannel = CreateObject<SingleModelSpectrumChannel> ();
+          m_spectrumChannel->AddPropagationLossModel (CreateObject<LogDistancePropagationLossModel> ());
+          m_spectrumChannel->SetPropagationDelayModel (CreateObject<ConstantSpeedPropagationDelayModel> ());
+        }
+      for (uint32_t i = 0; i < count; ++i)
+        {
+          Ptr<SixlowpanNetwork> network = DynamicCast<SixlowpanNetwork> (networks[i]);
+          if (m_shared)
+            {
+              network->ConfigureL2 (m_spectrumChannel);
+            }
+          else
+            {
+              // each LrWpanHelper has a channel of its own
+              network->ConfigureL2 ();
+            }
+        }
+    }
+  else
+    {
+      YansWifiChannelHelper channel = YansWifiChannelHelper::Default ();
+      if (m_shared && m_wifiChannel == 0)
+        {
+          m_wifiChannel = channel.Create ();
+        }
+      for (uint32_t i = 0; i < count; ++i)
+        {
+          Ptr<WifiNetwork> network = DynamicCast<WifiNetwork> (networks[i]);
+          network->ConfigureL2 (m_shared ? m_wifiChannel : channel.Create ());
+        }
+    }
+  m_times[L2] = clock.End ();
+
+  clock.Start ();
+  for (uint32_t i = 0; i < count; ++i)
+    {
+      double x = (m_built + i) * m_networkSpacing;
+      Ptr<MobilityModel> model = m_routerMobility.Create<MobilityModel> ();
+      model->SetPosition (Vector (x, 0, 0));
+      networks[i]->m_router->AggregateObject (model);
+      NodeContainer &nodes = networks[i]->m_nodes;
+      for (uint32_t j = 0; j < nodes.GetN (); ++j)
+        {
+          model = m_nodeMobility.Create<MobilityModel> ();
+          model->SetPosition (Vector (x, (j + 1) * m_nodeSpacing, 0));
+          nodes.Get (j)->AggregateObject (model);
+        }
+    }
+  m_times[MOBILITY] = clock.End ();
+
+  clock.Start ();
+  NodeContainer routers;
+  NodeContainer nodes;
+  for (uint32_t i = 0; i < count; ++i)
+    {
+      routers.Add (networks[i]->m_router);
+      nodes.Add (networks[i]->m_nodes);
+    }
+  InternetStackHelper internetv6;
+  internetv6.SetIpv4StackInstall (false);
+  internetv6.Install (nodes);
+  internetv6.SetRoutingHelper (*m_routing);
+  internetv6.Install (routers);
+  m_times[STACK] = clock.End ();
+
+  clock.Start ();
+  Ipv6AddressList list;
+  Ipv6Prefix prefix (64);
+  list.Init (m_base, prefix, Ipv6Address ("::1"));
+  for (uint32_t i = 0; i < count; ++i)
+    {
+      Assign (networks[i], list.GetNetwork (prefix, m_built + i));
+    }
+  m_times[ADDRESSES] = clock.End ();
+
+  m_built += count;
+  if (g_log.IsEnabled (LOG_INFO))
+    {
+      std::ostringstream os;
+      PrintTimes (os);
+      NS_LOG_INFO (count << " networks of " << m_nodesPerNetwork << " nodes built in " << os.str ());
+    }
+  return networks;
+}
+
+void
+NetworkFactory::Assign (Ptr<Network> network, Ipv6Address prefix)
+{
+  NS_LOG_FUNCTION (network << prefix);
+  Ipv6InterfaceContainer interfaces;
+  NetDeviceContainer &devices = network->m_netDevices;
+  for (uint32_t i = 0; i < devices.GetN (); ++i)
+    {
+      Ptr<NetDevice> device = devices.Get (i);
+      Ptr<Ipv6> ipv6 = device->GetNode ()->GetObject<Ipv6> ();
+      NS_ASSERT_MSG (ipv6, "NetworkFactory::Assign (): Bad ipv6");
+      int32_t ifIndex = ipv6->GetInterfaceForDevice (device);
+      if (ifIndex == -1)
+        {
+          ifIndex = ipv6->AddInterface (device);
+        }
+
+      Address mac = device->GetAddress ();
+      Ipv6Address address;
+      if (Mac64Address::IsMatchingType (mac))
+        {
+          address = Ipv6Address::MakeAutoconfiguredAddress (Mac64Address::ConvertFrom (mac), prefix);
+        }
+      else if (Mac48Address::IsMatchingType (mac))
+        {
+          address = Ipv6Address::MakeAutoconfiguredAddress (Mac48Address::ConvertFrom (mac), prefix);
+        }
+      else if (Mac16Address::IsMatchingType (mac))
+        {
+          address = Ipv6Address::MakeAutoconfiguredAddress (Mac16Address::ConvertFrom (mac), prefix);
+        }
+      else
+        {
+          NS_FATAL_ERROR ("Did not pass in a valid Mac Address (16, 48 or 64 bits)");
+        }
+      ipv6->SetMetric (ifIndex, 1);
+      ipv6->AddAddress (ifIndex, Ipv6InterfaceAddress (address, Ipv6Prefix (64)));
+      ipv6->SetUp (ifIndex);
+      interfaces.Add (ipv6, ifIndex);
+    }
+  NS_ASSERT_MSG (interfaces.GetN () != 0, "NetworkFactory::Assign (): no interface");
+  interfaces.SetForwarding (0, true);
+  interfaces.SetDefaultRouteInAllNodes (0);
+  network->m_ipv6Interfaces = interfaces;
+}
+
+int64_t
+NetworkFactory::GetTime (Phase phase) const
+{
+  NS_ASSERT (phase < N_PHASES);
+  return m_times[phase];
+}
+
+std::string
+NetworkFactory::GetPhaseName (Phase phase)
+{
+  switch (phase)
+    {
+    case NODES:
+      return "nodes";
+    case L2:
+      return "L2";
+    case MOBILITY:
+      return "mobility";
+    case STACK:
+      return "stack";
+    case ADDRESSES:
+      return "addresses";
+    default:
+      return "unknown";
+    }
+}
+
+void
+NetworkFactory::PrintTimes (std::ostream &os) const
+{
+  int64_t total = 0;
+  for (uint32_t i = 0; i < N_PHASES; ++i)
+    {
+      os << GetPhaseName (static_cast<Phase> (i)) << " " << m_times[i] << " ms, ";
+      total += m_times[i];
+    }
+  os << "total " << total << " ms";
+}
+
+} // namespace ns3
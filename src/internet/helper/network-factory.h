@@ -0,0 +1,201 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2015 Universite catholique de Louvain
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Lionel Metongnon <lionel.metongnon@uclouvain.be>
+ */
+
+#ifndef NETWORK_FACTORY_H
+#define NETWORK_FACTORY_H
+
+#include "ns3/ipv6-address.h"
+#include "ns3/ipv6-list-routing-helper.h"
+#include "ns3/object-factory.h"
+#include "ns3/spectrum-channel.h"
+#include "ns3/yans-wifi-channel.h"
+#include "network.h"
+
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace ns3
+{
+
+/**
+ * \brief Build many homogeneous wireless networks in one batch
+ *
+ * Building the networks one by one repeats the same set up for each of
+ * them: a channel, an InternetStackHelper, a MobilityHelper and an
+ * Ipv6AddressHelper per network, and a check of the stack of each node.
+ * The factory builds all the networks phase by phase instead:
+ *
+ * - NODES: the SixlowpanNetwork or WifiNetwork objects and their nodes;
+ * - L2: the devices, on channels created from a single channel template,
+ *   one per network or one shared by all of them (SetSharedChannel);
+ * - MOBILITY: a mobility model created from an ObjectFactory per node,
+ *   the networks in a row NetworkSpacing apart and their nodes in a
+ *   column NodeSpacing apart, the router first;
+ * - STACK: one InternetStackHelper installed on all the nodes at once,
+ *   and one with the routing helper on all the routers at once;
+ * - ADDRESSES: network k is the k-th /64 after the base network, and the
+ *   addresses are made from the MAC addresses directly, as
+ *   Ipv6AddressHelper does, without the address generator.
+ *
+ * The wall clock time of each phase of the last build is kept.
+ */
+class NetworkFactory
+{
+public:
+  /**
+   * \brief Kinds of networks
+   */
+  enum NetworkType
+  {
+    SIXLOWPAN, //!< SixlowpanNetwork
+    WIFI       //!< WifiNetwork
+  };
+
+  /**
+   * \brief Build phases
+   */
+  enum Phase
+  {
+    NODES,     //!< networks and nodes
+    L2,        //!< channels and devices
+    MOBILITY,  //!< mobility models
+    STACK,     //!< internet stacks
+    ADDRESSES, //!< addresses and routes
+    N_PHASES   //!< number of phases
+  };
+
+  NetworkFactory ();
+
+  /**
+   * \param type the kind of the networks
+   * \param nodesPerNetwork the number of nodes of each network, router excluded
+   */
+  NetworkFactory (NetworkType type, uint32_t nodesPerNetwork);
+
+  ~NetworkFactory ();
+
+  /**
+   * \param type the kind of the networks
+   */
+  void SetType (NetworkType type);
+
+  /**
+   * \param nodesPerNetwork the number of nodes of each network, router excluded
+   */
+  void SetNodesPerNetwork (uint32_t nodesPerNetwork);
+
+  /**
+   * \param network the first /64 network
+   */
+  void SetBase (Ipv6Address network);
+
+  /**
+   * \param shared true to put all the networks on the same channel
+   */
+  void SetSharedChannel (bool shared);
+
+  /**
+   * By default the routers only have static routing.
+   *
+   * \param routing the routing helper of the routers
+   */
+  void SetRoutingHelper (const Ipv6ListRoutingHelper &routing);
+
+  /**
+   * \brief Set the layout of the nodes
+   * \param nodeSpacing the distance between two nodes of a network
+   * \param networkSpacing the distance between two networks
+   * \param isNodeMobile true to let the nodes walk around, not the routers
+   */
+  void SetMobility (double nodeSpacing, double networkSpacing, bool isNodeMobile = false);
+
+  /**
+   * \brief Build networks
+   *
+   * The addresses of successive builds follow each other.
+   *
+   * \param count the number of networks
+   * \returns the networks
+   */
+  std::vector<Ptr<Network> > Build (uint32_t count);
+
+  /**
+   * \param phase a build phase
+   * \returns the wall clock time of the phase in the last build, in ms
+   */
+  int64_t GetTime (Phase phase) const;
+
+  /**
+   * \brief Print the wall clock times of the last build
+   * \param os the output stream
+   */
+  void PrintTimes (std::ostream &os) const;
+
+  /**
+   * \param phase a build phase
+   * \returns the name of the phase
+   */
+  static std::string GetPhaseName (Phase phase);
+
+private:
+  /**
+   * \brief Copy constructor, not implemented
+   * \param o object to copy
+   */
+  NetworkFactory (const NetworkFactory &o);
+
+  /**
+   * \brief Copy assignment, not implemented
+   * \param o object to copy
+   * \returns the object
+   */
+  NetworkFactory &operator= (const NetworkFactory &o);
+
+  /**
+   * \brief Set the default routing and mobility, common to the constructors
+   */
+  void Init (void);
+
+  /**
+   * \brief Add the addresses of a network and its default routes
+   * \param network the network
+   * \param prefix the /64 network
+   */
+  static void Assign (Ptr<Network> network, Ipv6Address prefix);
+
+  NetworkType m_type; //!< kind of the networks
+  uint32_t m_nodesPerNetwork; //!< nodes per network, router excluded
+  Ipv6Address m_base; //!< first network
+  uint64_t m_built; //!< networks already built
+  bool m_shared; //!< one channel for all the networks
+  Ptr<SpectrumChannel> m_spectrumChannel; //!< shared 6LoWPAN channel
+  Ptr<YansWifiChannel> m_wifiChannel; //!< shared WiFi channel
+  Ipv6ListRoutingHelper *m_routing; //!< routing of the routers
+  double m_nodeSpacing; //!< distance between two nodes
+  double m_networkSpacing; //!< distance between two networks
+  ObjectFactory m_routerMobility; //!< mobility model of the routers
+  ObjectFactory m_nodeMobility; //!< mobility model of the nodes
+  int64_t m_times[N_PHASES]; //!< wall clock time of the phases
+};
+
+} // namespace ns3
+
+#endif /* NETWORK_FACTORY_H */
@@ -114,6 +114,8 @@ public:
   virtual ~Network();
 
 protected:
+  friend class NetworkFactory;
+
   NodeContainer m_nodes; //!< Container of the normal Nodes
   Ptr<Node> m_router; //!< The router Nodes
   NetDeviceContainer m_netDevices; //!< Container of router Nodes
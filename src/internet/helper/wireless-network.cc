@@ -70,6 +70,14 @@ SixlowpanNetwork::ConfigureL2()
   m_netDevices = sixlowpan.Install (lrwpanDevices); 
 }
 
+void 
+SixlowpanNetwork::ConfigureL2(Ptr<SpectrumChannel> channel) 
+{
+  NS_LOG_FUNCTION (this << channel);
+  m_lrWpanHelper.SetChannel (channel);
+  ConfigureL2 ();
+}
+
 void
 SixlowpanNetwork::EnablePcap(std::string pcapFileName, bool promiscious)
 {
@@ -130,8 +138,15 @@ WifiNetwork::ConfigureL2()
 {
   NS_LOG_FUNCTION (this);
   YansWifiChannelHelper channel = YansWifiChannelHelper::Default ();
+  ConfigureL2 (channel.Create ());
+}
+
+void 
+WifiNetwork::ConfigureL2(Ptr<YansWifiChannel> channel) 
+{
+  NS_LOG_FUNCTION (this << channel);
   m_phy = YansWifiPhyHelper::Default ();
-  m_phy.SetChannel (channel.Create ());
+  m_phy.SetChannel (channel);
   WifiHelper wifi = WifiHelper::Default ();
   wifi.SetStandard (WIFI_PHY_STANDARD_80211g);
   wifi.SetRemoteStationManager ("ns3::AarfWifiManager");
@@ -24,6 +24,7 @@
 #include "ns3/mobility-module.h"
 #include "ns3/sixlowpan-module.h"
 #include "ns3/lr-wpan-module.h"
+#include "ns3/spectrum-channel.h"
 #include "ns3/wifi-module.h"
 #include "network.h"
 
@@ -51,6 +52,12 @@ public:
    * \returns the requested NetDevice.
    */
   virtual void ConfigureL2();
+  /**
+   * \brief configure the L2 layer of the node(s) on a given channel.
+   *
+   * \param channel the channel, which may be shared with other networks
+   */
+  void ConfigureL2(Ptr<SpectrumChannel> channel);
   /**
    * \brief Retrieve the container of the router node(s).
    *
@@ -89,6 +96,12 @@ public:
    * \returns the requested NetDevice.
    */
   virtual void ConfigureL2();
+  /**
+   * \brief configure the L2 layer of the node(s) on a given channel.
+   *
+   * \param channel the channel, which may be shared with other networks
+   */
+  void ConfigureL2(Ptr<YansWifiChannel> channel);
   /**
    * \brief Retrieve the container of the router node(s).
    *
@@ -0,0 +1,167 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2015 Universite catholique de Louvain
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Lionel Metongnon <lionel.metongnon@uclouvain.be>
+ */
+
+#ifndef IPV6_ADDRESS_BITS_H
+#define IPV6_ADDRESS_BITS_H
+
+#include "ns3/ipv6-address.h"
+
+#include <stdint.h>
+
+namespace ns3 {
+
+/**
+ * \ingroup address
+ *
+ * \brief The 128 bits of an IPv6 address as an unsigned integer
+ *
+ * Two 64 bits words, so that the address generators shift, add and
+ * combine addresses with a few word operations instead of loops over
+ * the 16 bytes of the address.
+ */
+class Ipv6AddressBits
+{
+public:
+  Ipv6AddressBits ()
+    : m_high (0),
+      m_low (0)
+  {
+  }
+
+  /**
+   * \param high the 64 most significant bits
+   * \param low the 64 least significant bits
+   */
+  Ipv6AddressBits (uint64_t high, uint64_t low)
+    : m_high (high),
+      m_low (low)
+  {
+  }
+
+  /**
+   * \param address the address
+   */
+  explicit Ipv6AddressBits (Ipv6Address address)
+  {
+    uint8_t bytes[16];
+    address.GetBytes (bytes);
+    m_high = Load (bytes);
+    m_low = Load (bytes + 8);
+  }
+
+  /**
+   * \returns the address made of the bits
+   */
+  Ipv6Address GetAddress (void) const
+  {
+    uint8_t bytes[16];
+    Store (m_high, bytes);
+    Store (m_low, bytes + 8);
+    return Ipv6Address (bytes);
+  }
+
+  /**
+   * \param value the value to add
+   * \returns the sum, modulo 2^128
+   */
+  Ipv6AddressBits Add (uint64_t value) const
+  {
+    uint64_t low = m_low + value;
+    return Ipv6AddressBits (m_high + (low < m_low ? 1 : 0), low);
+  }
+
+  /**
+   * \param n the number of bits, lower than 128
+   * \returns the bits shifted left
+   */
+  Ipv6AddressBits ShiftLeft (uint32_t n) const
+  {
+    if (n == 0)
+      {
+        return *this;
+      }
+    if (n >= 64)
+      {
+        return Ipv6AddressBits (m_low << (n - 64), 0);
+      }
+    return Ipv6AddressBits ((m_high << n) | (m_low >> (64 - n)), m_low << n);
+  }
+
+  /**
+   * \param n the number of bits, lower than 128
+   * \returns the bits shifted right
+   */
+  Ipv6AddressBits ShiftRight (uint32_t n) const
+  {
+    if (n == 0)
+      {
+        return *this;
+      }
+    if (n >= 64)
+      {
+        return Ipv6AddressBits (0, m_high >> (n - 64));
+      }
+    return Ipv6AddressBits (m_high >> n, (m_low >> n) | (m_high << (64 - n)));
+  }
+
+  /**
+   * \param other other bits
+   * \returns the union of the bits
+   */
+  Ipv6AddressBits Or (const Ipv6AddressBits &other) const
+  {
+    return Ipv6AddressBits (m_high | other.m_high, m_low | other.m_low);
+  }
+
+private:
+  /**
+   * \param bytes 8 bytes in network order
+   * \returns their value
+   */
+  static uint64_t Load (const uint8_t *bytes)
+  {
+    uint64_t value = 0;
+    for (uint32_t i = 0; i < 8; ++i)
+      {
+        value = (value << 8) | bytes[i];
+      }
+    return value;
+  }
+
+  /**
+   * \param value a value
+   * \param bytes set to the 8 bytes of the value in network order
+   */
+  static void Store (uint64_t value, uint8_t *bytes)
+  {
+    for (int32_t i = 7; i >= 0; --i)
+      {
+        bytes[i] = value & 0xff;
+        value >>= 8;
+      }
+  }
+
+  uint64_t m_high; //!< 64 most significant bits
+  uint64_t m_low;  //!< 64 least significant bits
+};
+
+} // namespace ns3
+
+#endif /* IPV6_ADDRESS_BITS_H */
@@ -23,6 +23,7 @@
 #include "ns3/log.h"
 #include "ns3/simulation-singleton.h"
 #include "ipv6-address-generator.h"
+#include "ipv6-address-bits.h"
 
 namespace ns3 {
 
@@ -135,7 +136,6 @@ public:
 
 private:
   static const uint32_t N_BITS = 128; //!< the number of bits in the address
-  static const uint32_t MOST_SIGNIFICANT_BIT = 0x80; //!< MSB set to 1
 
   /**
    * \brief Create an index number for the prefix
@@ -150,11 +150,9 @@ private:
   class NetworkState
   {
 public:
-    uint8_t prefix[16];  //!< the network prefix
-    uint32_t shift;      //!< a shift
-    uint8_t network[16]; //!< the network
-    uint8_t addr[16];    //!< the address
-    uint8_t addrMax[16]; //!< the maximum address
+    Ipv6AddressBits network; //!< the network, right-aligned
+    Ipv6AddressBits addr;    //!< the next interface ID
+    uint32_t shift;          //!< the number of bits of the interface ID
   };
 
   NetworkState m_netTable[N_BITS]; //!< the available networks
@@ -188,34 +186,10 @@ Ipv6AddressGeneratorImpl::Reset (void)
 {
   NS_LOG_FUNCTION (this);
 
-  uint8_t prefix[16] = { 0};
-
   for (uint32_t i = 0; i < N_BITS; ++i)
     {
-      for (uint32_t j = 0; j < 16; ++j)
-        {
-          m_netTable[i].prefix[j] = prefix[j];
-        }
-      for (uint32_t j = 0; j < 15; ++j)
-        {
-          prefix[15 - j] >>= 1;
-          prefix[15 - j] |= (prefix[15 - j - 1] & 1);
-        }
-      prefix[0] |= MOST_SIGNIFICANT_BIT;
-      for (uint32_t j = 0; j < 15; ++j)
-        {
-          m_netTable[i].network[j] = 0;
-        }
-      m_netTable[i].network[15] = 1;
-      for (uint32_t j = 0; j < 15; ++j)
-        {
-          m_netTable[i].addr[j] = 0;
-        }
-      m_netTable[i].addr[15] = 1;
-      for (uint32_t j = 0; j < 16; ++j)
-        {
-          m_netTable[i].addrMax[j] = ~prefix[j];
-        }
+      m_netTable[i].network = Ipv6AddressBits (0, 1);
+      m_netTable[i].addr = Ipv6AddressBits (0, 1);
       m_netTable[i].shift = N_BITS - i;
     }
   m_entries.clear ();
@@ -238,18 +212,6 @@ Ipv6AddressGeneratorImpl::Init (
 
   m_base = interfaceId;
   //
-  // We're going to be playing with the actual bits in the network and prefix so
-  // pull them out into ints.
-  //
-  uint8_t prefixBits[16];
-  prefix.GetBytes (prefixBits);
-  uint8_t netBits[16];
-  net.GetBytes (netBits);
-  uint8_t interfaceIdBits[16];
-  interfaceId.GetBytes (interfaceIdBits);
-  //
-  // Some quick reasonableness testing.
-  //
   // Convert the network prefix into an index into the network number table.
   // The network number comes in to us properly aligned for the prefix and so
   // needs to be shifted right into the normalized position (lowest bit of the
@@ -257,26 +219,9 @@ Ipv6AddressGeneratorImpl::Init (
   //
   uint32_t index = PrefixToIndex (prefix);
   NS_LOG_DEBUG ("Index " << index);
-  uint32_t a = m_netTable[index].shift / 8;
-  uint32_t b = m_netTable[index].shift % 8;
-  for (int32_t j = 15 - a; j >= 0; j--)
-    {
-      m_netTable[index].network[j + a] = netBits[j];
-    }
-  for (uint32_t j = 0; j < a; j++)
-    {
-      m_netTable[index].network[j] = 0;
-    }
-  for (uint32_t j = 15; j >= a; j--)
-    {
-      m_netTable[index].network[j] = m_netTable[index].network[j] >> b;
-      m_netTable[index].network[j] |= m_netTable[index].network[j - 1] << (8 - b);
-    }
-  for (int32_t j = 0; j < 16; j++)
-    {
-      m_netTable[index].addr[j] = interfaceIdBits[j];
-    }
-  return;
+  NetworkState &state = m_netTable[index];
+  state.network = Ipv6AddressBits (net).ShiftRight (state.shift);
+  state.addr = Ipv6AddressBits (interfaceId);
 }
 
 Ipv6Address
@@ -284,26 +229,8 @@ Ipv6AddressGeneratorImpl::GetNetwork (
   const Ipv6Prefix prefix) const
 {
   NS_LOG_FUNCTION (this);
-  uint8_t nw[16];
-  uint32_t index = PrefixToIndex (prefix);
-  uint32_t a = m_netTable[index].shift / 8;
-  uint32_t b = m_netTable[index].shift % 8;
-  for (uint32_t j = 0; j < 16 - a; ++j)
-    {
-      nw[j] = m_netTable[index].network[j + a];
-    }
-  for (uint32_t j = 16 - a; j < 16; ++j)
-    {
-      nw[j] = 0;
-    }
-  for (uint32_t j = 0; j < 15; j++)
-    {
-      nw[j] = nw[j] << b;
-      nw[j] |= nw[j + 1] >> (8 - b);
-    }
-  nw[15] = nw[15] << b;
-
-  return Ipv6Address (nw);
+  const NetworkState &state = m_netTable[PrefixToIndex (prefix)];
+  return state.network.ShiftLeft (state.shift).GetAddress ();
 }
 
 Ipv6Address
@@ -312,48 +239,11 @@ Ipv6AddressGeneratorImpl::NextNetwork (
 {
   NS_LOG_FUNCTION (this);
 
-  uint32_t index = PrefixToIndex (prefix);
+  NetworkState &state = m_netTable[PrefixToIndex (prefix)];
   // Reset the base to what was initialized
-  uint8_t interfaceIdBits[16];
-  m_base.GetBytes (interfaceIdBits);
-  for (int32_t j = 0; j < 16; j++)
-    {
-      m_netTable[index].addr[j] = interfaceIdBits[j];
-    }
-
-  for (int32_t j = 15; j >= 0; j--)
-    {
-      if (m_netTable[index].network[j] < 0xff)
-        {
-          ++m_netTable[index].network[j];
-          break;
-        }
-      else
-        {
-          ++m_netTable[index].network[j];
-        }
-    }
-
-  uint8_t nw[16];
-  uint32_t a = m_netTable[index].shift / 8;
-  uint32_t b = m_netTable[index].shift % 8;
-  for (uint32_t j = 0; j < 16 - a; ++j)
-    {
-      nw[j] = m_netTable[index].network[j + a];
-    }
-  for (uint32_t j = 16 - a; j < 16; ++j)
-    {
-      nw[j] = 0;
-    }
-  for (uint32_t j = 0; j < 15; j++)
-    {
-      nw[j] = nw[j] << b;
-      nw[j] |= nw[j + 1] >> (8 - b);
-    }
-  nw[15] = nw[15] << b;
-
-  return Ipv6Address (nw);
-
+  state.addr = Ipv6AddressBits (m_base);
+  state.network = state.network.Add (1);
+  return state.network.ShiftLeft (state.shift).GetAddress ();
 }
 
 void
@@ -363,14 +253,7 @@ Ipv6AddressGeneratorImpl::InitAddress (
 {
   NS_LOG_FUNCTION (this);
 
-  uint32_t index = PrefixToIndex (prefix);
-  uint8_t interfaceIdBits[16];
-  interfaceId.GetBytes (interfaceIdBits);
-
-  for (uint32_t j = 0; j < 16; ++j)
-    {
-      m_netTable[index].addr[j] = interfaceIdBits[j];
-    }
+  m_netTable[PrefixToIndex (prefix)].addr = Ipv6AddressBits (interfaceId);
 }
 
 Ipv6Address
@@ -378,31 +261,8 @@ Ipv6AddressGeneratorImpl::GetAddress (const Ipv6Prefix prefix) const
 {
   NS_LOG_FUNCTION (this);
 
-  uint32_t index = PrefixToIndex (prefix);
-
-  uint8_t nw[16];
-  uint32_t a = m_netTable[index].shift / 8;
-  uint32_t b = m_netTable[index].shift % 8;
-  for (uint32_t j = 0; j < 16 - a; ++j)
-    {
-      nw[j] = m_netTable[index].network[j + a];
-    }
-  for (uint32_t j = 16 - a; j < 16; ++j)
-    {
-      nw[j] = 0;
-    }
-  for (uint32_t j = 0; j < 15; j++)
-    {
-      nw[j] = nw[j] << b;
-      nw[j] |= nw[j + 1] >> (8 - b);
-    }
-  nw[15] = nw[15] << b;
-  for (uint32_t j = 0; j < 16; j++)
-    {
-      nw[j] |= m_netTable[index].addr[j];
-    }
-
-  return Ipv6Address (nw);
+  const NetworkState &state = m_netTable[PrefixToIndex (prefix)];
+  return state.network.ShiftLeft (state.shift).Or (state.addr).GetAddress ();
 }
 
 Ipv6Address
@@ -410,43 +270,9 @@ Ipv6AddressGeneratorImpl::NextAddress (const Ipv6Prefix prefix)
 {
   NS_LOG_FUNCTION (this);
 
-  uint32_t index = PrefixToIndex (prefix);
-
-  uint8_t ad[16];
-  uint32_t a = m_netTable[index].shift / 8;
-  uint32_t b = m_netTable[index].shift % 8;
-  for (uint32_t j = 0; j < 16 - a; ++j)
-    {
-      ad[j] = m_netTable[index].network[j + a];
-    }
-  for (uint32_t j = 16 - a; j < 16; ++j)
-    {
-      ad[j] = 0;
-    }
-  for (uint32_t j = 0; j < 15; j++)
-    {
-      ad[j] = ad[j] << b;
-      ad[j] |= ad[j + 1] >> (8 - b);
-    }
-  ad[15] = ad[15] << b;
-  for (uint32_t j = 0; j < 16; j++)
-    {
-      ad[j] |= m_netTable[index].addr[j];
-    }
-  Ipv6Address addr = Ipv6Address (ad);
-
-  for (int32_t j = 15; j >= 0; j--)
-    {
-      if (m_netTable[index].addr[j] < 0xff)
-        {
-          ++m_netTable[index].addr[j];
-          break;
-        }
-      else
-        {
-          ++m_netTable[index].addr[j];
-        }
-    }
+  NetworkState &state = m_netTable[PrefixToIndex (prefix)];
+  Ipv6Address addr = state.network.ShiftLeft (state.shift).Or (state.addr).GetAddress ();
+  state.addr = state.addr.Add (1);
 
   //
   // Make a note that we've allocated this address -- used for address collision
@@ -596,16 +422,18 @@ Ipv6AddressGeneratorImpl::PrefixToIndex (Ipv6Prefix prefix) const
 
   for (int32_t i = 15; i >= 0; --i)
     {
-      for (uint32_t j = 0; j < 8; ++j)
+      if (prefixBits[i] == 0)
         {
-          if (prefixBits[i] & 1)
-            {
-              uint32_t index = N_BITS - (15 - i) * 8 - j;
-              NS_ABORT_MSG_UNLESS (index > 0 && index < N_BITS, "Ip64AddressGenerator::PrefixToIndex(): Illegal Prefix");
-              return index;
-            }
-          prefixBits[i] >>= 1;
+          continue;
+        }
+      uint32_t j = 0;
+      while ((prefixBits[i] & (1 << j)) == 0)
+        {
+          ++j;
         }
+      uint32_t index = N_BITS - (15 - i) * 8 - j;
+      NS_ABORT_MSG_UNLESS (index > 0 && index < N_BITS, "Ip64AddressGenerator::PrefixToIndex(): Illegal Prefix");
+      return index;
     }
   NS_ASSERT_MSG (false, "Ipv6AddressGenerator::PrefixToIndex(): Impossible");
   return 0;
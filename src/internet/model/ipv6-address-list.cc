@@ -40,34 +40,11 @@ Ipv6AddressList::Reset (void)
 {
   NS_LOG_FUNCTION (this);
 
-  uint8_t prefix[16] = { 0};
-
   for (uint32_t i = 0; i < N_BITS; ++i)
     {
-      for (uint32_t j = 0; j < 16; ++j)
-        {
-          m_netTable[i].prefix[j] = prefix[j];
-        }
-      for (uint32_t j = 0; j < 15; ++j)
-        {
-          prefix[15 - j] >>= 1;
-          prefix[15 - j] |= (prefix[15 - j - 1] & 1);
-        }
-      prefix[0] |= MOST_SIGNIFICANT_BIT;
-      for (uint32_t j = 0; j < 15; ++j)
-        {
-          m_netTable[i].network[j] = 0;
-        }
-      m_netTable[i].network[15] = 1;
-      for (uint32_t j = 0; j < 15; ++j)
-        {
-          m_netTable[i].addr[j] = 0;
-        }
-      m_netTable[i].addr[15] = 1;
-      for (uint32_t j = 0; j < 16; ++j)
-        {
-          m_netTable[i].addrMax[j] = ~prefix[j];
-        }
+      m_netTable[i].first = Ipv6AddressBits (0, 1);
+      m_netTable[i].network = Ipv6AddressBits (0, 1);
+      m_netTable[i].addr = Ipv6AddressBits (0, 1);
       m_netTable[i].shift = N_BITS - i;
     }
   m_base = Ipv6Address ("::1");
@@ -88,18 +65,6 @@ Ipv6AddressList::Init (
 
   m_base = interfaceId;
   //
-  // We're going to be playing with the actual bits in the network and prefix so
-  // pull them out into ints.
-  //
-  uint8_t prefixBits[16];
-  prefix.GetBytes (prefixBits);
-  uint8_t netBits[16];
-  net.GetBytes (netBits);
-  uint8_t interfaceIdBits[16];
-  interfaceId.GetBytes (interfaceIdBits);
-  //
-  // Some quick reasonableness testing.
-  //
   // Convert the network prefix into an index into the network number table.
   // The network number comes in to us properly aligned for the prefix and so
   // needs to be shifted right into the normalized position (lowest bit of the
@@ -107,26 +72,10 @@ Ipv6AddressList::Init (
   //
   uint32_t index = PrefixToIndex (prefix);
   NS_LOG_DEBUG ("Index " << index);
-  uint32_t a = m_netTable[index].shift / 8;
-  uint32_t b = m_netTable[index].shift % 8;
-  for (int32_t j = 15 - a; j >= 0; j--)
-    {
-      m_netTable[index].network[j + a] = netBits[j];
-    }
-  for (uint32_t j = 0; j < a; j++)
-    {
-      m_netTable[index].network[j] = 0;
-    }
-  for (uint32_t j = 15; j >= a; j--)
-    {
-      m_netTable[index].network[j] = m_netTable[index].network[j] >> b;
-      m_netTable[index].network[j] |= m_netTable[index].network[j - 1] << (8 - b);
-    }
-  for (int32_t j = 0; j < 16; j++)
-    {
-      m_netTable[index].addr[j] = interfaceIdBits[j];
-    }
-  return;
+  NetworkState &state = m_netTable[index];
+  state.first = Ipv6AddressBits (net).ShiftRight (state.shift);
+  state.network = state.first;
+  state.addr = Ipv6AddressBits (interfaceId);
 }
 
 Ipv6Address
@@ -134,26 +83,17 @@ Ipv6AddressList::GetNetwork (
   const Ipv6Prefix prefix) const
 {
   NS_LOG_FUNCTION (this);
-  uint8_t nw[16];
-  uint32_t index = PrefixToIndex (prefix);
-  uint32_t a = m_netTable[index].shift / 8;
-  uint32_t b = m_netTable[index].shift % 8;
-  for (uint32_t j = 0; j < 16 - a; ++j)
-    {
-      nw[j] = m_netTable[index].network[j + a];
-    }
-  for (uint32_t j = 16 - a; j < 16; ++j)
-    {
-      nw[j] = 0;
-    }
-  for (uint32_t j = 0; j < 15; j++)
-    {
-      nw[j] = nw[j] << b;
-      nw[j] |= nw[j + 1] >> (8 - b);
-    }
-  nw[15] = nw[15] << b;
+  const NetworkState &state = m_netTable[PrefixToIndex (prefix)];
+  return state.network.ShiftLeft (state.shift).GetAddress ();
+}
 
-  return Ipv6Address (nw);
+Ipv6Address
+Ipv6AddressList::GetNetwork (
+  const Ipv6Prefix prefix, uint64_t index) const
+{
+  NS_LOG_FUNCTION (this << index);
+  const NetworkState &state = m_netTable[PrefixToIndex (prefix)];
+  return state.first.Add (index).ShiftLeft (state.shift).GetAddress ();
 }
 
 Ipv6Address
@@ -162,48 +102,11 @@ Ipv6AddressList::NextNetwork (
 {
   NS_LOG_FUNCTION (this);
 
-  uint32_t index = PrefixToIndex (prefix);
+  NetworkState &state = m_netTable[PrefixToIndex (prefix)];
   // Reset the base to what was initialized
-  uint8_t interfaceIdBits[16];
-  m_base.GetBytes (interfaceIdBits);
-  for (int32_t j = 0; j < 16; j++)
-    {
-      m_netTable[index].addr[j] = interfaceIdBits[j];
-    }
-
-  for (int32_t j = 15; j >= 0; j--)
-    {
-      if (m_netTable[index].network[j] < 0xff)
-        {
-          ++m_netTable[index].network[j];
-          break;
-        }
-      else
-        {
-          ++m_netTable[index].network[j];
-        }
-    }
-
-  uint8_t nw[16];
-  uint32_t a = m_netTable[index].shift / 8;
-  uint32_t b = m_netTable[index].shift % 8;
-  for (uint32_t j = 0; j < 16 - a; ++j)
-    {
-      nw[j] = m_netTable[index].network[j + a];
-    }
-  for (uint32_t j = 16 - a; j < 16; ++j)
-    {
-      nw[j] = 0;
-    }
-  for (uint32_t j = 0; j < 15; j++)
-    {
-      nw[j] = nw[j] << b;
-      nw[j] |= nw[j + 1] >> (8 - b);
-    }
-  nw[15] = nw[15] << b;
-
-  return Ipv6Address (nw);
-
+  state.addr = Ipv6AddressBits (m_base);
+  state.network = state.network.Add (1);
+  return state.network.ShiftLeft (state.shift).GetAddress ();
 }
 
 Ipv6Address
@@ -211,31 +114,17 @@ Ipv6AddressList::GetAddress (const Ipv6Prefix prefix) const
 {
   NS_LOG_FUNCTION (this);
 
-  uint32_t index = PrefixToIndex (prefix);
+  const NetworkState &state = m_netTable[PrefixToIndex (prefix)];
+  return state.network.ShiftLeft (state.shift).Or (state.addr).GetAddress ();
+}
 
-  uint8_t nw[16];
-  uint32_t a = m_netTable[index].shift / 8;
-  uint32_t b = m_netTable[index].shift % 8;
-  for (uint32_t j = 0; j < 16 - a; ++j)
-    {
-      nw[j] = m_netTable[index].network[j + a];
-    }
-  for (uint32_t j = 16 - a; j < 16; ++j)
-    {
-      nw[j] = 0;
-    }
-  for (uint32_t j = 0; j < 15; j++)
-    {
-      nw[j] = nw[j] << b;
-      nw[j] |= nw[j + 1] >> (8 - b);
-    }
-  nw[15] = nw[15] << b;
-  for (uint32_t j = 0; j < 16; j++)
-    {
-      nw[j] |= m_netTable[index].addr[j];
-    }
+Ipv6Address
+Ipv6AddressList::GetAddress (const Ipv6Prefix prefix, uint64_t index) const
+{
+  NS_LOG_FUNCTION (this << index);
 
-  return Ipv6Address (nw);
+  const NetworkState &state = m_netTable[PrefixToIndex (prefix)];
+  return state.network.ShiftLeft (state.shift).Or (Ipv6AddressBits (m_base).Add (index)).GetAddress ();
 }
 
 Ipv6Address
@@ -243,47 +132,18 @@ Ipv6AddressList::NextAddress (const Ipv6Prefix prefix)
 {
   NS_LOG_FUNCTION (this);
 
-  uint32_t index = PrefixToIndex (prefix);
-
-  uint8_t ad[16];
-  uint32_t a = m_netTable[index].shift / 8;
-  uint32_t b = m_netTable[index].shift % 8;
-  for (uint32_t j = 0; j < 16 - a; ++j)
-    {
-      ad[j] = m_netTable[index].network[j + a];
-    }
-  for (uint32_t j = 16 - a; j < 16; ++j)
-    {
-      ad[j] = 0;
-    }
-  for (uint32_t j = 0; j < 15; j++)
-    {
-      ad[j] = ad[j] << b;
-      ad[j] |= ad[j + 1] >> (8 - b);
-    }
-  ad[15] = ad[15] << b;
-  for (uint32_t j = 0; j < 16; j++)
-    {
-      ad[j] |= m_netTable[index].addr[j];
-    }
-  Ipv6Address addr = Ipv6Address (ad);
-
-  for (int32_t j = 15; j >= 0; j--)
-    {
-      if (m_netTable[index].addr[j] < 0xff)
-        {
-          ++m_netTable[index].addr[j];
-          break;
-        }
-      else
-        {
-          ++m_netTable[index].addr[j];
-        }
-    }
-
+  NetworkState &state = m_netTable[PrefixToIndex (prefix)];
+  Ipv6Address addr = state.network.ShiftLeft (state.shift).Or (state.addr).GetAddress ();
+  state.addr = state.addr.Add (1);
   return addr;
 }
 
+Ipv6Address
+Ipv6AddressList::MakeAddress (Ipv6Address network, Ipv6Address interfaceId, uint64_t index)
+{
+  return Ipv6AddressBits (network).Or (Ipv6AddressBits (interfaceId).Add (index)).GetAddress ();
+}
+
 uint32_t
 Ipv6AddressList::PrefixToIndex (Ipv6Prefix prefix) const
 {
@@ -303,16 +163,18 @@ Ipv6AddressList::PrefixToIndex (Ipv6Prefix prefix) const
 
   for (int32_t i = 15; i >= 0; --i)
     {
-      for (uint32_t j = 0; j < 8; ++j)
+      if (prefixBits[i] == 0)
+        {
+          continue;
+        }
+      uint32_t j = 0;
+      while ((prefixBits[i] & (1 << j)) == 0)
         {
-          if (prefixBits[i] & 1)
-            {
-              uint32_t index = N_BITS - (15 - i) * 8 - j;
-              NS_ABORT_MSG_UNLESS (index > 0 && index < N_BITS, "Ip64AddressGenerator::PrefixToIndex(): Illegal Prefix");
-              return index;
-            }
-          prefixBits[i] >>= 1;
+          ++j;
         }
+      uint32_t index = N_BITS - (15 - i) * 8 - j;
+      NS_ABORT_MSG_UNLESS (index > 0 && index < N_BITS, "Ip64AddressGenerator::PrefixToIndex(): Illegal Prefix");
+      return index;
     }
   NS_ASSERT_MSG (false, "Ipv6AddressList::PrefixToIndex(): Impossible");
   return 0;
@@ -21,6 +21,7 @@
 #define IPV6_ADDRESS_LIST_H
 
 #include "ns3/ipv6-address.h"
+#include "ipv6-address-bits.h"
 
 namespace ns3 {
 
@@ -51,6 +52,12 @@ namespace ns3 {
  * but can also be a pseudo-random value (\RFC{3041}).  This implementation
  * does not generate EUI-64-based interface IDs.
  *
+ * The networks and interface IDs are kept as 128 bits integers, so that
+ * the address at any index of a network, or any network after the one
+ * given to Init (), is computed in constant time: GetAddress (prefix, k)
+ * and GetNetwork (prefix, k) are the results of k calls to NextAddress ()
+ * and NextNetwork ().
+ *
  * \ingroup address
  *
  * \brief Implementation class of Ipv6AddressList
@@ -103,6 +110,17 @@ public:
    */
   Ipv6Address GetNetwork (const Ipv6Prefix prefix) const;
 
+  /**
+   * \brief Get a network after the one given to Init ()
+   *
+   * Does not change the internal state.
+   *
+   * \param prefix The Ipv6Prefix of the network
+   * \param index The number of networks after the initial one
+   * \returns the IPv6 address of the network
+   */
+  Ipv6Address GetNetwork (const Ipv6Prefix prefix, uint64_t index) const;
+
   /**
    * \brief Get the Ipv6Address that will be allocated upon NextAddress ()
    *
@@ -125,6 +143,32 @@ public:
    */
   Ipv6Address NextAddress (const Ipv6Prefix prefix);
 
+  /**
+   * \brief Get an address of the current network
+   *
+   * Does not change the internal state; this is the address returned by
+   * NextAddress () after index other ones, since Init () or NextNetwork ().
+   *
+   * \param prefix The Ipv6Prefix for the current network
+   * \param index The number of addresses before it
+   * \returns the IPv6 address
+   */
+  Ipv6Address GetAddress (const Ipv6Prefix prefix, uint64_t index) const;
+
+  /**
+   * \brief Build the address made of a network and an interface ID
+   * incremented by an index
+   *
+   * The interface ID is incremented and then or-ed with the network bits,
+   * as NextAddress () does.
+   *
+   * \param network The network address
+   * \param interfaceId The base interface ID
+   * \param index The increment of the interface ID
+   * \returns the IPv6 address
+   */
+  static Ipv6Address MakeAddress (Ipv6Address network, Ipv6Address interfaceId, uint64_t index);
+
   /**
    * \brief Reset the networks and Ipv6Address to zero
    */
@@ -142,7 +186,6 @@ public:
 
 private:
   static const uint32_t N_BITS = 128; //!< the number of bits in the address
-  static const uint32_t MOST_SIGNIFICANT_BIT = 0x80; //!< MSB set to 1
 
   /**
    * \brief Create an index number for the prefix
@@ -157,11 +200,10 @@ private:
   class NetworkState
   {
 public:
-    uint8_t prefix[16];  //!< the network prefix
-    uint32_t shift;      //!< a shift
-    uint8_t network[16]; //!< the network
-    uint8_t addr[16];    //!< the address
-    uint8_t addrMax[16]; //!< the maximum address
+    Ipv6AddressBits first;   //!< the network given to Init (), right-aligned
+    Ipv6AddressBits network; //!< the current network, right-aligned
+    Ipv6AddressBits addr;    //!< the next interface ID
+    uint32_t shift;          //!< the number of bits of the interface ID
   };
 
   NetworkState m_netTable[N_BITS]; //!< the available networks
@@ -0,0 +1,104 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2015 Universite catholique de Louvain
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Lionel Metongnon <lionel.metongnon@uclouvain.be>
+ */
+
+#include "ns3/ipv6-address.h"
+#include "ns3/ipv6-address-list.h"
+#include "ns3/test.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * Test that the random accesses of Ipv6AddressList give the addresses and
+ * networks of the sequential ones, across the 64 bits words
+ */
+class Ipv6AddressListTestCase : public TestCase
+{
+public:
+  Ipv6AddressListTestCase ();
+  virtual ~Ipv6AddressListTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+Ipv6AddressListTestCase::Ipv6AddressListTestCase ()
+  : TestCase ("Check the random accesses of Ipv6AddressList")
+{
+}
+
+Ipv6AddressListTestCase::~Ipv6AddressListTestCase ()
+{
+}
+
+void
+Ipv6AddressListTestCase::DoRun (void)
+{
+  Ipv6AddressList list;
+  Ipv6Prefix prefix (64);
+  list.Init (Ipv6Address ("2001:db8:0:1::"), prefix, Ipv6Address ("::ffff:ffff:ffff:fffe"));
+  NS_TEST_ASSERT_MSG_EQ (list.GetAddress (prefix), Ipv6Address ("2001:db8:0:1:ffff:ffff:ffff:fffe"), "Wrong first address");
+  for (uint64_t k = 0; k < 4; ++k)
+    {
+      Ipv6Address expected = list.GetAddress (prefix, k);
+      NS_TEST_ASSERT_MSG_EQ (list.NextAddress (prefix), expected, "Random access differs from NextAddress");
+    }
+  // the interface ID carries into the network bits, which it is or-ed with
+  NS_TEST_ASSERT_MSG_EQ (list.GetAddress (prefix, 2), Ipv6Address ("2001:db8:0:1::"), "Wrong address after the carry");
+  NS_TEST_ASSERT_MSG_EQ (list.GetAddress (prefix, 3), Ipv6Address ("2001:db8:0:1::1"), "Wrong address after the carry");
+
+  // networks across the two words, the prefix being in both
+  Ipv6Prefix wide (72);
+  list.Init (Ipv6Address ("2001:db8:0:ffff:ff00::"), wide, Ipv6Address ("::1"));
+  Ipv6Address next = list.NextNetwork (wide);
+  NS_TEST_ASSERT_MSG_EQ (next, Ipv6Address ("2001:db8:1::"), "Network not carried to the high word");
+  NS_TEST_ASSERT_MSG_EQ (list.GetNetwork (wide), next, "Wrong current network");
+  NS_TEST_ASSERT_MSG_EQ (list.GetNetwork (wide, 1), next, "Random access differs from NextNetwork");
+  NS_TEST_ASSERT_MSG_EQ (list.GetNetwork (wide, 0), Ipv6Address ("2001:db8:0:ffff:ff00::"), "Initial network lost");
+  NS_TEST_ASSERT_MSG_EQ (list.GetNetwork (wide, 2), Ipv6Address ("2001:db8:1:0:100::"), "Wrong network");
+  NS_TEST_ASSERT_MSG_EQ (list.GetNetwork (wide, 257), Ipv6Address ("2001:db8:1:1::"), "Wrong network");
+  NS_TEST_ASSERT_MSG_EQ (list.GetAddress (wide, 0x1000), Ipv6Address ("2001:db8:1::1001"), "Wrong address of the network");
+  NS_TEST_ASSERT_MSG_EQ (list.NextAddress (wide), Ipv6Address ("2001:db8:1::1"), "Interface ID not reset by NextNetwork");
+
+  NS_TEST_ASSERT_MSG_EQ (Ipv6AddressList::MakeAddress (Ipv6Address ("2001:db8::"), Ipv6Address ("::ff:fe00:1"), 0x1ff),
+                         Ipv6Address ("2001:db8::ff:fe00:200"), "Wrong combined address");
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Ipv6AddressList TestSuite
+ */
+class Ipv6AddressListTestSuite : public TestSuite
+{
+public:
+  Ipv6AddressListTestSuite ();
+};
+
+Ipv6AddressListTestSuite::Ipv6AddressListTestSuite ()
+  : TestSuite ("ipv6-address-list", UNIT)
+{
+  AddTestCase (new Ipv6AddressListTestCase, TestCase::QUICK);
+}
+
+static Ipv6AddressListTestSuite g_ipv6AddressListTestSuite; //!< Static variable for test initialization
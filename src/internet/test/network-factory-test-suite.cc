@@ -0,0 +1,155 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2015 Universite catholique de Louvain
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Lionel Metongnon <lionel.metongnon@uclouvain.be>
+ */
+
+#include "ns3/network-factory.h"
+#include "ns3/ipv6.h"
+#include "ns3/mobility-model.h"
+#include "ns3/simulator.h"
+#include "ns3/test.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief NetworkFactory test
+ */
+class NetworkFactoryTestCase : public TestCase
+{
+public:
+  /**
+   * \param type the kind of the networks
+   * \param shared true to share one channel between the networks
+   */
+  NetworkFactoryTestCase (NetworkFactory::NetworkType type, bool shared);
+  virtual ~NetworkFactoryTestCase ();
+
+private:
+  virtual void DoRun (void);
+  virtual void DoTeardown (void);
+
+  /**
+   * \param device a device of a network
+   * \returns its channel
+   */
+  static Ptr<Channel> GetChannel (Ptr<NetDevice> device);
+
+  NetworkFactory::NetworkType m_type; //!< kind of the networks
+  bool m_shared; //!< one channel for all the networks
+};
+
+NetworkFactoryTestCase::NetworkFactoryTestCase (NetworkFactory::NetworkType type, bool shared)
+  : TestCase (std::string (type == NetworkFactory::WIFI ? "WiFi" : "6LoWPAN")
+              + (shared ? " networks on a shared channel" : " networks on their own channel")),
+    m_type (type),
+    m_shared (shared)
+{
+}
+
+NetworkFactoryTestCase::~NetworkFactoryTestCase ()
+{
+}
+
+Ptr<Channel>
+NetworkFactoryTestCase::GetChannel (Ptr<NetDevice> device)
+{
+  // the 6LoWPAN device is on top of the device of the node's first
+  // interface, the one with the channel
+  Ptr<Node> node = device->GetNode ();
+  return node->GetDevice (0)->GetChannel ();
+}
+
+void
+NetworkFactoryTestCase::DoRun (void)
+{
+  const uint32_t nodes = 3;
+  NetworkFactory factory (m_type, nodes);
+  factory.SetBase (Ipv6Address ("2001:db8::"));
+  factory.SetSharedChannel (m_shared);
+  factory.SetMobility (10, 1000);
+
+  std::vector<Ptr<Network> > networks = factory.Build (4);
+  std::vector<Ptr<Network> > more = factory.Build (2);
+  networks.insert (networks.end (), more.begin (), more.end ());
+  NS_TEST_ASSERT_MSG_EQ (networks.size (), 6, "wrong number of networks");
+
+  const char *prefixes[] = { "2001:db8::", "2001:db8:0:1::", "2001:db8:0:2::",
+                             "2001:db8:0:3::", "2001:db8:0:4::", "2001:db8:0:5::" };
+  Ptr<Channel> first = GetChannel (networks[0]->GetNetworkDevices ().Get (0));
+  for (uint32_t k = 0; k < networks.size (); ++k)
+    {
+      Ptr<Network> network = networks[k];
+      NS_TEST_ASSERT_MSG_EQ (network->GetNodes ().GetN (), nodes, "wrong number of nodes");
+      NS_TEST_ASSERT_MSG_EQ (network->GetIpv6Interfaces ().GetN (), nodes + 1, "wrong number of interfaces");
+
+      Ipv6Address prefix (prefixes[k]);
+      Ipv6InterfaceContainer interfaces = network->GetIpv6Interfaces ();
+      for (uint32_t i = 0; i < interfaces.GetN (); ++i)
+        {
+          Ipv6Address address = interfaces.GetAddress (i, 1);
+          NS_TEST_ASSERT_MSG_EQ (Ipv6Prefix (64).IsMatch (address, prefix), true,
+                                 address << " is not in " << prefix << "/64");
+        }
+      NS_TEST_ASSERT_MSG_EQ (network->GetRouter ()->GetObject<Ipv6> ()->IsForwarding (1), true,
+                             "the router does not forward");
+
+      Ptr<Channel> channel = GetChannel (network->GetNetworkDevices ().Get (0));
+      NS_TEST_ASSERT_MSG_EQ ((channel == first), (m_shared || k == 0), "wrong channel");
+
+      Vector position = network->GetNodes ().Get (1)->GetObject<MobilityModel> ()->GetPosition ();
+      NS_TEST_ASSERT_MSG_EQ_TOL (position.x, k * 1000.0, 1e-9, "wrong position");
+      NS_TEST_ASSERT_MSG_EQ_TOL (position.y, 20.0, 1e-9, "wrong position");
+    }
+
+  for (uint32_t i = 0; i < NetworkFactory::N_PHASES; ++i)
+    {
+      NS_TEST_ASSERT_MSG_GT_OR_EQ (factory.GetTime (static_cast<NetworkFactory::Phase> (i)), 0,
+                                   "negative time");
+    }
+}
+
+void
+NetworkFactoryTestCase::DoTeardown (void)
+{
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief NetworkFactory TestSuite
+ */
+class NetworkFactoryTestSuite : public TestSuite
+{
+public:
+  NetworkFactoryTestSuite ();
+};
+
+NetworkFactoryTestSuite::NetworkFactoryTestSuite ()
+  : TestSuite ("network-factory", UNIT)
+{
+  AddTestCase (new NetworkFactoryTestCase (NetworkFactory::SIXLOWPAN, false), TestCase::QUICK);
+  AddTestCase (new NetworkFactoryTestCase (NetworkFactory::SIXLOWPAN, true), TestCase::QUICK);
+  AddTestCase (new NetworkFactoryTestCase (NetworkFactory::WIFI, true), TestCase::QUICK);
+}
+
+static NetworkFactoryTestSuite g_networkFactoryTestSuite; //!< Static variable for test initialization
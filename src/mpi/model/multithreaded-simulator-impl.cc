@@ -0,0 +1,817 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2015 Universite catholique de Louvain
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Lionel Metongnon <lionel.metongnon@uclouvain.be>
+ */
+
+#include "multithreaded-simulator-impl.h"
+
+#include "ns3/simulator.h"
+#include "ns3/scheduler.h"
+#include "ns3/event-impl.h"
+#include "ns3/make-event.h"
+#include "ns3/channel.h"
+#include "ns3/net-device.h"
+#include "ns3/node.h"
+#include "ns3/node-list.h"
+#include "ns3/nstime.h"
+#include "ns3/uinteger.h"
+#include "ns3/thread-safety.h"
+#include "ns3/assert.h"
+#include "ns3/log.h"
+
+#include <algorithm>
+#include <sched.h>
+#include <unistd.h>
+
+namespace ns3 {
+
+// Note:  Logging in this file is largely avoided due to the
+// number of calls that are made to these functions and the possibility
+// of causing recursions leading to stack overflow
+NS_LOG_COMPONENT_DEFINE ("MultithreadedSimulatorImpl");
+
+NS_OBJECT_ENSURE_REGISTERED (MultithreadedSimulatorImpl);
+
+namespace {
+
+/// No event, or no bound on the windows
+const uint64_t MAX_TS = 0x7fffffffffffffffULL;
+
+/// Unique ids taken at once by a partition, to share the counter rarely
+const uint32_t UID_BLOCK = 1024;
+
+/**
+ * \param root the parent of each node in the union-find forest
+ * \param node a node
+ * \returns the root of the tree of the node
+ */
+uint32_t
+FindRoot (std::vector<uint32_t> &root, uint32_t node)
+{
+  while (root[node] != node)
+    {
+      root[node] = root[root[node]];
+      node = root[node];
+    }
+  return node;
+}
+
+/**
+ * \param spins the number of checks of the awaited condition so far
+ */
+void
+Pause (uint32_t spins)
+{
+  // the windows are short: spin first, then leave the core
+  if (spins > 1000)
+    {
+      sched_yield ();
+    }
+}
+
+} // anonymous namespace
+
+__thread struct MultithreadedSimulatorImpl::Partition *MultithreadedSimulatorImpl::g_current = 0;
+
+bool
+MultithreadedSimulatorImpl::HandOver::operator < (const HandOver &o) const
+{
+  if (ts != o.ts)
+    {
+      return ts < o.ts;
+    }
+  if (source != o.source)
+    {
+      return source < o.source;
+    }
+  return sequence < o.sequence;
+}
+
+MultithreadedSimulatorImpl::Partition::Partition ()
+  : id (0),
+    currentTs (0),
+    currentUid (0),
+    currentContext (0xffffffff),
+    nextUid (0),
+    lastUid (0),
+    sent (0)
+{
+}
+
+TypeId
+MultithreadedSimulatorImpl::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::MultithreadedSimulatorImpl")
+    .SetParent<SimulatorImpl> ()
+    .SetGroupName ("Mpi")
+    .AddConstructor<MultithreadedSimulatorImpl> ()
+    .AddAttribute ("MaxThreads",
+                   "The maximum number of threads running the partitions, 0 for the online cores",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&MultithreadedSimulatorImpl::m_maxThreads),
+                   MakeUintegerChecker<uint32_t> ())
+  ;
+  return tid;
+}
+
+MultithreadedSimulatorImpl::MultithreadedSimulatorImpl ()
+{
+  NS_LOG_FUNCTION (this);
+  // uids are allocated from 4, see DefaultSimulatorImpl
+  m_uid = 4;
+  m_stop = false;
+  m_lookahead = MAX_TS;
+  m_maxThreads = 0;
+  m_nThreads = 1;
+  m_inWindow = false;
+  m_windowEnd = 0;
+  m_nextReady = 0;
+  m_busy = 0;
+  m_generation = 0;
+  m_poolGeneration = 0;
+  m_frontier = 0;
+  m_exiting = false;
+  m_main = SystemThread::Self ();
+  // the events without node, and every event until the first Run
+  m_partitions.push_back (new struct Partition ());
+}
+
+MultithreadedSimulatorImpl::~MultithreadedSimulatorImpl ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+MultithreadedSimulatorImpl::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  for (uint32_t i = 0; i < m_partitions.size (); ++i)
+    {
+      struct Partition *partition = m_partitions[i];
+      while (partition->events != 0 && !partition->events->IsEmpty ())
+        {
+          Scheduler::Event next = partition->events->RemoveNext ();
+          next.impl->Unref ();
+        }
+      for (uint32_t j = 0; j < partition->inbox.size (); ++j)
+        {
+          partition->inbox[j].event->Unref ();
+        }
+      delete partition;
+    }
+  m_partitions.clear ();
+  m_partitionOf.clear ();
+  SimulatorImpl::DoDispose ();
+}
+
+void
+MultithreadedSimulatorImpl::Destroy ()
+{
+  NS_LOG_FUNCTION (this);
+  while (!m_destroyEvents.empty ())
+    {
+      Ptr<EventImpl> ev = m_destroyEvents.front ().PeekEventImpl ();
+      m_destroyEvents.pop_front ();
+      NS_LOG_LOGIC ("handle destroy " << ev);
+      if (!ev->IsCancelled ())
+        {
+          ev->Invoke ();
+        }
+    }
+}
+
+void
+MultithreadedSimulatorImpl::SetScheduler (ObjectFactory schedulerFactory)
+{
+  NS_LOG_FUNCTION (this << schedulerFactory);
+  m_schedulerFactory = schedulerFactory;
+  for (uint32_t i = 0; i < m_partitions.size (); ++i)
+    {
+      struct Partition *partition = m_partitions[i];
+      Ptr<Scheduler> scheduler = m_schedulerFactory.Create<Scheduler> ();
+      while (partition->events != 0 && !partition->events->IsEmpty ())
+        {
+          scheduler->Insert (partition->events->RemoveNext ());
+        }
+      partition->events = scheduler;
+    }
+}
+
+// System ID for non-distributed simulation is always zero
+uint32_t
+MultithreadedSimulatorImpl::GetSystemId (void) const
+{
+  return 0;
+}
+
+uint32_t
+MultithreadedSimulatorImpl::GetNPartitions (void) const
+{
+  return m_partitions.size () - 1;
+}
+
+uint32_t
+MultithreadedSimulatorImpl::GetPartition (uint32_t context) const
+{
+  return Find (context)->id;
+}
+
+Time
+MultithreadedSimulatorImpl::GetLookahead (void) const
+{
+  return TimeStep (m_lookahead);
+}
+
+uint32_t
+MultithreadedSimulatorImpl::GetNThreads (void) const
+{
+  return m_nThreads;
+}
+
+struct MultithreadedSimulatorImpl::Partition *
+MultithreadedSimulatorImpl::Find (uint32_t context) const
+{
+  if (context < m_partitionOf.size ())
+    {
+      return m_partitions[m_partitionOf[context]];
+    }
+  return m_partitions[0];
+}
+
+struct MultithreadedSimulatorImpl::Partition *
+MultithreadedSimulatorImpl::GetCurrent (void) const
+{
+  return g_current != 0 ? g_current : m_partitions[0];
+}
+
+uint32_t
+MultithreadedSimulatorImpl::NextUid (struct Partition *partition)
+{
+  if (partition->nextUid == partition->lastUid)
+    {
+      partition->nextUid = __sync_fetch_and_add (&m_uid, UID_BLOCK);
+      partition->lastUid = partition->nextUid + UID_BLOCK;
+    }
+  return partition->nextUid++;
+}
+
+uint32_t
+MultithreadedSimulatorImpl::Insert (struct Partition *partition, uint64_t ts, uint32_t context, EventImpl *event)
+{
+  Scheduler::Event ev;
+  ev.impl = event;
+  ev.key.m_ts = ts;
+  ev.key.m_context = context;
+  ev.key.m_uid = NextUid (partition);
+  partition->events->Insert (ev);
+  return ev.key.m_uid;
+}
+
+uint64_t
+MultithreadedSimulatorImpl::GetNextTs (const struct Partition *partition) const
+{
+  if (partition->events->IsEmpty ())
+    {
+      return MAX_TS;
+    }
+  return partition->events->PeekNext ().key.m_ts;
+}
+
+void
+MultithreadedSimulatorImpl::Repartition (void)
+{
+  NS_LOG_FUNCTION (this);
+  // union of the nodes sharing a channel, except the point to point
+  // channels with a delay, which are the candidate cuts
+  uint32_t nNodes = NodeList::GetNNodes ();
+  std::vector<uint32_t> root (nNodes);
+  for (uint32_t i = 0; i < nNodes; ++i)
+    {
+      root[i] = i;
+    }
+  struct Cut
+  {
+    uint32_t a;
+    uint32_t b;
+    uint64_t delay;
+  };
+  std::vector<struct Cut> cuts;
+  for (uint32_t i = 0; i < nNodes; ++i)
+    {
+      Ptr<Node> node = NodeList::GetNode (i);
+      for (uint32_t j = 0; j < node->GetNDevices (); ++j)
+        {
+          Ptr<NetDevice> device = node->GetDevice (j);
+          Ptr<Channel> channel = device->GetChannel ();
+          if (channel == 0)
+            {
+              continue;
+            }
+          TimeValue delay;
+          if (device->IsPointToPoint () && channel->GetNDevices () == 2 &&
+              channel->GetAttributeFailSafe ("Delay", delay) && delay.Get ().IsStrictlyPositive ())
+            {
+              Ptr<NetDevice> peer = channel->GetDevice (channel->GetDevice (0) == device ? 1 : 0);
+              struct Cut cut = { i, peer->GetNode ()->GetId (), (uint64_t) delay.Get ().GetTimeStep () };
+              cuts.push_back (cut);
+              continue;
+            }
+          for (uint32_t k = 0; k < channel->GetNDevices (); ++k)
+            {
+              uint32_t a = FindRoot (root, i);
+              uint32_t b = FindRoot (root, channel->GetDevice (k)->GetNode ()->GetId ());
+              root[std::max (a, b)] = std::min (a, b);
+            }
+        }
+    }
+  m_lookahead = MAX_TS;
+  for (uint32_t i = 0; i < cuts.size (); ++i)
+    {
+      if (FindRoot (root, cuts[i].a) != FindRoot (root, cuts[i].b))
+        {
+          m_lookahead = std::min (m_lookahead, cuts[i].delay);
+        }
+    }
+  // number the partitions in the order of their first node
+  std::vector<uint32_t> partitionOf (nNodes);
+  uint32_t nPartitions = 0;
+  for (uint32_t i = 0; i < nNodes; ++i)
+    {
+      uint32_t r = FindRoot (root, i);
+      partitionOf[i] = r == i ? ++nPartitions : partitionOf[r];
+    }
+  if (partitionOf != m_partitionOf)
+    {
+      // move every event to its new partition, keeping its unique id
+      MergeInboxes ();
+      std::vector<Scheduler::Event> events;
+      for (uint32_t i = 0; i < m_partitions.size (); ++i)
+        {
+          while (!m_partitions[i]->events->IsEmpty ())
+            {
+              events.push_back (m_partitions[i]->events->RemoveNext ());
+            }
+        }
+      struct Partition *global = m_partitions[0];
+      for (uint32_t i = 1; i < m_partitions.size (); ++i)
+        {
+          global->currentTs = std::max (global->currentTs, m_partitions[i]->currentTs);
+          delete m_partitions[i];
+        }
+      m_partitions.resize (1);
+      for (uint32_t i = 1; i <= nPartitions; ++i)
+        {
+          struct Partition *partition = new struct Partition ();
+          partition->id = i;
+          partition->events = m_schedulerFactory.Create<Scheduler> ();
+          partition->currentTs = global->currentTs;
+          m_partitions.push_back (partition);
+        }
+      m_partitionOf = partitionOf;
+      for (uint32_t i = 0; i < events.size (); ++i)
+        {
+          Find (events[i].key.m_context)->events->Insert (events[i]);
+        }
+    }
+  m_nThreads = m_maxThreads;
+  if (m_nThreads == 0)
+    {
+      long cores = sysconf (_SC_NPROCESSORS_ONLN);
+      m_nThreads = cores > 0 ? cores : 1;
+    }
+  m_nThreads = std::max<uint32_t> (1, std::min (m_nThreads, nPartitions));
+  NS_LOG_INFO (nPartitions << " partitions, lookahead " << GetLookahead () << ", " << m_nThreads << " threads");
+}
+
+void
+MultithreadedSimulatorImpl::MergeInboxes (void)
+{
+  for (uint32_t i = 0; i < m_partitions.size (); ++i)
+    {
+      struct Partition *partition = m_partitions[i];
+      std::vector<HandOver> inbox;
+      {
+        CriticalSection cs (partition->inboxMutex);
+        inbox.swap (partition->inbox);
+      }
+      if (inbox.empty ())
+        {
+          continue;
+        }
+      for (uint32_t j = 0; j < inbox.size (); ++j)
+        {
+          if (inbox[j].source == 0xffffffff)
+            {
+              inbox[j].ts += m_frontier;
+            }
+        }
+      // the order of the senders does not depend on the threads
+      std::sort (inbox.begin (), inbox.end ());
+      for (uint32_t j = 0; j < inbox.size (); ++j)
+        {
+          Insert (partition, inbox[j].ts, inbox[j].context, inbox[j].event);
+        }
+    }
+}
+
+void
+MultithreadedSimulatorImpl::ProcessOneEvent (struct Partition *partition)
+{
+  Scheduler::Event next = partition->events->RemoveNext ();
+
+  NS_ASSERT (next.key.m_ts >= partition->currentTs);
+
+  NS_LOG_LOGIC ("handle " << next.key.m_ts);
+  partition->currentTs = next.key.m_ts;
+  partition->currentContext = next.key.m_context;
+  partition->currentUid = next.key.m_uid;
+  next.impl->Invoke ();
+  next.impl->Unref ();
+}
+
+void
+MultithreadedSimulatorImpl::ProcessReady (void)
+{
+  while (true)
+    {
+      uint32_t i = __sync_fetch_and_add (&m_nextReady, 1);
+      if (i >= m_ready.size ())
+        {
+          break;
+        }
+      struct Partition *partition = m_ready[i];
+      g_current = partition;
+      while (GetNextTs (partition) < m_windowEnd)
+        {
+          ProcessOneEvent (partition);
+        }
+    }
+  g_current = 0;
+}
+
+void
+MultithreadedSimulatorImpl::Work (void)
+{
+  uint32_t seen = m_poolGeneration;
+  while (true)
+    {
+      for (uint32_t spins = 0; m_generation == seen; ++spins)
+        {
+          Pause (spins);
+        }
+      __sync_synchronize ();
+      seen = m_generation;
+      if (m_exiting)
+        {
+          break;
+        }
+      ProcessReady ();
+      __sync_fetch_and_sub (&m_busy, 1);
+    }
+  // the free lists of the thread would be lost with it
+  EventImpl::ReleaseCache ();
+}
+
+bool
+MultithreadedSimulatorImpl::IsFinished (void) const
+{
+  if (m_stop)
+    {
+      return true;
+    }
+  for (uint32_t i = 0; i < m_partitions.size (); ++i)
+    {
+      if (!m_partitions[i]->events->IsEmpty () || !m_partitions[i]->inbox.empty ())
+        {
+          return false;
+        }
+    }
+  return true;
+}
+
+void
+MultithreadedSimulatorImpl::Run (void)
+{
+  NS_LOG_FUNCTION (this);
+  // Set the current threadId as the main threadId
+  m_main = SystemThread::Self ();
+  m_stop = false;
+  Repartition ();
+
+  ThreadSafety::Enable (m_nThreads > 1);
+  m_exiting = false;
+  m_poolGeneration = m_generation;
+  for (uint32_t i = 1; i < m_nThreads; ++i)
+    {
+      Ptr<SystemThread> thread = Create<SystemThread> (MakeCallback (&MultithreadedSimulatorImpl::Work, this));
+      thread->Start ();
+      m_threads.push_back (thread);
+    }
+
+  struct Partition *global = m_partitions[0];
+  while (!m_stop)
+    {
+      MergeInboxes ();
+      uint64_t next = MAX_TS;
+      for (uint32_t i = 1; i < m_partitions.size (); ++i)
+        {
+          next = std::min (next, GetNextTs (m_partitions[i]));
+        }
+      uint64_t nextGlobal = GetNextTs (global);
+      if (next == MAX_TS && nextGlobal == MAX_TS)
+        {
+          break;
+        }
+      if (nextGlobal <= next)
+        {
+          // the events without node run alone, between two windows
+          g_current = global;
+          while (!m_stop && GetNextTs (global) == nextGlobal)
+            {
+              ProcessOneEvent (global);
+            }
+          g_current = 0;
+          m_frontier = nextGlobal;
+          continue;
+        }
+
+      m_windowEnd = m_lookahead > MAX_TS - next ? MAX_TS : next + m_lookahead;
+      m_windowEnd = std::min (m_windowEnd, nextGlobal);
+      m_ready.clear ();
+      for (uint32_t i = 1; i < m_partitions.size (); ++i)
+        {
+          if (GetNextTs (m_partitions[i]) < m_windowEnd)
+            {
+              m_ready.push_back (m_partitions[i]);
+            }
+        }
+      m_nextReady = 0;
+      m_inWindow = true;
+      if (m_threads.empty () || m_ready.size () == 1)
+        {
+          ProcessReady ();
+        }
+      else
+        {
+          m_busy = m_threads.size ();
+          __sync_fetch_and_add (&m_generation, 1);
+          ProcessReady ();
+          for (uint32_t spins = 0; m_busy != 0; ++spins)
+            {
+              Pause (spins);
+            }
+          __sync_synchronize ();
+        }
+      m_inWindow = false;
+      for (uint32_t i = 0; i < m_ready.size (); ++i)
+        {
+          m_frontier = std::max (m_frontier, m_ready[i]->currentTs);
+        }
+    }
+
+  m_exiting = true;
+  __sync_fetch_and_add (&m_generation, 1);
+  for (uint32_t i = 0; i < m_threads.size (); ++i)
+    {
+      m_threads[i]->Join ();
+    }
+  m_threads.clear ();
+  ThreadSafety::Enable (false);
+  MergeInboxes ();
+
+  // the partitions stopped at different times: align their clocks
+  uint64_t now = 0;
+  for (uint32_t i = 0; i < m_partitions.size (); ++i)
+    {
+      now = std::max (now, m_partitions[i]->currentTs);
+    }
+  for (uint32_t i = 0; i < m_partitions.size (); ++i)
+    {
+      if (m_partitions[i]->currentTs < now)
+        {
+          m_partitions[i]->currentTs = now;
+          m_partitions[i]->currentUid = 0;
+        }
+    }
+  m_frontier = now;
+}
+
+void
+MultithreadedSimulatorImpl::Stop (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_stop = true;
+}
+
+void
+MultithreadedSimulatorImpl::Stop (Time const &delay)
+{
+  NS_LOG_FUNCTION (this << delay.GetTimeStep ());
+  ScheduleWithContext (0xffffffff, delay, MakeEvent (&Simulator::Stop));
+}
+
+//
+// Schedule an event for a _relative_ time in the future.
+//
+EventId
+MultithreadedSimulatorImpl::Schedule (Time const &delay, EventImpl *event)
+{
+  NS_LOG_FUNCTION (this << delay.GetTimeStep () << event);
+  NS_ASSERT_MSG (g_current != 0 || SystemThread::Equals (m_main), "Simulator::Schedule Thread-unsafe invocation!");
+
+  // the event stays in the partition of the current context
+  struct Partition *current = GetCurrent ();
+  Time tAbsolute = delay + TimeStep (current->currentTs);
+
+  NS_ASSERT (tAbsolute.IsPositive ());
+  NS_ASSERT (tAbsolute >= TimeStep (current->currentTs));
+  uint64_t ts = (uint64_t) tAbsolute.GetTimeStep ();
+  uint32_t uid = Insert (current, ts, current->currentContext, event);
+  return EventId (event, ts, current->currentContext, uid);
+}
+
+void
+MultithreadedSimulatorImpl::ScheduleWithContext (uint32_t context, Time const &delay, EventImpl *event)
+{
+  NS_LOG_FUNCTION (this << context << delay.GetTimeStep () << event);
+
+  struct Partition *target = Find (context);
+  if (g_current == 0 && !SystemThread::Equals (m_main))
+    {
+      // from outside of the simulation: relative to the time reached by
+      // all the partitions when it is merged
+      HandOver handOver = { (uint64_t) delay.GetTimeStep (), 0xffffffff, 0, context, event };
+      CriticalSection cs (target->inboxMutex);
+      target->inbox.push_back (handOver);
+      return;
+    }
+
+  struct Partition *current = GetCurrent ();
+  uint64_t ts = current->currentTs + delay.GetTimeStep ();
+  if (m_inWindow && target != current)
+    {
+      if (target == m_partitions[0])
+        {
+          // run between two windows
+          ts = std::max (ts, m_windowEnd);
+        }
+      else if (ts < m_windowEnd)
+        {
+          NS_FATAL_ERROR ("Event scheduled on node " << context << " at " << TimeStep (ts) <<
+                          ", within the lookahead " << GetLookahead () << " of partition " << current->id);
+        }
+      HandOver handOver = { ts, current->id, current->sent++, context, event };
+      CriticalSection cs (target->inboxMutex);
+      target->inbox.push_back (handOver);
+      return;
+    }
+  Insert (target, ts, context, event);
+}
+
+EventId
+MultithreadedSimulatorImpl::ScheduleNow (EventImpl *event)
+{
+  return Schedule (TimeStep (0), event);
+}
+
+EventId
+MultithreadedSimulatorImpl::ScheduleDestroy (EventImpl *event)
+{
+  CriticalSection cs (m_destroyMutex);
+  EventId id (Ptr<EventImpl> (event, false), GetCurrent ()->currentTs, 0xffffffff, 2);
+  m_destroyEvents.push_back (id);
+  return id;
+}
+
+Time
+MultithreadedSimulatorImpl::Now (void) const
+{
+  // Do not add function logging here, to avoid stack overflow
+  return TimeStep (GetCurrent ()->currentTs);
+}
+
+Time
+MultithreadedSimulatorImpl::GetDelayLeft (const EventId &id) const
+{
+  if (IsExpired (id))
+    {
+      return TimeStep (0);
+    }
+  else
+    {
+      return TimeStep (id.GetTs () - GetCurrent ()->currentTs);
+    }
+}
+
+void
+MultithreadedSimulatorImpl::Remove (const EventId &id)
+{
+  if (id.GetUid () == 2)
+    {
+      // destroy events.
+      CriticalSection cs (m_destroyMutex);
+      for (DestroyEvents::iterator i = m_destroyEvents.begin (); i != m_destroyEvents.end (); i++)
+        {
+          if (*i == id)
+            {
+              m_destroyEvents.erase (i);
+              break;
+            }
+        }
+      return;
+    }
+  if (IsExpired (id))
+    {
+      return;
+    }
+  struct Partition *partition = Find (id.GetContext ());
+  if (m_inWindow && partition != g_current)
+    {
+      // the queue belongs to another thread: the event is only cancelled
+      id.PeekEventImpl ()->Cancel ();
+      return;
+    }
+  Scheduler::Event event;
+  event.impl = id.PeekEventImpl ();
+  event.key.m_ts = id.GetTs ();
+  event.key.m_context = id.GetContext ();
+  event.key.m_uid = id.GetUid ();
+  partition->events->Remove (event);
+  event.impl->Cancel ();
+  // whenever we remove an event from the event list, we have to unref it.
+  event.impl->Unref ();
+}
+
+void
+MultithreadedSimulatorImpl::Cancel (const EventId &id)
+{
+  if (!IsExpired (id))
+    {
+      id.PeekEventImpl ()->Cancel ();
+    }
+}
+
+bool
+MultithreadedSimulatorImpl::IsExpired (const EventId &id) const
+{
+  if (id.GetUid () == 2)
+    {
+      if (id.PeekEventImpl () == 0 ||
+          id.PeekEventImpl ()->IsCancelled ())
+        {
+          return true;
+        }
+      // destroy events.
+      CriticalSection cs (const_cast<SystemMutex &> (m_destroyMutex));
+      for (DestroyEvents::const_iterator i = m_destroyEvents.begin (); i != m_destroyEvents.end (); i++)
+        {
+          if (*i == id)
+            {
+              return false;
+            }
+        }
+      return true;
+    }
+  const struct Partition *partition = Find (id.GetContext ());
+  if (id.PeekEventImpl () == 0 ||
+      id.GetTs () < partition->currentTs ||
+      (id.GetTs () == partition->currentTs &&
+       id.GetUid () <= partition->currentUid) ||
+      id.PeekEventImpl ()->IsCancelled ())
+    {
+      return true;
+    }
+  else
+    {
+      return false;
+    }
+}
+
+Time
+MultithreadedSimulatorImpl::GetMaximumSimulationTime (void) const
+{
+  return TimeStep (MAX_TS);
+}
+
+uint32_t
+MultithreadedSimulatorImpl::GetContext (void) const
+{
+  return GetCurrent ()->currentContext;
+}
+
+} // namespace ns3
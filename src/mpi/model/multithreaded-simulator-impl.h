@@ -0,0 +1,235 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2015 Universite catholique de Louvain
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Lionel Metongnon <lionel.metongnon@uclouvain.be>
+ */
+
+#ifndef NS3_MULTITHREADED_SIMULATOR_IMPL_H
+#define NS3_MULTITHREADED_SIMULATOR_IMPL_H
+
+#include "ns3/simulator-impl.h"
+#include "ns3/scheduler.h"
+#include "ns3/event-impl.h"
+#include "ns3/object-factory.h"
+#include "ns3/system-thread.h"
+#include "ns3/system-mutex.h"
+#include "ns3/ptr.h"
+
+#include <list>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \ingroup mpi
+ *
+ * \brief Parallel simulator running the nodes on a pool of threads
+ *
+ * At each Run, the nodes are partitioned into logical processes: the
+ * nodes sharing a channel are in the same partition, except the point to
+ * point channels with a positive Delay, which are cut.  The smallest
+ * delay of the cut channels is the lookahead: each partition runs its
+ * events in windows of that length on the threads of the pool, without
+ * any lock, and the events it schedules on another partition are handed
+ * over at the end of the window.  Unlike DistributedSimulatorImpl, there
+ * is no MPI and no system id to assign: select it with
+ *
+ * \code
+ *   GlobalValue::Bind ("SimulatorImplementationType",
+ *                      StringValue ("ns3::MultithreadedSimulatorImpl"));
+ * \endcode
+ *
+ * The events without a node context (0xffffffff), like Simulator::Stop,
+ * run alone between two windows.  A partition may schedule an event on
+ * another one only after the lookahead; the events scheduled there from
+ * a partition run at the end of the current window at the earliest.
+ *
+ * While the threads run, ns3::ThreadSafety makes the reference counts
+ * atomic, and the buffers, metadata and byte tags shared by several
+ * packets are copied before they are written instead of being extended
+ * in place.  The copies of one packet, such as the payload templates of
+ * the applications or the segments of a stream socket, may therefore
+ * travel through several partitions.  The models must otherwise not
+ * share state between nodes of different partitions, such as a
+ * ScanDiscoverySet shared by scanners placed in different partitions.
+ */
+class MultithreadedSimulatorImpl : public SimulatorImpl
+{
+public:
+  /**
+   * Register this type.
+   * \return The object TypeId.
+   */
+  static TypeId GetTypeId (void);
+
+  MultithreadedSimulatorImpl ();
+  ~MultithreadedSimulatorImpl ();
+
+  // Inherited
+  virtual void Destroy ();
+  virtual bool IsFinished (void) const;
+  virtual void Stop (void);
+  virtual void Stop (Time const &delay);
+  virtual EventId Schedule (Time const &delay, EventImpl *event);
+  virtual void ScheduleWithContext (uint32_t context, Time const &delay, EventImpl *event);
+  virtual EventId ScheduleNow (EventImpl *event);
+  virtual EventId ScheduleDestroy (EventImpl *event);
+  virtual void Remove (const EventId &id);
+  virtual void Cancel (const EventId &id);
+  virtual bool IsExpired (const EventId &id) const;
+  virtual void Run (void);
+  virtual Time Now (void) const;
+  virtual Time GetDelayLeft (const EventId &id) const;
+  virtual Time GetMaximumSimulationTime (void) const;
+  virtual void SetScheduler (ObjectFactory schedulerFactory);
+  virtual uint32_t GetSystemId (void) const;
+  virtual uint32_t GetContext (void) const;
+
+  /**
+   * \returns the number of partitions of the nodes, computed by Run
+   */
+  uint32_t GetNPartitions (void) const;
+
+  /**
+   * \param context a node id
+   * \returns the partition of the node, from 1, or 0 for the events
+   * without a node
+   */
+  uint32_t GetPartition (uint32_t context) const;
+
+  /**
+   * \returns the length of the windows, computed by Run
+   */
+  Time GetLookahead (void) const;
+
+  /**
+   * \returns the number of threads of the last Run
+   */
+  uint32_t GetNThreads (void) const;
+
+private:
+  virtual void DoDispose (void);
+
+  /**
+   * An event scheduled on another partition during a window, or from a
+   * thread outside of the simulation.
+   */
+  struct HandOver
+  {
+    uint64_t ts;         //!< Timestamp, or delay from outside of the simulation
+    uint32_t source;     //!< Partition of the sender, 0xffffffff from outside
+    uint32_t sequence;   //!< Order of the event in the sender
+    uint32_t context;    //!< Execution context
+    EventImpl *event;    //!< The event implementation
+    /**
+     * \param o another event
+     * \returns true if this event is handed over before the other one
+     */
+    bool operator < (const HandOver &o) const;
+  };
+
+  /** A logical process: the events of a set of nodes. */
+  struct Partition
+  {
+    Partition ();
+    uint32_t id;                  //!< Index in m_partitions
+    Ptr<Scheduler> events;        //!< The event priority queue
+    uint64_t currentTs;           //!< Timestamp of the current event
+    uint32_t currentUid;          //!< Unique id of the current event
+    uint32_t currentContext;      //!< Execution context of the current event
+    uint32_t nextUid;             //!< Next unique id of the block
+    uint32_t lastUid;             //!< End of the block of unique ids
+    uint32_t sent;                //!< Events handed over to other partitions
+    std::vector<HandOver> inbox;  //!< Events handed over to this partition
+    SystemMutex inboxMutex;       //!< Protects the inbox
+  };
+
+  /** Partition the nodes and move the events to their partition. */
+  void Repartition (void);
+  /**
+   * \param context an execution context
+   * \returns the partition running the context
+   */
+  struct Partition *Find (uint32_t context) const;
+  /** \returns the partition of the calling thread */
+  struct Partition *GetCurrent (void) const;
+  /**
+   * \param partition a partition
+   * \returns a unique id, increasing in the partition
+   */
+  uint32_t NextUid (struct Partition *partition);
+  /**
+   * \param partition the partition of the event
+   * \param ts the timestamp of the event
+   * \param context the execution context
+   * \param event the event implementation
+   * \returns the unique id of the event
+   */
+  uint32_t Insert (struct Partition *partition, uint64_t ts, uint32_t context, EventImpl *event);
+  /** Insert the events handed over during the last window. */
+  void MergeInboxes (void);
+  /**
+   * \param partition a partition
+   * \returns the timestamp of the next event of the partition, or the
+   * maximum simulation time
+   */
+  uint64_t GetNextTs (const struct Partition *partition) const;
+  /**
+   * \param partition the partition of the event
+   * Process the next event of a partition.
+   */
+  void ProcessOneEvent (struct Partition *partition);
+  /** Process the windows of the ready partitions, from any thread. */
+  void ProcessReady (void);
+  /** Body of the threads of the pool. */
+  void Work (void);
+
+  /** Partition run by the calling thread, 0 outside of the windows. */
+  static __thread struct Partition *g_current;
+
+  /** Container type for the events to run at Simulator::Destroy() */
+  typedef std::list<EventId> DestroyEvents;
+  /** The container of events to run at Destroy. */
+  DestroyEvents m_destroyEvents;
+  /** Protects the events to run at Destroy. */
+  SystemMutex m_destroyMutex;
+
+  ObjectFactory m_schedulerFactory;           //!< Scheduler of the partitions
+  std::vector<struct Partition *> m_partitions; //!< Partition 0 runs the events without node
+  std::vector<uint32_t> m_partitionOf;        //!< Partition of each node
+  uint64_t m_lookahead;                       //!< Length of the windows
+  uint32_t m_maxThreads;                      //!< Attribute, 0 for the online cores
+  uint32_t m_nThreads;                        //!< Threads of the current Run
+
+  volatile uint32_t m_uid;                    //!< Next block of unique ids
+  volatile bool m_stop;                       //!< Flag calling for the end of the simulation
+  volatile bool m_inWindow;                   //!< While the partitions run their window
+  uint64_t m_windowEnd;                       //!< End of the current window, excluded
+  std::vector<struct Partition *> m_ready;    //!< Partitions with events in the window
+  volatile uint32_t m_nextReady;              //!< Next ready partition to process
+  volatile uint32_t m_busy;                   //!< Threads of the pool still in the window
+  volatile uint32_t m_generation;             //!< Incremented at each window
+  uint32_t m_poolGeneration;                  //!< Generation when the pool started
+  uint64_t m_frontier;                        //!< Time reached by all the partitions
+  volatile bool m_exiting;                    //!< Asks the threads of the pool to exit
+  std::vector<Ptr<SystemThread> > m_threads;  //!< The pool
+  SystemThread::ThreadId m_main;              //!< Main execution thread
+};
+
+} // namespace ns3
+
+#endif /* NS3_MULTITHREADED_SIMULATOR_IMPL_H */
@@ -0,0 +1,366 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2015 Universite catholique de Louvain
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Lionel Metongnon <lionel.metongnon@uclouvain.be>
+ */
+
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/config.h"
+#include "ns3/string.h"
+#include "ns3/uinteger.h"
+#include "ns3/boolean.h"
+#include "ns3/nstime.h"
+#include "ns3/packet.h"
+#include "ns3/node.h"
+#include "ns3/node-container.h"
+#include "ns3/simple-net-device.h"
+#include "ns3/simple-channel.h"
+#include "ns3/mac48-address.h"
+#include "ns3/multithreaded-simulator-impl.h"
+
+#include <vector>
+#include <utility>
+
+using namespace ns3;
+
+namespace {
+
+/**
+ * \param nodes the nodes to attach to the channel
+ * \param delay the delay of the channel
+ * \param pointToPoint whether the devices are in point to point mode
+ * \returns the devices, in the order of the nodes
+ */
+std::vector<Ptr<SimpleNetDevice> >
+Connect (NodeContainer nodes, Time delay, bool pointToPoint)
+{
+  Ptr<SimpleChannel> channel = CreateObject<SimpleChannel> ();
+  channel->SetAttribute ("Delay", TimeValue (delay));
+  std::vector<Ptr<SimpleNetDevice> > devices;
+  for (uint32_t i = 0; i < nodes.GetN (); ++i)
+    {
+      Ptr<SimpleNetDevice> device = CreateObject<SimpleNetDevice> ();
+      device->SetAttribute ("PointToPointMode", BooleanValue (pointToPoint));
+      device->SetAddress (Mac48Address::Allocate ());
+      device->SetChannel (channel);
+      nodes.Get (i)->AddDevice (device);
+      devices.push_back (device);
+    }
+  return devices;
+}
+
+/**
+ * \returns the implementation of the running simulator
+ */
+Ptr<MultithreadedSimulatorImpl>
+GetImpl (void)
+{
+  return DynamicCast<MultithreadedSimulatorImpl> (Simulator::GetImplementation ());
+}
+
+} // anonymous namespace
+
+/**
+ * \ingroup mpi
+ *
+ * Check the partitions and the lookahead computed from the channels.
+ */
+class MultithreadedSimulatorPartitionTestCase : public TestCase
+{
+public:
+  MultithreadedSimulatorPartitionTestCase ();
+  virtual ~MultithreadedSimulatorPartitionTestCase ();
+
+private:
+  virtual void DoSetup (void);
+  virtual void DoRun (void);
+  virtual void DoTeardown (void);
+};
+
+MultithreadedSimulatorPartitionTestCase::MultithreadedSimulatorPartitionTestCase ()
+  : TestCase ("Partitions and lookahead follow the channels")
+{
+}
+
+MultithreadedSimulatorPartitionTestCase::~MultithreadedSimulatorPartitionTestCase ()
+{
+}
+
+void
+MultithreadedSimulatorPartitionTestCase::DoSetup (void)
+{
+  Config::SetGlobal ("SimulatorImplementationType", StringValue ("ns3::MultithreadedSimulatorImpl"));
+}
+
+void
+MultithreadedSimulatorPartitionTestCase::DoRun (void)
+{
+  NodeContainer nodes;
+  nodes.Create (5);
+  // a shared channel joins 0, 1 and 2, which makes the point to point
+  // channel 0-1 an internal one
+  Connect (NodeContainer (nodes.Get (0), nodes.Get (1), nodes.Get (2)), MilliSeconds (2), false);
+  Connect (NodeContainer (nodes.Get (0), nodes.Get (1)), MilliSeconds (1), true);
+  Connect (NodeContainer (nodes.Get (2), nodes.Get (3)), MilliSeconds (5), true);
+  Connect (NodeContainer (nodes.Get (3), nodes.Get (4)), MilliSeconds (7), true);
+  // no delay: no cut
+  Connect (NodeContainer (nodes.Get (3), nodes.Get (4)), Seconds (0), true);
+
+  Simulator::Run ();
+
+  Ptr<MultithreadedSimulatorImpl> impl = GetImpl ();
+  NS_TEST_ASSERT_MSG_NE (impl, 0, "Not running the multithreaded simulator");
+  NS_TEST_EXPECT_MSG_EQ (impl->GetNPartitions (), 2, "Wrong number of partitions");
+  NS_TEST_EXPECT_MSG_EQ (impl->GetPartition (0), 1, "Wrong partition of node 0");
+  NS_TEST_EXPECT_MSG_EQ (impl->GetPartition (1), 1, "Wrong partition of node 1");
+  NS_TEST_EXPECT_MSG_EQ (impl->GetPartition (2), 1, "Wrong partition of node 2");
+  NS_TEST_EXPECT_MSG_EQ (impl->GetPartition (3), 2, "Wrong partition of node 3");
+  NS_TEST_EXPECT_MSG_EQ (impl->GetPartition (4), 2, "Wrong partition of node 4");
+  NS_TEST_EXPECT_MSG_EQ (impl->GetPartition (0xffffffff), 0, "Wrong partition of the global events");
+  NS_TEST_EXPECT_MSG_EQ (impl->GetLookahead (), MilliSeconds (5), "Wrong lookahead");
+
+  Simulator::Destroy ();
+}
+
+void
+MultithreadedSimulatorPartitionTestCase::DoTeardown (void)
+{
+  Config::SetGlobal ("SimulatorImplementationType", StringValue ("ns3::DefaultSimulatorImpl"));
+}
+
+/**
+ * \ingroup mpi
+ *
+ * Forward packets around a ring of point to point links, and check the
+ * multithreaded simulator receives them exactly like the default one.
+ * With a template, every node sends copies of one packet, and each hop
+ * appends a byte to them: the partitions then extend the same buffer.
+ */
+class MultithreadedSimulatorRingTestCase : public TestCase
+{
+public:
+  /**
+   * \param maxThreads the threads of the multithreaded simulator
+   * \param stop the time to stop the simulations, or zero
+   * \param shared whether the nodes send copies of a template
+   */
+  MultithreadedSimulatorRingTestCase (uint32_t maxThreads, Time stop, bool shared = false);
+  virtual ~MultithreadedSimulatorRingTestCase ();
+
+private:
+  virtual void DoRun (void);
+  virtual void DoTeardown (void);
+
+  /// Time and digest of the size and content of the packets received by a node
+  typedef std::vector<std::pair<Time, uint32_t> > Received;
+
+  /**
+   * Run the ring on a simulator.
+   * \param simulatorType the implementation of the simulator
+   * \returns the packets received by each node
+   */
+  std::vector<Received> RunRing (std::string simulatorType);
+  /**
+   * Send the first packets of a node.
+   * \param device the device to the next node
+   */
+  void Start (Ptr<NetDevice> device);
+  /**
+   * Forward a packet to the next node, one byte shorter: with a
+   * template, two bytes are removed at the start and the id of the node
+   * is appended.
+   * \param device the receiving device
+   * \param packet the packet
+   * \param protocol the protocol number
+   * \param from the sender
+   * \returns true
+   */
+  bool Receive (Ptr<NetDevice> device, Ptr<const Packet> packet, uint16_t protocol, const Address &from);
+
+  uint32_t m_maxThreads;              //!< Threads of the multithreaded simulator
+  Time m_stop;                        //!< End of the simulations, or zero
+  bool m_shared;                      //!< Whether the nodes send copies of m_template
+  Ptr<Packet> m_template;             //!< Packet copied by every node
+  std::vector<Received> m_received;   //!< Written by the partition of each node
+  std::vector<Ptr<SimpleNetDevice> > m_toNext; //!< Device of each node to the next one
+  Time m_end;                         //!< Time at the end of the last simulation
+  uint32_t m_nThreads;                //!< Threads used by the last simulation
+};
+
+MultithreadedSimulatorRingTestCase::MultithreadedSimulatorRingTestCase (uint32_t maxThreads, Time stop, bool shared)
+  : TestCase (shared ? "Ring of point to point links forwarding copies of a template"
+                     : "Ring of point to point links"),
+    m_maxThreads (maxThreads),
+    m_stop (stop),
+    m_shared (shared),
+    m_nThreads (0)
+{
+}
+
+MultithreadedSimulatorRingTestCase::~MultithreadedSimulatorRingTestCase ()
+{
+}
+
+void
+MultithreadedSimulatorRingTestCase::Start (Ptr<NetDevice> device)
+{
+  for (uint32_t i = 0; i < 10; ++i)
+    {
+      Ptr<Packet> packet = m_shared ? m_template->Copy () : Create<Packet> (100 + i);
+      device->Send (packet, device->GetBroadcast (), 0x800);
+    }
+}
+
+bool
+MultithreadedSimulatorRingTestCase::Receive (Ptr<NetDevice> device, Ptr<const Packet> packet,
+                                             uint16_t protocol, const Address &from)
+{
+  Ptr<Node> node = device->GetNode ();
+  std::vector<uint8_t> content (packet->GetSize ());
+  packet->CopyData (content.empty () ? 0 : &content[0], content.size ());
+  uint32_t digest = packet->GetSize ();
+  for (uint32_t i = 0; i < content.size (); ++i)
+    {
+      digest = digest * 31 + content[i];
+    }
+  m_received[node->GetId ()].push_back (std::make_pair (Simulator::Now (), digest));
+  if (packet->GetSize () > 1)
+    {
+      Ptr<NetDevice> next = m_toNext[node->GetId ()];
+      Ptr<Packet> copy = packet->Copy ();
+      if (m_shared)
+        {
+          uint8_t id = node->GetId ();
+          copy->RemoveAtStart (2);
+          copy->AddAtEnd (Create<Packet> (&id, 1));
+        }
+      else
+        {
+          copy->RemoveAtEnd (1);
+        }
+      next->Send (copy, next->GetBroadcast (), protocol);
+    }
+  return true;
+}
+
+std::vector<MultithreadedSimulatorRingTestCase::Received>
+MultithreadedSimulatorRingTestCase::RunRing (std::string simulatorType)
+{
+  Config::SetGlobal ("SimulatorImplementationType", StringValue (simulatorType));
+  Config::SetDefault ("ns3::MultithreadedSimulatorImpl::MaxThreads", UintegerValue (m_maxThreads));
+
+  const uint32_t nNodes = 8;
+  NodeContainer nodes;
+  nodes.Create (nNodes);
+  for (uint32_t i = 0; i < nNodes; ++i)
+    {
+      // one slower link
+      Time delay = i == 3 ? MicroSeconds (2500) : MilliSeconds (1);
+      std::vector<Ptr<SimpleNetDevice> > devices = Connect (NodeContainer (nodes.Get (i), nodes.Get ((i + 1) % nNodes)),
+                                                            delay, true);
+      devices[1]->SetReceiveCallback (MakeCallback (&MultithreadedSimulatorRingTestCase::Receive, this));
+      m_toNext.push_back (devices[0]);
+    }
+  m_received.assign (nNodes, Received ());
+  std::vector<uint8_t> bytes (100);
+  for (uint32_t i = 0; i < bytes.size (); ++i)
+    {
+      bytes[i] = i * 7;
+    }
+  m_template = Create<Packet> (&bytes[0], bytes.size ());
+  for (uint32_t i = 0; i < nNodes; ++i)
+    {
+      Simulator::ScheduleWithContext (i, MicroSeconds (10 * i),
+                                      &MultithreadedSimulatorRingTestCase::Start, this, m_toNext[i]);
+    }
+  if (!m_stop.IsZero ())
+    {
+      Simulator::Stop (m_stop);
+    }
+
+  Simulator::Run ();
+
+  m_end = Simulator::Now ();
+  Ptr<MultithreadedSimulatorImpl> impl = GetImpl ();
+  m_nThreads = impl != 0 ? impl->GetNThreads () : 1;
+  if (impl != 0)
+    {
+      NS_TEST_EXPECT_MSG_EQ (impl->GetNPartitions (), nNodes, "Every link is a cut");
+      NS_TEST_EXPECT_MSG_EQ (impl->GetLookahead (), MilliSeconds (1), "Wrong lookahead");
+    }
+  Simulator::Destroy ();
+  m_toNext.clear ();
+  m_template = 0;
+
+  std::vector<Received> received;
+  received.swap (m_received);
+  return received;
+}
+
+void
+MultithreadedSimulatorRingTestCase::DoRun (void)
+{
+  std::vector<Received> expected = RunRing ("ns3::DefaultSimulatorImpl");
+  Time expectedEnd = m_end;
+  std::vector<Received> received = RunRing ("ns3::MultithreadedSimulatorImpl");
+
+  NS_TEST_EXPECT_MSG_EQ (m_nThreads, m_maxThreads, "Wrong number of threads");
+  NS_TEST_EXPECT_MSG_EQ (m_end, expectedEnd, "Wrong time at the end of the simulation");
+  NS_TEST_ASSERT_MSG_EQ (received.size (), expected.size (), "Wrong number of nodes");
+  for (uint32_t i = 0; i < expected.size (); ++i)
+    {
+      NS_TEST_ASSERT_MSG_EQ (received[i].size (), expected[i].size (), "Wrong number of packets on node " << i);
+      for (uint32_t j = 0; j < expected[i].size (); ++j)
+        {
+          NS_TEST_ASSERT_MSG_EQ (received[i][j].first, expected[i][j].first, "Wrong time of packet " << j << " on node " << i);
+          NS_TEST_ASSERT_MSG_EQ (received[i][j].second, expected[i][j].second, "Wrong content of packet " << j << " on node " << i);
+        }
+    }
+  if (!m_stop.IsZero ())
+    {
+      NS_TEST_EXPECT_MSG_EQ (m_end, m_stop, "Not stopped");
+    }
+}
+
+void
+MultithreadedSimulatorRingTestCase::DoTeardown (void)
+{
+  Config::SetGlobal ("SimulatorImplementationType", StringValue ("ns3::DefaultSimulatorImpl"));
+  Config::SetDefault ("ns3::MultithreadedSimulatorImpl::MaxThreads", UintegerValue (0));
+}
+
+/**
+ * \ingroup mpi
+ *
+ * The multithreaded simulator TestSuite.
+ */
+class MultithreadedSimulatorTestSuite : public TestSuite
+{
+public:
+  MultithreadedSimulatorTestSuite ()
+    : TestSuite ("multithreaded-simulator", UNIT)
+  {
+    AddTestCase (new MultithreadedSimulatorPartitionTestCase, TestCase::QUICK);
+    AddTestCase (new MultithreadedSimulatorRingTestCase (1, Seconds (0)), TestCase::QUICK);
+    AddTestCase (new MultithreadedSimulatorRingTestCase (4, Seconds (0)), TestCase::QUICK);
+    AddTestCase (new MultithreadedSimulatorRingTestCase (4, MicroSeconds (30500)), TestCase::QUICK);
+    AddTestCase (new MultithreadedSimulatorRingTestCase (4, Seconds (0), true), TestCase::QUICK);
+  }
+};
+
+static MultithreadedSimulatorTestSuite g_multithreadedSimulatorTestSuite;
@@ -759,9 +759,9 @@ private:
   /**
    * location in a newly-allocated buffer where you should start
    * writing data. i.e., m_start should be initialized to this 
-   * value.
+   * value.  Each thread of a simulation has its own.
    */
-  static uint32_t g_recommendedStart;
+  static __thread uint32_t g_recommendedStart;
 
   /**
    * offset to the start of the virtual zero area from the start
@@ -801,6 +801,7 @@ private:
 } // namespace ns3
 
 #include "ns3/assert.h"
+#include "ns3/thread-safety.h"
 #include <cstring>
 
 namespace ns3 {
@@ -1049,7 +1050,7 @@ Buffer::Buffer (Buffer const&o)
     m_start (o.m_start),
     m_end (o.m_end)
 {
-  m_data->m_count++;
+  ThreadSafety::Increment (m_data->m_count);
   NS_ASSERT (CheckInternalState ());
 }
 
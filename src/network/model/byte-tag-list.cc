@@ -19,6 +19,7 @@
  */
 #include "byte-tag-list.h"
 #include "ns3/log.h"
+#include "ns3/thread-safety.h"
 #include <vector>
 #include <cstring>
 
@@ -156,7 +157,7 @@ ByteTagList::ByteTagList (const ByteTagList &o)
   NS_LOG_FUNCTION (this << &o);
   if (m_data != 0)
     {
-      m_data->count++;
+      ThreadSafety::Increment (m_data->count);
     }
 }
 ByteTagList &
@@ -175,7 +176,7 @@ ByteTagList::operator = (const ByteTagList &o)
   m_used = o.m_used;
   if (m_data != 0)
     {
-      m_data->count++;
+      ThreadSafety::Increment (m_data->count);
     }
   return *this;
 }
@@ -199,7 +200,8 @@ ByteTagList::Add (TypeId tid, uint32_t bufferSize, int32_t start, int32_t end)
       m_used = 0;
     } 
   else if (m_data->size < spaceNeeded ||
-           (m_data->count != 1 && m_data->dirty != m_used))
+           (m_data->count != 1 &&
+            (m_data->dirty != m_used || ThreadSafety::IsEnabled ())))
     {
       struct ByteTagListData *newData = Allocate (spaceNeeded);
       std::memcpy (&newData->data, &m_data->data, m_used);
@@ -344,7 +346,8 @@ struct ByteTagListData *
 ByteTagList::Allocate (uint32_t size)
 {
   NS_LOG_FUNCTION (this << size);
-  while (!g_freeList.empty ())
+  // the free list is not shared between threads
+  while (!ThreadSafety::IsEnabled () && !g_freeList.empty ())
     {
       struct ByteTagListData *data = g_freeList.back ();
       g_freeList.pop_back ();
@@ -375,10 +378,10 @@ ByteTagList::Deallocate (struct ByteTagListData *data)
       return;
     }
   g_maxSize = std::max (g_maxSize, data->size);
-  data->count--;
-  if (data->count == 0)
+  if (ThreadSafety::Decrement (data->count))
     {
-      if (g_freeList.size () > FREE_LIST_SIZE ||
+      if (ThreadSafety::IsEnabled () ||
+          g_freeList.size () > FREE_LIST_SIZE ||
           data->size < g_maxSize)
         {
           uint8_t *buffer = (uint8_t *)data;
@@ -413,8 +416,7 @@ ByteTagList::Deallocate (struct ByteTagListData *data)
     {
       return;
     }
-  data->count--;
-  if (data->count == 0)
+  if (ThreadSafety::Decrement (data->count))
     {
       uint8_t *buffer = (uint8_t *)data;
       delete [] buffer;
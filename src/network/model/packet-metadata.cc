@@ -34,8 +34,8 @@ NS_LOG_COMPONENT_DEFINE ("PacketMetadata");
 bool PacketMetadata::m_enable = false;
 bool PacketMetadata::m_enableChecking = false;
 bool PacketMetadata::m_metadataSkipped = false;
-uint32_t PacketMetadata::m_maxSize = 0;
-uint16_t PacketMetadata::m_chunkUid = 0;
+__thread uint32_t PacketMetadata::m_maxSize = 0;
+__thread uint16_t PacketMetadata::m_chunkUid = 0;
 PacketMetadata::DataFreeList PacketMetadata::m_freeList;
 
 PacketMetadata::DataFreeList::~DataFreeList ()
@@ -77,8 +77,7 @@ PacketMetadata::ReserveCopy (uint32_t size)
   struct PacketMetadata::Data *newData = PacketMetadata::Create (m_used + size);
   memcpy (newData->m_data, m_data->m_data, m_used);
   newData->m_dirtyEnd = m_used;
-  m_data->m_count--;
-  if (m_data->m_count == 0) 
+  if (ThreadSafety::Decrement (m_data->m_count))
     {
       PacketMetadata::Recycle (m_data);
     }
@@ -100,10 +99,11 @@ PacketMetadata::Reserve (uint32_t size)
 {
   NS_LOG_FUNCTION (this << size);
   NS_ASSERT (m_data != 0);
+  // the threads of a simulation cannot share the dirty end of the data
   if (m_data->m_size >= m_used + size &&
-      (m_head == 0xffff ||
-       m_data->m_count == 1 ||
-       m_data->m_dirtyEnd == m_used))
+      (m_data->m_count == 1 ||
+       (!ThreadSafety::IsEnabled () &&
+        (m_head == 0xffff || m_data->m_dirtyEnd == m_used))))
     {
       /* enough room, not dirty. */
     }
@@ -381,9 +381,9 @@ PacketMetadata::AddSmall (const struct PacketMetadata::SmallItem *item)
   uint32_t sizeSize = GetUleb128Size (item->size);
   uint32_t n =  2 + 2 + typeUidSize + sizeSize + 2;
   if (m_used + n > m_data->m_size ||
-      (m_head != 0xffff &&
-       m_data->m_count != 1 &&
-       m_used != m_data->m_dirtyEnd))
+      (m_data->m_count != 1 &&
+       (ThreadSafety::IsEnabled () ||
+        (m_head != 0xffff && m_used != m_data->m_dirtyEnd))))
     {
       ReserveCopy (n);
     }
@@ -419,9 +419,9 @@ PacketMetadata::AddBig (uint32_t next, uint32_t prev,
   uint32_t n = 2 + 2 + typeUidSize + sizeSize + 2 + fragStartSize + fragEndSize + 4;
 
   if (m_used + n > m_data->m_size ||
-      (m_head != 0xffff &&
-       m_data->m_count != 1 &&
-       m_used != m_data->m_dirtyEnd))
+      (m_data->m_count != 1 &&
+       (ThreadSafety::IsEnabled () ||
+        (m_head != 0xffff && m_used != m_data->m_dirtyEnd))))
     {
       ReserveCopy (n);
     }
@@ -464,7 +464,8 @@ PacketMetadata::ReplaceTail (PacketMetadata::SmallItem *item,
    * path below.
    */
   if (m_tail + available == m_used &&
-      m_used == m_data->m_dirtyEnd)
+      m_used == m_data->m_dirtyEnd &&
+      !ThreadSafety::IsEnabled ())
     {
       available = m_data->m_size - m_tail;
     }
@@ -576,7 +577,8 @@ PacketMetadata::Create (uint32_t size)
     {
       m_maxSize = size;
     }
-  while (!m_freeList.empty ()) 
+  // the free list is not shared between threads
+  while (!ThreadSafety::IsEnabled () && !m_freeList.empty ()) 
     {
       struct PacketMetadata::Data *data = m_freeList.back ();
       m_freeList.pop_back ();
@@ -597,7 +599,7 @@ void
 PacketMetadata::Recycle (struct PacketMetadata::Data *data)
 {
   NS_LOG_FUNCTION (data);
-  if (!m_enable)
+  if (!m_enable || ThreadSafety::IsEnabled ())
     {
       PacketMetadata::Deallocate (data);
       return;
@@ -26,6 +26,7 @@
 #include "ns3/callback.h"
 #include "ns3/assert.h"
 #include "ns3/type-id.h"
+#include "ns3/thread-safety.h"
 #include "buffer.h"
 
 namespace ns3 {
@@ -667,8 +668,8 @@ public:
    */
   static bool m_metadataSkipped;
 
-  static uint32_t m_maxSize; //!< maximum metadata size
-  static uint16_t m_chunkUid; //!< Chunk Uid
+  static __thread uint32_t m_maxSize; //!< maximum metadata size, per thread
+  static __thread uint16_t m_chunkUid; //!< Chunk Uid, per thread
 
   struct Data *m_data; //!< Metadata storage
   /*
@@ -708,7 +709,7 @@ PacketMetadata::PacketMetadata (PacketMetadata const &o)
 {
   NS_ASSERT (m_data != 0);
   NS_ASSERT (m_data->m_count < std::numeric_limits<uint32_t>::max());
-  m_data->m_count++;
+  ThreadSafety::Increment (m_data->m_count);
 }
 PacketMetadata &
 PacketMetadata::operator = (PacketMetadata const& o)
@@ -717,14 +718,13 @@ PacketMetadata::operator = (PacketMetadata const& o)
     {
       // not self assignment
       NS_ASSERT (m_data != 0);
-      m_data->m_count--;
-      if (m_data->m_count == 0) 
+      if (ThreadSafety::Decrement (m_data->m_count))
         {
           PacketMetadata::Recycle (m_data);
         }
       m_data = o.m_data;
       NS_ASSERT (m_data != 0);
-      m_data->m_count++;
+      ThreadSafety::Increment (m_data->m_count);
     }
   m_head = o.m_head;
   m_tail = o.m_tail;
@@ -735,8 +735,7 @@ PacketMetadata::operator = (PacketMetadata const& o)
 PacketMetadata::~PacketMetadata ()
 {
   NS_ASSERT (m_data != 0);
-  m_data->m_count--;
-  if (m_data->m_count == 0) 
+  if (ThreadSafety::Decrement (m_data->m_count))
     {
       PacketMetadata::Recycle (m_data);
     }
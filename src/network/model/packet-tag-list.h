@@ -28,6 +28,7 @@
 #include <stdint.h>
 #include <ostream>
 #include "ns3/type-id.h"
+#include "ns3/thread-safety.h"
 
 namespace ns3 {
 
@@ -311,7 +312,7 @@ PacketTagList::PacketTagList (PacketTagList const &o)
 {
   if (m_next != 0)
     {
-      m_next->count++;
+      ThreadSafety::Increment (m_next->count);
     }
 }
 
@@ -327,7 +328,7 @@ PacketTagList::operator = (PacketTagList const &o)
   m_next = o.m_next;
   if (m_next != 0) 
     {
-      m_next->count++;
+      ThreadSafety::Increment (m_next->count);
     }
   return *this;
 }
@@ -343,8 +344,7 @@ PacketTagList::RemoveAll (void)
   struct TagData *prev = 0;
   for (struct TagData *cur = m_next; cur != 0; cur = cur->next)
     {
-      cur->count--;
-      if (cur->count > 0) 
+      if (!ThreadSafety::Decrement (cur->count))
         {
           break;
         }
@@ -45,13 +45,20 @@ public:
   Bench (const uint32_t population, const uint32_t total)
   : m_population (population),
     m_total (total),
-    m_count (0)
+    m_count (0),
+    m_longFraction (0)
   { };
   
   void SetRandomStream (Ptr<RandomVariableStream> stream)
   {
     m_rand = stream;
   }
+
+  void SetLongStream (Ptr<RandomVariableStream> stream, double fraction)
+  {
+    m_long = stream;
+    m_longFraction = fraction;
+  }
     
   void SetPopulation (const uint32_t population)
   {
@@ -66,13 +73,36 @@ public:
   void RunBench (void);
 private:
   void Cb (void);
+  Time GetDelay (void);
   
   Ptr<RandomVariableStream> m_rand;
   uint32_t m_population;
   uint32_t m_total;
   uint32_t m_count;
+  // a fraction of the events is delayed after m_long instead, like the
+  // timeouts of the probes of a scan among their transmissions
+  Ptr<RandomVariableStream> m_long;
+  Ptr<UniformRandomVariable> m_choice;
+  double m_longFraction;
 };
 
+Time
+Bench::GetDelay (void)
+{
+  if (m_longFraction > 0)
+    {
+      if (m_choice == 0)
+        {
+          m_choice = CreateObject<UniformRandomVariable> ();
+        }
+      if (m_choice->GetValue () < m_longFraction)
+        {
+          return NanoSeconds (m_long->GetValue ());
+        }
+    }
+  return NanoSeconds (m_rand->GetValue ());
+}
+
 void
 Bench::RunBench (void) 
 {
@@ -86,7 +116,7 @@ Bench::RunBench (void)
   time.Start ();
   for (uint32_t i = 0; i < m_population; ++i)
     {
-      Time at = NanoSeconds (m_rand->GetValue ());
+      Time at = GetDelay ();
       Simulator::Schedule (at, &Bench::Cb, this);
     }
   init = time.End ();
@@ -118,7 +148,7 @@ Bench::Cb (void)
     }
   DEB ("event at " << Simulator::Now ().GetSeconds () << "s");
 
-  Time after = NanoSeconds (m_rand->GetValue ());
+  Time after = GetDelay ();
   Simulator::Schedule (after, &Bench::Cb, this);
   ++m_count;
 }
@@ -186,6 +216,10 @@ int main (int argc, char *argv[])
   bool schedHeap = false;
   bool schedList = false;
   bool schedMap  = true;
+  bool schedLadder = false;
+  bool schedAll  = false;
+  double scan    = 0;
+  bool pool      = true;
 
   uint32_t pop   =  100000;
   uint32_t total = 1000000;
@@ -200,11 +234,18 @@ int main (int argc, char *argv[])
              "  an ascii file, given by the --file=\"<filename>\" argument,\n"
              "  or standard input, by the argument --file=\"-\"\n"
              "In the case of either --file form, the input is expected\n"
-             "to be ascii, giving the relative event times in ns.");
+             "to be ascii, giving the relative event times in ns.\n"
+             "With --scan=<fraction>, that fraction of the events is rather\n"
+             "delayed after an exponential distribution with mean 1 s, like\n"
+             "the timeouts of the probes of a scan.");
   cmd.AddValue ("cal",   "use CalendarSheduler",          schedCal);
   cmd.AddValue ("heap",  "use HeapScheduler",             schedHeap);
   cmd.AddValue ("list",  "use ListSheduler",              schedList);
   cmd.AddValue ("map",   "use MapScheduler (default)",    schedMap);
+  cmd.AddValue ("ladder", "use LadderScheduler",          schedLadder);
+  cmd.AddValue ("all",   "compare all the schedulers",    schedAll);
+  cmd.AddValue ("scan",  "fraction of long delays (default 0)", scan);
+  cmd.AddValue ("pool",  "recycle the events (default true)", pool);
   cmd.AddValue ("debug", "enable debugging output",       g_debug);
   cmd.AddValue ("pop",   "event population size (default 1E5)",         pop);
   cmd.AddValue ("total", "total number of events to run (default 1E6)", total);
@@ -215,58 +256,87 @@ int main (int argc, char *argv[])
   g_me = cmd.GetName () + ": ";
   g_fwidth += 6;  // 5 extra chars in '2.000002e+07 ': . e+0 _
 
-  ObjectFactory factory ("ns3::MapScheduler");
-  if (schedCal)  { factory.SetTypeId ("ns3::CalendarScheduler"); }
-  if (schedHeap) { factory.SetTypeId ("ns3::HeapScheduler");     }
-  if (schedList) { factory.SetTypeId ("ns3::ListScheduler");     }  
-  Simulator::SetScheduler (factory);
+  std::vector<std::string> schedulers;
+  if (schedAll)
+    {
+      schedulers.push_back ("ns3::MapScheduler");
+      schedulers.push_back ("ns3::HeapScheduler");
+      schedulers.push_back ("ns3::CalendarScheduler");
+      schedulers.push_back ("ns3::LadderScheduler");
+      schedulers.push_back ("ns3::ListScheduler");
+    }
+  else
+    {
+      std::string type = "ns3::MapScheduler";
+      if (schedCal)  { type = "ns3::CalendarScheduler"; }
+      if (schedHeap) { type = "ns3::HeapScheduler";     }
+      if (schedList) { type = "ns3::ListScheduler";     }
+      if (schedLadder) { type = "ns3::LadderScheduler"; }
+      schedulers.push_back (type);
+    }
 
   LOGME (std::setprecision (g_fwidth - 6));
   DEB ("debugging is ON");
 
-  LOGME ("scheduler: " << factory.GetTypeId ().GetName ());
+  EventImpl::EnablePool (pool);
+  LOGME ("event pool: " << (pool ? "on" : "off"));
   LOGME ("population: " << pop);
   LOGME ("total events: " << total);
   LOGME ("runs: " << runs);
   
   Bench *bench = new Bench (pop, total);
   bench->SetRandomStream (GetRandomStream (filename));
+  if (scan > 0)
+    {
+      LOGME ("long delays: " << scan);
+      Ptr<ExponentialRandomVariable> erv = CreateObject<ExponentialRandomVariable> ();
+      erv->SetAttribute ("Mean", DoubleValue (1e9));
+      bench->SetLongStream (erv, scan);
+    }
 
-  // table header
-  LOG ("");
-  LOG (std::left << std::setw (g_fwidth) << "Run #" <<
-       std::left << std::setw (3 * g_fwidth) << "Inititialization:" <<
-       std::left << std::setw (3 * g_fwidth) << "Simulation:");
-  LOG (std::left << std::setw (g_fwidth) << "" <<
-       std::left << std::setw (g_fwidth) << "Time (s)" <<
-       std::left << std::setw (g_fwidth) << "Rate (ev/s)" <<
-       std::left << std::setw (g_fwidth) << "Per (s/ev)" <<
-       std::left << std::setw (g_fwidth) << "Time (s)" <<
-       std::left << std::setw (g_fwidth) << "Rate (ev/s)" <<
-       std::left << std::setw (g_fwidth) << "Per (s/ev)" );
-  LOG (std::setfill ('-') <<
-       std::right << std::setw (g_fwidth) << " " <<
-       std::right << std::setw (g_fwidth) << " " <<       
-       std::right << std::setw (g_fwidth) << " " <<       
-       std::right << std::setw (g_fwidth) << " " <<       
-       std::right << std::setw (g_fwidth) << " " <<       
-       std::right << std::setw (g_fwidth) << " " <<       
-       std::right << std::setw (g_fwidth) << " " <<
-       std::setfill (' ')
-       );
-       
-  // prime
-  DEB ("priming");
-  std::cout << std::left << std::setw (g_fwidth) << "(prime)";
-  bench->RunBench ();
-
-  bench->SetPopulation (pop);
-  bench->SetTotal (total);
-  for (uint32_t i = 0; i < runs; i++)
+  for (uint32_t s = 0; s < schedulers.size (); ++s)
     {
-      std::cout << std::setw (g_fwidth) << i;
-      
+      ObjectFactory factory (schedulers[s]);
+      Simulator::SetScheduler (factory);
+
+      LOG ("");
+      LOGME ("scheduler: " << factory.GetTypeId ().GetName ());
+
+      // table header
+      LOG (std::left << std::setw (g_fwidth) << "Run #" <<
+           std::left << std::setw (3 * g_fwidth) << "Inititialization:" <<
+           std::left << std::setw (3 * g_fwidth) << "Simulation:");
+      LOG (std::left << std::setw (g_fwidth) << "" <<
+           std::left << std::setw (g_fwidth) << "Time (s)" <<
+           std::left << std::setw (g_fwidth) << "Rate (ev/s)" <<
+           std::left << std::setw (g_fwidth) << "Per (s/ev)" <<
+           std::left << std::setw (g_fwidth) << "Time (s)" <<
+           std::left << std::setw (g_fwidth) << "Rate (ev/s)" <<
+           std::left << std::setw (g_fwidth) << "Per (s/ev)" );
+      LOG (std::setfill ('-') <<
+           std::right << std::setw (g_fwidth) << " " <<
+           std::right << std::setw (g_fwidth) << " " <<       
+           std::right << std::setw (g_fwidth) << " " <<       
+           std::right << std::setw (g_fwidth) << " " <<       
+           std::right << std::setw (g_fwidth) << " " <<       
+           std::right << std::setw (g_fwidth) << " " <<       
+           std::right << std::setw (g_fwidth) << " " <<
+           std::setfill (' ')
+           );
+       
+      // prime
+      DEB ("priming");
+      std::cout << std::left << std::setw (g_fwidth) << "(prime)";
       bench->RunBench ();
+
+      bench->SetPopulation (pop);
+      bench->SetTotal (total);
+      for (uint32_t i = 0; i < runs; i++)
+        {
+          std::cout << std::setw (g_fwidth) << i;
+      
+          bench->RunBench ();
+        }
     }
 
   LOG ("");
@@ -0,0 +1,166 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2015 Universite catholique de Louvain
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Lionel Metongnon <lionel.metongnon@uclouvain.be>
+ */
+
+#include "ns3/core-module.h"
+
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+using namespace ns3;
+
+// Stress the injection of events from foreign threads with
+// Simulator::ScheduleWithContext, as the reader threads of the
+// FdNetDevice and TapBridge do, against a busy main loop.
+
+class Injector
+{
+public:
+  Injector (uint32_t producers, uint32_t events, Time period)
+    : m_producers (producers),
+      m_events (events),
+      m_period (period),
+      m_received (0),
+      m_ticks (0),
+      m_done (0)
+  {
+  }
+
+  void Run (void);
+
+private:
+  void Produce (void);
+  void Receive (void);
+  void Tick (void);
+
+  uint32_t m_producers;
+  uint32_t m_events;
+  Time m_period;
+  uint64_t m_received;
+  uint64_t m_ticks;
+  volatile uint32_t m_done;
+  std::vector<Ptr<SystemThread> > m_threads;
+  SystemWallClockMs m_producersClock;
+  double m_producersTime;
+};
+
+void
+Injector::Produce (void)
+{
+  for (uint32_t i = 0; i < m_events; ++i)
+    {
+      Simulator::ScheduleWithContext (0xffffffff, Seconds (0), &Injector::Receive, this);
+    }
+  if (__sync_add_and_fetch (&m_done, 1) == m_producers)
+    {
+      m_producersTime = m_producersClock.End () / 1000.0;
+    }
+}
+
+void
+Injector::Receive (void)
+{
+  ++m_received;
+}
+
+void
+Injector::Tick (void)
+{
+  ++m_ticks;
+  if (m_received == (uint64_t) m_producers * m_events)
+    {
+      Simulator::Stop ();
+      return;
+    }
+  // the main loop keeps busy with its own events
+  Simulator::Schedule (m_period, &Injector::Tick, this);
+}
+
+void
+Injector::Run (void)
+{
+  Simulator::Schedule (m_period, &Injector::Tick, this);
+
+  SystemWallClockMs clock;
+  clock.Start ();
+  m_producersClock.Start ();
+  for (uint32_t i = 0; i < m_producers; ++i)
+    {
+      Ptr<SystemThread> thread = Create<SystemThread> (MakeCallback (&Injector::Produce, this));
+      thread->Start ();
+      m_threads.push_back (thread);
+    }
+  Simulator::Run ();
+  double total = clock.End () / 1000.0;
+  for (uint32_t i = 0; i < m_threads.size (); ++i)
+    {
+      m_threads[i]->Join ();
+    }
+
+  uint64_t injected = (uint64_t) m_producers * m_events;
+  std::cout << std::setw (10) << m_producers
+            << std::setw (14) << injected / m_producersTime
+            << std::setw (14) << (injected + m_ticks) / total
+            << std::setw (14) << m_ticks
+            << std::endl;
+}
+
+int main (int argc, char *argv[])
+{
+  uint32_t producers = 4;
+  uint32_t events = 200000;
+  bool realtime = false;
+  Time period;
+
+  CommandLine cmd;
+  cmd.Usage ("Benchmark the injection of events from foreign threads.\n"
+             "\n"
+             "Each producer thread schedules its events with context at once\n"
+             "while the main loop runs an event every period.");
+  cmd.AddValue ("producers", "number of producer threads (default 4)", producers);
+  cmd.AddValue ("events", "events of each producer (default 2E5)", events);
+  cmd.AddValue ("realtime", "use the RealtimeSimulatorImpl", realtime);
+  cmd.AddValue ("period", "time between the events of the main loop (default 1ns, 1us in real time)", period);
+  cmd.Parse (argc, argv);
+
+  if (realtime)
+    {
+      GlobalValue::Bind ("SimulatorImplementationType", StringValue ("ns3::RealtimeSimulatorImpl"));
+    }
+  if (period.IsZero ())
+    {
+      // the main loop has to keep up with the wall clock in real time
+      period = realtime ? MicroSeconds (1) : NanoSeconds (1);
+    }
+
+  std::cout << std::left
+            << std::setw (10) << "Producers"
+            << std::setw (14) << "Inject (ev/s)"
+            << std::setw (14) << "Run (ev/s)"
+            << std::setw (14) << "Main events"
+            << std::right << std::endl;
+  for (uint32_t i = 1; i <= producers; i *= 2)
+    {
+      Injector injector (i, events, period);
+      injector.Run ();
+      Simulator::Destroy ();
+    }
+  return 0;
+}
@@ -0,0 +1,59 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2015 Universite catholique de Louvain
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Lionel Metongnon <lionel.metongnon@uclouvain.be>
+ */
+
+// Rebuild the text result files (.rst and .dat) of the binary records
+// written by ScanTools and PenetrationTools with ResultFormat=Binary:
+//
+//   ./waf --run "scan-result-convert --input=./data/64_3_scanning.bin"
+
+#include "ns3/command-line.h"
+#include "ns3/scan-result-sink.h"
+#include <iostream>
+#include <string>
+#include <stdlib.h> // for exit ()
+
+using namespace ns3;
+
+int main (int argc, char *argv[])
+{
+  std::string input;
+  std::string dataDir = "./data";
+  std::string plotDir = "./plot";
+
+  CommandLine cmd;
+  cmd.Usage ("Convert binary ScanTools/PenetrationTools results to the text layouts");
+  cmd.AddValue ("input", "binary result file (<name>_scanning.bin or <name>_penetration.bin)", input);
+  cmd.AddValue ("data", "directory of the .rst files", dataDir);
+  cmd.AddValue ("plot", "directory of the .dat files", plotDir);
+  cmd.Parse (argc, argv);
+
+  if (input.empty ())
+    {
+      std::cerr << "Error-- the binary file must be specified " <<
+        "by command-line argument --input=(file)" << std::endl;
+      exit (1);
+    }
+  if (!ScanResultSink::Convert (input, dataDir, plotDir))
+    {
+      std::cerr << "Error-- " << input << " is not a valid result file" << std::endl;
+      exit (1);
+    }
+  return 0;
+}
@@ -0,0 +1,98 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2015 Universite catholique de Louvain
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Lionel Metongnon <lionel.metongnon@uclouvain.be>
+ */
+
+// Run a simulation program for every combination of parameter values, one
+// process per core, each in a directory of its own, and gather the
+// ScanTools/PenetrationTools results in <output>/summary.tsv:
+//
+//   ./waf --run "scan-sweep --program=./build/scratch/scan
+//                --params=PacketSize=64,128;Victims=1,10 --runs=5"
+
+#include "ns3/command-line.h"
+#include "ns3/parameter-sweep.h"
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <stdlib.h> // for exit ()
+
+using namespace ns3;
+
+int main (int argc, char *argv[])
+{
+  std::string program;
+  std::string arguments;
+  std::string params;
+  std::string output = "./sweep";
+  uint32_t firstRun = 1;
+  uint32_t runs = 1;
+  uint32_t jobs = 0;
+
+  CommandLine cmd;
+  cmd.Usage ("Run a simulation program for every combination of parameter values");
+  cmd.AddValue ("program", "simulation program", program);
+  cmd.AddValue ("args", "arguments given to every run, separated by blanks", arguments);
+  cmd.AddValue ("params", "parameters, as <name>=<value>,<value>;<name>=...", params);
+  cmd.AddValue ("output", "directory of the runs", output);
+  cmd.AddValue ("first-run", "first RngRun", firstRun);
+  cmd.AddValue ("runs", "number of RngRun per combination", runs);
+  cmd.AddValue ("jobs", "processes at a time, 0 for one per core", jobs);
+  cmd.Parse (argc, argv);
+
+  if (program.empty ())
+    {
+      std::cerr << "Error-- the simulation program must be specified " <<
+        "by command-line argument --program=(file)" << std::endl;
+      exit (1);
+    }
+
+  ParameterSweep sweep;
+  sweep.SetProgram (program);
+  sweep.SetRuns (firstRun, runs);
+  sweep.SetJobs (jobs);
+  sweep.SetOutputDirectory (output);
+
+  std::istringstream words (arguments);
+  std::string word;
+  while (words >> word)
+    {
+      sweep.AddArgument (word);
+    }
+  std::istringstream parameters (params);
+  std::string parameter;
+  while (std::getline (parameters, parameter, ';'))
+    {
+      std::string::size_type equal = parameter.find ('=');
+      if (equal == std::string::npos)
+        {
+          std::cerr << "Error-- bad parameter " << parameter << std::endl;
+          exit (1);
+        }
+      sweep.AddParameter (parameter.substr (0, equal), parameter.substr (equal + 1));
+    }
+
+  uint32_t failed = sweep.Start ();
+  sweep.PrintSummary (std::cout);
+  if (failed != 0)
+    {
+      std::cerr << failed << " of " << sweep.GetNRuns () << " runs failed" << std::endl;
+      return 1;
+    }
+  return 0;
+}